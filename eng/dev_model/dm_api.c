@@ -128,6 +128,9 @@ int iotx_dm_connect(_IN_ iotx_dm_init_params_t *init_params)
     if (init_params->event_callback != NULL) {
         ctx->event_callback = init_params->event_callback;
     }
+    if (init_params->typed_event_callback != NULL) {
+        ctx->typed_event_callback = init_params->typed_event_callback;
+    }
 
     res = dm_client_connect(IOTX_DM_CLIENT_CONNECT_TIMEOUT_MS);
     if (res != SUCCESS_RETURN) {
@@ -248,10 +251,29 @@ int iotx_dm_yield(int timeout_ms)
     return STATE_SUCCESS;
 }
 
+/* events typed callback does not take are rendered into JSON as they used to be queued */
+static void _dm_api_dispatch_event(dm_api_ctx_t *ctx, iotx_dm_event_t *event)
+{
+    char *message = NULL;
+
+    if (ctx->typed_event_callback && ctx->typed_event_callback(event) == 0) {
+        return;
+    }
+
+    if (ctx->event_callback) {
+        message = dm_msg_event_to_json(event);
+        if (message == NULL) {
+            return;
+        }
+        ctx->event_callback(event->type, message);
+        DM_free(message);
+    }
+}
+
 void iotx_dm_dispatch(void)
 {
     int count = 0;
-    void *data = NULL;
+    dm_ipc_msg_t msg;
     dm_api_ctx_t *ctx = _dm_api_get_ctx();
 
 #if !defined(DM_MESSAGE_CACHE_DISABLED)
@@ -267,18 +289,17 @@ void iotx_dm_dispatch(void)
     dm_fota_status_check();
 #endif
     while (CONFIG_DISPATCH_QUEUE_MAXLEN == 0 || count++ < CONFIG_DISPATCH_QUEUE_MAXLEN) {
-        if (dm_ipc_msg_next(&data) == SUCCESS_RETURN) {
-            dm_ipc_msg_t *msg = (dm_ipc_msg_t *)data;
-
-            if (ctx->event_callback) {
-                ctx->event_callback(msg->type, msg->data);
+        if (dm_ipc_msg_next(&msg) == SUCCESS_RETURN) {
+            if (msg.event != NULL) {
+                _dm_api_dispatch_event(ctx, msg.event);
+                DM_free(msg.event);
+            } else if (ctx->event_callback) {
+                ctx->event_callback(msg.type, msg.data);
             }
 
-            if (msg->data) {
-                DM_free(msg->data);
+            if (msg.data) {
+                DM_free(msg.data);
             }
-            DM_free(msg);
-            data = NULL;
         } else {
             break;
         }
@@ -309,7 +330,8 @@ int iotx_dm_subscribe_user_topic(char *topic, void *user_callback)
         int retry_cnt = IOTX_DM_CLIENT_SUB_RETRY_MAX_COUNTS;
         int local_sub = 0;
         do {
-            res = dm_client_subscribe(uri, dm_client_user_sub_request, &local_sub);
+            res = dm_client_subscribe(dm_client_fd(product_key, device_name), uri, dm_client_user_sub_request,
+                                      &local_sub);
         } while (res < SUCCESS_RETURN && --retry_cnt);
         DM_free(uri);
     }
@@ -593,6 +615,18 @@ int iotx_dm_subdev_destroy(_IN_ int devid)
     return SUCCESS_RETURN;
 }
 
+/* one more gateway to spread subdevices over its connection, added before iotx_dm_connect() */
+int iotx_dm_shard_gateway_add(_IN_ iotx_dev_meta_info_t *meta)
+{
+    int res = 0;
+
+    _dm_api_lock();
+    res = dm_client_shard_add(meta);
+    _dm_api_unlock();
+
+    return res;
+}
+
 int iotx_dm_subdev_number(void)
 {
     int number = 0;
@@ -49,7 +49,7 @@ static dm_client_uri_map_t g_dm_client_uri_map[] = {
 
 #if !defined(DEVICE_MODEL_RAWDATA_SOLO)
 /* property/event post reply filter */
-static int _dm_client_subscribe_filter(char *uri, iotx_cm_data_handle_cb cb)
+static int _dm_client_subscribe_filter(int fd, char *uri, iotx_cm_data_handle_cb cb)
 {
     int res = 0;
     int event_post_reply_opt = 0;
@@ -61,12 +61,12 @@ static int _dm_client_subscribe_filter(char *uri, iotx_cm_data_handle_cb cb)
     }
 
     if (event_post_reply_opt == 0) {
-        res = dm_client_unsubscribe(uri);
+        res = dm_client_unsubscribe(fd, uri);
         return res;
     } else {
         res = -1;
         while (res < SUCCESS_RETURN && retry_cnt--) {
-            res = dm_client_subscribe(uri, cb, 0);
+            res = dm_client_subscribe(fd, uri, cb, 0);
         }
         return res;
     }
@@ -79,15 +79,23 @@ int dm_client_subscribe_all(int devid, char product_key[IOTX_PRODUCT_KEY_LEN + 1
 {
     int res = 0, index = 0;
     int number = sizeof(g_dm_client_uri_map) / sizeof(dm_client_uri_map_t);
+    int fd = dm_client_fd(product_key, device_name);
     char *uri = NULL;
+#ifdef MQTT_AUTO_SUBSCRIBE
     uint8_t local_sub = 0;
+#else
+    iotx_cm_sub_entry_t *entry = NULL;
+    iotx_cm_sub_entry_t swap;
+    int entry_num = 0, failed = 0, idx = 0;
+    int retry_cnt = IOTX_DM_CLIENT_SUB_RETRY_MAX_COUNTS;
+#endif
 
 #if !defined(DEVICE_MODEL_RAWDATA_SOLO)
     /* index 0 must be DM_URI_THING_EVENT_POST_REPLY_WILDCARD */
     res = dm_utils_service_name((char *)g_dm_client_uri_map[0].uri_prefix, (char *)g_dm_client_uri_map[0].uri_name,
                                 product_key, device_name, &uri);
     if (res == SUCCESS_RETURN) {
-        _dm_client_subscribe_filter(uri, (iotx_cm_data_handle_cb)g_dm_client_uri_map[0].callback);
+        _dm_client_subscribe_filter(fd, uri, (iotx_cm_data_handle_cb)g_dm_client_uri_map[0].callback);
         DM_free(uri);
     }
     index = 1;
@@ -102,6 +110,12 @@ int dm_client_subscribe_all(int devid, char product_key[IOTX_PRODUCT_KEY_LEN + 1
     }
 #else
     (void)devid;
+
+    entry = DM_malloc(number * sizeof(iotx_cm_sub_entry_t));
+    if (entry == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    memset(entry, 0, number * sizeof(iotx_cm_sub_entry_t));
 #endif  /* #ifdef MQTT_AUTO_SUBSCRIBE */
 
     for (; index < number; index++) {
@@ -117,7 +131,7 @@ int dm_client_subscribe_all(int devid, char product_key[IOTX_PRODUCT_KEY_LEN + 1
         }
 
         local_sub = 1;
-        res = dm_client_subscribe(uri, (iotx_cm_data_handle_cb)g_dm_client_uri_map[index].callback, &local_sub);
+        res = dm_client_subscribe(fd, uri, (iotx_cm_data_handle_cb)g_dm_client_uri_map[index].callback, &local_sub);
         DM_free(uri);
 #else
         res = dm_utils_service_name((char *)g_dm_client_uri_map[index].uri_prefix, (char *)g_dm_client_uri_map[index].uri_name,
@@ -126,17 +140,39 @@ int dm_client_subscribe_all(int devid, char product_key[IOTX_PRODUCT_KEY_LEN + 1
             continue;
         }
 
-        {
-            int retry_cnt = IOTX_DM_CLIENT_SUB_RETRY_MAX_COUNTS;
-            local_sub = 0;
-            do {
-                res = dm_client_subscribe(uri, (iotx_cm_data_handle_cb)g_dm_client_uri_map[index].callback, &local_sub);
-            } while (res < SUCCESS_RETURN && --retry_cnt);
-            DM_free(uri);
-        }
+        entry[entry_num].topic = uri;
+        entry[entry_num].topic_handle_func = (iotx_cm_data_handle_cb)g_dm_client_uri_map[index].callback;
+        entry_num++;
 #endif /*  MQTT_AUTO_SUBSCRIBE */
     }
 
+#ifndef MQTT_AUTO_SUBSCRIBE
+    /* subscribe all topics without waiting for each other, and retry the failed ones only */
+    failed = entry_num;
+    while (failed > 0 && retry_cnt--) {
+        for (idx = 0; idx < failed; idx++) {
+            entry[idx].result = FAIL_RETURN;
+        }
+        dm_client_subscribe_multi(fd, entry, failed);
+
+        /* move failed ones to the front, so that all uri are still there to be freed */
+        for (idx = 0, res = 0; idx < failed; idx++) {
+            if (entry[idx].result < SUCCESS_RETURN) {
+                swap = entry[res];
+                entry[res] = entry[idx];
+                entry[idx] = swap;
+                res++;
+            }
+        }
+        failed = res;
+    }
+
+    for (idx = 0; idx < entry_num; idx++) {
+        DM_free(entry[idx].topic);
+    }
+    DM_free(entry);
+#endif /*  MQTT_AUTO_SUBSCRIBE */
+
     return SUCCESS_RETURN;
 }
 
@@ -155,6 +191,9 @@ void dm_client_event_handle(int fd, iotx_cm_event_msg_t *event, void *context)
     switch (event->type) {
         case IOTX_CM_EVENT_CLOUD_CONNECTED: {
             _dm_client_event_cloud_connected_handle();
+#ifdef DEVICE_MODEL_GATEWAY
+            dm_client_shard_retry();
+#endif
         }
         break;
         case IOTX_CM_EVENT_CLOUD_CONNECT_FAILED: {
@@ -170,6 +209,36 @@ void dm_client_event_handle(int fd, iotx_cm_event_msg_t *event, void *context)
     }
 }
 
+#ifdef DEVICE_MODEL_GATEWAY
+/* events of shard connections are not told to user, subdevices of a shard which reconnects log in again */
+void dm_client_shard_event_handle(int fd, iotx_cm_event_msg_t *event, void *context)
+{
+    int cursor = 0, devid = 0;
+    char product_key[IOTX_PRODUCT_KEY_LEN + 1] = {0};
+    char device_name[IOTX_DEVICE_NAME_LEN + 1] = {0};
+    char device_secret[IOTX_DEVICE_SECRET_LEN + 1] = {0};
+    iotx_dm_dev_status_t status = IOTX_DM_DEV_STATUS_UNAUTHORIZED;
+
+    if (event->type != IOTX_CM_EVENT_CLOUD_CONNECTED) {
+        return;
+    }
+
+    while (dm_mgr_device_next(&cursor, &devid) == SUCCESS_RETURN) {
+        if (devid == IOTX_DM_LOCAL_NODE_DEVID ||
+            dm_mgr_get_dev_status(devid, &status) != SUCCESS_RETURN || status < IOTX_DM_DEV_STATUS_LOGINED) {
+            continue;
+        }
+        memset(product_key, 0, IOTX_PRODUCT_KEY_LEN + 1);
+        memset(device_name, 0, IOTX_DEVICE_NAME_LEN + 1);
+        if (dm_mgr_search_device_by_devid(devid, product_key, device_name, device_secret) != SUCCESS_RETURN ||
+            dm_client_fd(product_key, device_name) != fd) {
+            continue;
+        }
+        dm_mgr_upstream_combine_login(devid);
+    }
+}
+#endif
+
 void dm_client_thing_model_down_raw(int fd, const char *topic, const char *payload, unsigned int payload_len,
                                     void *context)
 {
@@ -427,6 +496,7 @@ int dm_client_subdev_unsubscribe(char product_key[IOTX_PRODUCT_KEY_LEN + 1], cha
 {
     int res = 0, index = 0;
     int number = sizeof(g_dm_client_uri_map) / sizeof(dm_client_uri_map_t);
+    int fd = dm_client_fd(product_key, device_name);
     char *uri = NULL;
 
     for (index = 0; index < number; index++) {
@@ -441,7 +511,7 @@ int dm_client_subdev_unsubscribe(char product_key[IOTX_PRODUCT_KEY_LEN + 1], cha
             continue;
         }
 
-        dm_client_unsubscribe(uri);
+        dm_client_unsubscribe(fd, uri);
         DM_free(uri);
     }
 
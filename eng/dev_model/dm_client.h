@@ -9,6 +9,9 @@ typedef struct {
 } dm_client_uri_map_t;
 
 void dm_client_event_handle(int fd, iotx_cm_event_msg_t *event, void *context);
+#ifdef DEVICE_MODEL_GATEWAY
+void dm_client_shard_event_handle(int fd, iotx_cm_event_msg_t *event, void *context);
+#endif
 
 int dm_client_subscribe_all(int devid, char product_key[IOTX_PRODUCT_KEY_LEN + 1], char device_name[IOTX_DEVICE_NAME_LEN + 1],
                             int dev_type);
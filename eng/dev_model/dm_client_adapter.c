@@ -2,11 +2,46 @@
 
 static dm_client_ctx_t g_dm_client_ctx = {0};
 
+#ifdef DEVICE_MODEL_GATEWAY
+#if CONFIG_DM_SHARD_MAX >= CM_MAX_FD_NUM
+    #error "CONFIG_DM_SHARD_MAX must be less than CM_MAX_FD_NUM, connection of local gateway takes one fd"
+#endif
+
+/* kept apart from g_dm_client_ctx, so that shards may be added before dm_client_open() */
+static dm_client_shard_t g_dm_client_shard[CONFIG_DM_SHARD_MAX];
+static int g_dm_client_shard_num = 0;
+static int g_dm_client_shard_timeout_ms = 0;
+static int g_dm_client_shard_retry = 0;     /* set by connect of local gateway, shards not connected are retried */
+#endif
+
 static dm_client_ctx_t *dm_client_get_ctx(void)
 {
     return &g_dm_client_ctx;
 }
 
+/* messages to user wait in IPC queue, stop reading cloud before it overflows */
+static int dm_client_rx_backlog(void *context)
+{
+    return dm_ipc_msg_level();
+}
+
+static void _dm_client_init_param(iotx_cm_init_param_t *cm_param)
+{
+    memset(cm_param, 0, sizeof(iotx_cm_init_param_t));
+
+    cm_param->request_timeout_ms = IOTX_DM_CLIENT_REQUEST_TIMEOUT_MS;
+    cm_param->keepalive_interval_ms = IOTX_DM_CLIENT_KEEPALIVE_INTERVAL_MS;
+    cm_param->write_buf_size = CONFIG_MQTT_TX_MAXLEN;
+    cm_param->read_buf_size = CONFIG_MQTT_RX_MAXLEN;
+#if defined(COAP_COMM_ENABLED) && !defined(MQTT_COMM_ENABLED)
+    cm_param->protocol_type = IOTX_CM_PROTOCOL_TYPE_COAP;
+#else
+    cm_param->protocol_type = IOTX_CM_PROTOCOL_TYPE_MQTT;
+#endif
+    cm_param->handle_event = dm_client_event_handle;
+    cm_param->rx_backlog = dm_client_rx_backlog;
+}
+
 int dm_client_open(void)
 {
     int res = 0;
@@ -14,19 +49,12 @@ int dm_client_open(void)
     iotx_cm_init_param_t cm_param;
 
     memset(ctx, 0, sizeof(dm_client_ctx_t));
-    memset(&cm_param, 0, sizeof(iotx_cm_init_param_t));
-
-    cm_param.request_timeout_ms = IOTX_DM_CLIENT_REQUEST_TIMEOUT_MS;
-    cm_param.keepalive_interval_ms = IOTX_DM_CLIENT_KEEPALIVE_INTERVAL_MS;
-    cm_param.write_buf_size = CONFIG_MQTT_TX_MAXLEN;
-    cm_param.read_buf_size = CONFIG_MQTT_RX_MAXLEN;
-#if defined(COAP_COMM_ENABLED) && !defined(MQTT_COMM_ENABLED)
-    cm_param.protocol_type = IOTX_CM_PROTOCOL_TYPE_COAP;
-#else
-    cm_param.protocol_type = IOTX_CM_PROTOCOL_TYPE_MQTT;
+#ifdef DEVICE_MODEL_GATEWAY
+    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, ctx->product_key);
+    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, ctx->device_name);
 #endif
-    cm_param.handle_event = dm_client_event_handle;
 
+    _dm_client_init_param(&cm_param);
     res = iotx_cm_open(&cm_param);
 
     if (res < SUCCESS_RETURN) {
@@ -37,24 +65,174 @@ int dm_client_open(void)
     return SUCCESS_RETURN;
 }
 
+#ifdef DEVICE_MODEL_GATEWAY
+/* add identity of one more gateway to connect with, before dm_client_connect() */
+int dm_client_shard_add(iotx_dev_meta_info_t *meta)
+{
+    dm_client_shard_t *shard = NULL;
+
+    if (meta == NULL || strlen(meta->product_key) == 0 || strlen(meta->device_name) == 0 ||
+        strlen(meta->device_secret) == 0) {
+        return STATE_USER_INPUT_INVALID;
+    }
+    if (g_dm_client_shard_num >= CONFIG_DM_SHARD_MAX) {
+        return STATE_DEV_MODEL_CM_OPEN_FAILED;
+    }
+
+    shard = &g_dm_client_shard[g_dm_client_shard_num++];
+    memcpy(&shard->meta, meta, sizeof(iotx_dev_meta_info_t));
+    shard->fd = -1;
+    shard->connected = 0;
+
+    return SUCCESS_RETURN;
+}
+
+/*
+ * open and connect shards, one which fails to connect is kept open, so that its subdevices are not moved to
+ * other connections, and is connected again when local gateway connects or reconnects next time
+ */
+static void _dm_client_shard_connect(int timeout_ms)
+{
+    int res = 0, idx = 0;
+    dm_client_shard_t *shard = NULL;
+    iotx_cm_init_param_t cm_param;
+
+    _dm_client_init_param(&cm_param);
+    if (cm_param.protocol_type != IOTX_CM_PROTOCOL_TYPE_MQTT) {
+        return;
+    }
+    cm_param.handle_event = dm_client_shard_event_handle;
+
+    for (idx = 0; idx < g_dm_client_shard_num; idx++) {
+        shard = &g_dm_client_shard[idx];
+        if (shard->connected) {
+            continue;
+        }
+
+        if (shard->fd < 0) {
+            cm_param.shard_meta = &shard->meta;
+            res = iotx_cm_open(&cm_param);
+            if (res < SUCCESS_RETURN) {
+                iotx_state_event(ITE_STATE_DEV_MODEL, res, "shard %s.%s open failed", shard->meta.product_key,
+                                 shard->meta.device_name);
+                continue;
+            }
+            shard->fd = res;
+        }
+
+        res = iotx_cm_connect(shard->fd, timeout_ms);
+        if (res != SUCCESS_RETURN) {
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MQTT_CONNECT_FAILED, "shard %s.%s connect failed",
+                             shard->meta.product_key, shard->meta.device_name);
+            continue;
+        }
+        shard->connected = 1;
+
+        /* replies to gateway requests on behalf of subdevices come to topics of shard gateway */
+        dm_client_subscribe_all(IOTX_DM_LOCAL_NODE_DEVID, shard->meta.product_key, shard->meta.device_name,
+                                IOTX_DM_DEVICE_GATEWAY);
+    }
+}
+
+/* called on connect of local gateway, in its yield thread, so shards are connected later by dm_client_yield() */
+void dm_client_shard_retry(void)
+{
+    g_dm_client_shard_retry = 1;
+}
+#endif
+
 int dm_client_connect(int timeout_ms)
 {
+    int res = 0;
     dm_client_ctx_t *ctx = dm_client_get_ctx();
 
-    return iotx_cm_connect(ctx->fd, timeout_ms);
+    res = iotx_cm_connect(ctx->fd, timeout_ms);
+#ifdef DEVICE_MODEL_GATEWAY
+    if (res == SUCCESS_RETURN) {
+        g_dm_client_shard_timeout_ms = timeout_ms;
+        g_dm_client_shard_retry = 0;
+        _dm_client_shard_connect(timeout_ms);
+    }
+#endif
+
+    return res;
 }
 
 int dm_client_close(void)
 {
     dm_client_ctx_t *ctx = dm_client_get_ctx();
+#ifdef DEVICE_MODEL_GATEWAY
+    int idx = 0;
+
+    for (idx = 0; idx < g_dm_client_shard_num; idx++) {
+        if (g_dm_client_shard[idx].fd >= 0) {
+            iotx_cm_close(g_dm_client_shard[idx].fd);
+            g_dm_client_shard[idx].fd = -1;
+        }
+        g_dm_client_shard[idx].connected = 0;
+    }
+    g_dm_client_shard_retry = 0;
+#endif
 
     return iotx_cm_close(ctx->fd);
 }
 
-int dm_client_subscribe(char *uri, iotx_cm_data_handle_cb callback, void *context)
+/* fd of connection which carries traffic of device */
+int dm_client_fd(const char *product_key, const char *device_name)
 {
-    uint8_t local_sub = 0;
     dm_client_ctx_t *ctx = dm_client_get_ctx();
+#ifdef DEVICE_MODEL_GATEWAY
+    int idx = 0, fd = 0, shard_num = 0;
+
+    for (idx = 0; idx < g_dm_client_shard_num; idx++) {
+        if (g_dm_client_shard[idx].fd < 0) {
+            continue;
+        }
+        if (strcmp(g_dm_client_shard[idx].meta.product_key, product_key) == 0 &&
+            strcmp(g_dm_client_shard[idx].meta.device_name, device_name) == 0) {
+            return g_dm_client_shard[idx].fd;
+        }
+        shard_num++;
+    }
+
+    /* local gateway always talks through its own connection */
+    if (shard_num == 0 || (strcmp(ctx->product_key, product_key) == 0 && strcmp(ctx->device_name, device_name) == 0)) {
+        return ctx->fd;
+    }
+
+    fd = iotx_cm_shard_fd(product_key, device_name);
+    if (fd >= 0) {
+        return fd;
+    }
+#endif
+
+    return ctx->fd;
+}
+
+#ifdef DEVICE_MODEL_GATEWAY
+/* identity of gateway whose connection carries traffic of subdevice, requests on its behalf go to topics of it */
+void dm_client_gateway(const char *product_key, const char *device_name,
+                       char gw_product_key[IOTX_PRODUCT_KEY_LEN + 1], char gw_device_name[IOTX_DEVICE_NAME_LEN + 1])
+{
+    dm_client_ctx_t *ctx = dm_client_get_ctx();
+    int idx = 0, fd = dm_client_fd(product_key, device_name);
+
+    for (idx = 0; idx < g_dm_client_shard_num; idx++) {
+        if (g_dm_client_shard[idx].fd >= 0 && g_dm_client_shard[idx].fd == fd) {
+            memcpy(gw_product_key, g_dm_client_shard[idx].meta.product_key, IOTX_PRODUCT_KEY_LEN + 1);
+            memcpy(gw_device_name, g_dm_client_shard[idx].meta.device_name, IOTX_DEVICE_NAME_LEN + 1);
+            return;
+        }
+    }
+
+    memcpy(gw_product_key, ctx->product_key, IOTX_PRODUCT_KEY_LEN + 1);
+    memcpy(gw_device_name, ctx->device_name, IOTX_DEVICE_NAME_LEN + 1);
+}
+#endif
+
+int dm_client_subscribe(int fd, char *uri, iotx_cm_data_handle_cb callback, void *context)
+{
+    uint8_t local_sub = 0;
     iotx_cm_ext_params_t sub_params;
 
     memset(&sub_params, 0, sizeof(iotx_cm_ext_params_t));
@@ -73,21 +251,32 @@ int dm_client_subscribe(char *uri, iotx_cm_data_handle_cb callback, void *contex
     sub_params.sync_timeout = IOTX_DM_CLIENT_SUB_TIMEOUT_MS;
     sub_params.ack_cb = NULL;
 
-    return iotx_cm_sub(ctx->fd, &sub_params, (const char *)uri, callback, NULL);
+    return iotx_cm_sub(fd, &sub_params, (const char *)uri, callback, NULL);
 }
 
-int dm_client_unsubscribe(char *uri)
+/* subscribe to cloud topics together, 'result' of each entry tells whether it is subscribed */
+int dm_client_subscribe_multi(int fd, iotx_cm_sub_entry_t *entry, int count)
 {
-    dm_client_ctx_t *ctx = dm_client_get_ctx();
+    iotx_cm_ext_params_t sub_params;
 
-    return iotx_cm_unsub(ctx->fd, uri);
+    memset(&sub_params, 0, sizeof(iotx_cm_ext_params_t));
+    sub_params.ack_type = IOTX_CM_MESSAGE_NO_ACK;
+    sub_params.sync_mode = IOTX_CM_SYNC;
+    sub_params.sync_timeout = IOTX_DM_CLIENT_SUB_TIMEOUT_MS;
+    sub_params.ack_cb = NULL;
+
+    return iotx_cm_sub_multi(fd, &sub_params, entry, count);
+}
+
+int dm_client_unsubscribe(int fd, char *uri)
+{
+    return iotx_cm_unsub(fd, uri);
 }
 
-int dm_client_publish(char *uri, unsigned char *payload, int payload_len, iotx_cm_data_handle_cb callback)
+int dm_client_publish(int fd, char *uri, unsigned char *payload, int payload_len, iotx_cm_data_handle_cb callback)
 {
     int res = 0;
     char *pub_uri = NULL;
-    dm_client_ctx_t *ctx = dm_client_get_ctx();
     iotx_cm_ext_params_t pub_param;
 
     memset(&pub_param, 0, sizeof(iotx_cm_ext_params_t));
@@ -108,7 +297,7 @@ int dm_client_publish(char *uri, unsigned char *payload, int payload_len, iotx_c
 
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_TX_CLOUD_MESSAGE, "pub-uri: %s", pub_uri);
 
-    res = iotx_cm_pub(ctx->fd, &pub_param, (const char *)pub_uri, (const char *)payload, (unsigned int)payload_len);
+    res = iotx_cm_pub(fd, &pub_param, (const char *)pub_uri, (const char *)payload, (unsigned int)payload_len);
 
 #if defined(COAP_COMM_ENABLED) && !defined(MQTT_COMM_ENABLED)
     DM_free(pub_uri);
@@ -121,6 +310,13 @@ int dm_client_yield(unsigned int timeout)
 {
     dm_client_ctx_t *ctx = dm_client_get_ctx();
 
+#ifdef DEVICE_MODEL_GATEWAY
+    if (g_dm_client_shard_retry) {
+        g_dm_client_shard_retry = 0;
+        _dm_client_shard_connect(g_dm_client_shard_timeout_ms);
+    }
+#endif
+
     return iotx_cm_yield(ctx->fd, timeout);
 }
 
@@ -5,14 +5,39 @@ typedef struct {
     int fd;
     iotx_conn_info_t *conn_info;
     void *callback;
+#ifdef DEVICE_MODEL_GATEWAY
+    char product_key[IOTX_PRODUCT_KEY_LEN + 1];
+    char device_name[IOTX_DEVICE_NAME_LEN + 1];
+#endif
 } dm_client_ctx_t;
 
+#ifdef DEVICE_MODEL_GATEWAY
+/*
+ * Connection made with identity of one more gateway. Subdevices are spread over the
+ * connection of local gateway and those of shards by iotx_cm_shard_fd(), and all their
+ * traffic, including topo and login requests of gateway on their behalf, goes through it.
+ */
+typedef struct {
+    iotx_dev_meta_info_t meta;
+    int fd;                         /* -1 unless opened, kept while connect is retried, so sharding stays the same */
+    int connected;
+} dm_client_shard_t;
+#endif
+
 int dm_client_open(void);
 int dm_client_connect(int timeout_ms);
 int dm_client_close(void);
-int dm_client_subscribe(char *uri, iotx_cm_data_handle_cb callback, void *context);
-int dm_client_unsubscribe(char *uri);
-int dm_client_publish(char *uri, unsigned char *payload, int payload_len, iotx_cm_data_handle_cb callback);
+int dm_client_fd(const char *product_key, const char *device_name);
+#ifdef DEVICE_MODEL_GATEWAY
+int dm_client_shard_add(iotx_dev_meta_info_t *meta);
+void dm_client_shard_retry(void);
+void dm_client_gateway(const char *product_key, const char *device_name,
+                       char gw_product_key[IOTX_PRODUCT_KEY_LEN + 1], char gw_device_name[IOTX_DEVICE_NAME_LEN + 1]);
+#endif
+int dm_client_subscribe(int fd, char *uri, iotx_cm_data_handle_cb callback, void *context);
+int dm_client_subscribe_multi(int fd, iotx_cm_sub_entry_t *entry, int count);
+int dm_client_unsubscribe(int fd, char *uri);
+int dm_client_publish(int fd, char *uri, unsigned char *payload, int payload_len, iotx_cm_data_handle_cb callback);
 int dm_client_yield(unsigned int timeout);
 void dm_client_user_sub_request(int fd, const char *topic, const char *payload, unsigned int payload_len,
                                 void *context);
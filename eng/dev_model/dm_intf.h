@@ -12,6 +12,7 @@ typedef struct {
     void *cloud_connectivity;
     void *local_connectivity;
     iotx_dm_event_callback event_callback;
+    iotx_dm_typed_event_callback typed_event_callback;
 } dm_api_ctx_t;
 
 #if defined(DEPRECATED_LINKKIT)
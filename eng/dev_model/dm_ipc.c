@@ -6,6 +6,15 @@
 
 #include "iotx_dm_internal.h"
 
+#ifndef DM_IPC_HAS_ATOMIC
+    /* plain accesses, queue is locked by mutex */
+    #define DM_IPC_ATOMIC_LOAD(ptr)                 (*(ptr))
+    #define DM_IPC_ATOMIC_STORE(ptr, val)           (*(ptr) = (val))
+    #define DM_IPC_ATOMIC_CAS(ptr, expected, val)   ((*(ptr) == *(expected)) ? (*(ptr) = (val), 1) : (*(expected) = *(ptr), 0))
+#endif
+
+#define DM_IPC_SLOT(ctx, pos)   (&(ctx)->slot[(pos) & (ctx)->mask])
+
 dm_ipc_t g_dm_ipc;
 
 static dm_ipc_t *_dm_ipc_get_ctx(void)
@@ -32,18 +41,40 @@ static void _dm_ipc_unlock(void)
 int dm_ipc_init(int max_size)
 {
     dm_ipc_t *ctx = _dm_ipc_get_ctx();
+    uint32_t num = 1, pos = 0;
 
     memset(ctx, 0, sizeof(dm_ipc_t));
 
+    if (max_size <= 0) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+#ifndef DM_IPC_HAS_ATOMIC
     /* Create Mutex */
     ctx->mutex = HAL_MutexCreate();
     if (ctx->mutex == NULL) {
         return STATE_SYS_DEPEND_MUTEX_CREATE;
     }
+#endif
 
-    /* Init List */
-    ctx->msg_list.max_size = max_size;
-    INIT_LIST_HEAD(&ctx->msg_list.message_list);
+    /* Init Ring, the only allocation of queue */
+    while (num < (uint32_t)max_size) {
+        num <<= 1;
+    }
+    ctx->slot = DM_malloc(num * sizeof(dm_ipc_slot_t));
+    if (ctx->slot == NULL) {
+        if (ctx->mutex) {
+            HAL_MutexDestroy(ctx->mutex);
+            ctx->mutex = NULL;
+        }
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    memset(ctx->slot, 0, num * sizeof(dm_ipc_slot_t));
+    for (pos = 0; pos < num; pos++) {
+        ctx->slot[pos].seq = pos;
+    }
+    ctx->mask = num - 1;
+    ctx->max_size = max_size;
 
     return SUCCESS_RETURN;
 }
@@ -51,88 +82,137 @@ int dm_ipc_init(int max_size)
 void dm_ipc_deinit(void)
 {
     dm_ipc_t *ctx = _dm_ipc_get_ctx();
-    dm_ipc_msg_node_t *del_node = NULL;
-    dm_ipc_msg_node_t *next_node = NULL;
-    dm_ipc_msg_t *del_msg = NULL;
+    dm_ipc_msg_t del_msg;
 
-    if (ctx->mutex) {
-        HAL_MutexDestroy(ctx->mutex);
+    if (ctx->slot == NULL) {
+        return;
     }
 
-    list_for_each_entry_safe(del_node, next_node, &ctx->msg_list.message_list, linked_list, dm_ipc_msg_node_t) {
-        /* Free Message */
-        del_msg = (dm_ipc_msg_t *)del_node->data;
-        if (del_msg->data) {
-            DM_free(del_msg->data);
+    /* Free Messages Left */
+    while (dm_ipc_msg_next(&del_msg) == SUCCESS_RETURN) {
+        if (del_msg.data) {
+            DM_free(del_msg.data);
+        }
+        if (del_msg.event) {
+            DM_free(del_msg.event);
         }
-        DM_free(del_msg);
-        del_msg = NULL;
+    }
+
+    DM_free(ctx->slot);
+    ctx->slot = NULL;
 
-        /* Free Node */
-        list_del(&del_node->linked_list);
-        DM_free(del_node);
+    if (ctx->mutex) {
+        HAL_MutexDestroy(ctx->mutex);
+        ctx->mutex = NULL;
     }
 }
 
-int dm_ipc_msg_insert(void *data)
+/* claim next position and copy 'msg' into its slot, any thread may call it, what 'msg' points to is taken over */
+int dm_ipc_msg_insert(dm_ipc_msg_t *msg)
 {
     dm_ipc_t *ctx = _dm_ipc_get_ctx();
-    dm_ipc_msg_node_t *node = NULL;
+    dm_ipc_slot_t *slot = NULL;
+    uint32_t pos = 0;
+    int32_t diff = 0;
 
-    if (data == NULL) {
+    if (msg == NULL || ctx->slot == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
     _dm_ipc_lock();
-    iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_OPERATION, "msg queue size: %d, max size: %d",
-                     ctx->msg_list.size, ctx->msg_list.max_size);
-    if (ctx->msg_list.size >= ctx->msg_list.max_size) {
-        _dm_ipc_unlock();
-        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_FULL, NULL);
-        return STATE_DEV_MODEL_MSGQ_FULL;
-    }
+    pos = DM_IPC_ATOMIC_LOAD(&ctx->tail);
+    for (;;) {
+        /* size is kept to 'max_size', ring may be larger as it is a power of 2 */
+        if ((int32_t)(pos - DM_IPC_ATOMIC_LOAD(&ctx->head)) >= ctx->max_size) {
+            _dm_ipc_unlock();
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_FULL, NULL);
+            return STATE_DEV_MODEL_MSGQ_FULL;
+        }
 
-    node = DM_malloc(sizeof(dm_ipc_msg_node_t));
-    if (node == NULL) {
-        _dm_ipc_unlock();
-        return STATE_SYS_DEPEND_MALLOC;
+        slot = DM_IPC_SLOT(ctx, pos);
+        diff = (int32_t)(DM_IPC_ATOMIC_LOAD(&slot->seq) - pos);
+        if (diff == 0) {
+            /* slot is free, claim it unless another producer did, then 'pos' is reloaded */
+            if (DM_IPC_ATOMIC_CAS(&ctx->tail, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* consumer has not emptied the slot of last round yet */
+            _dm_ipc_unlock();
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_FULL, NULL);
+            return STATE_DEV_MODEL_MSGQ_FULL;
+        } else {
+            pos = DM_IPC_ATOMIC_LOAD(&ctx->tail);
+        }
     }
-    memset(node, 0, sizeof(dm_ipc_msg_node_t));
-
-    node->data = data;
-    INIT_LIST_HEAD(&node->linked_list);
-    ctx->msg_list.size++;
-    list_add_tail(&node->linked_list, &ctx->msg_list.message_list);
 
+    memcpy(&slot->msg, msg, sizeof(dm_ipc_msg_t));
+    DM_IPC_ATOMIC_STORE(&slot->seq, pos + 1);
     _dm_ipc_unlock();
+
+    iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_OPERATION, "msg queue size: %d, max size: %d",
+                     (int)(pos + 1 - DM_IPC_ATOMIC_LOAD(&ctx->head)), ctx->max_size);
     return SUCCESS_RETURN;
 }
 
-int dm_ipc_msg_next(void **data)
+/* take oldest filled slot into 'msg', position is claimed as well, so that dispatch may run in more than one thread */
+int dm_ipc_msg_next(dm_ipc_msg_t *msg)
 {
     dm_ipc_t *ctx = _dm_ipc_get_ctx();
-    dm_ipc_msg_node_t *node = NULL;
+    dm_ipc_slot_t *slot = NULL;
+    uint32_t pos = 0;
+    int32_t diff = 0;
 
-    if (data == NULL || *data != NULL) {
+    if (msg == NULL || ctx->slot == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
     _dm_ipc_lock();
-
-    if (list_empty(&ctx->msg_list.message_list)) {
-        _dm_ipc_unlock();
-        return STATE_DEV_MODEL_MSGQ_EMPTY;
+    pos = DM_IPC_ATOMIC_LOAD(&ctx->head);
+    for (;;) {
+        slot = DM_IPC_SLOT(ctx, pos);
+        diff = (int32_t)(DM_IPC_ATOMIC_LOAD(&slot->seq) - (pos + 1));
+        if (diff == 0) {
+            if (DM_IPC_ATOMIC_CAS(&ctx->head, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* nothing filled, or producer which claimed it is still copying */
+            _dm_ipc_unlock();
+            return STATE_DEV_MODEL_MSGQ_EMPTY;
+        } else {
+            pos = DM_IPC_ATOMIC_LOAD(&ctx->head);
+        }
     }
 
-    node = list_first_entry(&ctx->msg_list.message_list, dm_ipc_msg_node_t, linked_list);
-    list_del(&node->linked_list);
-    ctx->msg_list.size--;
-
-    *data = node->data;
-    DM_free(node);
-
+    memcpy(msg, &slot->msg, sizeof(dm_ipc_msg_t));
+    /* free for producer of next round */
+    DM_IPC_ATOMIC_STORE(&slot->seq, pos + ctx->mask + 1);
     _dm_ipc_unlock();
+
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_OPERATION, "msg dequeue");
     return SUCCESS_RETURN;
 }
 
+
+/* fill level of message queue in percent of its capacity */
+int dm_ipc_msg_level(void)
+{
+    dm_ipc_t *ctx = _dm_ipc_get_ctx();
+    int32_t size = 0;
+
+    if (ctx->slot == NULL || ctx->max_size <= 0) {
+        return 0;
+    }
+
+    /* read without lock, so that it is a snapshot at best */
+    size = (int32_t)(DM_IPC_ATOMIC_LOAD(&ctx->tail) - DM_IPC_ATOMIC_LOAD(&ctx->head));
+    if (size < 0) {
+        size = 0;
+    }
+    if (size > ctx->max_size) {
+        size = ctx->max_size;
+    }
+
+    return size * 100 / ctx->max_size;
+}
@@ -12,27 +12,45 @@
 typedef struct {
     iotx_dm_event_types_t type;
     char *data;
+    iotx_dm_event_t *event;     /* typed event instead of JSON 'data', its strings follow it */
 } dm_ipc_msg_t;
 
-typedef struct {
-    void *data;
-    struct list_head linked_list;
-} dm_ipc_msg_node_t;
+/* atomic operations of message queue, it is locked by mutex without them */
+#if defined(__GNUC__) || defined(__clang__)
+    #define DM_IPC_HAS_ATOMIC
+    #define DM_IPC_ATOMIC_LOAD(ptr)                 __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define DM_IPC_ATOMIC_STORE(ptr, val)           __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+    #define DM_IPC_ATOMIC_CAS(ptr, expected, val)   \
+        __atomic_compare_exchange_n((ptr), (expected), (val), 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#endif
 
+/* Slot of message queue, message is kept in it, 'seq' tells whose turn it is, see dm_ipc_msg_insert() */
 typedef struct {
-    int max_size;
-    int size;
-    struct list_head message_list;
-} dm_ipc_msg_list_t;
+    uint32_t seq;
+    dm_ipc_msg_t msg;
+} dm_ipc_slot_t;
 
+/*
+ * Bounded queue of messages to user, pushed by any thread and popped by dispatch, without lock.
+ * Slot 'pos & mask' holds seq 'pos' when it is free for the producer claiming 'pos', and 'pos + 1'
+ * once that producer filled it. Positions of producers and consumer are kept on cache lines of
+ * their own, so that threads on both sides do not invalidate each other's line.
+ */
 typedef struct {
-    void *mutex;
-    dm_ipc_msg_list_t msg_list;
+    uint32_t tail;              /* next position claimed by producers */
+    uint8_t tail_pad[CONFIG_IPC_CACHE_LINE - sizeof(uint32_t)];
+    uint32_t head;              /* next position claimed by consumer */
+    uint8_t head_pad[CONFIG_IPC_CACHE_LINE - sizeof(uint32_t)];
+    uint32_t mask;              /* slots are a power of 2, not less than 'max_size' */
+    int max_size;
+    dm_ipc_slot_t *slot;
+    void *mutex;                /* only without atomic operations */
 } dm_ipc_t;
 
 int dm_ipc_init(int max_size);
 void dm_ipc_deinit(void);
-int dm_ipc_msg_insert(void *data);
-int dm_ipc_msg_next(void **data);
+int dm_ipc_msg_insert(dm_ipc_msg_t *msg);
+int dm_ipc_msg_next(dm_ipc_msg_t *msg);
+int dm_ipc_msg_level(void);
 
 #endif
@@ -29,28 +29,179 @@ static void _dm_mgr_mutex_unlock(void)
     }
 }
 
-static int _dm_mgr_next_devid(void)
+#define DM_MGR_DEV_TABLE_SIZE_MIN   (8)
+#define DM_MGR_PKDN_INDEX_SIZE_MIN  (16)
+
+/* devid destroyed longest ago, or a new one if none is free, it is taken by _dm_mgr_take_devid() */
+static int _dm_mgr_next_devid(dm_mgr_ctx *ctx)
 {
-    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
+    if (ctx->free_num > 0) {
+        return ctx->free_devid[ctx->free_head];
+    }
 
-    return ctx->global_devid++;
+    return ctx->global_devid;
 }
 
-static int _dm_mgr_search_dev_by_devid(_IN_ int devid, _OU_ dm_mgr_dev_node_t **node)
+static void _dm_mgr_take_devid(dm_mgr_ctx *ctx)
 {
-    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *search_node = NULL;
+    if (ctx->free_num > 0) {
+        ctx->free_head = (ctx->free_head + 1) % ctx->dev_table_size;
+        ctx->free_num--;
+        return;
+    }
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if (search_node->devid == devid) {
-            if (node) {
-                *node = search_node;
+    ctx->global_devid++;
+}
+
+/* FNV-1a of product key and device name, with '/' in between as neither of them has it */
+static uint32_t _dm_mgr_pkdn_hash(const char *product_key, const char *device_name)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*product_key != '\0') {
+        hash = (hash ^ (uint8_t)*product_key++) * 16777619U;
+    }
+    hash = (hash ^ (uint8_t)'/') * 16777619U;
+    while (*device_name != '\0') {
+        hash = (hash ^ (uint8_t)*device_name++) * 16777619U;
+    }
+
+    return hash;
+}
+
+static void _dm_mgr_pkdn_index_insert(dm_mgr_ctx *ctx, dm_mgr_dev_node_t *node)
+{
+    uint32_t mask = ctx->pkdn_index_size - 1;
+    uint32_t idx = node->pkdn_hash & mask;
+
+    while (ctx->pkdn_index[idx] != NULL) {
+        idx = (idx + 1) & mask;
+    }
+    ctx->pkdn_index[idx] = node;
+}
+
+/* clear slot and shift back following nodes of the probe sequence, so that no tombstone is needed */
+static void _dm_mgr_pkdn_index_remove(dm_mgr_ctx *ctx, uint32_t idx)
+{
+    uint32_t mask = ctx->pkdn_index_size - 1;
+    uint32_t next = (idx + 1) & mask;
+    uint32_t home = 0;
+
+    ctx->pkdn_index[idx] = NULL;
+    while (ctx->pkdn_index[next] != NULL) {
+        home = ctx->pkdn_index[next]->pkdn_hash & mask;
+        /* move node back unless its home slot lies cyclically in (idx, next] */
+        if ((next > idx && (home <= idx || home > next)) || (next < idx && home <= idx && home > next)) {
+            ctx->pkdn_index[idx] = ctx->pkdn_index[next];
+            ctx->pkdn_index[next] = NULL;
+            idx = next;
+        }
+        next = (next + 1) & mask;
+    }
+}
+
+/* make room for one more device in both table and index, so that adding it can not fail any more */
+static int _dm_mgr_reserve_dev(dm_mgr_ctx *ctx, int devid)
+{
+    int size = 0, idx = 0;
+    dm_mgr_dev_node_t **table = NULL;
+    dm_mgr_dev_node_t **index = NULL;
+    int *ring = NULL;
+    uint32_t old_size = 0;
+
+    if (devid >= ctx->dev_table_size) {
+        size = (ctx->dev_table_size == 0) ? DM_MGR_DEV_TABLE_SIZE_MIN : ctx->dev_table_size;
+        while (size <= devid) {
+            size *= 2;
+        }
+        table = DM_malloc(size * sizeof(dm_mgr_dev_node_t *));
+        if (table == NULL) {
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        /* every devid below table size may be destroyed, so that ring of them never overflows */
+        ring = DM_malloc(size * sizeof(int));
+        if (ring == NULL) {
+            DM_free(table);
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        memset(table, 0, size * sizeof(dm_mgr_dev_node_t *));
+        if (ctx->dev_table != NULL) {
+            memcpy(table, ctx->dev_table, ctx->dev_table_size * sizeof(dm_mgr_dev_node_t *));
+            DM_free(ctx->dev_table);
+        }
+        for (idx = 0; idx < ctx->free_num; idx++) {
+            ring[idx] = ctx->free_devid[(ctx->free_head + idx) % ctx->dev_table_size];
+        }
+        if (ctx->free_devid != NULL) {
+            DM_free(ctx->free_devid);
+        }
+        ctx->dev_table = table;
+        ctx->dev_table_size = size;
+        ctx->free_devid = ring;
+        ctx->free_head = 0;
+    }
+
+    /* keep index at most half full, so that probe sequences stay short */
+    if ((uint32_t)(ctx->dev_num + 1) * 2 > ctx->pkdn_index_size) {
+        old_size = ctx->pkdn_index_size;
+        size = (old_size == 0) ? DM_MGR_PKDN_INDEX_SIZE_MIN : old_size * 2;
+        index = DM_malloc(size * sizeof(dm_mgr_dev_node_t *));
+        if (index == NULL) {
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        memset(index, 0, size * sizeof(dm_mgr_dev_node_t *));
+        table = ctx->pkdn_index;
+        ctx->pkdn_index = index;
+        ctx->pkdn_index_size = size;
+        for (idx = 0; idx < (int)old_size; idx++) {
+            if (table[idx] != NULL) {
+                _dm_mgr_pkdn_index_insert(ctx, table[idx]);
             }
-            return SUCCESS_RETURN;
+        }
+        if (table != NULL) {
+            DM_free(table);
         }
     }
 
-    return STATE_DEV_MODEL_DEVICE_NOT_FOUND;
+    return SUCCESS_RETURN;
+}
+
+/* room has to be reserved by _dm_mgr_reserve_dev() */
+static void _dm_mgr_add_dev(dm_mgr_ctx *ctx, dm_mgr_dev_node_t *node)
+{
+    node->pkdn_hash = _dm_mgr_pkdn_hash(node->product_key, node->device_name);
+    ctx->dev_table[node->devid] = node;
+    _dm_mgr_pkdn_index_insert(ctx, node);
+    ctx->dev_num++;
+}
+
+static void _dm_mgr_remove_dev(dm_mgr_ctx *ctx, dm_mgr_dev_node_t *node)
+{
+    uint32_t mask = ctx->pkdn_index_size - 1;
+    uint32_t idx = node->pkdn_hash & mask;
+
+    while (ctx->pkdn_index[idx] != node) {
+        idx = (idx + 1) & mask;
+    }
+    _dm_mgr_pkdn_index_remove(ctx, idx);
+    ctx->dev_table[node->devid] = NULL;
+    ctx->dev_num--;
+    ctx->free_devid[(ctx->free_head + ctx->free_num) % ctx->dev_table_size] = node->devid;
+    ctx->free_num++;
+}
+
+static int _dm_mgr_search_dev_by_devid(_IN_ int devid, _OU_ dm_mgr_dev_node_t **node)
+{
+    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
+
+    if (devid < 0 || devid >= ctx->dev_table_size || ctx->dev_table[devid] == NULL) {
+        return STATE_DEV_MODEL_DEVICE_NOT_FOUND;
+    }
+
+    if (node) {
+        *node = ctx->dev_table[devid];
+    }
+    return SUCCESS_RETURN;
 }
 
 static int _dm_mgr_search_dev_by_pkdn(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
@@ -58,12 +209,18 @@ static int _dm_mgr_search_dev_by_pkdn(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN
 {
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *search_node = NULL;
+    uint32_t hash = 0, mask = 0, idx = 0;
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if ((strlen(search_node->product_key) == strlen(product_key)) &&
-            (memcmp(search_node->product_key, product_key, strlen(product_key)) == 0) &&
-            (strlen(search_node->device_name) == strlen(device_name)) &&
-            (memcmp(search_node->device_name, device_name, strlen(device_name)) == 0)) {
+    if (ctx->pkdn_index_size == 0) {
+        return STATE_DEV_MODEL_DEVICE_NOT_FOUND;
+    }
+
+    hash = _dm_mgr_pkdn_hash(product_key, device_name);
+    mask = ctx->pkdn_index_size - 1;
+    for (idx = hash & mask; (search_node = ctx->pkdn_index[idx]) != NULL; idx = (idx + 1) & mask) {
+        if (search_node->pkdn_hash == hash &&
+            strcmp(search_node->product_key, product_key) == 0 &&
+            strcmp(search_node->device_name, device_name) == 0) {
             if (node) {
                 *node = search_node;
             }
@@ -94,6 +251,11 @@ static int _dm_mgr_insert_dev(_IN_ int devid, _IN_ int dev_type, char product_ke
         return STATE_DEV_MODEL_DEVICE_ALREADY_EXIST;
     }
 
+    res = _dm_mgr_reserve_dev(ctx, devid);
+    if (res != SUCCESS_RETURN) {
+        return res;
+    }
+
     node = DM_malloc(sizeof(dm_mgr_dev_node_t));
     if (node == NULL) {
         return STATE_SYS_DEPEND_MALLOC;
@@ -104,9 +266,8 @@ static int _dm_mgr_insert_dev(_IN_ int devid, _IN_ int dev_type, char product_ke
     node->dev_type = dev_type;
     memcpy(node->product_key, product_key, strlen(product_key));
     memcpy(node->device_name, device_name, strlen(device_name));
-    INIT_LIST_HEAD(&node->linked_list);
 
-    list_add_tail(&node->linked_list, &ctx->dev_list);
+    _dm_mgr_add_dev(ctx, node);
 
     return SUCCESS_RETURN;
 }
@@ -115,15 +276,36 @@ static void _dm_mgr_destroy_devlist(void)
 {
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
     dm_mgr_dev_node_t *del_node = NULL;
-    dm_mgr_dev_node_t *next_node = NULL;
+    int devid = 0;
 
-    list_for_each_entry_safe(del_node, next_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        list_del(&del_node->linked_list);
+    for (devid = 0; devid < ctx->dev_table_size; devid++) {
+        del_node = ctx->dev_table[devid];
+        if (del_node == NULL) {
+            continue;
+        }
 #ifdef DEPRECATED_LINKKIT
         dm_shw_destroy(&del_node->dev_shadow);
 #endif
         DM_free(del_node);
     }
+
+    if (ctx->dev_table) {
+        DM_free(ctx->dev_table);
+    }
+    if (ctx->pkdn_index) {
+        DM_free(ctx->pkdn_index);
+    }
+    if (ctx->free_devid) {
+        DM_free(ctx->free_devid);
+    }
+    ctx->dev_table = NULL;
+    ctx->dev_table_size = 0;
+    ctx->free_devid = NULL;
+    ctx->free_head = 0;
+    ctx->free_num = 0;
+    ctx->pkdn_index = NULL;
+    ctx->pkdn_index_size = 0;
+    ctx->dev_num = 0;
 }
 
 #ifdef DEPRECATED_LINKKIT
@@ -170,9 +352,6 @@ int dm_mgr_init(void)
     /* Init Device Id*/
     ctx->global_devid = IOTX_DM_LOCAL_NODE_DEVID + 1;
 
-    /* Init Device List */
-    INIT_LIST_HEAD(&ctx->dev_list);
-
     /* Local Node */
     IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, product_key);
     IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, device_name);
@@ -188,6 +367,7 @@ int dm_mgr_init(void)
     return SUCCESS_RETURN;
 
 ERROR:
+    _dm_mgr_destroy_devlist();
     if (ctx->mutex) {
         HAL_MutexDestroy(ctx->mutex);
     }
@@ -256,13 +436,19 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
         return STATE_DEV_MODEL_DEVICE_ALREADY_EXIST;
     }
 
+    res = _dm_mgr_reserve_dev(ctx, _dm_mgr_next_devid(ctx));
+    if (res != SUCCESS_RETURN) {
+        return res;
+    }
+
     node = DM_malloc(sizeof(dm_mgr_dev_node_t));
     if (node == NULL) {
         return STATE_SYS_DEPEND_MALLOC;
     }
     memset(node, 0, sizeof(dm_mgr_dev_node_t));
 
-    node->devid = _dm_mgr_next_devid();
+    node->devid = _dm_mgr_next_devid(ctx);
+    _dm_mgr_take_devid(ctx);
     node->dev_type = dev_type;
 #if defined(DEPRECATED_LINKKIT)
     node->dev_shadow = NULL;
@@ -275,9 +461,8 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
         memcpy(node->device_secret, device_secret, strlen(device_secret));
     }
     node->dev_status = IOTX_DM_DEV_STATUS_AUTHORIZED;
-    INIT_LIST_HEAD(&node->linked_list);
 
-    list_add_tail(&node->linked_list, &ctx->dev_list);
+    _dm_mgr_add_dev(ctx, node);
 
     if (devid) {
         *devid = node->devid;
@@ -304,7 +489,7 @@ int dm_mgr_device_destroy(_IN_ int devid)
         return STATE_DEV_MODEL_SUBD_NOT_DELETEABLE;
     }
 
-    list_del(&node->linked_list);
+    _dm_mgr_remove_dev(_dm_mgr_get_ctx(), node);
 
 #if defined(DEPRECATED_LINKKIT)
     if (node->dev_shadow) {
@@ -323,57 +508,49 @@ int dm_mgr_device_destroy(_IN_ int devid)
 
 int dm_mgr_device_number(void)
 {
-    int index = 0;
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *search_node = NULL;
-
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        index++;
-    }
 
-    return index;
+    return ctx->dev_num;
 }
 
-int dm_mgr_get_devid_by_index(_IN_ int index, _OU_ int *devid)
+/*
+ * Iterate devices in order of devid, starting with '*cursor' of 0. Devices may be created or destroyed
+ * between calls, iteration goes on with the devid after the last one returned.
+ */
+int dm_mgr_device_next(int *cursor, _OU_ int *devid)
 {
-    int search_index = 0;
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *search_node = NULL;
+    int search_devid = 0;
 
-    if (index < 0 || devid == NULL) {
+    if (cursor == NULL || *cursor < 0 || devid == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if (search_index == index) {
-            *devid = search_node->devid;
+    for (search_devid = *cursor; search_devid < ctx->dev_table_size; search_devid++) {
+        if (ctx->dev_table[search_devid] != NULL) {
+            *devid = search_devid;
+            *cursor = search_devid + 1;
             return SUCCESS_RETURN;
         }
-        search_index++;
     }
 
+    *cursor = search_devid;
     return STATE_DEV_MODEL_DEVICE_NOT_FOUND;
 }
 
-int dm_mgr_get_next_devid(_IN_ int devid, _OU_ int *devid_next)
+int dm_mgr_get_devid_by_index(_IN_ int index, _OU_ int *devid)
 {
-    dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *search_node = NULL;
-    dm_mgr_dev_node_t *next_node = NULL;
+    int search_index = 0, cursor = 0;
 
-    if (devid < 0 || devid_next == NULL) {
+    if (index < 0 || devid == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
-    list_for_each_entry(next_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if (search_node && search_node->devid == devid) {
-            *devid_next = next_node->devid;
+    while (dm_mgr_device_next(&cursor, devid) == SUCCESS_RETURN) {
+        if (search_index == index) {
             return SUCCESS_RETURN;
         }
-
-        if (next_node->devid == devid) {
-            search_node = next_node;
-        }
+        search_index++;
     }
 
     return STATE_DEV_MODEL_DEVICE_NOT_FOUND;
@@ -622,8 +799,7 @@ int dm_mgr_upstream_thing_sub_register(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_SYS_PREFIX;
     request.service_name = DM_URI_THING_SUB_REGISTER;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_thing_sub_register(node->product_key, node->device_name, &request);
@@ -674,8 +850,7 @@ int dm_mgr_upstream_thing_proxy_product_register(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_SYS_PREFIX;
     request.service_name = DM_URI_THING_PROXY_PRODUCT_REGISTER;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_thing_proxy_product_register(node->product_key, node->product_secret, node->device_name, &request);
@@ -726,8 +901,7 @@ int dm_mgr_upstream_thing_sub_unregister(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_SYS_PREFIX;
     request.service_name = DM_URI_THING_SUB_UNREGISTER;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_thing_sub_unregister(node->product_key, node->device_name, &request);
@@ -778,8 +952,7 @@ int dm_mgr_upstream_thing_topo_add(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_SYS_PREFIX;
     request.service_name = DM_URI_THING_TOPO_ADD;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_thing_topo_add(node->product_key, node->device_name, node->device_secret, &request);
@@ -830,8 +1003,7 @@ int dm_mgr_upstream_thing_topo_delete(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_SYS_PREFIX;
     request.service_name = DM_URI_THING_TOPO_DELETE;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_thing_topo_delete(node->product_key, node->device_name, &request);
@@ -930,8 +1102,7 @@ int dm_mgr_upstream_thing_list_found(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_SYS_PREFIX;
     request.service_name = DM_URI_THING_LIST_FOUND;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_thing_list_found(node->product_key, node->device_name, &request);
@@ -982,8 +1153,7 @@ int dm_mgr_upstream_combine_login(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_EXT_SESSION_PREFIX;
     request.service_name = DM_URI_COMBINE_LOGIN;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_combine_login(node->product_key, node->device_name, node->device_secret, &request);
@@ -1038,8 +1208,7 @@ int dm_mgr_upstream_combine_logout(_IN_ int devid)
     memset(&request, 0, sizeof(dm_msg_request_t));
     request.service_prefix = DM_URI_EXT_SESSION_PREFIX;
     request.service_name = DM_URI_COMBINE_LOGOUT;
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, request.product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, request.device_name);
+    dm_client_gateway(node->product_key, node->device_name, request.product_key, request.device_name);
 
     /* Get Params And Method */
     res = dm_msg_combine_logout(node->product_key, node->device_name, &request);
@@ -1102,7 +1271,8 @@ int dm_mgr_upstream_thing_firmware_version_update(_IN_ int devid, _IN_ char *pay
         return res;
     }
 
-    res = dm_client_publish(uri, (unsigned char *)payload, strlen(payload), dm_client_thing_model_up_raw_reply);
+    res = dm_client_publish(dm_client_fd(request.product_key, request.device_name), uri, (unsigned char *)payload,
+                            strlen(payload), dm_client_thing_model_up_raw_reply);
     if (res < SUCCESS_RETURN) {
         DM_free(uri);
         return res;
@@ -1145,7 +1315,8 @@ int dm_mgr_upstream_thing_model_up_raw(_IN_ int devid, _IN_ char *payload, _IN_
 
     HEXDUMP_INFO(payload, payload_len);
 
-    res = dm_client_publish(uri, (unsigned char *)payload, payload_len, dm_client_thing_model_up_raw_reply);
+    res = dm_client_publish(dm_client_fd(request.product_key, request.device_name), uri, (unsigned char *)payload,
+                            payload_len, dm_client_thing_model_up_raw_reply);
 #ifdef ALCS_ENABLED
     res1 = dm_server_send(uri, (unsigned char *)payload, payload_len, NULL);
     if (res1 < 0) {
@@ -1584,7 +1755,8 @@ int dm_mgr_upstream_ntp_request(void)
         return res;
     }
 
-    res = dm_client_publish(uri, (unsigned char *)ntp_request_fmt, strlen(ntp_request_fmt), dm_client_ntp_response);
+    res = dm_client_publish(dm_client_fd(request.product_key, request.device_name), uri,
+                            (unsigned char *)ntp_request_fmt, strlen(ntp_request_fmt), dm_client_ntp_response);
     DM_free(uri);
     return res;
 }
@@ -1788,12 +1960,13 @@ int dm_mgr_deprecated_get_tsl_source(_IN_ int devid, _IN_ iotx_dm_tsl_source_t *
 static int dm_mgr_deprecated_search_devid_by_node(_IN_ dm_mgr_dev_node_t *node, _OU_ int *devid)
 {
     dm_mgr_ctx *ctx = _dm_mgr_get_ctx();
-    dm_mgr_dev_node_t *search_node = NULL;
+    int search_devid = 0;
 
-    list_for_each_entry(search_node, &ctx->dev_list, linked_list, dm_mgr_dev_node_t) {
-        if (search_node == node) {
+    /* 'node' may be stale, so it is compared but never read */
+    for (search_devid = 0; search_devid < ctx->dev_table_size; search_devid++) {
+        if (ctx->dev_table[search_devid] == node) {
             if (devid) {
-                *devid = search_node->devid;
+                *devid = search_devid;
             }
             return SUCCESS_RETURN;
         }
@@ -22,13 +22,25 @@ typedef struct {
     char device_secret[IOTX_DEVICE_SECRET_LEN + 1];
     iotx_dm_dev_avail_t status;
     iotx_dm_dev_status_t dev_status;
-    struct list_head linked_list;
+    uint32_t pkdn_hash;
 } dm_mgr_dev_node_t;
 
+/*
+ * Devices are found by devid in a table indexed by it, and by product key and device name in an open
+ * addressing index with linear probing. Both grow by doubling. Devids of destroyed devices are given
+ * out again, oldest first, so that table stays as large as the most devices ever existing at once.
+ */
 typedef struct {
     void *mutex;
-    int global_devid;
-    struct list_head dev_list;
+    int global_devid;                   /* next devid never given out yet */
+    int dev_num;
+    dm_mgr_dev_node_t **dev_table;      /* 'dev_table_size' slots, NULL for devid not in use */
+    int dev_table_size;
+    int *free_devid;                    /* ring of 'dev_table_size' slots, devids destroyed in order */
+    int free_head;
+    int free_num;
+    dm_mgr_dev_node_t **pkdn_index;     /* 'pkdn_index_size' slots, a power of 2 */
+    uint32_t pkdn_index_size;
 } dm_mgr_ctx;
 
 int dm_mgr_init(void);
@@ -40,7 +52,7 @@ int dm_mgr_device_create(_IN_ int dev_type, _IN_ char product_key[IOTX_PRODUCT_K
 int dm_mgr_device_destroy(_IN_ int devid);
 int dm_mgr_device_number(void);
 int dm_mgr_get_devid_by_index(_IN_ int index, _OU_ int *devid);
-int dm_mgr_get_next_devid(_IN_ int devid, _OU_ int *devid_next);
+int dm_mgr_device_next(int *cursor, _OU_ int *devid);
 int dm_mgr_search_device_by_devid(_IN_ int devid, _OU_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                                   _OU_ char device_name[IOTX_DEVICE_NAME_LEN + 1], _OU_ char device_secret[IOTX_DEVICE_SECRET_LEN + 1]);
 int dm_mgr_search_device_by_pkdn(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
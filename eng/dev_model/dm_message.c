@@ -30,46 +30,77 @@ int dm_msg_deinit(void)
 int _dm_msg_send_to_user(iotx_dm_event_types_t type, char *message)
 {
     int res = 0;
-    dm_ipc_msg_t *dipc_msg = NULL;
+    dm_ipc_msg_t dipc_msg;
 
-    dipc_msg = DM_malloc(sizeof(dm_ipc_msg_t));
-    if (dipc_msg == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(dipc_msg, 0, sizeof(dm_ipc_msg_t));
+    memset(&dipc_msg, 0, sizeof(dm_ipc_msg_t));
+    dipc_msg.type = type;
+    dipc_msg.data = message;
 
-    dipc_msg->type = type;
-    dipc_msg->data = message;
-
-    res = dm_ipc_msg_insert((void *)dipc_msg);
+    res = dm_ipc_msg_insert(&dipc_msg);
     if (res != SUCCESS_RETURN) {
-        DM_free(dipc_msg);
         return res;
     }
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_OPERATION, "msg enqueue w/ message type: %d", type);
     return SUCCESS_RETURN;
 }
 
-const char DM_MSG_SEND_MSG_TIMEOUT_FMT[] DM_READ_ONLY = "{\"id\":%d,\"code\":%d,\"devid\":%d}";
-int dm_msg_send_msg_timeout_to_user(int msg_id, int devid, iotx_dm_event_types_t type)
+/* copy string of event behind it, terminated, and return where next one goes */
+static char *_dm_msg_event_copy_str(char *pos, const char **str, int len)
 {
-    int res = 0, message_len = 0;
-    char *message = NULL;
+    if (*str == NULL) {
+        return pos;
+    }
+    memcpy(pos, *str, len);
+    pos[len] = '\0';
+    *str = pos;
+    return pos + len + 1;
+}
 
-    message_len = strlen(DM_MSG_SEND_MSG_TIMEOUT_FMT) + DM_UTILS_UINT32_STRLEN * 3 + 1;
-    message = DM_malloc(message_len + 1);
-    if (message == NULL) {
+/* queue typed event, strings it points to are copied along in the same allocation */
+int _dm_msg_send_event_to_user(iotx_dm_event_t *event)
+{
+    int res = 0, size = 0;
+    char *pos = NULL;
+    iotx_dm_event_t *copy = NULL;
+    dm_ipc_msg_t dipc_msg;
+
+    size = sizeof(iotx_dm_event_t) + event->id_len + event->identifier_len + event->rrpcid_len + event->payload_len + 4;
+    copy = DM_malloc(size);
+    if (copy == NULL) {
         return STATE_SYS_DEPEND_MALLOC;
     }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_SEND_MSG_TIMEOUT_FMT, msg_id, IOTX_DM_ERR_CODE_TIMEOUT, devid);
+    memcpy(copy, event, sizeof(iotx_dm_event_t));
+    pos = (char *)(copy + 1);
+    pos = _dm_msg_event_copy_str(pos, &copy->id, copy->id_len);
+    pos = _dm_msg_event_copy_str(pos, &copy->identifier, copy->identifier_len);
+    pos = _dm_msg_event_copy_str(pos, &copy->rrpcid, copy->rrpcid_len);
+    _dm_msg_event_copy_str(pos, &copy->payload, copy->payload_len);
 
-    res = _dm_msg_send_to_user(type, message);
+    memset(&dipc_msg, 0, sizeof(dm_ipc_msg_t));
+    dipc_msg.type = event->type;
+    dipc_msg.event = copy;
+
+    res = dm_ipc_msg_insert(&dipc_msg);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
+        DM_free(copy);
+        return res;
     }
+    iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MSGQ_OPERATION, "msg enqueue w/ message type: %d", event->type);
+    return SUCCESS_RETURN;
+}
 
-    return res;
+const char DM_MSG_SEND_MSG_TIMEOUT_FMT[] DM_READ_ONLY = "{\"id\":%d,\"code\":%d,\"devid\":%d}";
+int dm_msg_send_msg_timeout_to_user(int msg_id, int devid, iotx_dm_event_types_t type)
+{
+    iotx_dm_event_t event;
+
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = type;
+    event.devid = devid;
+    event.msgid = msg_id;
+    event.code = IOTX_DM_ERR_CODE_TIMEOUT;
+
+    return _dm_msg_send_event_to_user(&event);
 }
 extern void *g_user_topic_callback;
 int dm_msg_thing_model_user_sub(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN],
@@ -142,20 +173,20 @@ int dm_msg_uri_parse_pkdn(_IN_ char *uri, _IN_ int uri_len, _IN_ int start_deli,
 
 int dm_msg_request_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_request_payload_t *request)
 {
-    lite_cjson_t lite;
+    dm_utils_json_t json;
 
     if (payload == NULL || payload_len <= 0 || request == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
-    if (dm_utils_json_parse(payload, payload_len, cJSON_Object, &lite) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID), cJSON_String, &request->id) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_VERSION, strlen(DM_MSG_KEY_VERSION), cJSON_String,
-                                  &request->version) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_METHOD, strlen(DM_MSG_KEY_METHOD), cJSON_String,
-                                  &request->method) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_PARAMS, strlen(DM_MSG_KEY_PARAMS), cJSON_Invalid,
-                                  &request->params) != SUCCESS_RETURN) {
+    if (dm_utils_json_doc_parse(payload, payload_len, cJSON_Object, &json) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID), cJSON_String, &request->id) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_VERSION, strlen(DM_MSG_KEY_VERSION), cJSON_String,
+                               &request->version) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_METHOD, strlen(DM_MSG_KEY_METHOD), cJSON_String,
+                               &request->method) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_PARAMS, strlen(DM_MSG_KEY_PARAMS), cJSON_Invalid,
+                               &request->params) != SUCCESS_RETURN) {
         return STATE_DEV_MODEL_ALINK_MSG_PARSE_FAILED;
     }
 
@@ -170,18 +201,18 @@ int dm_msg_request_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_r
 
 int dm_msg_response_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_response_payload_t *response)
 {
-    lite_cjson_t lite, lite_message;
+    dm_utils_json_t json;
 
     if (payload == NULL || payload_len <= 0 || response == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
-    if (dm_utils_json_parse(payload, payload_len, cJSON_Object, &lite) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID), cJSON_String, &response->id) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_CODE, strlen(DM_MSG_KEY_CODE), cJSON_Number,
-                                  &response->code) != SUCCESS_RETURN ||
-        dm_utils_json_object_item(&lite, DM_MSG_KEY_DATA, strlen(DM_MSG_KEY_DATA), cJSON_Invalid,
-                                  &response->data) != SUCCESS_RETURN) {
+    if (dm_utils_json_doc_parse(payload, payload_len, cJSON_Object, &json) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID), cJSON_String, &response->id) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_CODE, strlen(DM_MSG_KEY_CODE), cJSON_Number,
+                               &response->code) != SUCCESS_RETURN ||
+        dm_utils_json_doc_item(&json, DM_MSG_KEY_DATA, strlen(DM_MSG_KEY_DATA), cJSON_Invalid,
+                               &response->data) != SUCCESS_RETURN) {
         return STATE_DEV_MODEL_ALINK_MSG_PARSE_FAILED;
     }
 
@@ -191,17 +222,69 @@ int dm_msg_response_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_
                      response->code.value_int,
                      response->data.value_length, response->data.value);
 
-    memset(&lite_message, 0, sizeof(lite_cjson_t));
-    dm_utils_json_object_item(&lite, DM_MSG_KEY_MESSAGE, strlen(DM_MSG_KEY_MESSAGE), cJSON_Invalid,
-                              &response->message);
+    dm_utils_json_doc_item(&json, DM_MSG_KEY_MESSAGE, strlen(DM_MSG_KEY_MESSAGE), cJSON_Invalid,
+                           &response->message);
 
     return SUCCESS_RETURN;
 }
 
-const char DM_MSG_REQUEST[] DM_READ_ONLY = "{\"id\":\"%d\",\"version\":\"%s\",\"params\":%.*s,\"method\":\"%s\"}";
+static void _dm_msg_request_write(lite_cjson_writer_t *writer, int msgid, const char *params, int params_len,
+                                  const char *method)
+{
+    char id[DM_UTILS_UINT32_STRLEN + 2] = {0};
+
+    HAL_Snprintf(id, sizeof(id), "%d", msgid);
+
+    lite_cjson_writer_object_begin(writer);
+    lite_cjson_writer_key(writer, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID));
+    lite_cjson_writer_string(writer, id, strlen(id));
+    lite_cjson_writer_key(writer, DM_MSG_KEY_VERSION, strlen(DM_MSG_KEY_VERSION));
+    lite_cjson_writer_string(writer, DM_MSG_VERSION, strlen(DM_MSG_VERSION));
+    lite_cjson_writer_key(writer, DM_MSG_KEY_PARAMS, strlen(DM_MSG_KEY_PARAMS));
+    lite_cjson_writer_raw(writer, params, params_len);
+    lite_cjson_writer_key(writer, DM_MSG_KEY_METHOD, strlen(DM_MSG_KEY_METHOD));
+    lite_cjson_writer_string(writer, method, strlen(method));
+    lite_cjson_writer_object_end(writer);
+}
+
+/*
+ * Write request envelope into 'buf', or into one allocation of exact size if it does not fit there.
+ * Return length of '*payload', which has to be freed if it is not 'buf'.
+ */
+int dm_msg_request_payload(int msgid, const char *params, int params_len, const char *method,
+                           char *buf, int buf_size, char **payload)
+{
+    int res = 0;
+    lite_cjson_writer_t writer;
+
+    lite_cjson_writer_init(&writer, buf, buf_size);
+    _dm_msg_request_write(&writer, msgid, params, params_len, method);
+    res = lite_cjson_writer_finish(&writer);
+    if (res == LITE_CJSON_ERR_BUFFER_FULL) {
+        buf_size = writer.len + 1;
+        buf = DM_malloc(buf_size);
+        if (buf == NULL) {
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        lite_cjson_writer_init(&writer, buf, buf_size);
+        _dm_msg_request_write(&writer, msgid, params, params_len, method);
+        res = lite_cjson_writer_finish(&writer);
+        if (res < 0) {
+            DM_free(buf);
+        }
+    }
+    if (res < 0) {
+        return STATE_DEV_MODEL_WRONG_JSON_FORMAT;
+    }
+
+    *payload = buf;
+    return res;
+}
+
 int dm_msg_request(dm_msg_dest_type_t type, _IN_ dm_msg_request_t *request)
 {
     int res = 0, payload_len = 0;
+    char stack_payload[CONFIG_MSG_STACK_PAYLOAD_LEN];
     char *payload = NULL, *uri = NULL;
     lite_cjson_t lite;
 
@@ -216,47 +299,62 @@ int dm_msg_request(dm_msg_dest_type_t type, _IN_ dm_msg_request_t *request)
         return res;
     }
 
-    payload_len = strlen(DM_MSG_REQUEST) + 10 + strlen(DM_MSG_VERSION) + request->params_len + strlen(
-                              request->method) + 1;
-    payload = DM_malloc(payload_len);
-    if (payload == NULL) {
+    payload_len = dm_msg_request_payload(request->msgid, request->params, request->params_len, request->method,
+                                         stack_payload, sizeof(stack_payload), &payload);
+    if (payload_len < 0) {
+        iotx_state_event(ITE_STATE_DEV_MODEL, payload_len, "request assemble failed, uri: %s", uri);
         DM_free(uri);
-        return STATE_SYS_DEPEND_MALLOC;
+        return payload_len;
     }
-    memset(payload, 0, payload_len);
-    HAL_Snprintf(payload, payload_len, DM_MSG_REQUEST, request->msgid,
-                 DM_MSG_VERSION, request->params_len, request->params, request->method);
 
     memset(&lite, 0, sizeof(lite_cjson_t));
     res = lite_cjson_parse(payload, payload_len, &lite);
     if (res < SUCCESS_RETURN) {
         iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_WRONG_JSON_FORMAT, payload);
-        DM_free(uri);
-        DM_free(payload);
-        return STATE_DEV_MODEL_WRONG_JSON_FORMAT;
+        res = STATE_DEV_MODEL_WRONG_JSON_FORMAT;
+        goto exit;
     }
 
     if (type & DM_MSG_DEST_CLOUD) {
-        res = dm_client_publish(uri, (unsigned char *)payload, strlen(payload), request->callback);
+        res = dm_client_publish(dm_client_fd(request->product_key, request->device_name), uri, (unsigned char *)payload,
+                                payload_len, request->callback);
     }
 
 #ifdef ALCS_ENABLED
     if (type & DM_MSG_DEST_LOCAL) {
-        res = dm_server_send(uri, (unsigned char *)payload, strlen(payload), NULL);
+        res = dm_server_send(uri, (unsigned char *)payload, payload_len, NULL);
     }
 #endif
 
+exit:
     DM_free(uri);
-    DM_free(payload);
+    if (payload != stack_payload) {
+        DM_free(payload);
+    }
     return res;
 }
 
-const char DM_MSG_RESPONSE_WITH_DATA[] DM_READ_ONLY = "{\"id\":\"%.*s\",\"code\":%d,\"data\":%.*s}";
+static void _dm_msg_response_write(lite_cjson_writer_t *writer, dm_msg_request_payload_t *request,
+                                   dm_msg_response_t *response, const char *data, int data_len)
+{
+    lite_cjson_writer_object_begin(writer);
+    lite_cjson_writer_key(writer, DM_MSG_KEY_ID, strlen(DM_MSG_KEY_ID));
+    /* id is kept as received, escaped already */
+    lite_cjson_writer_string_escaped(writer, request->id.value, request->id.value_length);
+    lite_cjson_writer_key(writer, DM_MSG_KEY_CODE, strlen(DM_MSG_KEY_CODE));
+    lite_cjson_writer_int(writer, response->code);
+    lite_cjson_writer_key(writer, DM_MSG_KEY_DATA, strlen(DM_MSG_KEY_DATA));
+    lite_cjson_writer_raw(writer, data, data_len);
+    lite_cjson_writer_object_end(writer);
+}
+
 int dm_msg_response(dm_msg_dest_type_t type, _IN_ dm_msg_request_payload_t *request, _IN_ dm_msg_response_t *response,
                     _IN_ char *data, _IN_ int data_len, _IN_ void *user_data)
 {
-    int res = 0, payload_len = 0;
-    char *uri = NULL, *payload = NULL;
+    int res = 0, payload_len = 0, payload_size = CONFIG_MSG_STACK_PAYLOAD_LEN;
+    char stack_payload[CONFIG_MSG_STACK_PAYLOAD_LEN];
+    char *uri = NULL, *payload = stack_payload;
+    lite_cjson_writer_t writer;
     lite_cjson_t lite;
 
     if (request == NULL || response == NULL || data == NULL || data_len <= 0) {
@@ -270,29 +368,33 @@ int dm_msg_response(dm_msg_dest_type_t type, _IN_ dm_msg_request_payload_t *requ
         return FAIL_RETURN;
     }
 
-    /* Response Payload */
-    payload_len = strlen(DM_MSG_RESPONSE_WITH_DATA) + request->id.value_length + DM_UTILS_UINT32_STRLEN + data_len + 1;
-    payload = DM_malloc(payload_len);
-    if (payload == NULL) {
-        DM_free(uri);
-        return STATE_SYS_DEPEND_MALLOC;
+    /* Response Payload, written again into exact allocation only if it does not fit on stack */
+    lite_cjson_writer_init(&writer, payload, payload_size);
+    _dm_msg_response_write(&writer, request, response, data, data_len);
+    payload_len = lite_cjson_writer_finish(&writer);
+    if (payload_len == LITE_CJSON_ERR_BUFFER_FULL) {
+        payload_size = writer.len + 1;
+        payload = DM_malloc(payload_size);
+        if (payload == NULL) {
+            DM_free(uri);
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        lite_cjson_writer_init(&writer, payload, payload_size);
+        _dm_msg_response_write(&writer, request, response, data, data_len);
+        payload_len = lite_cjson_writer_finish(&writer);
     }
-    memset(payload, 0, payload_len);
-    HAL_Snprintf(payload, payload_len, DM_MSG_RESPONSE_WITH_DATA,
-                 request->id.value_length, request->id.value, response->code, data_len, data);
 
     memset(&lite, 0, sizeof(lite_cjson_t));
-    res = lite_cjson_parse(payload, payload_len, &lite);
-    if (res < SUCCESS_RETURN) {
-        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_WRONG_JSON_FORMAT, "wrong JSON format, uri: %s, payload: %s", uri,
-                         payload);
-        DM_free(uri);
-        DM_free(payload);
-        return FAIL_RETURN;
+    if (payload_len < 0 || lite_cjson_parse(payload, payload_len, &lite) < SUCCESS_RETURN) {
+        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_WRONG_JSON_FORMAT, "wrong JSON format, uri: %s, payload: %.*s",
+                         uri, data_len, data);
+        res = FAIL_RETURN;
+        goto exit;
     }
 
     if (type & DM_MSG_DEST_CLOUD) {
-        dm_client_publish(uri, (unsigned char *)payload, strlen(payload), NULL);
+        dm_client_publish(dm_client_fd(response->product_key, response->device_name), uri, (unsigned char *)payload,
+                          payload_len, NULL);
     }
 
 #ifdef ALCS_ENABLED
@@ -306,16 +408,19 @@ int dm_msg_response(dm_msg_dest_type_t type, _IN_ dm_msg_request_payload_t *requ
             if (strstr(end, "_reply") != 0) {
                 *end = '\0';
             }
-            dm_server_send(uri, (unsigned char *)payload, strlen(payload), user_data);
+            dm_server_send(uri, (unsigned char *)payload, payload_len, user_data);
         } while (0);
 
     }
 #endif
 
+    res = SUCCESS_RETURN;
+exit:
     DM_free(uri);
-    DM_free(payload);
-
-    return SUCCESS_RETURN;
+    if (payload != stack_payload) {
+        DM_free(payload);
+    }
+    return res;
 }
 
 
@@ -324,8 +429,8 @@ int dm_msg_thing_model_down_raw(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                                 _IN_ char device_name[IOTX_DEVICE_NAME_LEN + 1],
                                 _IN_ char *payload, _IN_ int payload_len)
 {
-    int res = 0, devid = 0, message_len = 0;
-    char *hexstr = NULL, *message = NULL;
+    int res = 0, devid = 0;
+    iotx_dm_event_t event;
 
     if (product_key == NULL || device_name == NULL ||
         (strlen(product_key) >= IOTX_PRODUCT_KEY_LEN + 1) ||
@@ -339,24 +444,15 @@ int dm_msg_thing_model_down_raw(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
         return FAIL_RETURN;
     }
 
-    res = dm_utils_hex_to_str((unsigned char *)payload, payload_len, &hexstr);
-    if (res != SUCCESS_RETURN) {
-        return FAIL_RETURN;
-    }
-
-    message_len = strlen(DM_MSG_THING_MODEL_DOWN_FMT) + DM_UTILS_UINT32_STRLEN + strlen(hexstr) + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(hexstr);
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_THING_MODEL_DOWN_FMT, devid, strlen(hexstr), hexstr);
-    DM_free(hexstr);
+    /* raw bytes are handed over as they are, hex string is only made for JSON consumers */
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_MODEL_DOWN_RAW;
+    event.devid = devid;
+    event.payload = payload;
+    event.payload_len = payload_len;
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_MODEL_DOWN_RAW, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -368,8 +464,8 @@ const char DM_MSG_THING_MODEL_UP_RAW_REPLY_FMT[] DM_READ_ONLY = "{\"devid\":%d,\
 int dm_msg_thing_model_up_raw_reply(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                                     _IN_ char device_name[IOTX_DEVICE_NAME_LEN + 1], char *payload, int payload_len)
 {
-    int res = 0, devid = 0, message_len = 0;
-    char *hexstr = NULL, *message = NULL;
+    int res = 0, devid = 0;
+    iotx_dm_event_t event;
 
     if (product_key == NULL || device_name == NULL ||
         (strlen(product_key) >= IOTX_PRODUCT_KEY_LEN + 1) ||
@@ -383,24 +479,14 @@ int dm_msg_thing_model_up_raw_reply(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN +
         return FAIL_RETURN;
     }
 
-    res = dm_utils_hex_to_str((unsigned char *)payload, payload_len, &hexstr);
-    if (res != SUCCESS_RETURN) {
-        return FAIL_RETURN;
-    }
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_MODEL_UP_RAW_REPLY;
+    event.devid = devid;
+    event.payload = payload;
+    event.payload_len = payload_len;
 
-    message_len = strlen(DM_MSG_THING_MODEL_DOWN_FMT) + DM_UTILS_UINT32_STRLEN + strlen(hexstr) + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(hexstr);
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_THING_MODEL_DOWN_FMT, devid, strlen(hexstr), hexstr);
-    DM_free(hexstr);
-
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_MODEL_UP_RAW_REPLY, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -416,24 +502,19 @@ int dm_msg_thing_model_up_raw_reply(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN +
 #endif
 int dm_msg_property_set(int devid, dm_msg_request_payload_t *request)
 {
-    int res = 0, message_len = 0;
-    char *message = NULL;
+    int res = 0;
+    iotx_dm_event_t event;
 
-    message_len = strlen(DM_MSG_PROPERTY_SET_FMT) + DM_UTILS_UINT32_STRLEN + request->params.value_length + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-#ifdef LOG_REPORT_TO_CLOUD
-    HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, devid, request->params.value_length, request->params.value,
-                 request->id.value_length, request->id.value);
-#else
-    HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, devid, request->params.value_length, request->params.value);
-#endif
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_PROPERTY_SET, message);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_PROPERTY_SET;
+    event.devid = devid;
+    event.id = request->id.value;
+    event.id_len = request->id.value_length;
+    event.payload = request->params.value;
+    event.payload_len = request->params.value_length;
+
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
     return SUCCESS_RETURN;
@@ -443,34 +524,20 @@ const char DM_MSG_THING_PROPERTY_GET_FMT[] DM_READ_ONLY =
             "{\"id\":\"%.*s\",\"devid\":%d,\"payload\":%.*s,\"ctx\":\"%s\"}";
 int dm_msg_property_get(_IN_ int devid, _IN_ dm_msg_request_payload_t *request, _IN_ void *ctx)
 {
-    int res = 0, message_len = 0;
-    uintptr_t ctx_addr_num = (uintptr_t)ctx;
-    char *ctx_addr_str = NULL, *message = NULL;
-
-    ctx_addr_str = DM_malloc(sizeof(uintptr_t) * 2 + 1);
-    if (ctx_addr_str == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(ctx_addr_str, 0, sizeof(uintptr_t) * 2 + 1);
-
-    infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
-
-    message_len = strlen(DM_MSG_THING_PROPERTY_GET_FMT) + request->id.value_length + DM_UTILS_UINT32_STRLEN +
-                  request->params.value_length + strlen(ctx_addr_str) + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(ctx_addr_str);
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_THING_PROPERTY_GET_FMT, request->id.value_length, request->id.value, devid,
-                 request->params.value_length, request->params.value, ctx_addr_str);
+    int res = 0;
+    iotx_dm_event_t event;
 
-    DM_free(ctx_addr_str);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_PROPERTY_GET;
+    event.devid = devid;
+    event.id = request->id.value;
+    event.id_len = request->id.value_length;
+    event.payload = request->params.value;
+    event.payload_len = request->params.value_length;
+    event.ctx = ctx;
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_PROPERTY_GET, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -483,10 +550,8 @@ int dm_msg_thing_service_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1]
                                  _IN_ char device_name[IOTX_DEVICE_NAME_LEN + 1],
                                  char *identifier, int identifier_len, dm_msg_request_payload_t *request,  _IN_ void *ctx)
 {
-    int res = 0, devid = 0, message_len = 0;
-    char *message = NULL;
-    uintptr_t ctx_addr_num = (uintptr_t)ctx;
-    char *ctx_addr_str = NULL;
+    int res = 0, devid = 0;
+    iotx_dm_event_t event;
 
     res = dm_mgr_search_device_by_pkdn(product_key, device_name, &devid);
     if (res != SUCCESS_RETURN) {
@@ -500,32 +565,20 @@ int dm_msg_thing_service_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1]
     }
 #endif
 
-    ctx_addr_str = DM_malloc(sizeof(uintptr_t) * 2 + 1);
-    if (ctx_addr_str == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(ctx_addr_str, 0, sizeof(uintptr_t) * 2 + 1);
-    infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
-
-    message_len = strlen(DM_MSG_SERVICE_REQUEST_FMT) + request->id.value_length + DM_UTILS_UINT32_STRLEN + identifier_len +
-                  request->params.value_length + strlen(ctx_addr_str)  + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(ctx_addr_str);
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_SERVICE_REQUEST_FMT, request->id.value_length, request->id.value, devid,
-                 identifier_len, identifier,
-                 request->params.value_length, request->params.value, ctx_addr_str);
-
-    DM_free(ctx_addr_str);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_THING_SERVICE_REQUEST;
+    event.devid = devid;
+    event.id = request->id.value;
+    event.id_len = request->id.value_length;
+    event.identifier = identifier;
+    event.identifier_len = identifier_len;
+    event.payload = request->params.value;
+    event.payload_len = request->params.value_length;
+    event.ctx = ctx;
 
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_RX_CLOUD_MESSAGE, "serviceID: %.*s", identifier_len, identifier);
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_THING_SERVICE_REQUEST, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -539,9 +592,10 @@ int dm_msg_rrpc_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
                         _IN_ char device_name[IOTX_DEVICE_NAME_LEN + 1],
                         char *rrpcid, int rrpcid_len, dm_msg_request_payload_t *request)
 {
-    int res = 0, devid = 0, message_len = 0;
+    int res = 0, devid = 0;
     int service_offset = 0, serviceid_len = 0;
-    char *serviceid = NULL, *message = NULL;
+    char *serviceid = NULL;
+    iotx_dm_event_t event;
 
     /* Get Devid */
     res = dm_mgr_search_device_by_pkdn(product_key, device_name, &devid);
@@ -558,23 +612,22 @@ int dm_msg_rrpc_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1],
     serviceid = request->method.value + service_offset + 1;
 
     /* Send Message To User */
-    message_len = strlen(DM_MSG_EVENT_RRPC_REQUEST_FMT) + request->id.value_length + DM_UTILS_UINT32_STRLEN + serviceid_len
-                  + rrpcid_len +
-                  request->params.value_length + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_EVENT_RRPC_REQUEST_FMT, request->id.value_length, request->id.value, devid,
-                 serviceid_len, serviceid, rrpcid_len, rrpcid,
-                 request->params.value_length, request->params.value);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_RRPC_REQUEST;
+    event.devid = devid;
+    event.id = request->id.value;
+    event.id_len = request->id.value_length;
+    event.identifier = serviceid;
+    event.identifier_len = serviceid_len;
+    event.rrpcid = rrpcid;
+    event.rrpcid_len = rrpcid_len;
+    event.payload = request->params.value;
+    event.payload_len = request->params.value_length;
 
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_RX_CLOUD_MESSAGE, "rrpcid: %.*s", rrpcid_len, rrpcid);
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_RRPC_REQUEST, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -585,8 +638,9 @@ const char DM_MSG_EVENT_PROPERTY_POST_REPLY_FMT[] DM_READ_ONLY =
             "{\"id\":%d,\"code\":%d,\"devid\":%d,\"payload\":%.*s}";
 int dm_msg_thing_event_property_post_reply(dm_msg_response_payload_t *response)
 {
-    int res = 0, devid = 0, id = 0, message_len = 0, payload_len = 0;
-    char *message = NULL, *payload = NULL, *str_payload = NULL;
+    int res = 0, devid = 0, id = 0, payload_len = 0;
+    char *payload = NULL, *str_payload = NULL;
+    iotx_dm_event_t event;
     char int_id[DM_UTILS_UINT32_STRLEN + 1] = {0};
 #if !defined(DM_MESSAGE_CACHE_DISABLED)
     dm_msg_cache_node_t *node = NULL;
@@ -630,21 +684,17 @@ int dm_msg_thing_event_property_post_reply(dm_msg_response_payload_t *response)
         }
     }
 
-    message_len = strlen(DM_MSG_EVENT_PROPERTY_POST_REPLY_FMT) + DM_UTILS_UINT32_STRLEN * 3 + payload_len +
-                  1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        DM_free(str_payload);
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_EVENT_PROPERTY_POST_REPLY_FMT, id, response->code.value_int, devid,
-                 payload_len, payload);
-    DM_free(str_payload);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_EVENT_PROPERTY_POST_REPLY;
+    event.devid = devid;
+    event.msgid = id;
+    event.code = response->code.value_int;
+    event.payload = payload;
+    event.payload_len = payload_len;
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_EVENT_PROPERTY_POST_REPLY, message);
+    res = _dm_msg_send_event_to_user(&event);
+    DM_free(str_payload);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -656,8 +706,8 @@ const char DM_MSG_EVENT_SPECIFIC_POST_REPLY_FMT[] DM_READ_ONLY =
 int dm_msg_thing_event_post_reply(_IN_ char *identifier, _IN_ int identifier_len,
                                   _IN_ dm_msg_response_payload_t *response)
 {
-    int res = 0, devid = 0, id = 0, message_len = 0;
-    char *message = NULL;
+    int res = 0, devid = 0, id = 0;
+    iotx_dm_event_t event;
     char int_id[DM_UTILS_UINT32_STRLEN + 1] = {0};
 #if !defined(DM_MESSAGE_CACHE_DISABLED)
     dm_msg_cache_node_t *node = NULL;
@@ -677,21 +727,20 @@ int dm_msg_thing_event_post_reply(_IN_ char *identifier, _IN_ int identifier_len
     devid = node->devid;
 #endif
 
-    message_len = strlen(DM_MSG_EVENT_SPECIFIC_POST_REPLY_FMT) + DM_UTILS_UINT32_STRLEN * 3 + strlen(
-                              identifier) + response->message.value_length + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_EVENT_SPECIFIC_POST_REPLY_FMT, id, response->code.value_int, devid,
-                 identifier_len, identifier, response->message.value_length, response->message.value);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_EVENT_SPECIFIC_POST_REPLY;
+    event.devid = devid;
+    event.msgid = id;
+    event.code = response->code.value_int;
+    event.identifier = identifier;
+    event.identifier_len = identifier_len;
+    event.payload = response->message.value;
+    event.payload_len = response->message.value_length;
 
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_RX_CLOUD_MESSAGE, "eventID: %.*s", identifier_len, identifier);
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_EVENT_SPECIFIC_POST_REPLY, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -791,8 +840,8 @@ int dm_msg_thing_property_desired_delete_reply(dm_msg_response_payload_t *respon
 const char DM_MSG_EVENT_DEVICEINFO_UPDATE_REPLY_FMT[] DM_READ_ONLY = "{\"id\":%d,\"code\":%d,\"devid\":%d}";
 int dm_msg_thing_deviceinfo_update_reply(dm_msg_response_payload_t *response)
 {
-    int res = 0, devid = 0, id = 0, message_len = 0;
-    char *message = NULL;
+    int res = 0, devid = 0, id = 0;
+    iotx_dm_event_t event;
     char int_id[DM_UTILS_UINT32_STRLEN + 1] = {0};
 #if !defined(DM_MESSAGE_CACHE_DISABLED)
     dm_msg_cache_node_t *node = NULL;
@@ -813,17 +862,14 @@ int dm_msg_thing_deviceinfo_update_reply(dm_msg_response_payload_t *response)
     devid = node->devid;
 #endif
 
-    message_len = strlen(DM_MSG_EVENT_DEVICEINFO_UPDATE_REPLY_FMT) + DM_UTILS_UINT32_STRLEN * 3 + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_EVENT_DEVICEINFO_UPDATE_REPLY_FMT, id, response->code.value_int, devid);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_DEVICEINFO_UPDATE_REPLY;
+    event.devid = devid;
+    event.msgid = id;
+    event.code = response->code.value_int;
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_DEVICEINFO_UPDATE_REPLY, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -833,8 +879,8 @@ int dm_msg_thing_deviceinfo_update_reply(dm_msg_response_payload_t *response)
 const char DM_MSG_EVENT_DEVICEINFO_DELETE_REPLY_FMT[] DM_READ_ONLY = "{\"id\":%d,\"code\":%d,\"devid\":%d}";
 int dm_msg_thing_deviceinfo_delete_reply(dm_msg_response_payload_t *response)
 {
-    int res = 0, devid = 0, id = 0, message_len = 0;
-    char *message = NULL;
+    int res = 0, devid = 0, id = 0;
+    iotx_dm_event_t event;
     char int_id[DM_UTILS_UINT32_STRLEN + 1] = {0};
 #if !defined(DM_MESSAGE_CACHE_DISABLED)
     dm_msg_cache_node_t *node = NULL;
@@ -855,17 +901,14 @@ int dm_msg_thing_deviceinfo_delete_reply(dm_msg_response_payload_t *response)
     devid = node->devid;
 #endif
 
-    message_len = strlen(DM_MSG_EVENT_DEVICEINFO_DELETE_REPLY_FMT) + DM_UTILS_UINT32_STRLEN * 3 + 1;
-    message = DM_malloc(message_len);
-    if (message == NULL) {
-        return STATE_SYS_DEPEND_MALLOC;
-    }
-    memset(message, 0, message_len);
-    HAL_Snprintf(message, message_len, DM_MSG_EVENT_DEVICEINFO_DELETE_REPLY_FMT, id, response->code.value_int, devid);
+    memset(&event, 0, sizeof(iotx_dm_event_t));
+    event.type = IOTX_DM_EVENT_DEVICEINFO_DELETE_REPLY;
+    event.devid = devid;
+    event.msgid = id;
+    event.code = response->code.value_int;
 
-    res = _dm_msg_send_to_user(IOTX_DM_EVENT_DEVICEINFO_DELETE_REPLY, message);
+    res = _dm_msg_send_event_to_user(&event);
     if (res != SUCCESS_RETURN) {
-        DM_free(message);
         return FAIL_RETURN;
     }
 
@@ -1880,7 +1923,7 @@ const char DM_MSG_DEV_CORE_SERVICE_DEV[] DM_READ_ONLY =
             "{\"devices\":{\"addr\":\"%s\",\"port\":%d,\"pal\":\"linkkit-ica\",\"profile\":%s}}";
 int dm_msg_dev_core_service_dev(char **payload, int *payload_len)
 {
-    int res = 0, index = 0, search_devid = 0;
+    int res = 0, cursor = 0, search_devid = 0;
     char product_key[IOTX_PRODUCT_KEY_LEN + 1] = {0};
     char device_name[IOTX_DEVICE_NAME_LEN + 1] = {0};
     char device_secret[IOTX_DEVICE_SECRET_LEN + 1] = {0};
@@ -1899,19 +1942,12 @@ int dm_msg_dev_core_service_dev(char **payload, int *payload_len)
     }
 
     /* Get Product Key And Device Name Of All Device */
-    for (index = 0; index < dm_mgr_device_number(); index++) {
-        search_devid = 0;
+    while (dm_mgr_device_next(&cursor, &search_devid) == SUCCESS_RETURN) {
         lite_object = NULL;
         memset(product_key, 0, IOTX_PRODUCT_KEY_LEN + 1);
         memset(device_name, 0, IOTX_DEVICE_NAME_LEN + 1);
         memset(device_secret, 0, IOTX_DEVICE_SECRET_LEN + 1);
 
-        res = dm_mgr_get_devid_by_index(index, &search_devid);
-        if (res != SUCCESS_RETURN) {
-            lite_cjson_delete(lite_array);
-            return FAIL_RETURN;
-        }
-
         res = dm_mgr_search_device_by_devid(search_devid, product_key, device_name, device_secret);
         if (res != SUCCESS_RETURN) {
             lite_cjson_delete(lite_array);
@@ -2791,3 +2827,138 @@ int dm_msg_thing_service_request(_IN_ char product_key[IOTX_PRODUCT_KEY_LEN + 1]
 }
 
 #endif
+
+static char *_dm_msg_event_ctx_str(void *ctx)
+{
+    uintptr_t ctx_addr_num = (uintptr_t)ctx;
+    char *ctx_addr_str = NULL;
+
+    ctx_addr_str = DM_malloc(sizeof(uintptr_t) * 2 + 1);
+    if (ctx_addr_str == NULL) {
+        return NULL;
+    }
+    memset(ctx_addr_str, 0, sizeof(uintptr_t) * 2 + 1);
+    infra_hex2str((unsigned char *)&ctx_addr_num, sizeof(uintptr_t), ctx_addr_str);
+
+    return ctx_addr_str;
+}
+
+/* render typed event into JSON it used to be queued as, for consumers of iotx_dm_event_callback */
+char *dm_msg_event_to_json(iotx_dm_event_t *event)
+{
+    int message_len = 0;
+    char *message = NULL, *hexstr = NULL;
+
+    /* timeout has neither payload nor identifier, whichever event type it is for */
+    if (event->payload == NULL && event->identifier == NULL) {
+        message_len = strlen(DM_MSG_SEND_MSG_TIMEOUT_FMT) + DM_UTILS_UINT32_STRLEN * 3 + 1;
+        message = DM_malloc(message_len);
+        if (message == NULL) {
+            return NULL;
+        }
+        memset(message, 0, message_len);
+        HAL_Snprintf(message, message_len, DM_MSG_SEND_MSG_TIMEOUT_FMT, event->msgid, event->code, event->devid);
+        return message;
+    }
+
+    switch (event->type) {
+        case IOTX_DM_EVENT_MODEL_DOWN_RAW:
+        case IOTX_DM_EVENT_MODEL_UP_RAW_REPLY: {
+            if (dm_utils_hex_to_str((unsigned char *)event->payload, event->payload_len, &hexstr) != SUCCESS_RETURN) {
+                return NULL;
+            }
+            message_len = strlen(DM_MSG_THING_MODEL_DOWN_FMT) + DM_UTILS_UINT32_STRLEN + strlen(hexstr) + 1;
+            message = DM_malloc(message_len);
+            if (message != NULL) {
+                memset(message, 0, message_len);
+                HAL_Snprintf(message, message_len, (event->type == IOTX_DM_EVENT_MODEL_DOWN_RAW) ?
+                             DM_MSG_THING_MODEL_DOWN_FMT : DM_MSG_THING_MODEL_UP_RAW_REPLY_FMT,
+                             event->devid, strlen(hexstr), hexstr);
+            }
+            DM_free(hexstr);
+        }
+        break;
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
+#ifndef DEPRECATED_LINKKIT
+        case IOTX_DM_EVENT_PROPERTY_SET: {
+            message_len = strlen(DM_MSG_PROPERTY_SET_FMT) + DM_UTILS_UINT32_STRLEN + event->payload_len + event->id_len + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            memset(message, 0, message_len);
+#ifdef LOG_REPORT_TO_CLOUD
+            HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, event->devid, event->payload_len, event->payload,
+                         event->id_len, event->id);
+#else
+            HAL_Snprintf(message, message_len, DM_MSG_PROPERTY_SET_FMT, event->devid, event->payload_len, event->payload);
+#endif
+        }
+        break;
+        case IOTX_DM_EVENT_PROPERTY_GET:
+        case IOTX_DM_EVENT_THING_SERVICE_REQUEST: {
+            char *ctx_addr_str = _dm_msg_event_ctx_str(event->ctx);
+
+            if (ctx_addr_str == NULL) {
+                return NULL;
+            }
+            message_len = strlen(DM_MSG_SERVICE_REQUEST_FMT) + event->id_len + DM_UTILS_UINT32_STRLEN +
+                          event->identifier_len + event->payload_len + strlen(ctx_addr_str) + 1;
+            message = DM_malloc(message_len);
+            if (message != NULL) {
+                memset(message, 0, message_len);
+                if (event->type == IOTX_DM_EVENT_PROPERTY_GET) {
+                    HAL_Snprintf(message, message_len, DM_MSG_THING_PROPERTY_GET_FMT, event->id_len, event->id, event->devid,
+                                 event->payload_len, event->payload, ctx_addr_str);
+                } else {
+                    HAL_Snprintf(message, message_len, DM_MSG_SERVICE_REQUEST_FMT, event->id_len, event->id, event->devid,
+                                 event->identifier_len, event->identifier, event->payload_len, event->payload, ctx_addr_str);
+                }
+            }
+            DM_free(ctx_addr_str);
+        }
+        break;
+#endif
+        case IOTX_DM_EVENT_RRPC_REQUEST: {
+            message_len = strlen(DM_MSG_EVENT_RRPC_REQUEST_FMT) + event->id_len + DM_UTILS_UINT32_STRLEN +
+                          event->identifier_len + event->rrpcid_len + event->payload_len + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            memset(message, 0, message_len);
+            HAL_Snprintf(message, message_len, DM_MSG_EVENT_RRPC_REQUEST_FMT, event->id_len, event->id, event->devid,
+                         event->identifier_len, event->identifier, event->rrpcid_len, event->rrpcid,
+                         event->payload_len, event->payload);
+        }
+        break;
+        case IOTX_DM_EVENT_EVENT_PROPERTY_POST_REPLY: {
+            message_len = strlen(DM_MSG_EVENT_PROPERTY_POST_REPLY_FMT) + DM_UTILS_UINT32_STRLEN * 3 + event->payload_len + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            memset(message, 0, message_len);
+            HAL_Snprintf(message, message_len, DM_MSG_EVENT_PROPERTY_POST_REPLY_FMT, event->msgid, event->code, event->devid,
+                         event->payload_len, event->payload);
+        }
+        break;
+        case IOTX_DM_EVENT_EVENT_SPECIFIC_POST_REPLY: {
+            message_len = strlen(DM_MSG_EVENT_SPECIFIC_POST_REPLY_FMT) + DM_UTILS_UINT32_STRLEN * 3 +
+                          event->identifier_len + event->payload_len + 1;
+            message = DM_malloc(message_len);
+            if (message == NULL) {
+                return NULL;
+            }
+            memset(message, 0, message_len);
+            HAL_Snprintf(message, message_len, DM_MSG_EVENT_SPECIFIC_POST_REPLY_FMT, event->msgid, event->code, event->devid,
+                         event->identifier_len, event->identifier, event->payload_len, event->payload);
+        }
+        break;
+#endif
+        default:
+            break;
+    }
+
+    return message;
+}
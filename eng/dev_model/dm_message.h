@@ -93,11 +93,15 @@ typedef struct {
 int dm_msg_init(void);
 int dm_msg_deinit(void);
 int _dm_msg_send_to_user(iotx_dm_event_types_t type, char *message);
+int _dm_msg_send_event_to_user(iotx_dm_event_t *event);
+char *dm_msg_event_to_json(iotx_dm_event_t *event);
 int dm_msg_send_msg_timeout_to_user(int msg_id, int devid, iotx_dm_event_types_t type);
 int dm_msg_uri_parse_pkdn(_IN_ char *uri, _IN_ int uri_len, _IN_ int start_deli, _IN_ int end_deli,
                           _OU_ char product_key[IOTX_PRODUCT_KEY_LEN + 1], _OU_ char device_name[IOTX_DEVICE_NAME_LEN + 1]);
 int dm_msg_request_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_request_payload_t *request);
 int dm_msg_response_parse(_IN_ char *payload, _IN_ int payload_len, _OU_ dm_msg_response_payload_t *response);
+int dm_msg_request_payload(int msgid, const char *params, int params_len, const char *method,
+                           char *buf, int buf_size, char **payload);
 int dm_msg_request(dm_msg_dest_type_t type, _IN_ dm_msg_request_t *request);
 int dm_msg_response(dm_msg_dest_type_t type, _IN_ dm_msg_request_payload_t *request, _IN_ dm_msg_response_t *response,
                     _IN_ char *data, _IN_ int data_len, _IN_ void *user_data);
@@ -5,6 +5,11 @@
 
 #if !defined(DM_MESSAGE_CACHE_DISABLED)
 
+/* index is never full, so that probing always ends at an empty slot */
+#if (CONFIG_MSGCACHE_INDEX_LEN & (CONFIG_MSGCACHE_INDEX_LEN - 1)) != 0 || CONFIG_MSGCACHE_INDEX_LEN <= CONFIG_MSGCACHE_QUEUE_MAXLEN
+    #error "CONFIG_MSGCACHE_INDEX_LEN must be a power of two greater than CONFIG_MSGCACHE_QUEUE_MAXLEN"
+#endif
+
 dm_msg_cache_ctx_t g_dm_msg_cache_ctx;
 
 dm_msg_cache_ctx_t *_dm_msg_cache_get_ctx(void)
@@ -28,6 +33,75 @@ static void _dm_msg_cache_mutex_unlock(void)
     }
 }
 
+/* open addressing index of message cache, with linear probing, must be called with mutex held */
+static uint32_t _dm_msg_cache_index_hash(int msgid)
+{
+    return (uint32_t)msgid & (CONFIG_MSGCACHE_INDEX_LEN - 1);
+}
+
+/* find slot of node, or of the first node with msgid if node is NULL, -1 if there is none */
+static int _dm_msg_cache_index_find(dm_msg_cache_ctx_t *ctx, int msgid, dm_msg_cache_node_t *node)
+{
+    uint32_t idx = _dm_msg_cache_index_hash(msgid);
+    uint32_t probe = 0;
+
+    for (probe = 0; probe < CONFIG_MSGCACHE_INDEX_LEN && ctx->dmc_index[idx] != NULL; probe++) {
+        if (ctx->dmc_index[idx] == node || (node == NULL && ctx->dmc_index[idx]->msgid == msgid)) {
+            return idx;
+        }
+        idx = (idx + 1) & (CONFIG_MSGCACHE_INDEX_LEN - 1);
+    }
+
+    return -1;
+}
+
+static void _dm_msg_cache_index_insert(dm_msg_cache_ctx_t *ctx, dm_msg_cache_node_t *node)
+{
+    uint32_t idx = _dm_msg_cache_index_hash(node->msgid);
+
+    while (ctx->dmc_index[idx] != NULL) {
+        idx = (idx + 1) & (CONFIG_MSGCACHE_INDEX_LEN - 1);
+    }
+    ctx->dmc_index[idx] = node;
+}
+
+/* clear slot and shift back following nodes of the probe sequence, so that no tombstone is needed */
+static void _dm_msg_cache_index_remove(dm_msg_cache_ctx_t *ctx, uint32_t idx)
+{
+    uint32_t next = (idx + 1) & (CONFIG_MSGCACHE_INDEX_LEN - 1);
+    uint32_t home = 0;
+
+    ctx->dmc_index[idx] = NULL;
+    while (ctx->dmc_index[next] != NULL) {
+        home = _dm_msg_cache_index_hash(ctx->dmc_index[next]->msgid);
+        /* move node back unless its home slot lies cyclically in (idx, next] */
+        if ((next > idx && (home <= idx || home > next)) || (next < idx && home <= idx && home > next)) {
+            ctx->dmc_index[idx] = ctx->dmc_index[next];
+            ctx->dmc_index[next] = NULL;
+            idx = next;
+        }
+        next = (next + 1) & (CONFIG_MSGCACHE_INDEX_LEN - 1);
+    }
+}
+
+/* drop node from list and index, 'idx' being its slot */
+static void _dm_msg_cache_node_free(dm_msg_cache_ctx_t *ctx, dm_msg_cache_node_t *node, int idx)
+{
+    if (idx < 0) {
+        idx = _dm_msg_cache_index_find(ctx, node->msgid, node);
+    }
+    if (idx >= 0) {
+        _dm_msg_cache_index_remove(ctx, idx);
+    }
+
+    list_del(&node->linked_list);
+    if (node->data) {
+        DM_free(node->data);
+    }
+    DM_free(node);
+    ctx->dmc_list_size--;
+}
+
 int dm_msg_cache_init(void)
 {
     dm_msg_cache_ctx_t *ctx = _dm_msg_cache_get_ctx();
@@ -59,12 +133,14 @@ int dm_msg_cache_deinit(void)
             DM_free(node->data);
         }
         DM_free(node);
-        _dm_msg_cache_mutex_unlock();
     }
+    memset(ctx->dmc_index, 0, sizeof(ctx->dmc_index));
+    ctx->dmc_list_size = 0;
     _dm_msg_cache_mutex_unlock();
 
     if (ctx->mutex) {
         HAL_MutexDestroy(ctx->mutex);
+        ctx->mutex = NULL;
     }
 
     return SUCCESS_RETURN;
@@ -76,9 +152,6 @@ int dm_msg_cache_insert(int msgid, int devid, iotx_dm_event_types_t type, char *
     dm_msg_cache_node_t *node = NULL;
 
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CTX_LIST_INSERT, "context list size: %d", ctx->dmc_list_size);
-    if (ctx->dmc_list_size >= CONFIG_MSGCACHE_QUEUE_MAXLEN) {
-        return STATE_DEV_MODEL_CTX_LIST_FULL;
-    }
 
     node = DM_malloc(sizeof(dm_msg_cache_node_t));
     if (node == NULL) {
@@ -94,7 +167,14 @@ int dm_msg_cache_insert(int msgid, int devid, iotx_dm_event_types_t type, char *
     INIT_LIST_HEAD(&node->linked_list);
 
     _dm_msg_cache_mutex_lock();
+    if (ctx->dmc_list_size >= CONFIG_MSGCACHE_QUEUE_MAXLEN) {
+        _dm_msg_cache_mutex_unlock();
+        DM_free(node);
+        return STATE_DEV_MODEL_CTX_LIST_FULL;
+    }
+    /* all nodes have the same timeout, so that tail of list is always the last one to expire */
     list_add_tail(&node->linked_list, &ctx->dmc_list);
+    _dm_msg_cache_index_insert(ctx, node);
     ctx->dmc_list_size++;
     _dm_msg_cache_mutex_unlock();
     iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CTX_LIST_INSERT, "context elem inserted, msgid: %d", msgid);
@@ -105,19 +185,18 @@ int dm_msg_cache_insert(int msgid, int devid, iotx_dm_event_types_t type, char *
 int dm_msg_cache_search(_IN_ int msgid, _OU_ dm_msg_cache_node_t **node)
 {
     dm_msg_cache_ctx_t *ctx = _dm_msg_cache_get_ctx();
-    dm_msg_cache_node_t *search_node = NULL;
+    int idx = 0;
 
     if (msgid < 0 || node == NULL || *node != NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
     _dm_msg_cache_mutex_lock();
-    list_for_each_entry(search_node, &ctx->dmc_list, linked_list, dm_msg_cache_node_t) {
-        if (search_node->msgid == msgid) {
-            *node = search_node;
-            _dm_msg_cache_mutex_unlock();
-            return SUCCESS_RETURN;
-        }
+    idx = _dm_msg_cache_index_find(ctx, msgid, NULL);
+    if (idx >= 0) {
+        *node = ctx->dmc_index[idx];
+        _dm_msg_cache_mutex_unlock();
+        return SUCCESS_RETURN;
     }
 
     _dm_msg_cache_mutex_unlock();
@@ -127,50 +206,42 @@ int dm_msg_cache_search(_IN_ int msgid, _OU_ dm_msg_cache_node_t **node)
 int dm_msg_cache_remove(int msgid)
 {
     dm_msg_cache_ctx_t *ctx = _dm_msg_cache_get_ctx();
-    dm_msg_cache_node_t *node = NULL;
-    dm_msg_cache_node_t *next = NULL;
+    int idx = 0;
 
     _dm_msg_cache_mutex_lock();
-    list_for_each_entry_safe(node, next, &ctx->dmc_list, linked_list, dm_msg_cache_node_t) {
-        if (node->msgid == msgid) {
-            list_del(&node->linked_list);
-            if (node->data) {
-                DM_free(node->data);
-            }
-            ctx->dmc_list_size--;
-            DM_free(node);
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CTX_LIST_REMOVE, "context elem remove, msgid: %d", msgid);
-            _dm_msg_cache_mutex_unlock();
-            return SUCCESS_RETURN;
-        }
+    idx = _dm_msg_cache_index_find(ctx, msgid, NULL);
+    if (idx >= 0) {
+        _dm_msg_cache_node_free(ctx, ctx->dmc_index[idx], idx);
+        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CTX_LIST_REMOVE, "context elem remove, msgid: %d", msgid);
+        _dm_msg_cache_mutex_unlock();
+        return SUCCESS_RETURN;
     }
 
     _dm_msg_cache_mutex_unlock();
     return STATE_DEV_MODEL_CTX_LIST_EMPTY;
 }
 
+/* only expired nodes at head of list are visited, the first one still pending ends the walk */
 void dm_msg_cache_tick(void)
 {
     dm_msg_cache_ctx_t *ctx = _dm_msg_cache_get_ctx();
     dm_msg_cache_node_t *node = NULL;
-    dm_msg_cache_node_t *next = NULL;
     uint64_t current_time = HAL_UptimeMs();
 
     _dm_msg_cache_mutex_lock();
-    list_for_each_entry_safe(node, next, &ctx->dmc_list, linked_list, dm_msg_cache_node_t) {
+    while (!list_empty(&ctx->dmc_list)) {
+        node = list_first_entry(&ctx->dmc_list, dm_msg_cache_node_t, linked_list);
         if (current_time < node->ctime) {
             node->ctime = current_time;
         }
-        if (current_time - node->ctime >= DM_MSG_CACHE_TIMEOUT_MS_DEFAULT) {
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CTX_LIST_FADEOUT, "context elem timeout, msgid: %d", node->msgid);
-            /* Send Timeout Message To User */
-            dm_msg_send_msg_timeout_to_user(node->msgid, node->devid, node->response_type);
-            list_del(&node->linked_list);
-            if (node->data) {
-                DM_free(node->data);
-            }
-            DM_free(node);
+        if (current_time - node->ctime < DM_MSG_CACHE_TIMEOUT_MS_DEFAULT) {
+            break;
         }
+
+        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CTX_LIST_FADEOUT, "context elem timeout, msgid: %d", node->msgid);
+        /* Send Timeout Message To User */
+        dm_msg_send_msg_timeout_to_user(node->msgid, node->devid, node->response_type);
+        _dm_msg_cache_node_free(ctx, node, -1);
     }
     _dm_msg_cache_mutex_unlock();
 }
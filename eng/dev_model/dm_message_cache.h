@@ -17,13 +17,14 @@ typedef struct {
     iotx_dm_event_types_t response_type;
     char *data;
     uint64_t ctime;
-    struct list_head linked_list;
+    struct list_head linked_list;   /* in order of insertion, which is order of expiry as well */
 } dm_msg_cache_node_t;
 
 typedef struct {
     void *mutex;
     int dmc_list_size;
     struct list_head dmc_list;
+    dm_msg_cache_node_t *dmc_index[CONFIG_MSGCACHE_INDEX_LEN];  /* msgid index of 'dmc_list' */
 } dm_msg_cache_ctx_t;
 
 int dm_msg_cache_init(void);
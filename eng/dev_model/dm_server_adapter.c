@@ -9,8 +9,6 @@
 
 const char DM_URI_DEV_CORE_SERVICE_DEV_NOTIFY[] DM_READ_ONLY = "/dev/core/service/dev/notify";
 
-extern const char DM_MSG_REQUEST[];
-
 static dm_server_ctx_t g_dm_server_ctx = {0};
 
 static dm_server_ctx_t *dm_server_get_ctx(void)
@@ -30,17 +28,11 @@ static int _dm_server_dev_notify(void *handle)
 
     dm_msg_dev_core_service_dev(&data, &data_len);
 
-    payload_len = strlen(DM_MSG_REQUEST) + 10 + strlen(DM_MSG_VERSION) + data_len + strlen(
-                              ALCS_NOTIFY_METHOD) + 1;
-
-    payload = DM_malloc(payload_len);
-    if (payload == NULL) {
+    payload_len = dm_msg_request_payload(iotx_report_id(), data, data_len, ALCS_NOTIFY_METHOD, NULL, 0, &payload);
+    if (payload_len < 0) {
         DM_free(data);
-        return STATE_SYS_DEPEND_MALLOC;
+        return payload_len;
     }
-    memset(payload, 0, payload_len);
-    HAL_Snprintf(payload, payload_len, DM_MSG_REQUEST, iotx_report_id(),
-                 DM_MSG_VERSION, data_len, data, ALCS_NOTIFY_METHOD);
 
     memset(&notify_sa, 0, sizeof(notify_sa));
     memcpy(notify_sa.addr, ALCS_NOTIFY_HOST, strlen(ALCS_NOTIFY_HOST));
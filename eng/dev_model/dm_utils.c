@@ -411,6 +411,65 @@ int dm_utils_json_object_item(_IN_ lite_cjson_t *lite, _IN_ const char *key, _IN
     return SUCCESS_RETURN;
 }
 
+int dm_utils_json_doc_parse(_IN_ const char *payload, _IN_ int payload_len, _IN_ int type,
+                            _OU_ dm_utils_json_t *json)
+{
+    int res = 0;
+
+    if (payload == NULL || payload_len <= 0 || type < 0 || json == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+    memset(&json->doc, 0, sizeof(lite_cjson_doc_t));
+    json->doc.tokens = json->tokens;
+    json->doc.token_num = DM_UTILS_JSON_TOKEN_NUM;
+
+    res = lite_cjson_doc_parse(&json->doc, payload, payload_len, 1);
+    if (res == LITE_CJSON_ERR_TOKEN_FULL) {
+        return dm_utils_json_parse(payload, payload_len, type, &json->lite);
+    }
+    if (res < 0 || lite_cjson_doc_item(&json->doc, 0, &json->lite) != SUCCESS_RETURN) {
+        memset(&json->lite, 0, sizeof(lite_cjson_t));
+        return STATE_DEV_MODEL_WRONG_JSON_FORMAT;
+    }
+
+    if (type != cJSON_Invalid && json->lite.type != type) {
+        json->doc.token_cnt = 0;
+        memset(&json->lite, 0, sizeof(lite_cjson_t));
+        return STATE_DEV_MODEL_WRONG_JSON_FORMAT;
+    }
+
+    return SUCCESS_RETURN;
+}
+
+int dm_utils_json_doc_item(_IN_ dm_utils_json_t *json, _IN_ const char *key, _IN_ int key_len, _IN_ int type,
+                           _OU_ lite_cjson_t *lite_item)
+{
+    int index = 0;
+
+    if (json == NULL || key == NULL || key_len <= 0 || type < 0 || lite_item == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    if (json->doc.token_cnt == 0) {
+        return dm_utils_json_object_item(&json->lite, key, key_len, type, lite_item);
+    }
+
+    memset(lite_item, 0, sizeof(lite_cjson_t));
+
+    index = lite_cjson_doc_object_item(&json->doc, 0, key, key_len);
+    if (index < 0 || lite_cjson_doc_item(&json->doc, index, lite_item) != SUCCESS_RETURN) {
+        memset(lite_item, 0, sizeof(lite_cjson_t));
+        return STATE_DEV_MODEL_GET_JSON_ITEM_FAILED;
+    }
+
+    if (type != cJSON_Invalid && lite_item->type != type) {
+        memset(lite_item, 0, sizeof(lite_cjson_t));
+        return STATE_DEV_MODEL_GET_JSON_ITEM_FAILED;
+    }
+
+    return SUCCESS_RETURN;
+}
+
 void *dm_utils_malloc(unsigned int size)
 {
 #ifdef INFRA_MEM_STATS
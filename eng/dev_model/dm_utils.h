@@ -46,6 +46,18 @@ int dm_utils_uri_add_prefix(const char *prefix, char *uri, char **new_uri);
 int dm_utils_json_parse(const char *payload, int payload_len, int type, lite_cjson_t *lite);
 int dm_utils_json_object_item(lite_cjson_t *lite, const char *key, int key_len, int type,
                               lite_cjson_t *lite_item);
+
+#define DM_UTILS_JSON_TOKEN_NUM (16)
+
+/* Payload tokenized once for lookup of its top level keys */
+typedef struct {
+    lite_cjson_doc_t doc;
+    lite_cjson_token_t tokens[DM_UTILS_JSON_TOKEN_NUM];
+    lite_cjson_t lite;          /* whole payload, searched as text when it has too many keys for 'tokens' */
+} dm_utils_json_t;
+
+int dm_utils_json_doc_parse(const char *payload, int payload_len, int type, dm_utils_json_t *json);
+int dm_utils_json_doc_item(dm_utils_json_t *json, const char *key, int key_len, int type, lite_cjson_t *lite_item);
 void *dm_utils_malloc(unsigned int size);
 void dm_utils_free(void *ptr);
 #endif
@@ -411,270 +411,301 @@ static void _iotx_linkkit_upstream_callback_remove(int msgid, int code)
     int  report_sample = 0;
 #endif
 
-static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *payload)
+/* events handled without JSON, return non-zero for _iotx_linkkit_event_callback() to take it */
+static int _iotx_linkkit_typed_event_callback(iotx_dm_event_t *event)
 {
-    int res = 0;
     void *callback;
-#ifdef LOG_REPORT_TO_CLOUD
-    lite_cjson_t msg_id;
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
+    int res = 0;
 #endif
-    lite_cjson_t lite, lite_item_id, lite_item_devid, lite_item_serviceid, lite_item_payload, lite_item_ctx;
-    lite_cjson_t lite_item_code, lite_item_eventid, lite_item_utc, lite_item_rrpcid, lite_item_topo;
-    lite_cjson_t lite_item_pk, lite_item_time;
-    lite_cjson_t lite_item_version, lite_item_configid, lite_item_configsize, lite_item_gettype, lite_item_sign,
-                 lite_item_signmethod, lite_item_url, lite_item_data, lite_item_message;
 
-    iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "alink event type: %d", type);
+    switch (event->type) {
+        case IOTX_DM_EVENT_MODEL_DOWN_RAW:
+        case IOTX_DM_EVENT_MODEL_UP_RAW_REPLY: {
+            if (event->payload == NULL) {
+                return 0;
+            }
 
-    if (payload) {
-        res = dm_utils_json_parse(payload, strlen(payload), cJSON_Invalid, &lite);
-        if (res != SUCCESS_RETURN) {
-            return;
-        }
-#ifdef LOG_REPORT_TO_CLOUD
-        dm_utils_json_object_item(&lite, "msgid", 5, cJSON_Invalid, &msg_id);
-#endif
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_ID, strlen(IOTX_LINKKIT_KEY_ID), cJSON_Invalid, &lite_item_id);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_DEVID, strlen(IOTX_LINKKIT_KEY_DEVID), cJSON_Invalid,
-                                  &lite_item_devid);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_SERVICEID, strlen(IOTX_LINKKIT_KEY_SERVICEID), cJSON_Invalid,
-                                  &lite_item_serviceid);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_PAYLOAD, strlen(IOTX_LINKKIT_KEY_PAYLOAD), cJSON_Invalid,
-                                  &lite_item_payload);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_CTX, strlen(IOTX_LINKKIT_KEY_CTX), cJSON_Invalid, &lite_item_ctx);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_CODE, strlen(IOTX_LINKKIT_KEY_CODE), cJSON_Invalid, &lite_item_code);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_EVENTID, strlen(IOTX_LINKKIT_KEY_EVENTID), cJSON_Invalid,
-                                  &lite_item_eventid);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_UTC, strlen(IOTX_LINKKIT_KEY_UTC), cJSON_Invalid, &lite_item_utc);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_RRPCID, strlen(IOTX_LINKKIT_KEY_RRPCID), cJSON_Invalid,
-                                  &lite_item_rrpcid);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_TOPO, strlen(IOTX_LINKKIT_KEY_TOPO), cJSON_Invalid,
-                                  &lite_item_topo);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_PRODUCT_KEY, strlen(IOTX_LINKKIT_KEY_PRODUCT_KEY), cJSON_Invalid,
-                                  &lite_item_pk);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_TIME, strlen(IOTX_LINKKIT_KEY_TIME), cJSON_Invalid,
-                                  &lite_item_time);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_VERSION, strlen(IOTX_LINKKIT_KEY_VERSION), cJSON_Invalid,
-                                  &lite_item_version);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_CONFIG_ID, strlen(IOTX_LINKKIT_KEY_CONFIG_ID), cJSON_Invalid,
-                                  &lite_item_configid);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_CONFIG_SIZE, strlen(IOTX_LINKKIT_KEY_CONFIG_SIZE), cJSON_Invalid,
-                                  &lite_item_configsize);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_GET_TYPE, strlen(IOTX_LINKKIT_KEY_GET_TYPE), cJSON_Invalid,
-                                  &lite_item_gettype);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_SIGN, strlen(IOTX_LINKKIT_KEY_SIGN), cJSON_Invalid,
-                                  &lite_item_sign);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_SIGN_METHOD, strlen(IOTX_LINKKIT_KEY_SIGN_METHOD), cJSON_Invalid,
-                                  &lite_item_signmethod);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_URL, strlen(IOTX_LINKKIT_KEY_URL), cJSON_Invalid,
-                                  &lite_item_url);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_DATA, strlen(IOTX_LINKKIT_KEY_DATA), cJSON_Invalid,
-                                  &lite_item_data);
-        dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_MESSAGE, strlen(IOTX_LINKKIT_KEY_MESSAGE), cJSON_Invalid,
-                                  &lite_item_message);
-    }
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "%s, devid: %d, raw len: %d",
+                             (event->type == IOTX_DM_EVENT_MODEL_DOWN_RAW) ? "down raw" : "up raw reply",
+                             event->devid, event->payload_len);
 
-    switch (type) {
-        case IOTX_DM_EVENT_CLOUD_CONNECTED: {
-            callback = iotx_event_callback(ITE_CONNECT_SUCC);
+            HEXDUMP_DEBUG(event->payload, event->payload_len);
+            callback = iotx_event_callback(ITE_RAWDATA_ARRIVED);
             if (callback) {
-                ((int (*)(void))callback)();
+                ((int (*)(const int, const unsigned char *, const int))callback)(event->devid,
+                        (const unsigned char *)event->payload, event->payload_len);
             }
         }
         break;
-        case IOTX_DM_EVENT_CLOUD_DISCONNECT: {
-            callback = iotx_event_callback(ITE_DISCONNECTED);
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
+        case IOTX_DM_EVENT_THING_SERVICE_REQUEST: {
+            int response_len = 0;
+            char *response = NULL;
+
+            if (event->id == NULL || event->identifier == NULL || event->payload == NULL || event->payload[0] != '{') {
+                return 0;
+            }
+
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT,
+                             "service req, msgid: %s, devid: %d, serviceid: %s, payload: %s",
+                             event->id, event->devid, event->identifier, event->payload);
+
+            callback = iotx_event_callback(ITE_SERVICE_REQUEST);
             if (callback) {
-                ((int (*)(void))callback)();
+                res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
+                                int *))callback)(event->devid, event->identifier, event->identifier_len,
+                                                 event->payload, event->payload_len, &response, &response_len);
+                if (response != NULL && response_len > 0) {
+                    /* service response exist */
+                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
+                    iotx_dm_send_service_response(event->devid, (char *)event->id, event->id_len, code,
+                                                  (char *)event->identifier, event->identifier_len,
+                                                  response, response_len, event->ctx);
+                    HAL_Free(response);
+                }
+            }
+
+            callback = iotx_event_callback(ITE_SERVICE_REQUEST_EXT);
+            if (callback) {
+                void *service_ctx = NULL;
+                _linkkit_service_list_insert(IOTX_SERVICE_REQ_TYPE_GENERAL, (char *)event->id, NULL, 0, event->ctx,
+                                             &service_ctx);
+                if (service_ctx != NULL) {
+                    res = ((int (*)(int, const char *, int, const char *, int, const char *, int,
+                                    void *))callback)(event->devid, event->identifier, event->identifier_len,
+                                                      event->id, event->id_len, event->payload, event->payload_len, service_ctx);
+                }
             }
         }
         break;
-        case IOTX_DM_EVENT_INITIALIZED: {
-            if (payload == NULL || lite_item_devid.type != cJSON_Number) {
-                return;
+        case IOTX_DM_EVENT_PROPERTY_SET: {
+            if (event->payload == NULL || event->payload[0] != '{') {
+                return 0;
             }
 
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "dev init, devid: %d",
-                             lite_item_devid.value_int);
-
-            callback = iotx_event_callback(ITE_INITIALIZE_COMPLETED);
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "property set, devid: %d, payload: %s",
+                             event->devid, event->payload);
+#ifdef LOG_REPORT_TO_CLOUD
+            if (SUCCESS_RETURN == check_target_msg(event->id, event->id_len)) {
+                report_sample = 1;
+                send_permance_info((char *)event->id, event->id_len, "3", 1);
+            }
+#endif
+            callback = iotx_event_callback(ITE_PROPERTY_SET);
             if (callback) {
-                ((int (*)(const int))callback)(lite_item_devid.value_int);
+                ((int (*)(const int, const char *, const int))callback)(event->devid, event->payload, event->payload_len);
+            }
+#ifdef LOG_REPORT_TO_CLOUD
+            if (1 == report_sample) {
+                send_permance_info(NULL, 0, "5", 2);
+                report_sample = 0;
             }
+#endif
         }
         break;
-        case IOTX_DM_EVENT_MODEL_DOWN_RAW: {
-            int raw_data_len = 0;
-            unsigned char *raw_data = NULL;
+        case IOTX_DM_EVENT_PROPERTY_GET: {
+            int response_len = 0;
+            char *response = NULL;
 
-            if (payload == NULL || lite_item_devid.type != cJSON_Number || lite_item_payload.type != cJSON_String) {
-                return;
+            if (event->id == NULL || event->payload == NULL || event->payload[0] != '[') {
+                return 0;
             }
 
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "down raw, devid: %d, raw: %.*s",
-                             lite_item_devid.value_int,
-                             lite_item_payload.value_length, lite_item_payload.value);
-
-            raw_data_len = lite_item_payload.value_length / 2;
-            raw_data = IMPL_LINKKIT_MALLOC(raw_data_len);
-            if (raw_data == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
-            }
-            LITE_hexstr_convert(lite_item_payload.value, lite_item_payload.value_length, raw_data, raw_data_len);
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT,
+                             "property get, msgid: %s, devid: %d, payload: %s",
+                             event->id, event->devid, event->payload);
 
-            HEXDUMP_DEBUG(raw_data, raw_data_len);
-            callback = iotx_event_callback(ITE_RAWDATA_ARRIVED);
+            callback = iotx_event_callback(ITE_PROPERTY_GET);
             if (callback) {
-                ((int (*)(const int, const unsigned char *, const int))callback)(lite_item_devid.value_int, raw_data, raw_data_len);
-            }
+                res = ((int (*)(const int, const char *, const int, char **, int *))callback)(event->devid, event->payload,
+                        event->payload_len, &response, &response_len);
 
-            IMPL_LINKKIT_FREE(raw_data);
+                if (response != NULL && response_len > 0) {
+                    /* property get response exist */
+                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
+                    iotx_dm_send_property_get_response(event->devid, (char *)event->id, event->id_len, code,
+                                                       response, response_len, event->ctx);
+                    HAL_Free(response);
+                }
+            }
         }
         break;
-        case IOTX_DM_EVENT_MODEL_UP_RAW_REPLY: {
-            int raw_data_len = 0;
-            unsigned char *raw_data = NULL;
-
-            if (payload == NULL || lite_item_devid.type != cJSON_Number || lite_item_payload.type != cJSON_String) {
-                return;
-            }
+        case IOTX_DM_EVENT_EVENT_PROPERTY_POST_REPLY:
+        case IOTX_DM_EVENT_DEVICEINFO_UPDATE_REPLY:
+        case IOTX_DM_EVENT_DEVICEINFO_DELETE_REPLY: {
+            const char *user_payload = NULL;
+            int user_payload_length = 0;
 
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "up raw reply, devid: %d, raw: %.*s",
-                             lite_item_devid.value_int,
-                             lite_item_payload.value_length, lite_item_payload.value);
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "report reply, code: %d", event->code);
 
-            raw_data_len = lite_item_payload.value_length / 2;
-            raw_data = IMPL_LINKKIT_MALLOC(raw_data_len);
-            if (raw_data == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
+            /* only data of reply is passed on, message of failure is not */
+            if (event->payload != NULL && event->payload[0] == '{' && event->payload_len > 0) {
+                user_payload = event->payload;
+                user_payload_length = event->payload_len;
             }
-            memset(raw_data, 0, raw_data_len);
-            LITE_hexstr_convert(lite_item_payload.value, lite_item_payload.value_length, raw_data, raw_data_len);
 
-            HEXDUMP_DEBUG(raw_data, raw_data_len);
-
-            callback = iotx_event_callback(ITE_RAWDATA_ARRIVED);
+            callback = iotx_event_callback(ITE_REPORT_REPLY);
             if (callback) {
-                ((int (*)(const int, const unsigned char *, const int))callback)(lite_item_devid.value_int, raw_data, raw_data_len);
+                ((int (*)(const int, const int, const int, const char *, const int))callback)(event->devid,
+                        event->msgid, event->code, user_payload, user_payload_length);
             }
-
-            IMPL_LINKKIT_FREE(raw_data);
         }
         break;
-#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
-        case IOTX_DM_EVENT_THING_SERVICE_REQUEST: {
-            int response_len = 0;
-            char *request = NULL, *response = NULL;
-
-            uintptr_t property_get_ctx_num = 0;
-            void *property_get_ctx = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_String || lite_item_devid.type != cJSON_Number ||
-                lite_item_serviceid.type != cJSON_String || lite_item_payload.type != cJSON_Object) {
-                return;
+        case IOTX_DM_EVENT_EVENT_SPECIFIC_POST_REPLY: {
+            /* timeout of event post has no event id, and is not reported */
+            if (event->identifier == NULL || event->payload == NULL) {
+                return 0;
             }
 
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT,
-                             "service req, msgid: %.*s, devid: %d, serviceid: %.*s, payload: %.*s",
-                             lite_item_id.value_length, lite_item_id.value,
-                             lite_item_devid.value_int,
-                             lite_item_serviceid.value_length, lite_item_serviceid.value,
-                             lite_item_payload.value_length, lite_item_payload.value);
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "event post reply, eventID: %s",
+                             event->identifier);
 
-            LITE_hexstr_convert(lite_item_ctx.value, lite_item_ctx.value_length, (unsigned char *)&property_get_ctx_num,
-                                sizeof(uintptr_t));
-            property_get_ctx = (void *)property_get_ctx_num;
+            callback = iotx_event_callback(ITE_TRIGGER_EVENT_REPLY);
+            if (callback) {
+                ((int (*)(const int, const int, const int, const char *, const int, const char *,
+                          const int))callback)(event->devid, event->msgid, event->code,
+                                               event->identifier, event->identifier_len, event->payload, event->payload_len);
+            }
+        }
+        break;
+        case IOTX_DM_EVENT_RRPC_REQUEST: {
+            int rrpc_response_len = 0;
+            char *rrpc_response = NULL;
 
-            request = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (request == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
+            if (event->id == NULL || event->identifier == NULL || event->rrpcid == NULL ||
+                event->payload == NULL || event->payload[0] != '{') {
+                return 0;
             }
-            memset(request, 0, lite_item_payload.value_length + 1);
-            memcpy(request, lite_item_payload.value, lite_item_payload.value_length);
+
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "rrpc request received, payload: %s",
+                             event->payload);
 
             callback = iotx_event_callback(ITE_SERVICE_REQUEST);
             if (callback) {
                 res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
-                                int *))callback)(lite_item_devid.value_int, lite_item_serviceid.value,
-                                                 lite_item_serviceid.value_length, request, lite_item_payload.value_length, &response, &response_len);
-                if (response != NULL && response_len > 0) {
-                    /* service response exist */
+                                int *))callback)(event->devid, event->identifier, event->identifier_len,
+                                                 event->payload, event->payload_len, &rrpc_response, &rrpc_response_len);
+                if (rrpc_response != NULL && rrpc_response_len > 0) {
                     iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
-                    iotx_dm_send_service_response(lite_item_devid.value_int, lite_item_id.value, lite_item_id.value_length, code,
-                                                  lite_item_serviceid.value,
-                                                  lite_item_serviceid.value_length,
-                                                  response, response_len, property_get_ctx);
-                    HAL_Free(response);
+                    iotx_dm_send_rrpc_response(event->devid, (char *)event->id, event->id_len, code,
+                                               (char *)event->rrpcid, event->rrpcid_len,
+                                               rrpc_response, rrpc_response_len);
+                    HAL_Free(rrpc_response);
                 }
             }
 
             callback = iotx_event_callback(ITE_SERVICE_REQUEST_EXT);
             if (callback) {
                 void *service_ctx = NULL;
-                _linkkit_service_list_insert(IOTX_SERVICE_REQ_TYPE_GENERAL, lite_item_id.value, NULL, 0, property_get_ctx,
-                                             &service_ctx);
+                _linkkit_service_list_insert(IOTX_SERVICE_REQ_TYPE_RRPC, (char *)event->id, (char *)event->rrpcid,
+                                             event->rrpcid_len, NULL, &service_ctx);
                 if (service_ctx != NULL) {
                     res = ((int (*)(int, const char *, int, const char *, int, const char *, int,
-                                    void *))callback)(lite_item_devid.value_int,
-                                                      lite_item_serviceid.value,
-                                                      lite_item_serviceid.value_length, lite_item_id.value, lite_item_id.value_length, request,
-                                                      lite_item_payload.value_length, service_ctx);
+                                    void *))callback)(event->devid, event->identifier, event->identifier_len,
+                                                      event->id, event->id_len, event->payload, event->payload_len, service_ctx);
                 }
             }
-
-            IMPL_LINKKIT_FREE(request);
         }
         break;
-        case IOTX_DM_EVENT_PROPERTY_SET: {
-            char *property_payload = NULL;
+#endif
+        default: {
+            return -1;
+        }
+    }
 
-            if (payload == NULL || lite_item_devid.type != cJSON_Number || lite_item_payload.type != cJSON_Object) {
-                return;
-            }
+    return 0;
+}
 
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "property set, devid: %d, payload: %.*s",
-                             lite_item_devid.value_int,
-                             lite_item_payload.value_length, lite_item_payload.value);
+static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *payload)
+{
+    int res = 0;
+    void *callback;
+    dm_utils_json_t json;
+    lite_cjson_t lite_item_id, lite_item_devid, lite_item_payload;
+    lite_cjson_t lite_item_code, lite_item_utc, lite_item_topo;
+    lite_cjson_t lite_item_pk, lite_item_time;
+    lite_cjson_t lite_item_version, lite_item_configid, lite_item_configsize, lite_item_gettype, lite_item_sign,
+                 lite_item_signmethod, lite_item_url, lite_item_data, lite_item_message;
 
-            property_payload = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (property_payload == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
-            }
-            memset(property_payload, 0, lite_item_payload.value_length + 1);
-            memcpy(property_payload, lite_item_payload.value, lite_item_payload.value_length);
-#ifdef LOG_REPORT_TO_CLOUD
-            if (SUCCESS_RETURN == check_target_msg(msg_id.value, msg_id.value_length)) {
-                report_sample = 1;
-                send_permance_info(msg_id.value, msg_id.value_length, "3", 1);
+    iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "alink event type: %d", type);
+
+    if (payload) {
+        res = dm_utils_json_doc_parse(payload, strlen(payload), cJSON_Invalid, &json);
+        if (res != SUCCESS_RETURN) {
+            return;
+        }
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_ID, strlen(IOTX_LINKKIT_KEY_ID), cJSON_Invalid, &lite_item_id);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_DEVID, strlen(IOTX_LINKKIT_KEY_DEVID), cJSON_Invalid,
+                               &lite_item_devid);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_PAYLOAD, strlen(IOTX_LINKKIT_KEY_PAYLOAD), cJSON_Invalid,
+                               &lite_item_payload);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_CODE, strlen(IOTX_LINKKIT_KEY_CODE), cJSON_Invalid, &lite_item_code);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_UTC, strlen(IOTX_LINKKIT_KEY_UTC), cJSON_Invalid, &lite_item_utc);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_TOPO, strlen(IOTX_LINKKIT_KEY_TOPO), cJSON_Invalid,
+                               &lite_item_topo);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_PRODUCT_KEY, strlen(IOTX_LINKKIT_KEY_PRODUCT_KEY), cJSON_Invalid,
+                               &lite_item_pk);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_TIME, strlen(IOTX_LINKKIT_KEY_TIME), cJSON_Invalid,
+                               &lite_item_time);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_VERSION, strlen(IOTX_LINKKIT_KEY_VERSION), cJSON_Invalid,
+                               &lite_item_version);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_CONFIG_ID, strlen(IOTX_LINKKIT_KEY_CONFIG_ID), cJSON_Invalid,
+                               &lite_item_configid);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_CONFIG_SIZE, strlen(IOTX_LINKKIT_KEY_CONFIG_SIZE), cJSON_Invalid,
+                               &lite_item_configsize);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_GET_TYPE, strlen(IOTX_LINKKIT_KEY_GET_TYPE), cJSON_Invalid,
+                               &lite_item_gettype);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_SIGN, strlen(IOTX_LINKKIT_KEY_SIGN), cJSON_Invalid,
+                               &lite_item_sign);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_SIGN_METHOD, strlen(IOTX_LINKKIT_KEY_SIGN_METHOD), cJSON_Invalid,
+                               &lite_item_signmethod);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_URL, strlen(IOTX_LINKKIT_KEY_URL), cJSON_Invalid,
+                               &lite_item_url);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_DATA, strlen(IOTX_LINKKIT_KEY_DATA), cJSON_Invalid,
+                               &lite_item_data);
+        dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_MESSAGE, strlen(IOTX_LINKKIT_KEY_MESSAGE), cJSON_Invalid,
+                               &lite_item_message);
+    }
+
+    switch (type) {
+        case IOTX_DM_EVENT_CLOUD_CONNECTED: {
+            callback = iotx_event_callback(ITE_CONNECT_SUCC);
+            if (callback) {
+                ((int (*)(void))callback)();
             }
-#endif
-            callback = iotx_event_callback(ITE_PROPERTY_SET);
+        }
+        break;
+        case IOTX_DM_EVENT_CLOUD_DISCONNECT: {
+            callback = iotx_event_callback(ITE_DISCONNECTED);
             if (callback) {
-                ((int (*)(const int, const char *, const int))callback)(lite_item_devid.value_int, property_payload,
-                        lite_item_payload.value_length);
+                ((int (*)(void))callback)();
             }
-#ifdef LOG_REPORT_TO_CLOUD
-            if (1 == report_sample) {
-                send_permance_info(NULL, 0, "5", 2);
-                report_sample = 0;
+        }
+        break;
+        case IOTX_DM_EVENT_INITIALIZED: {
+            if (payload == NULL || lite_item_devid.type != cJSON_Number) {
+                return;
             }
-#endif
 
-            IMPL_LINKKIT_FREE(property_payload);
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "dev init, devid: %d",
+                             lite_item_devid.value_int);
+
+            callback = iotx_event_callback(ITE_INITIALIZE_COMPLETED);
+            if (callback) {
+                ((int (*)(const int))callback)(lite_item_devid.value_int);
+            }
         }
         break;
+#if !defined(DEVICE_MODEL_RAWDATA_SOLO)
 #ifdef DEVICE_MODEL_SHADOW
         case IOTX_DM_EVENT_PROPERTY_DESIRED_GET_REPLY: {
             char *property_data = NULL;
             lite_cjson_t lite_item_data;
 
             memset(&lite_item_data, 0, sizeof(lite_cjson_t));
-            dm_utils_json_object_item(&lite, IOTX_LINKKIT_KEY_DATA, strlen(IOTX_LINKKIT_KEY_DATA), cJSON_Invalid,
-                                      &lite_item_data);
+            dm_utils_json_doc_item(&json, IOTX_LINKKIT_KEY_DATA, strlen(IOTX_LINKKIT_KEY_DATA), cJSON_Invalid,
+                                   &lite_item_data);
             if (payload == NULL || lite_item_data.type != cJSON_Object) {
                 return;
             }
@@ -699,59 +730,7 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
             IMPL_LINKKIT_FREE(property_data);
         }
         break;
-#endif
-        case IOTX_DM_EVENT_PROPERTY_GET: {
-            int response_len = 0;
-            char *request = NULL, *response = NULL;
-            uintptr_t property_get_ctx_num = 0;
-            void *property_get_ctx = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_String || lite_item_devid.type != cJSON_Number ||
-                lite_item_payload.type != cJSON_Array) {
-                return;
-            }
-
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT,
-                             "property get, msgid: %.*s, devid: %d, payload: %.*s",
-                             lite_item_id.value_length, lite_item_id.value,
-                             lite_item_devid.value_int,
-                             lite_item_payload.value_length, lite_item_payload.value);
-
-            LITE_hexstr_convert(lite_item_ctx.value, lite_item_ctx.value_length, (unsigned char *)&property_get_ctx_num,
-                                sizeof(uintptr_t));
-            property_get_ctx = (void *)property_get_ctx_num;
-
-            request = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (request == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
-            }
-            memset(request, 0, lite_item_payload.value_length + 1);
-            memcpy(request, lite_item_payload.value, lite_item_payload.value_length);
-
-            callback = iotx_event_callback(ITE_PROPERTY_GET);
-            if (callback) {
-                res = ((int (*)(const int, const char *, const int, char **, int *))callback)(lite_item_devid.value_int, request,
-                        lite_item_payload.value_length, &response, &response_len);
-
-                if (response != NULL && response_len > 0) {
-                    /* property get response exist */
-                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
-                    iotx_dm_send_property_get_response(lite_item_devid.value_int, lite_item_id.value, lite_item_id.value_length, code,
-                                                       response, response_len, property_get_ctx);
-                    HAL_Free(response);
-                }
-            }
-
-            IMPL_LINKKIT_FREE(request);
-        }
-        break;
-        case IOTX_DM_EVENT_EVENT_PROPERTY_POST_REPLY:
-        case IOTX_DM_EVENT_DEVICEINFO_UPDATE_REPLY:
-#ifdef DEVICE_MODEL_SHADOW
-        case IOTX_DM_EVENT_PROPERTY_DESIRED_DELETE_REPLY:
-#endif
-        case IOTX_DM_EVENT_DEVICEINFO_DELETE_REPLY: {
+        case IOTX_DM_EVENT_PROPERTY_DESIRED_DELETE_REPLY: {
             char *user_payload = NULL;
             int user_payload_length = 0;
 
@@ -759,7 +738,7 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
                 || lite_item_devid.type != cJSON_Number) {
                 return;
             }
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "deviceinfo delete post reply, code: %d",
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "desired delete reply, code: %d",
                              lite_item_code.value_int);
 
             if (lite_item_payload.type == cJSON_Object && lite_item_payload.value_length > 0) {
@@ -785,49 +764,7 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
             }
         }
         break;
-        case IOTX_DM_EVENT_EVENT_SPECIFIC_POST_REPLY: {
-            char *user_eventid = NULL;
-            char *user_payload = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_Number || lite_item_code.type != cJSON_Number ||
-                lite_item_devid.type != cJSON_Number || lite_item_eventid.type != cJSON_String
-                || lite_item_payload.type != cJSON_String) {
-                return;
-            }
-
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "event post reply, eventID: %.*s",
-                             lite_item_eventid.value_length, lite_item_eventid.value);
-
-            user_eventid = IMPL_LINKKIT_MALLOC(lite_item_eventid.value_length + 1);
-            if (user_eventid == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
-            }
-            memset(user_eventid, 0, lite_item_eventid.value_length + 1);
-            memcpy(user_eventid, lite_item_eventid.value, lite_item_eventid.value_length);
-
-            user_payload = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (user_payload == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                IMPL_LINKKIT_FREE(user_eventid);
-                return;
-            }
-            memset(user_payload, 0, lite_item_payload.value_length + 1);
-            memcpy(user_payload, lite_item_payload.value, lite_item_payload.value_length);
-
-
-            callback = iotx_event_callback(ITE_TRIGGER_EVENT_REPLY);
-            if (callback) {
-                ((int (*)(const int, const int, const int, const char *, const int, const char *,
-                          const int))callback)(lite_item_devid.value_int,
-                                               lite_item_id.value_int, lite_item_code.value_int,
-                                               user_eventid, lite_item_eventid.value_length, user_payload, lite_item_payload.value_length);
-            }
-
-            IMPL_LINKKIT_FREE(user_eventid);
-            IMPL_LINKKIT_FREE(user_payload);
-        }
-        break;
+#endif
         case IOTX_DM_EVENT_NTP_RESPONSE: {
             char *utc_payload = NULL;
 
@@ -854,60 +791,6 @@ static void _iotx_linkkit_event_callback(iotx_dm_event_types_t type, char *paylo
             IMPL_LINKKIT_FREE(utc_payload);
         }
         break;
-        case IOTX_DM_EVENT_RRPC_REQUEST: {
-            int rrpc_response_len = 0;
-            char *rrpc_request = NULL, *rrpc_response = NULL;
-
-            if (payload == NULL || lite_item_id.type != cJSON_String || lite_item_devid.type != cJSON_Number ||
-                lite_item_serviceid.type != cJSON_String || lite_item_rrpcid.type != cJSON_String
-                || lite_item_payload.type != cJSON_Object) {
-                return;
-            }
-
-            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_ALINK_PROT_EVENT, "rrpc request received, payload: %.*s",
-                             lite_item_payload.value_length, lite_item_payload.value);
-
-            rrpc_request = IMPL_LINKKIT_MALLOC(lite_item_payload.value_length + 1);
-            if (rrpc_request == NULL) {
-                iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
-                return;
-            }
-            memset(rrpc_request, 0, lite_item_payload.value_length + 1);
-            memcpy(rrpc_request, lite_item_payload.value, lite_item_payload.value_length);
-
-            callback = iotx_event_callback(ITE_SERVICE_REQUEST);
-            if (callback) {
-                res = ((int (*)(const int, const char *, const int, const char *, const int, char **,
-                                int *))callback)(lite_item_devid.value_int, lite_item_serviceid.value,
-                                                 lite_item_serviceid.value_length,
-                                                 rrpc_request, lite_item_payload.value_length, &rrpc_response, &rrpc_response_len);
-                if (rrpc_response != NULL && rrpc_response_len > 0) {
-                    iotx_dm_error_code_t code = (res == 0) ? (IOTX_DM_ERR_CODE_SUCCESS) : (IOTX_DM_ERR_CODE_REQUEST_ERROR);
-                    iotx_dm_send_rrpc_response(lite_item_devid.value_int, lite_item_id.value, lite_item_id.value_length, code,
-                                               lite_item_rrpcid.value,
-                                               lite_item_rrpcid.value_length,
-                                               rrpc_response, rrpc_response_len);
-                    HAL_Free(rrpc_response);
-                }
-            }
-
-            callback = iotx_event_callback(ITE_SERVICE_REQUEST_EXT);
-            if (callback) {
-                void *service_ctx = NULL;
-                _linkkit_service_list_insert(IOTX_SERVICE_REQ_TYPE_RRPC, lite_item_id.value, lite_item_rrpcid.value,
-                                             lite_item_rrpcid.value_length, NULL, &service_ctx);
-                if (service_ctx != NULL) {
-                    res = ((int (*)(int, const char *, int, const char *, int, const char *, int,
-                                    void *))callback)(lite_item_devid.value_int,
-                                                      lite_item_serviceid.value,
-                                                      lite_item_serviceid.value_length, lite_item_id.value, lite_item_id.value_length, rrpc_request,
-                                                      lite_item_payload.value_length, service_ctx);
-                }
-            }
-
-            IMPL_LINKKIT_FREE(rrpc_request);
-        }
-        break;
 #endif
         case IOTX_DM_EVENT_FOTA_NEW_FIRMWARE: {
             char *version = NULL;
@@ -1224,6 +1107,7 @@ static int _iotx_linkkit_master_connect(void)
 
     memset(&dm_init_params, 0, sizeof(iotx_dm_init_params_t));
     dm_init_params.event_callback = _iotx_linkkit_event_callback;
+    dm_init_params.typed_event_callback = _iotx_linkkit_typed_event_callback;
 
     res = iotx_dm_connect(&dm_init_params);
     if (res != SUCCESS_RETURN) {
@@ -17,9 +17,9 @@ static int inited_conn_num = 0;
 
 #ifdef DEVICE_MODEL_GATEWAY
     static void *_iotx_cm_yield_thread_func(void *params);
-    static void *yield_thread = NULL;
-    static int yield_task_leave = 1;
 #endif
+static int _iotx_cm_shard_default(const char *product_key, const char *device_name, int shard_num);
+static iotx_cm_shard_fp shard_policy = _iotx_cm_shard_default;
 
 const char ERR_INVALID_PARAMS[] = "invalid parameter";
 int iotx_cm_open(iotx_cm_init_param_t *params)
@@ -47,16 +47,19 @@ int iotx_cm_open(iotx_cm_init_param_t *params)
     }
     fd = _get_fd(connection);
     if (fd < 0) {
-        connection->close_func();
+        connection->close_func(connection);
         return fd;
     }
     connection->fd = fd;
+#ifdef DEVICE_MODEL_GATEWAY
+    connection->yield_task_leave = 1;
+#endif
     return fd;
 }
 
 int iotx_cm_connect(int fd, uint32_t timeout)
 {
-    iotx_cm_connect_fp connect_func;
+    iotx_cm_connection_t *connection;
     int ret;
 
     if (_fd_is_valid(fd) < 0) {
@@ -64,29 +67,33 @@ int iotx_cm_connect(int fd, uint32_t timeout)
     }
 
     HAL_MutexLock(fd_lock);
-    connect_func = _cm_fd[fd]->connect_func;
+    connection = _cm_fd[fd];
     HAL_MutexUnlock(fd_lock);
 
     iotx_event_post(IOTX_CONN_CLOUD);
 
-    ret = connect_func(timeout);
+    ret = connection->connect_func(connection, timeout);
 
     if (ret == 0) {
         inited_conn_num++;
-        if (inited_conn_num == 1) {
 
 #ifdef DEVICE_MODEL_GATEWAY
+        if (connection->yield_thread == NULL) {
             int stack_used;
             hal_os_thread_param_t task_parms = {0};
             task_parms.stack_size = 6144;
             task_parms.name = "cm_yield";
-            ret = HAL_ThreadCreate(&yield_thread, _iotx_cm_yield_thread_func, NULL,
+            connection->yield_stop = 0;
+            connection->yield_task_leave = 0;
+            ret = HAL_ThreadCreate(&connection->yield_thread, _iotx_cm_yield_thread_func, connection,
                                    &task_parms, &stack_used);
             if (ret < 0) {
+                connection->yield_thread = NULL;
+                connection->yield_task_leave = 1;
                 inited_conn_num--;
             }
-#endif
         }
+#endif
         iotx_event_post(IOTX_CONN_CLOUD_SUC);
     } else {
         iotx_event_post(IOTX_CONN_CLOUD_FAIL);
@@ -97,7 +104,7 @@ int iotx_cm_connect(int fd, uint32_t timeout)
 
 static int _iotx_cm_yield(int fd, unsigned int timeout)
 {
-    iotx_cm_yield_fp yield_func;
+    iotx_cm_connection_t *connection;
 
     if (fd_lock == NULL) {
         return STATE_DEV_MODEL_INTERNAL_ERROR;
@@ -106,14 +113,11 @@ static int _iotx_cm_yield(int fd, unsigned int timeout)
     if (fd == -1) {
         int i;
         for (i = 0; i < CM_MAX_FD_NUM; i++) {
-            yield_func = NULL;
             HAL_MutexLock(fd_lock);
-            if (_cm_fd[i] != NULL) {
-                yield_func = _cm_fd[i]->yield_func;
-            }
+            connection = _cm_fd[i];
             HAL_MutexUnlock(fd_lock);
-            if (yield_func != NULL) {
-                yield_func(timeout);
+            if (connection != NULL) {
+                connection->yield_func(connection, timeout);
             }
         }
         return STATE_SUCCESS;
@@ -124,19 +128,21 @@ static int _iotx_cm_yield(int fd, unsigned int timeout)
     }
 
     HAL_MutexLock(fd_lock);
-    yield_func = _cm_fd[fd]->yield_func;
+    connection = _cm_fd[fd];
     HAL_MutexUnlock(fd_lock);
-    return yield_func(timeout);
+    return connection->yield_func(connection, timeout);
 }
 
 #ifdef DEVICE_MODEL_GATEWAY
+/* yield one connection, so that a slow connection does not hold up the others */
 static void *_iotx_cm_yield_thread_func(void *params)
 {
-    yield_task_leave = 0;
-    while (inited_conn_num > 0) {
-        _iotx_cm_yield(-1, CM_DEFAULT_YIELD_TIMEOUT);
+    iotx_cm_connection_t *connection = (iotx_cm_connection_t *)params;
+
+    while (!connection->yield_stop) {
+        connection->yield_func(connection, CM_DEFAULT_YIELD_TIMEOUT);
     }
-    yield_task_leave = 1;
+    connection->yield_task_leave = 1;
     return NULL;
 }
 #endif
@@ -153,49 +159,77 @@ int iotx_cm_yield(int fd, unsigned int timeout)
 int iotx_cm_sub(int fd, iotx_cm_ext_params_t *ext, const char *topic,
                 iotx_cm_data_handle_cb topic_handle_func, void *pcontext)
 {
-    iotx_cm_sub_fp sub_func;
+    iotx_cm_connection_t *connection;
 
     if (_fd_is_valid(fd) < 0) {
         return STATE_DEV_MODEL_CM_FD_ERROR;
     }
 
     HAL_MutexLock(fd_lock);
-    sub_func = _cm_fd[fd]->sub_func;
+    connection = _cm_fd[fd];
     HAL_MutexUnlock(fd_lock);
-    return sub_func(ext, topic, topic_handle_func, pcontext);
+    return connection->sub_func(connection, ext, topic, topic_handle_func, pcontext);
+}
+
+/* subscribe topics together, return count of topics subscribed */
+int iotx_cm_sub_multi(int fd, iotx_cm_ext_params_t *ext, iotx_cm_sub_entry_t *entry, int count)
+{
+    iotx_cm_connection_t *connection;
+    int idx, subed = 0;
+
+    if (_fd_is_valid(fd) < 0) {
+        return STATE_DEV_MODEL_CM_FD_ERROR;
+    }
+
+    HAL_MutexLock(fd_lock);
+    connection = _cm_fd[fd];
+    HAL_MutexUnlock(fd_lock);
+
+    if (connection->sub_multi_func != NULL) {
+        return connection->sub_multi_func(connection, ext, entry, count);
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        entry[idx].result = connection->sub_func(connection, ext, entry[idx].topic, entry[idx].topic_handle_func,
+                                                 entry[idx].pcontext);
+        if (entry[idx].result >= 0) {
+            subed++;
+        }
+    }
+    return subed;
 }
 
 int iotx_cm_unsub(int fd, const char *topic)
 {
-    iotx_cm_unsub_fp unsub_func;
+    iotx_cm_connection_t *connection;
 
     if (_fd_is_valid(fd) < 0) {
         return STATE_DEV_MODEL_CM_FD_ERROR;
     }
 
     HAL_MutexLock(fd_lock);
-    unsub_func = _cm_fd[fd]->unsub_func;
+    connection = _cm_fd[fd];
     HAL_MutexUnlock(fd_lock);
-    return unsub_func(topic);
+    return connection->unsub_func(connection, topic);
 }
 
 int iotx_cm_pub(int fd, iotx_cm_ext_params_t *ext, const char *topic, const char *payload, unsigned int payload_len)
 {
-    iotx_cm_pub_fp pub_func;
+    iotx_cm_connection_t *connection;
 
     if (_fd_is_valid(fd) < 0) {
         return STATE_DEV_MODEL_CM_FD_ERROR;
     }
 
     HAL_MutexLock(fd_lock);
-    pub_func = _cm_fd[fd]->pub_func;
+    connection = _cm_fd[fd];
     HAL_MutexUnlock(fd_lock);
-    return pub_func(ext, topic, payload, payload_len);
+    return connection->pub_func(connection, ext, topic, payload, payload_len);
 }
 
 int iotx_cm_close(int fd)
 {
-    iotx_cm_close_fp close_func;
+    iotx_cm_connection_t *connection;
 
     if (_fd_is_valid(fd) < 0) {
         return STATE_DEV_MODEL_CM_FD_ERROR;
@@ -205,19 +239,19 @@ int iotx_cm_close(int fd)
         inited_conn_num--;
     }
 
-    if (inited_conn_num == 0) {
+    HAL_MutexLock(fd_lock);
+    connection = _cm_fd[fd];
+    HAL_MutexUnlock(fd_lock);
+
 #ifdef DEVICE_MODEL_GATEWAY
-        while (!yield_task_leave) {
-            HAL_SleepMs(10);
-        }
-        yield_thread = NULL;
-#endif
+    connection->yield_stop = 1;
+    while (!connection->yield_task_leave) {
+        HAL_SleepMs(10);
     }
+    connection->yield_thread = NULL;
+#endif
 
-    HAL_MutexLock(fd_lock);
-    close_func = _cm_fd[fd]->close_func;
-    HAL_MutexUnlock(fd_lock);
-    if (close_func() != 0) {
+    if (connection->close_func(connection) != 0) {
         return -1;
     }
     if (_recycle_fd(fd) != 0) {
@@ -234,6 +268,60 @@ int iotx_cm_close(int fd)
     return 0;
 }
 
+void iotx_cm_set_shard_policy(iotx_cm_shard_fp policy)
+{
+    shard_policy = (policy != NULL) ? policy : _iotx_cm_shard_default;
+}
+
+/* fd of MQTT connection device is sharded to, picked by shard policy among opened ones in fd order */
+int iotx_cm_shard_fd(const char *product_key, const char *device_name)
+{
+    int shard_fd[CM_MAX_FD_NUM];
+    int i, shard_num = 0, shard;
+
+    if (product_key == NULL || device_name == NULL) {
+        return STATE_USER_INPUT_NULL_POINTER;
+    }
+    if (fd_lock == NULL) {
+        return STATE_DEV_MODEL_CM_FD_NOT_FOUND;
+    }
+
+    HAL_MutexLock(fd_lock);
+    for (i = 0; i < CM_MAX_FD_NUM; i++) {
+        if (_cm_fd[i] != NULL && _cm_fd[i]->protocol_type == IOTX_CM_PROTOCOL_TYPE_MQTT) {
+            shard_fd[shard_num++] = i;
+        }
+    }
+    HAL_MutexUnlock(fd_lock);
+
+    if (shard_num == 0) {
+        return STATE_DEV_MODEL_CM_FD_NOT_FOUND;
+    }
+
+    shard = shard_policy(product_key, device_name, shard_num);
+    if (shard < 0 || shard >= shard_num) {
+        shard = 0;
+    }
+    return shard_fd[shard];
+}
+
+/* FNV-1a hash of "product_key.device_name" */
+static int _iotx_cm_shard_default(const char *product_key, const char *device_name, int shard_num)
+{
+    uint32_t hash = 2166136261u;
+    const char *p;
+
+    for (p = product_key; *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    hash = (hash ^ (uint8_t)'.') * 16777619u;
+    for (p = device_name; *p != '\0'; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+
+    return (int)(hash % (uint32_t)shard_num);
+}
+
 
 static int inline _fd_is_valid(int fd)
 {
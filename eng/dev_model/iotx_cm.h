@@ -8,7 +8,9 @@
 
 #include "infra_types.h"
 
-#define CM_MAX_FD_NUM             3
+#ifndef CM_MAX_FD_NUM
+    #define CM_MAX_FD_NUM         3
+#endif
 #define CM_DEFAULT_YIELD_TIMEOUT  200
 /* message confirmation type */
 typedef enum {
@@ -100,6 +102,8 @@ typedef void (*iotx_cm_data_handle_cb)(int fd, const char *topic, const char *pa
 #endif
 
 typedef void (*iotx_cm_event_handle_cb)(int fd, iotx_cm_event_msg_t *event, void *context);
+/* fill level in percent of queue fed by iotx_cm_event_handle_cb, cloud is not read while it is high */
+typedef int (*iotx_cm_backlog_cb)(void *context);
 
 
 /* IoTx initializa parameters */
@@ -115,6 +119,8 @@ typedef struct {
     iotx_dev_meta_info_t         *dev_info;
     iotx_mqtt_region_types_t      region;
 #endif
+    iotx_dev_meta_info_t         *shard_meta;               /* MQTT only, identity of connection besides the first one */
+    iotx_cm_backlog_cb            rx_backlog;               /* MQTT only, fill level of queue fed by 'handle_event' */
 } iotx_cm_init_param_t;
 
 typedef struct {
@@ -125,12 +131,26 @@ typedef struct {
     void                          *cb_context;
 } iotx_cm_ext_params_t;
 
+/* topic of iotx_cm_sub_multi(), 'result' is set to non-negative once it is subscribed */
+typedef struct {
+    const char                    *topic;
+    iotx_cm_data_handle_cb        topic_handle_func;
+    void                          *pcontext;
+    int                           result;
+} iotx_cm_sub_entry_t;
+
+/* pick one of 'shard_num' MQTT connections for device, return its index in [0, shard_num) */
+typedef int (*iotx_cm_shard_fp)(const char *product_key, const char *device_name, int shard_num);
+
 int iotx_cm_open(iotx_cm_init_param_t *params);
 int iotx_cm_connect(int fd, uint32_t timeout);
 int iotx_cm_yield(int fd, unsigned int timeout);
 int iotx_cm_sub(int fd, iotx_cm_ext_params_t *ext, const char *topic,
                 iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
+int iotx_cm_sub_multi(int fd, iotx_cm_ext_params_t *ext, iotx_cm_sub_entry_t *entry, int count);
 int iotx_cm_unsub(int fd, const char *topic);
 int iotx_cm_pub(int fd, iotx_cm_ext_params_t *ext, const char *topic, const char *payload, unsigned int payload_len);
 int iotx_cm_close(int fd);
+void iotx_cm_set_shard_policy(iotx_cm_shard_fp policy);
+int iotx_cm_shard_fd(const char *product_key, const char *device_name);
 #endif /* _LINKKIT_CM_H_ */
@@ -35,14 +35,14 @@ static struct list_head g_coap_response_list = LIST_HEAD_INIT(g_coap_response_li
 static iotx_cm_connection_t *_coap_conncection = NULL;
 static int iotx_set_devinfo(iotx_coap_device_info_t *p_devinfo);
 
-static int  _coap_connect(uint32_t timeout);
-static int _coap_publish(iotx_cm_ext_params_t *params, const char *topic, const char *payload,
-                         unsigned int payload_len);
-static int _coap_sub(iotx_cm_ext_params_t *params, const char *topic,
+static int  _coap_connect(iotx_cm_connection_t *connection, uint32_t timeout);
+static int _coap_publish(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params, const char *topic,
+                         const char *payload, unsigned int payload_len);
+static int _coap_sub(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params, const char *topic,
                      iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
 static iotx_msg_type_t _get_coap_qos(iotx_cm_ack_types_t ack_type);
-static int _coap_unsub(const char *topic);
-static int _coap_close();
+static int _coap_unsub(iotx_cm_connection_t *connection, const char *topic);
+static int _coap_close(iotx_cm_connection_t *connection);
 static void _set_common_handlers();
 
 iotx_cm_connection_t *iotx_cm_open_coap(iotx_cm_init_param_t *params)
@@ -136,7 +136,7 @@ static int iotx_set_devinfo(iotx_coap_device_info_t *p_devinfo)
     return IOTX_SUCCESS;
 }
 
-static int  _coap_connect(uint32_t timeout)
+static int  _coap_connect(iotx_cm_connection_t *connection, uint32_t timeout)
 {
     int ret;
     char url[100] = {0};
@@ -257,7 +257,8 @@ static void _coap_response_default(void *p_arg, void *p_message)
 }
 
 
-static int _coap_publish(iotx_cm_ext_params_t *ext, const char *topic, const char *payload, unsigned int payload_len)
+static int _coap_publish(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *ext, const char *topic,
+                         const char *payload, unsigned int payload_len)
 {
     iotx_msg_type_t qos = 0;
     iotx_message_t     message;
@@ -316,7 +317,7 @@ static int _coap_publish(iotx_cm_ext_params_t *ext, const char *topic, const cha
     return 0;
 }
 
-static int _coap_yield(uint32_t timeout)
+static int _coap_yield(iotx_cm_connection_t *connection, uint32_t timeout)
 {
     if (_coap_conncection == NULL) {
         return NULL_VALUE_ERROR;
@@ -324,18 +325,18 @@ static int _coap_yield(uint32_t timeout)
     return  IOT_CoAP_Yield((iotx_coap_context_t *)_coap_conncection->context);
 }
 
-static int _coap_sub(iotx_cm_ext_params_t *ext, const char *topic,
+static int _coap_sub(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *ext, const char *topic,
                      iotx_cm_data_handle_cb topic_handle_func, void *pcontext)
 {
     return 0;
 }
 
-static int _coap_unsub(const char *topic)
+static int _coap_unsub(iotx_cm_connection_t *connection, const char *topic)
 {
     return 0;
 }
 
-static int _coap_close()
+static int _coap_close(iotx_cm_connection_t *connection)
 {
     coap_response_node_t *node = NULL;
     coap_response_node_t *next = NULL;
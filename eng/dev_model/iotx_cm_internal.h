@@ -42,17 +42,21 @@
     #define cm_err(...)          do{HAL_Printf(__VA_ARGS__);HAL_Printf("\r\n");}while(0)
 #endif
 
-typedef int (*iotx_cm_connect_fp)(uint32_t timeout);
-typedef int (*iotx_cm_yield_fp)(unsigned int timeout);
-typedef int (*iotx_cm_sub_fp)(iotx_cm_ext_params_t *params, const char *topic,
+typedef struct iotx_connection_st iotx_cm_connection_t;
+
+typedef int (*iotx_cm_connect_fp)(iotx_cm_connection_t *connection, uint32_t timeout);
+typedef int (*iotx_cm_yield_fp)(iotx_cm_connection_t *connection, unsigned int timeout);
+typedef int (*iotx_cm_sub_fp)(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params, const char *topic,
                               iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
-typedef int (*iotx_cm_unsub_fp)(const char *topic);
-typedef int (*iotx_cm_pub_fp)(iotx_cm_ext_params_t *params, const char *topic, const char *payload,
-                              unsigned int payload_len);
-typedef int (*iotx_cm_close_fp)();
+typedef int (*iotx_cm_sub_multi_fp)(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params,
+                                    iotx_cm_sub_entry_t *entry, int count);
+typedef int (*iotx_cm_unsub_fp)(iotx_cm_connection_t *connection, const char *topic);
+typedef int (*iotx_cm_pub_fp)(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params, const char *topic,
+                              const char *payload, unsigned int payload_len);
+typedef int (*iotx_cm_close_fp)(iotx_cm_connection_t *connection);
 
 
-typedef struct iotx_connection_st {
+struct iotx_connection_st {
     int                              fd;
     void                             *open_params;
     void                             *context;
@@ -60,14 +64,19 @@ typedef struct iotx_connection_st {
     iotx_cm_protocol_types_t         protocol_type;
     iotx_cm_connect_fp               connect_func;
     iotx_cm_sub_fp                   sub_func;
+    iotx_cm_sub_multi_fp             sub_multi_func;            /* optional, topics are subscribed one by one without it */
     iotx_cm_unsub_fp                 unsub_func;
     iotx_cm_pub_fp                   pub_func;
     iotx_cm_yield_fp                 yield_func;
     iotx_cm_close_fp                 close_func;
     iotx_cm_event_handle_cb          event_handler;
     void                             *cb_data;
-
-} iotx_cm_connection_t;
+#ifdef DEVICE_MODEL_GATEWAY
+    void                             *yield_thread;             /* each connection is yielded in its own thread */
+    int                              yield_stop;
+    int                              yield_task_leave;
+#endif
+};
 
 #include "iotx_cm_mqtt.h"
 
@@ -1,65 +1,139 @@
 #include "iotx_cm_internal.h"
+#include "dev_sign_api.h"
 
 #if defined(MQTT_COMM_ENABLED) || defined(MAL_ENABLED)
 
-static iotx_cm_connection_t *_mqtt_conncection = NULL;
+/* open_params of MQTT connection */
+typedef struct {
+    iotx_mqtt_param_t               mqtt_param;
+    int                             primary;        /* connected by IOT_MQTT_Construct() with identity of IOT_Ioctl() */
+    iotx_dev_meta_info_t            meta;           /* identity of other connections */
+    iotx_sign_mqtt_t                sign;           /* signed from 'meta', referred by MQTT client while connected */
+    iotx_cm_backlog_cb              rx_backlog;     /* reading pauses while its queue is nearly full */
+    void                           *rx_backlog_ctx;
+} iotx_cm_mqtt_param_t;
+
+static iotx_cm_connection_t *_mqtt_conncection[CM_MAX_FD_NUM] = {NULL};
 static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iotx_mqtt_event_msg_pt msg);
-static int  _mqtt_connect(uint32_t timeout);
-static int _mqtt_publish(iotx_cm_ext_params_t *params, const char *topic, const char *payload,
-                         unsigned int payload_len);
-static int _mqtt_sub(iotx_cm_ext_params_t *params, const char *topic,
+static int  _mqtt_connect(iotx_cm_connection_t *connection, uint32_t timeout);
+static int _mqtt_publish(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params, const char *topic,
+                         const char *payload, unsigned int payload_len);
+static int _mqtt_sub(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *params, const char *topic,
                      iotx_cm_data_handle_cb topic_handle_func, void *pcontext);
+static int _mqtt_sub_multi(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *ext,
+                           iotx_cm_sub_entry_t *entry, int count);
 static iotx_mqtt_qos_t _get_mqtt_qos(iotx_cm_ack_types_t ack_type);
-static int _mqtt_unsub(const char *topic);
-static int _mqtt_close(void);
-static void _set_common_handlers(void);
+static int _mqtt_unsub(iotx_cm_connection_t *connection, const char *topic);
+static int _mqtt_close(iotx_cm_connection_t *connection);
+static void _set_common_handlers(iotx_cm_connection_t *connection);
+
+static iotx_cm_connection_t *_mqtt_primary_connection(void)
+{
+    int idx;
+
+    for (idx = 0; idx < CM_MAX_FD_NUM; idx++) {
+        if (_mqtt_conncection[idx] != NULL &&
+            ((iotx_cm_mqtt_param_t *)_mqtt_conncection[idx]->open_params)->primary) {
+            return _mqtt_conncection[idx];
+        }
+    }
+    return NULL;
+}
+
+/* connection of MQTT client, whose event handler is not given its connection as context */
+static iotx_cm_connection_t *_mqtt_client_connection(void *pclient)
+{
+    int idx;
+
+    for (idx = 0; idx < CM_MAX_FD_NUM; idx++) {
+        if (_mqtt_conncection[idx] != NULL && _mqtt_conncection[idx]->context == pclient) {
+            return _mqtt_conncection[idx];
+        }
+    }
+    return NULL;
+}
+
+/* a shard has no client until it connects, and NULL handle would be taken by MQTT API as the primary client */
+static int _mqtt_connection_ready(iotx_cm_connection_t *connection)
+{
+    if (connection == NULL) {
+        return 0;
+    }
+    return (connection->context != NULL || ((iotx_cm_mqtt_param_t *)connection->open_params)->primary) ? 1 : 0;
+}
 
 iotx_cm_connection_t *iotx_cm_open_mqtt(iotx_cm_init_param_t *params)
 {
+    iotx_cm_connection_t *connection = NULL;
+    iotx_cm_mqtt_param_t *open_param = NULL;
     iotx_mqtt_param_t *mqtt_param = NULL;
+    int slot;
+
+    if (params->shard_meta == NULL) {
+        connection = _mqtt_primary_connection();
+        if (connection != NULL) {
+            iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_INTERNAL_MQTT_DUP_INIT, NULL);
+            return connection;
+        }
+    }
 
-    if (_mqtt_conncection != NULL) {
-        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_INTERNAL_MQTT_DUP_INIT, NULL);
-        return _mqtt_conncection;
+    for (slot = 0; slot < CM_MAX_FD_NUM; slot++) {
+        if (_mqtt_conncection[slot] == NULL) {
+            break;
+        }
+    }
+    if (slot == CM_MAX_FD_NUM) {
+        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_CM_FD_NOT_FOUND, "too many mqtt connections");
+        return NULL;
     }
 
-    _mqtt_conncection = (iotx_cm_connection_t *)cm_malloc(sizeof(iotx_cm_connection_t));
-    if (_mqtt_conncection == NULL) {
+    connection = (iotx_cm_connection_t *)cm_malloc(sizeof(iotx_cm_connection_t));
+    if (connection == NULL) {
         iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
         goto failed;
     }
-    memset(_mqtt_conncection, 0, sizeof(iotx_cm_connection_t));
+    memset(connection, 0, sizeof(iotx_cm_connection_t));
 
-    mqtt_param = (iotx_mqtt_param_t *)cm_malloc(sizeof(iotx_mqtt_param_t));
-    if (mqtt_param == NULL) {
+    open_param = (iotx_cm_mqtt_param_t *)cm_malloc(sizeof(iotx_cm_mqtt_param_t));
+    if (open_param == NULL) {
         iotx_state_event(ITE_STATE_DEV_MODEL, STATE_SYS_DEPEND_MALLOC, NULL);
         goto failed;
     }
-    memset(mqtt_param, 0, sizeof(iotx_mqtt_param_t));
+    memset(open_param, 0, sizeof(iotx_cm_mqtt_param_t));
 
+    mqtt_param = &open_param->mqtt_param;
     mqtt_param->request_timeout_ms = params->request_timeout_ms;
     mqtt_param->clean_session = 0;
     mqtt_param->keepalive_interval_ms = params->keepalive_interval_ms;
     mqtt_param->read_buf_size = params->read_buf_size;
     mqtt_param->write_buf_size = params->write_buf_size;
     mqtt_param->handle_event.h_fp = iotx_cloud_conn_mqtt_event_handle;
-    mqtt_param->handle_event.pcontext = NULL;
+    mqtt_param->handle_event.pcontext = connection;
 
-    _mqtt_conncection->open_params = mqtt_param;
-    _mqtt_conncection->event_handler = params->handle_event;
-    _mqtt_conncection->cb_data = params->context;
-    _set_common_handlers();
+    if (params->shard_meta == NULL) {
+        open_param->primary = 1;
+    } else {
+        memcpy(&open_param->meta, params->shard_meta, sizeof(iotx_dev_meta_info_t));
+    }
+    open_param->rx_backlog = params->rx_backlog;
+    open_param->rx_backlog_ctx = params->context;
 
-    return _mqtt_conncection;
+    connection->open_params = open_param;
+    connection->protocol_type = IOTX_CM_PROTOCOL_TYPE_MQTT;
+    connection->event_handler = params->handle_event;
+    connection->cb_data = params->context;
+    _set_common_handlers(connection);
+    _mqtt_conncection[slot] = connection;
+
+    return connection;
 
 failed:
-    if (_mqtt_conncection != NULL) {
-        cm_free(_mqtt_conncection);
-        _mqtt_conncection = NULL;
+    if (connection != NULL) {
+        cm_free(connection);
     }
 
-    if (mqtt_param != NULL) {
-        cm_free(mqtt_param);
+    if (open_param != NULL) {
+        cm_free(open_param);
     }
 
     return NULL;
@@ -68,7 +142,13 @@ failed:
 static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iotx_mqtt_event_msg_pt msg)
 {
     uintptr_t packet_id = (uintptr_t)msg->msg;
-    if (_mqtt_conncection == NULL) {
+    iotx_cm_connection_t *connection = (iotx_cm_connection_t *)pcontext;
+
+    /* context of received publish is its topic handler instead */
+    if (msg->event_type == IOTX_MQTT_EVENT_PUBLISH_RECEIVED) {
+        connection = _mqtt_client_connection(pclient);
+    }
+    if (connection == NULL) {
         return;
     }
 
@@ -77,8 +157,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             iotx_cm_event_msg_t event;
             event.type = IOTX_CM_EVENT_CLOUD_DISCONNECT;
             event.msg = NULL;
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -88,8 +168,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_CLOUD_CONNECTED;
             event.msg = NULL;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -99,8 +179,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_SUBCRIBE_SUCCESS;
             event.msg = (void *)packet_id;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -111,8 +191,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_SUBCRIBE_FAILED;
             event.msg = (void *)packet_id;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -122,8 +202,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_UNSUB_SUCCESS;
             event.msg = (void *)packet_id;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -134,8 +214,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_UNSUB_FAILED;
             event.msg = (void *)packet_id;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -145,8 +225,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_PUBLISH_SUCCESS;
             event.msg = (void *)packet_id;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -157,8 +237,8 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             event.type = IOTX_CM_EVENT_PUBLISH_FAILED;
             event.msg = (void *)packet_id;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, _mqtt_conncection->cb_data);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, connection->cb_data);
             }
         }
         break;
@@ -181,7 +261,7 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
             memset(topic, 0, topic_info->topic_len + 1);
             memcpy(topic, topic_info->ptopic, topic_info->topic_len);
 
-            topic_handle_func(_mqtt_conncection->fd, topic, topic_info->payload, topic_info->payload_len, NULL);
+            topic_handle_func(connection->fd, topic, topic_info->payload, topic_info->payload_len, NULL);
 
             cm_free(topic);
         }
@@ -197,23 +277,60 @@ static void iotx_cloud_conn_mqtt_event_handle(void *pcontext, void *pclient, iot
 }
 
 extern sdk_impl_ctx_t g_sdk_impl_ctx;
-static int _mqtt_connect(uint32_t timeout)
+
+/* construct MQTT client of connection, other than the primary one it signs its own identity */
+static void *_mqtt_construct(iotx_cm_mqtt_param_t *open_param)
+{
+    iotx_mqtt_region_types_t region = IOTX_CLOUD_REGION_SHANGHAI;
+    iotx_mqtt_param_t mqtt_param;
+
+    if (open_param->primary) {
+        return IOT_MQTT_Construct(&open_param->mqtt_param);
+    }
+
+    IOT_Ioctl(IOTX_IOCTL_GET_REGION, (void *)&region);
+    memset(&open_param->sign, 0, sizeof(iotx_sign_mqtt_t));
+    if (IOT_Sign_MQTT(region, &open_param->meta, &open_param->sign) < STATE_SUCCESS) {
+        iotx_state_event(ITE_STATE_DEV_MODEL, STATE_DEV_MODEL_MQTT_CONNECT_FAILED, "mqtt sign of shard fail");
+        return NULL;
+    }
+
+    memcpy(&mqtt_param, &open_param->mqtt_param, sizeof(iotx_mqtt_param_t));
+    mqtt_param.host = open_param->sign.hostname;
+    if (mqtt_param.port == 0) {
+        mqtt_param.port = open_param->sign.port;
+    }
+    mqtt_param.client_id = open_param->sign.clientid;
+    mqtt_param.username = open_param->sign.username;
+    mqtt_param.password = open_param->sign.password;
+
+    return IOT_MQTT_Construct_Multi(&mqtt_param);
+}
+
+static int _mqtt_connect(iotx_cm_connection_t *connection, uint32_t timeout)
 {
     void *pclient;
     iotx_time_t timer;
     iotx_cm_event_msg_t event;
+    iotx_cm_mqtt_param_t *open_param;
 
     char product_key[IOTX_PRODUCT_KEY_LEN + 1] = {0};
     char device_name[IOTX_DEVICE_NAME_LEN + 1] = {0};
     char device_secret[IOTX_DEVICE_SECRET_LEN + 1] = {0};
 
-    if (_mqtt_conncection == NULL) {
+    if (connection == NULL) {
         return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
     }
+    open_param = (iotx_cm_mqtt_param_t *)connection->open_params;
 
-    IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, product_key);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, device_name);
-    IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_SECRET, device_secret);
+    if (open_param->primary) {
+        IOT_Ioctl(IOTX_IOCTL_GET_PRODUCT_KEY, product_key);
+        IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_NAME, device_name);
+        IOT_Ioctl(IOTX_IOCTL_GET_DEVICE_SECRET, device_secret);
+    } else {
+        memcpy(product_key, open_param->meta.product_key, IOTX_PRODUCT_KEY_LEN);
+        memcpy(device_name, open_param->meta.device_name, IOTX_DEVICE_NAME_LEN);
+    }
 
     if (strlen(product_key) == 0) {
         return STATE_USER_INPUT_PK;
@@ -226,22 +343,25 @@ static int _mqtt_connect(uint32_t timeout)
     utils_time_countdown_ms(&timer, timeout);
 
     if (g_sdk_impl_ctx.mqtt_customzie_info[0] != '\0') {
-        ((iotx_mqtt_param_t *)_mqtt_conncection->open_params)->customize_info = g_sdk_impl_ctx.mqtt_customzie_info;
+        open_param->mqtt_param.customize_info = g_sdk_impl_ctx.mqtt_customzie_info;
     }
     if (g_sdk_impl_ctx.mqtt_port_num != 0) {
-        ((iotx_mqtt_param_t *)_mqtt_conncection->open_params)->port = g_sdk_impl_ctx.mqtt_port_num;
+        open_param->mqtt_param.port = g_sdk_impl_ctx.mqtt_port_num;
     }
 
     do {
-        pclient = IOT_MQTT_Construct((iotx_mqtt_param_t *)_mqtt_conncection->open_params);
+        pclient = _mqtt_construct(open_param);
         if (pclient != NULL) {
             iotx_cm_event_msg_t event;
-            _mqtt_conncection->context = pclient;
+            connection->context = pclient;
+            if (open_param->rx_backlog != NULL) {
+                IOT_MQTT_Set_Backlog_Source(pclient, open_param->rx_backlog, open_param->rx_backlog_ctx);
+            }
             event.type = IOTX_CM_EVENT_CLOUD_CONNECTED;
             event.msg = NULL;
 
-            if (_mqtt_conncection->event_handler) {
-                _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, (void *)_mqtt_conncection);
+            if (connection->event_handler) {
+                connection->event_handler(connection->fd, &event, (void *)connection);
             }
             return STATE_SUCCESS;
         }
@@ -251,37 +371,38 @@ static int _mqtt_connect(uint32_t timeout)
     event.type = IOTX_CM_EVENT_CLOUD_CONNECT_FAILED;
     event.msg = NULL;
 
-    if (_mqtt_conncection->event_handler) {
-        _mqtt_conncection->event_handler(_mqtt_conncection->fd, &event, (void *)_mqtt_conncection);
+    if (connection->event_handler) {
+        connection->event_handler(connection->fd, &event, (void *)connection);
     }
 
     return STATE_DEV_MODEL_MQTT_CONNECT_FAILED;
 }
 
-static int _mqtt_publish(iotx_cm_ext_params_t *ext, const char *topic, const char *payload, unsigned int payload_len)
+static int _mqtt_publish(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *ext, const char *topic,
+                         const char *payload, unsigned int payload_len)
 {
     int qos = 0;
 
-    if (_mqtt_conncection == NULL) {
+    if (!_mqtt_connection_ready(connection)) {
         return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
     }
 
     if (ext != NULL) {
         qos = (int)_get_mqtt_qos(ext->ack_type);
     }
-    return IOT_MQTT_Publish_Simple(_mqtt_conncection->context, topic, qos, (void *)payload, payload_len);
+    return IOT_MQTT_Publish_Simple(connection->context, topic, qos, (void *)payload, payload_len);
 }
 
-static int _mqtt_yield(uint32_t timeout)
+static int _mqtt_yield(iotx_cm_connection_t *connection, uint32_t timeout)
 {
-    if (_mqtt_conncection == NULL) {
+    if (!_mqtt_connection_ready(connection)) {
         return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
     }
 
-    return IOT_MQTT_Yield(_mqtt_conncection->context, timeout);
+    return IOT_MQTT_Yield(connection->context, timeout);
 }
 
-static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
+static int _mqtt_sub(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *ext, const char *topic,
                      iotx_cm_data_handle_cb topic_handle_func, void *pcontext)
 {
     int sync = 0;
@@ -289,7 +410,7 @@ static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
     int timeout = 0;
     int ret;
 
-    if (_mqtt_conncection == NULL) {
+    if (!_mqtt_connection_ready(connection)) {
         return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
     }
 
@@ -304,14 +425,14 @@ static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
     }
 
     if (sync != 0) {
-        ret = IOT_MQTT_Subscribe_Sync(_mqtt_conncection->context,
+        ret = IOT_MQTT_Subscribe_Sync(connection->context,
                                       topic,
                                       qos,
                                       iotx_cloud_conn_mqtt_event_handle,
                                       (void *)topic_handle_func,
                                       timeout);
     } else {
-        ret = IOT_MQTT_Subscribe(_mqtt_conncection->context,
+        ret = IOT_MQTT_Subscribe(connection->context,
                                  topic,
                                  qos,
                                  iotx_cloud_conn_mqtt_event_handle,
@@ -321,25 +442,74 @@ static int _mqtt_sub(iotx_cm_ext_params_t *ext, const char *topic,
     return ret;
 }
 
-static int _mqtt_unsub(const char *topic)
+static int _mqtt_sub_multi(iotx_cm_connection_t *connection, iotx_cm_ext_params_t *ext,
+                           iotx_cm_sub_entry_t *entry, int count)
+{
+    iotx_mqtt_sub_entry_t *mqtt_entry = NULL;
+    int idx, ret, subed = 0;
+
+    if (!_mqtt_connection_ready(connection)) {
+        return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
+    }
+
+    /* only sync subscribe is packed, async one is sent without waiting already */
+    if (ext == NULL || ext->sync_mode == IOTX_CM_ASYNC) {
+        for (idx = 0; idx < count; idx++) {
+            entry[idx].result = _mqtt_sub(connection, ext, entry[idx].topic, entry[idx].topic_handle_func, entry[idx].pcontext);
+            if (entry[idx].result >= 0) {
+                subed++;
+            }
+        }
+        return subed;
+    }
+
+    mqtt_entry = (iotx_mqtt_sub_entry_t *)cm_malloc(count * sizeof(iotx_mqtt_sub_entry_t));
+    if (mqtt_entry == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    memset(mqtt_entry, 0, count * sizeof(iotx_mqtt_sub_entry_t));
+
+    for (idx = 0; idx < count; idx++) {
+        mqtt_entry[idx].topic_filter = entry[idx].topic;
+        mqtt_entry[idx].qos = _get_mqtt_qos(ext->ack_type);
+        mqtt_entry[idx].topic_handle_func = iotx_cloud_conn_mqtt_event_handle;
+        mqtt_entry[idx].pcontext = (void *)entry[idx].topic_handle_func;
+    }
+
+    ret = IOT_MQTT_Subscribe_Multi_Sync(connection->context, mqtt_entry, count, ext->sync_timeout);
+    for (idx = 0; idx < count; idx++) {
+        entry[idx].result = (ret < 0) ? ret : mqtt_entry[idx].result;
+    }
+
+    cm_free(mqtt_entry);
+    return ret;
+}
+
+static int _mqtt_unsub(iotx_cm_connection_t *connection, const char *topic)
 {
-    if (_mqtt_conncection == NULL) {
+    if (!_mqtt_connection_ready(connection)) {
         return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
     }
 
-    return IOT_MQTT_Unsubscribe(_mqtt_conncection->context, topic);
+    return IOT_MQTT_Unsubscribe(connection->context, topic);
 }
 
-static int _mqtt_close()
+static int _mqtt_close(iotx_cm_connection_t *connection)
 {
-    if (_mqtt_conncection == NULL) {
+    int idx;
+
+    if (connection == NULL) {
         return STATE_DEV_MODEL_INTERNAL_MQTT_NOT_INIT_YET;
     }
 
-    cm_free(_mqtt_conncection->open_params);
-    IOT_MQTT_Destroy(&_mqtt_conncection->context);
-    cm_free(_mqtt_conncection);
-    _mqtt_conncection = NULL;
+    IOT_MQTT_Destroy(&connection->context);
+    for (idx = 0; idx < CM_MAX_FD_NUM; idx++) {
+        if (_mqtt_conncection[idx] == connection) {
+            _mqtt_conncection[idx] = NULL;
+        }
+    }
+    cm_free(connection->open_params);
+    cm_free(connection);
     return STATE_SUCCESS;
 }
 
@@ -360,15 +530,16 @@ static iotx_mqtt_qos_t _get_mqtt_qos(iotx_cm_ack_types_t ack_type)
     }
 }
 
-static void _set_common_handlers()
+static void _set_common_handlers(iotx_cm_connection_t *connection)
 {
-    if (_mqtt_conncection != NULL) {
-        _mqtt_conncection->connect_func = _mqtt_connect;
-        _mqtt_conncection->sub_func = _mqtt_sub;
-        _mqtt_conncection->unsub_func = _mqtt_unsub;
-        _mqtt_conncection->pub_func = _mqtt_publish;
-        _mqtt_conncection->yield_func = (iotx_cm_yield_fp)_mqtt_yield;
-        _mqtt_conncection->close_func = _mqtt_close;
+    if (connection != NULL) {
+        connection->connect_func = _mqtt_connect;
+        connection->sub_func = _mqtt_sub;
+        connection->sub_multi_func = _mqtt_sub_multi;
+        connection->unsub_func = _mqtt_unsub;
+        connection->pub_func = _mqtt_publish;
+        connection->yield_func = (iotx_cm_yield_fp)_mqtt_yield;
+        connection->close_func = _mqtt_close;
     }
 }
 #endif
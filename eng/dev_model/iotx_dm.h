@@ -102,6 +102,29 @@ typedef enum {
 
 typedef void (*iotx_dm_event_callback)(iotx_dm_event_types_t type, char *payload);
 
+/* Event handed over without being rendered into JSON, fields 'type' does not use are zero */
+typedef struct {
+    iotx_dm_event_types_t type;
+    int devid;
+    int msgid;                  /* id of reply, or of request timed out */
+    int code;
+    const char *id;             /* id of request, to be echoed in its response */
+    int id_len;
+    const char *identifier;     /* service id or event id */
+    int identifier_len;
+    const char *rrpcid;
+    int rrpcid_len;
+    const char *payload;        /* JSON value, or raw bytes of IOTX_DM_EVENT_MODEL_DOWN_RAW/UP_RAW_REPLY */
+    int payload_len;
+    void *ctx;                  /* context of request, passed back with its response */
+} iotx_dm_event_t;
+
+/*
+ * Strings of 'event' are terminated and valid until callback returns.
+ * Return 0 if event is handled, otherwise it is rendered into JSON and passed to iotx_dm_event_callback.
+ */
+typedef int (*iotx_dm_typed_event_callback)(iotx_dm_event_t *event);
+
 typedef enum {
     IOTX_DM_DEVICE_SECRET_PRODUCT,
     IOTX_DM_DEVICE_SECRET_DEVICE,
@@ -137,6 +160,7 @@ typedef struct {
     iotx_dm_device_secret_types_t secret_type;
     iotx_dm_cloud_domain_types_t domain_type;
     iotx_dm_event_callback event_callback;
+    iotx_dm_typed_event_callback typed_event_callback;  /* optional, typed events are rendered for 'event_callback' without it */
 } iotx_dm_init_params_t;
 
 typedef enum {
@@ -233,6 +257,7 @@ int iotx_dm_subdev_logout(_IN_ int devid);
 int iotx_dm_get_device_type(_IN_ int devid, _OU_ int *type);
 int iotx_dm_get_device_avail_status(_IN_ int devid, _OU_ iotx_dm_dev_avail_t *status);
 int iotx_dm_get_device_status(_IN_ int devid, _OU_ iotx_dm_dev_status_t *status);
+int iotx_dm_shard_gateway_add(_IN_ iotx_dev_meta_info_t *meta);
 #ifdef DEVICE_MODEL_SUBDEV_OTA
     int iotx_dm_send_firmware_version(int devid, const char *firmware_version);
     int iotx_dm_ota_switch_device(_IN_ int devid);
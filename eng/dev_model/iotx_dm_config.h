@@ -31,8 +31,28 @@
     #define CONFIG_DISPATCH_PACKET_MAXCOUNT (0)
 #endif
 
+/* positions of producers and consumer of dispatch queue are kept this far apart */
+#ifndef CONFIG_IPC_CACHE_LINE
+    #define CONFIG_IPC_CACHE_LINE           (64)
+#endif
+
 #ifndef CONFIG_MSGCACHE_QUEUE_MAXLEN
-    #define CONFIG_MSGCACHE_QUEUE_MAXLEN    (50)
+    #define CONFIG_MSGCACHE_QUEUE_MAXLEN    (256)
+#endif
+
+/* slots of msgid index of message cache, a power of two, keep it at least twice of CONFIG_MSGCACHE_QUEUE_MAXLEN */
+#ifndef CONFIG_MSGCACHE_INDEX_LEN
+    #define CONFIG_MSGCACHE_INDEX_LEN       (CONFIG_MSGCACHE_QUEUE_MAXLEN * 2)
+#endif
+
+/* upstream payloads up to this size are written on stack, larger ones into one allocation */
+#ifndef CONFIG_MSG_STACK_PAYLOAD_LEN
+    #define CONFIG_MSG_STACK_PAYLOAD_LEN    (256)
+#endif
+
+/* gateways besides local one whose connections subdevices are spread over */
+#ifndef CONFIG_DM_SHARD_MAX
+    #define CONFIG_DM_SHARD_MAX             (2)
 #endif
 
 #ifndef CONFIG_FOTA_RETRY_INTERNAL_MS
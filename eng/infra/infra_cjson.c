@@ -32,6 +32,19 @@ typedef struct {
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
+/*
+ * Scanning a word at a time, in plain C so that it is the same on every MCU. Words are loaded with
+ * memcpy() as content is not aligned and cores like Cortex-M0 fault on unaligned access.
+ */
+typedef unsigned long lite_word_t;
+
+#define LITE_WORD_ONES              (~(lite_word_t)0 / 0xFF)
+#define LITE_WORD_HIGHS             (LITE_WORD_ONES * 0x80)
+/* non-zero if any byte of 'w' is 0 */
+#define lite_word_has_zero(w)       (((w) - LITE_WORD_ONES) & ~(w) & LITE_WORD_HIGHS)
+/* non-zero if any byte of 'w' is 'c' */
+#define lite_word_has_byte(w, c)    lite_word_has_zero((w) ^ (LITE_WORD_ONES * (unsigned char)(c)))
+
 /* Predeclare these prototypes. */
 static int parse_value(lite_cjson_t *const item, parse_buffer *const input_buffer);
 static int parse_string(lite_cjson_t *const item, parse_buffer *const input_buffer);
@@ -290,6 +303,32 @@ fail:
     return -1;
 }
 
+/* first quote or backslash in [input, input_end), input_end if none */
+static const unsigned char *scan_string_special(const unsigned char *input, const unsigned char *input_end)
+{
+    lite_word_t word, hit;
+
+    while (input_end - input >= (int)sizeof(lite_word_t)) {
+        memcpy(&word, input, sizeof(lite_word_t));
+        hit = lite_word_has_byte(word, '\"') | lite_word_has_byte(word, '\\');
+        if (hit) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+            /* lowest flagged byte is always a real match, false ones can only follow it */
+            return input + (__builtin_ctzl(hit) >> 3);
+#else
+            break;
+#endif
+        }
+        input += sizeof(lite_word_t);
+    }
+
+    while (input < input_end && *input != '\"' && *input != '\\') {
+        input++;
+    }
+
+    return input;
+}
+
 /* Parse the input text into an unescaped cinput, and populate item. */
 static int parse_string(lite_cjson_t *const item, parse_buffer *const input_buffer)
 {
@@ -308,17 +347,20 @@ static int parse_string(lite_cjson_t *const item, parse_buffer *const input_buff
         /* calculate approximate size of the output (overestimate) */
         /* int allocation_length = 0; */
         int skipped_bytes = 0;
-        while (((int)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"')) {
+        const unsigned char *content_end = input_buffer->content + input_buffer->length;
+
+        while (input_end < content_end) {
+            input_end = scan_string_special(input_end, content_end);
+            if (input_end >= content_end || *input_end == '\"') {
+                break;
+            }
             /* is escape sequence */
-            if (input_end[0] == '\\') {
-                if ((int)(input_end + 1 - input_buffer->content) >= input_buffer->length) {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
-                }
-                skipped_bytes++;
-                input_end++;
+            if (input_end + 1 >= content_end) {
+                /* prevent buffer overflow when last input character is a backslash */
+                goto fail;
             }
-            input_end++;
+            skipped_bytes++;
+            input_end += 2;
         }
         if (((int)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"')) {
             /* printf("end error\n"); */
@@ -922,6 +964,504 @@ int lite_cjson_object_item_by_index(lite_cjson_t *lite, int index, lite_cjson_t
     return -1;
 }
 
+/*** lite_cjson tokenizer ***/
+typedef struct {
+    lite_cjson_doc_t *doc;
+    int max_depth;
+} token_state;
+
+static int token_alloc(token_state *const state, int offset, int key_offset, int key_length)
+{
+    lite_cjson_doc_t *doc = state->doc;
+    lite_cjson_token_t *token = NULL;
+
+    if (doc->tokens != NULL) {
+        if (doc->token_cnt >= doc->token_num) {
+            return LITE_CJSON_ERR_TOKEN_FULL;
+        }
+        token = &doc->tokens[doc->token_cnt];
+        memset(token, 0, sizeof(lite_cjson_token_t));
+        token->offset = offset;
+        token->key_offset = key_offset;
+        token->key_length = key_length;
+        token->child = -1;
+        token->next = -1;
+    }
+
+    return doc->token_cnt++;
+}
+
+/* Tokenize value at current offset and its members, return index of its token. */
+static int tokenize_value(token_state *const state, parse_buffer *const input_buffer, int key_offset, int key_length)
+{
+    lite_cjson_doc_t *doc = state->doc;
+    lite_cjson_t key_item, value_item;
+    unsigned char close = 0;
+    int index = 0, child = 0, prev = -1, size = 0;
+    int start_pos = input_buffer->offset;
+
+    if (cannot_access_at_index(input_buffer, 0)) {
+        return -1;
+    }
+
+    if (buffer_at_offset(input_buffer)[0] == '[') {
+        close = ']';
+    } else if (buffer_at_offset(input_buffer)[0] == '{') {
+        close = '}';
+    }
+
+    /* scalars, and containers beyond 'max_depth' which are skipped as a whole */
+    if (close == 0 || (state->max_depth > 0 && input_buffer->depth >= state->max_depth)) {
+        memset(&value_item, 0, sizeof(lite_cjson_t));
+        if (parse_value(&value_item, input_buffer) != 0) {
+            return -1;
+        }
+        index = token_alloc(state, (int)((const unsigned char *)value_item.value - input_buffer->content),
+                            key_offset, key_length);
+        if (index >= 0 && doc->tokens != NULL) {
+            doc->tokens[index].type = value_item.type;
+            doc->tokens[index].length = value_item.value_length;
+            doc->tokens[index].size = value_item.size;
+        }
+        return index;
+    }
+
+    if (input_buffer->depth >= LITE_CJSON_NESTING_LIMIT) {
+        return -1; /* to deeply nested */
+    }
+
+    index = token_alloc(state, start_pos, key_offset, key_length);
+    if (index < 0) {
+        return index;
+    }
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == close)) {
+        goto success; /* empty array or object */
+    }
+
+    do {
+        if (cannot_access_at_index(input_buffer, 0)) {
+            return -1;
+        }
+
+        key_offset = key_length = 0;
+        if (close == '}') {
+            /* parse the name of the child */
+            memset(&key_item, 0, sizeof(lite_cjson_t));
+            if (parse_string(&key_item, input_buffer) != 0) {
+                return -1;
+            }
+            buffer_skip_whitespace(input_buffer);
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':')) {
+                return -1; /* invalid object */
+            }
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+
+            key_offset = (int)((const unsigned char *)key_item.value - input_buffer->content);
+            key_length = key_item.value_length;
+        }
+
+        child = tokenize_value(state, input_buffer, key_offset, key_length);
+        if (child < 0) {
+            return child;
+        }
+        if (doc->tokens != NULL) {
+            if (prev < 0) {
+                doc->tokens[index].child = child;
+            } else {
+                doc->tokens[prev].next = child;
+            }
+        }
+        prev = child;
+        size++;
+
+        buffer_skip_whitespace(input_buffer);
+        if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ',')) {
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+            continue;
+        }
+        break;
+    } while (1);
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != close)) {
+        return -1; /* expected end of array or object */
+    }
+
+success:
+    input_buffer->depth--;
+
+    if (doc->tokens != NULL) {
+        doc->tokens[index].type = (close == '}') ? cJSON_Object : cJSON_Array;
+        doc->tokens[index].length = input_buffer->offset - start_pos + 1;
+        doc->tokens[index].size = size;
+    }
+
+    input_buffer->offset++;
+
+    return index;
+}
+
+int lite_cjson_doc_parse(lite_cjson_doc_t *doc, const char *src, int src_len, int max_depth)
+{
+    int res = 0;
+    parse_buffer buffer;
+    token_state state;
+
+    if (!doc || !src || src_len <= 0 || (doc->tokens != NULL && doc->token_num <= 0)) {
+        return -1;
+    }
+
+    doc->src = src;
+    doc->src_len = src_len;
+    doc->token_cnt = 0;
+
+    memset(&buffer, 0, sizeof(parse_buffer));
+    buffer.content = (const unsigned char *)src;
+    buffer.length = src_len;
+    buffer.offset = 0;
+
+    state.doc = doc;
+    state.max_depth = max_depth;
+
+    res = tokenize_value(&state, buffer_skip_whitespace(skip_utf8_bom(&buffer)), 0, 0);
+    if (res < 0) {
+        doc->token_cnt = 0;
+        return res;
+    }
+
+    return doc->token_cnt;
+}
+
+/* members are walked by sibling link, values of them are never parsed again */
+int lite_cjson_doc_object_item(lite_cjson_doc_t *doc, int parent, const char *key, int key_len)
+{
+    int index = 0;
+    lite_cjson_token_t *token = NULL;
+
+    if (!doc || !doc->tokens || parent < 0 || parent >= doc->token_cnt ||
+        doc->tokens[parent].type != cJSON_Object || !key || key_len <= 0) {
+        return -1;
+    }
+
+    for (index = doc->tokens[parent].child; index >= 0; index = token->next) {
+        token = &doc->tokens[index];
+        if (token->key_length == key_len && memcmp(doc->src + token->key_offset, key, key_len) == 0) {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+int lite_cjson_doc_array_item(lite_cjson_doc_t *doc, int parent, int index)
+{
+    int iter = 0;
+
+    if (!doc || !doc->tokens || parent < 0 || parent >= doc->token_cnt ||
+        doc->tokens[parent].type != cJSON_Array || index < 0 || index >= doc->tokens[parent].size) {
+        return -1;
+    }
+
+    for (iter = doc->tokens[parent].child; iter >= 0 && index > 0; index--) {
+        iter = doc->tokens[iter].next;
+    }
+
+    return iter;
+}
+
+int lite_cjson_doc_item(lite_cjson_doc_t *doc, int token, lite_cjson_t *lite)
+{
+    parse_buffer buffer;
+    lite_cjson_token_t *item = NULL;
+
+    if (!doc || !doc->tokens || token < 0 || token >= doc->token_cnt || !lite) {
+        return -1;
+    }
+    item = &doc->tokens[token];
+
+    memset(lite, 0, sizeof(lite_cjson_t));
+    lite->type = item->type;
+    lite->value = (char *)doc->src + item->offset;
+    lite->value_length = item->length;
+    lite->size = item->size;
+
+    if (item->type == cJSON_Number) {
+        memset(&buffer, 0, sizeof(parse_buffer));
+        buffer.content = (const unsigned char *)lite->value;
+        buffer.length = item->length;
+        buffer.offset = 0;
+        if (parse_number(lite, &buffer) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*** lite_cjson writer ***/
+/* set if 'writer' is inside something which is not valid JSON any more */
+#define WRITER_ERR_FORMAT (-1)
+
+#define writer_level_bit(writer) (1U << ((writer)->depth - 1))
+
+/* bytes beyond 'size' are only counted, so that 'len' tells buffer size needed */
+static void writer_put(lite_cjson_writer_t *writer, const char *data, int len)
+{
+    if (writer->buf != NULL && writer->len + len < writer->size) {
+        memcpy(writer->buf + writer->len, data, len);
+    }
+    writer->len += len;
+}
+
+static void writer_put_char(lite_cjson_writer_t *writer, char c)
+{
+    if (writer->buf != NULL && writer->len + 1 < writer->size) {
+        writer->buf[writer->len] = c;
+    }
+    writer->len++;
+}
+
+/* comma before every member but the first one, none between key and its value */
+static void writer_separate(lite_cjson_writer_t *writer)
+{
+    if (writer->after_key) {
+        writer->after_key = 0;
+        return;
+    }
+    if (writer->depth == 0) {
+        if (writer->len != 0) {
+            writer->error = WRITER_ERR_FORMAT;
+        }
+        return;
+    }
+    if (writer->first & writer_level_bit(writer)) {
+        writer->first &= ~writer_level_bit(writer);
+    } else {
+        writer_put_char(writer, ',');
+    }
+}
+
+static void writer_put_string(lite_cjson_writer_t *writer, const char *str, int len)
+{
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char *input = (const unsigned char *)str;
+    const unsigned char *input_end = input + len;
+    const unsigned char *run = input;
+    char escape[6] = {'\\', 'u', '0', '0', 0, 0};
+
+    writer_put_char(writer, '\"');
+    for (; input < input_end; input++) {
+        if (*input >= 32 && *input != '\"' && *input != '\\') {
+            continue;
+        }
+
+        /* unescaped run is copied at once */
+        writer_put(writer, (const char *)run, input - run);
+        run = input + 1;
+
+        switch (*input) {
+            case '\"':
+            case '\\':
+                escape[1] = *input;
+                break;
+            case '\b':
+                escape[1] = 'b';
+                break;
+            case '\f':
+                escape[1] = 'f';
+                break;
+            case '\n':
+                escape[1] = 'n';
+                break;
+            case '\r':
+                escape[1] = 'r';
+                break;
+            case '\t':
+                escape[1] = 't';
+                break;
+            default:
+                escape[1] = 'u';
+                escape[4] = hex[*input >> 4];
+                escape[5] = hex[*input & 0x0F];
+                writer_put(writer, escape, 6);
+                continue;
+        }
+        writer_put(writer, escape, 2);
+    }
+    writer_put(writer, (const char *)run, input - run);
+    writer_put_char(writer, '\"');
+}
+
+void lite_cjson_writer_init(lite_cjson_writer_t *writer, char *buf, int size)
+{
+    memset(writer, 0, sizeof(lite_cjson_writer_t));
+    writer->buf = buf;
+    writer->size = (buf == NULL) ? 0 : size;
+}
+
+static void writer_begin(lite_cjson_writer_t *writer, char open)
+{
+    writer_separate(writer);
+    if (writer->depth >= LITE_CJSON_WRITER_DEPTH_MAX) {
+        writer->error = WRITER_ERR_FORMAT;
+        return;
+    }
+    writer_put_char(writer, open);
+    writer->depth++;
+    writer->first |= writer_level_bit(writer);
+}
+
+static void writer_end(lite_cjson_writer_t *writer, char close)
+{
+    if (writer->depth == 0 || writer->after_key) {
+        writer->error = WRITER_ERR_FORMAT;
+        return;
+    }
+    writer_put_char(writer, close);
+    writer->depth--;
+}
+
+void lite_cjson_writer_object_begin(lite_cjson_writer_t *writer)
+{
+    writer_begin(writer, '{');
+}
+
+void lite_cjson_writer_object_end(lite_cjson_writer_t *writer)
+{
+    writer_end(writer, '}');
+}
+
+void lite_cjson_writer_array_begin(lite_cjson_writer_t *writer)
+{
+    writer_begin(writer, '[');
+}
+
+void lite_cjson_writer_array_end(lite_cjson_writer_t *writer)
+{
+    writer_end(writer, ']');
+}
+
+void lite_cjson_writer_key(lite_cjson_writer_t *writer, const char *key, int key_len)
+{
+    if (writer->after_key) {
+        writer->error = WRITER_ERR_FORMAT;
+        return;
+    }
+    writer_separate(writer);
+    writer_put_string(writer, key, key_len);
+    writer_put_char(writer, ':');
+    writer->after_key = 1;
+}
+
+void lite_cjson_writer_string(lite_cjson_writer_t *writer, const char *str, int len)
+{
+    writer_separate(writer);
+    writer_put_string(writer, str, len);
+}
+
+void lite_cjson_writer_string_escaped(lite_cjson_writer_t *writer, const char *str, int len)
+{
+    writer_separate(writer);
+    writer_put_char(writer, '\"');
+    writer_put(writer, str, len);
+    writer_put_char(writer, '\"');
+}
+
+void lite_cjson_writer_int(lite_cjson_writer_t *writer, int value)
+{
+    char digits[11];
+    int pos = sizeof(digits);
+    /* negated as unsigned, so that INT_MIN does not overflow */
+    unsigned int magnitude = (value < 0) ? (0U - (unsigned int)value) : (unsigned int)value;
+
+    writer_separate(writer);
+    do {
+        digits[--pos] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        writer_put_char(writer, '-');
+    }
+    writer_put(writer, digits + pos, sizeof(digits) - pos);
+}
+
+#if LITE_CJSON_WRITER_DOUBLE
+void lite_cjson_writer_double(lite_cjson_writer_t *writer, double value)
+{
+    char number[26];
+    int len = 0, idx = 0;
+
+    writer_separate(writer);
+
+    /* NaN and Infinity are not JSON */
+    if ((value * 0) != 0) {
+        writer_put(writer, "null", 4);
+        return;
+    }
+
+    /* 15 digits avoid nonsignificant ones, 17 are needed if the value can not be recovered from them */
+    len = sprintf(number, "%1.15g", value);
+    if (strtod(number, NULL) != value) {
+        len = sprintf(number, "%1.17g", value);
+    }
+    if (len < 0 || len >= (int)sizeof(number)) {
+        writer->error = WRITER_ERR_FORMAT;
+        return;
+    }
+    /* decimal point of locale */
+    for (idx = 0; idx < len; idx++) {
+        if (number[idx] == ',') {
+            number[idx] = '.';
+        }
+    }
+    writer_put(writer, number, len);
+}
+#endif
+
+void lite_cjson_writer_bool(lite_cjson_writer_t *writer, int value)
+{
+    writer_separate(writer);
+    if (value) {
+        writer_put(writer, "true", 4);
+    } else {
+        writer_put(writer, "false", 5);
+    }
+}
+
+void lite_cjson_writer_null(lite_cjson_writer_t *writer)
+{
+    writer_separate(writer);
+    writer_put(writer, "null", 4);
+}
+
+void lite_cjson_writer_raw(lite_cjson_writer_t *writer, const char *json, int len)
+{
+    if (json == NULL || len <= 0) {
+        writer->error = WRITER_ERR_FORMAT;
+        return;
+    }
+    writer_separate(writer);
+    writer_put(writer, json, len);
+}
+
+int lite_cjson_writer_finish(lite_cjson_writer_t *writer)
+{
+    if (writer->error != 0 || writer->depth != 0 || writer->after_key || writer->len == 0) {
+        return -1;
+    }
+    if (writer->len >= writer->size) {
+        return LITE_CJSON_ERR_BUFFER_FULL;
+    }
+
+    writer->buf[writer->len] = '\0';
+    return writer->len;
+}
+
 /*** cjson create, add and print ***/
 #if defined(DEVICE_MODEL_GATEWAY) || defined(ALCS_ENABLED) || defined(DEPRECATED_LINKKIT)
 #define true ((cJSON_bool)1)
@@ -58,6 +58,93 @@ int lite_cjson_object_item_by_index(
             lite_cjson_t *lite_item_key,
             lite_cjson_t *lite_item_value);
 
+/*** lite_cjson tokenizer ***/
+/* lite_cjson_doc_parse() ran out of tokens */
+#define LITE_CJSON_ERR_TOKEN_FULL (-2)
+
+/* One value of document, located by offsets into source. Children of container follow it in token array. */
+typedef struct {
+    int type;
+    int offset;         /* value of string is without quotes, like lite_cjson_t */
+    int length;
+    int key_offset;     /* key of object member, without quotes */
+    int key_length;     /* 0 if not object member */
+    int size;           /* members of array/object */
+    int child;          /* index of first member, -1 if none or not tokenized */
+    int next;           /* index of next sibling, -1 for last one */
+} lite_cjson_token_t;
+
+typedef struct {
+    const char *src;
+    int src_len;
+    lite_cjson_token_t *tokens;     /* set by caller, NULL to only count tokens needed */
+    int token_num;                  /* set by caller */
+    int token_cnt;
+} lite_cjson_doc_t;
+
+/*
+ * Parse document once into 'doc->tokens', root being token 0. Containers nested deeper than 'max_depth'
+ * (0 for no limit) are validated but kept as one token, which is enough for lookup of top level keys.
+ * Return number of tokens, -1 if invalid, LITE_CJSON_ERR_TOKEN_FULL if 'doc->token_num' is too small.
+ */
+int lite_cjson_doc_parse(lite_cjson_doc_t *doc, const char *src, int src_len, int max_depth);
+int lite_cjson_doc_object_item(lite_cjson_doc_t *doc, int parent, const char *key, int key_len);
+int lite_cjson_doc_array_item(lite_cjson_doc_t *doc, int parent, int index);
+/* fill 'lite' as lite_cjson_parse() would for value of 'token', so that other lite_cjson APIs take it */
+int lite_cjson_doc_item(lite_cjson_doc_t *doc, int token, lite_cjson_t *lite);
+
+
+/*** lite_cjson writer ***/
+/* output of lite_cjson writer does not fit in its buffer */
+#define LITE_CJSON_ERR_BUFFER_FULL (-3)
+
+#ifndef LITE_CJSON_WRITER_DEPTH_MAX
+    #define LITE_CJSON_WRITER_DEPTH_MAX 32
+#endif
+
+/* lite_cjson_writer_double(), off by default since it links float formatting of sprintf() */
+#ifndef LITE_CJSON_WRITER_DOUBLE
+    #define LITE_CJSON_WRITER_DOUBLE 0
+#endif
+
+/*
+ * Streaming writer, JSON text goes straight into caller's buffer without any allocation. Values are
+ * escaped and numbers formatted in place, commas are put by writer. Calls do not fail one by one,
+ * lite_cjson_writer_finish() tells whether all of them succeeded.
+ */
+typedef struct {
+    char *buf;              /* NULL to only count length needed */
+    int size;
+    int len;                /* length written, or needed if it exceeds 'size' */
+    int depth;
+    unsigned int first;     /* bit of each level is set until its first member is written */
+    int after_key;
+    int error;
+} lite_cjson_writer_t;
+
+void lite_cjson_writer_init(lite_cjson_writer_t *writer, char *buf, int size);
+void lite_cjson_writer_object_begin(lite_cjson_writer_t *writer);
+void lite_cjson_writer_object_end(lite_cjson_writer_t *writer);
+void lite_cjson_writer_array_begin(lite_cjson_writer_t *writer);
+void lite_cjson_writer_array_end(lite_cjson_writer_t *writer);
+void lite_cjson_writer_key(lite_cjson_writer_t *writer, const char *key, int key_len);
+void lite_cjson_writer_string(lite_cjson_writer_t *writer, const char *str, int len);
+/* 'str' is escaped already, such as string value parsed by lite_cjson, it is put between quotes as it is */
+void lite_cjson_writer_string_escaped(lite_cjson_writer_t *writer, const char *str, int len);
+void lite_cjson_writer_int(lite_cjson_writer_t *writer, int value);
+#if LITE_CJSON_WRITER_DOUBLE
+void lite_cjson_writer_double(lite_cjson_writer_t *writer, double value);
+#endif
+void lite_cjson_writer_bool(lite_cjson_writer_t *writer, int value);
+void lite_cjson_writer_null(lite_cjson_writer_t *writer);
+/* 'json' is put as it is, it has to be one valid JSON value */
+void lite_cjson_writer_raw(lite_cjson_writer_t *writer, const char *json, int len);
+/*
+ * Terminate text with '\0' and return its length, -1 if calls did not make one JSON value, or
+ * LITE_CJSON_ERR_BUFFER_FULL if buffer was too small, 'writer->len' + 1 bytes being needed then.
+ */
+int lite_cjson_writer_finish(lite_cjson_writer_t *writer);
+
 
 /*** lite_cjson create, add and print ***/
 typedef int cJSON_bool;
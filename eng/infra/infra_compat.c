@@ -270,6 +270,10 @@ int IOT_Ioctl(int option, void *data)
             res = iot_linkkit_subdev_query_id(dev_info->product_key, dev_info->device_name);
         }
         break;
+        case IOTX_IOCTL_ADD_SHARD_GATEWAY: {
+            res = iotx_dm_shard_gateway_add((iotx_dev_meta_info_t *)data);
+        }
+        break;
 #endif
 #if defined(WIFI_PROVISION_ENABLED)
         case IOTX_IOCTL_SET_AWSS_ENABLE_INTERVAL: {
@@ -195,7 +195,8 @@ typedef enum {
     IOTX_IOCTL_SET_DEVICE_NAME,         /* vale(char *) - set device name */
     IOTX_IOCTL_GET_DEVICE_NAME,         /* vale(char[IOTX_DEVICE_NAME_LEN + 1]) - get device name */
     IOTX_IOCTL_SET_DEVICE_SECRET,       /* vale(char *) - set device secret */
-    IOTX_IOCTL_GET_DEVICE_SECRET        /* vale(char[IOTX_DEVICE_SECRET_LEN + 1]) - get device secret */
+    IOTX_IOCTL_GET_DEVICE_SECRET,       /* vale(char[IOTX_DEVICE_SECRET_LEN + 1]) - get device secret */
+    IOTX_IOCTL_ADD_SHARD_GATEWAY        /* value(iotx_dev_meta_info_t*): only for gateway, one more gateway whose connection carries part of subdevices, set before IOT_Linkkit_Connect */
 } iotx_ioctl_option_t;
 
 typedef enum {
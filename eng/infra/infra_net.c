@@ -43,6 +43,34 @@ static int write_ssl(utils_network_pt pNetwork, const char *buffer, uint32_t len
     return AT_SSL_Write((uintptr_t)pNetwork->handle, buffer, len, timeout_ms);
 }
 
+static int writev_ssl(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    int idx = 0, rc = 0, sent = 0;
+
+    for (idx = 0; idx < iovcnt; idx++) {
+        rc = write_ssl(pNetwork, (const char *)iov[idx].base, iov[idx].len, timeout_ms);
+        if (rc < 0) {
+            return (sent > 0) ? sent : rc;
+        }
+        sent += rc;
+        if (rc < iov[idx].len) {
+            break;
+        }
+    }
+
+    return sent;
+}
+
+static int pending_ssl(utils_network_pt pNetwork)
+{
+    return 0;
+}
+
+static int wait_ssl(utils_network_pt pNetwork, void *sem, uint32_t timeout_ms)
+{
+    return 1;
+}
+
 static int disconnect_ssl(utils_network_pt pNetwork)
 {
     if (NULL == pNetwork) {
@@ -110,6 +138,33 @@ static int write_ssl(utils_network_pt pNetwork, const char *buffer, uint32_t len
     return HAL_SSL_Write((uintptr_t)pNetwork->handle, buffer, len, timeout_ms);
 }
 
+static int writev_ssl(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    if (NULL == pNetwork) {
+        return STATE_SYS_DEPEND_NWK_INVALID_HANDLE;
+    }
+
+    return HAL_SSL_Writev((uintptr_t)pNetwork->handle, iov, iovcnt, timeout_ms);
+}
+
+static int pending_ssl(utils_network_pt pNetwork)
+{
+    if (NULL == pNetwork) {
+        return STATE_SYS_DEPEND_NWK_INVALID_HANDLE;
+    }
+
+    return HAL_SSL_Pending((uintptr_t)pNetwork->handle);
+}
+
+static int wait_ssl(utils_network_pt pNetwork, void *sem, uint32_t timeout_ms)
+{
+    if (NULL == pNetwork) {
+        return STATE_SYS_DEPEND_NWK_INVALID_HANDLE;
+    }
+
+    return HAL_SSL_WaitReadable((uintptr_t)pNetwork->handle, sem, timeout_ms);
+}
+
 static int disconnect_ssl(utils_network_pt pNetwork)
 {
     if (NULL == pNetwork) {
@@ -168,6 +223,34 @@ static int write_tcp(utils_network_pt pNetwork, const char *buffer, uint32_t len
     return AT_TCP_Write(pNetwork->handle, buffer, len, timeout_ms);
 }
 
+static int writev_tcp(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    int idx = 0, rc = 0, sent = 0;
+
+    for (idx = 0; idx < iovcnt; idx++) {
+        rc = write_tcp(pNetwork, (const char *)iov[idx].base, iov[idx].len, timeout_ms);
+        if (rc < 0) {
+            return (sent > 0) ? sent : rc;
+        }
+        sent += rc;
+        if (rc < iov[idx].len) {
+            break;
+        }
+    }
+
+    return sent;
+}
+
+static int pending_tcp(utils_network_pt pNetwork)
+{
+    return 0;
+}
+
+static int wait_tcp(utils_network_pt pNetwork, void *sem, uint32_t timeout_ms)
+{
+    return 1;
+}
+
 static int disconnect_tcp(utils_network_pt pNetwork)
 {
     if (pNetwork->handle == (uintptr_t)(-1)) {
@@ -206,6 +289,21 @@ static int write_tcp(utils_network_pt pNetwork, const char *buffer, uint32_t len
     return HAL_TCP_Write(pNetwork->handle, buffer, len, timeout_ms);
 }
 
+static int writev_tcp(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    return HAL_TCP_Writev(pNetwork->handle, iov, iovcnt, timeout_ms);
+}
+
+static int pending_tcp(utils_network_pt pNetwork)
+{
+    return 0;
+}
+
+static int wait_tcp(utils_network_pt pNetwork, void *sem, uint32_t timeout_ms)
+{
+    return HAL_TCP_WaitReadable(pNetwork->handle, sem, timeout_ms);
+}
+
 static int disconnect_tcp(utils_network_pt pNetwork)
 {
     if (pNetwork->handle == (uintptr_t)(-1)) {
@@ -257,6 +355,42 @@ int utils_net_write(utils_network_pt pNetwork, const char *buffer, uint32_t len,
     return ret;
 }
 
+int utils_net_writev(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    int ret = 0;
+#if defined(SUPPORT_TLS)
+    ret = writev_ssl(pNetwork, iov, iovcnt, timeout_ms);
+#else
+    ret = writev_tcp(pNetwork, iov, iovcnt, timeout_ms);
+#endif
+
+    return ret;
+}
+
+int utils_net_pending(utils_network_pt pNetwork)
+{
+    int ret = 0;
+#if defined(SUPPORT_TLS)
+    ret = pending_ssl(pNetwork);
+#else
+    ret = pending_tcp(pNetwork);
+#endif
+
+    return ret;
+}
+
+int utils_net_wait(utils_network_pt pNetwork, void *sem, uint32_t timeout_ms)
+{
+    int ret = 0;
+#if defined(SUPPORT_TLS)
+    ret = wait_ssl(pNetwork, sem, timeout_ms);
+#else
+    ret = wait_tcp(pNetwork, sem, timeout_ms);
+#endif
+
+    return ret;
+}
+
 int iotx_net_disconnect(utils_network_pt pNetwork)
 {
     int ret = 0;
@@ -299,6 +433,9 @@ int iotx_net_init(utils_network_pt pNetwork, const char *host, uint16_t port, co
     pNetwork->handle = 0;
     pNetwork->read = utils_net_read;
     pNetwork->write = utils_net_write;
+    pNetwork->writev = utils_net_writev;
+    pNetwork->pending = utils_net_pending;
+    pNetwork->wait = utils_net_wait;
     pNetwork->disconnect = iotx_net_disconnect;
     pNetwork->connect = iotx_net_connect;
 
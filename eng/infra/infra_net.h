@@ -6,6 +6,7 @@
 #define _INFRA_NET_H_
 
 #include "infra_types.h"
+#include "wrappers_defs.h"
 
 /**
  * @brief The structure of network connection(TCP or SSL).
@@ -33,6 +34,15 @@ struct utils_network {
     /**< Send data to server function pointer. */
     int (*write)(utils_network_pt, const char *, uint32_t, uint32_t);
 
+    /**< Send several buffers to server in one write function pointer. */
+    int (*writev)(utils_network_pt, const hal_iovec_t *, int, uint32_t);
+
+    /**< Bytes which can be read at once without blocking function pointer. */
+    int (*pending)(utils_network_pt);
+
+    /**< Wait until data may be readable or wakeup semaphore is posted function pointer. */
+    int (*wait)(utils_network_pt, void *, uint32_t);
+
     /**< Disconnect the network */
     int (*disconnect)(utils_network_pt);
 
@@ -42,6 +52,9 @@ struct utils_network {
 
 int utils_net_read(utils_network_pt pNetwork, char *buffer, uint32_t len, uint32_t timeout_ms);
 int utils_net_write(utils_network_pt pNetwork, const char *buffer, uint32_t len, uint32_t timeout_ms);
+int utils_net_writev(utils_network_pt pNetwork, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms);
+int utils_net_pending(utils_network_pt pNetwork);
+int utils_net_wait(utils_network_pt pNetwork, void *sem, uint32_t timeout_ms);
 int iotx_net_disconnect(utils_network_pt pNetwork);
 int iotx_net_connect(utils_network_pt pNetwork);
 int iotx_net_init(utils_network_pt pNetwork, const char *host, uint16_t port, const char *ca_crt);
@@ -128,6 +128,9 @@ extern "C" {
 /* SDK run into exception when invoking HAL_Firmware_Persistence_Write() */
 /* SDK调用的系统适配接口 HAL_Firmware_Persistence_Write() 返回异常, 未能成功将固件写入ROM */
 #define STATE_SYS_DEPEND_FIRMWAIRE_WIRTE            (STATE_SYS_DEPEND_BASE - 0x000F)
+/* SDK run into exception when invoking HAL_ThreadCreate() */
+/* SDK调用的系统适配接口 HAL_ThreadCreate() 返回异常, 未能成功创建线程 */
+#define STATE_SYS_DEPEND_THREAD_CREATE              (STATE_SYS_DEPEND_BASE - 0x0010)
 
 /* System: 0x0200 ~ 0x02FF */
 
@@ -257,6 +260,18 @@ extern "C" {
 /* Report publish relative parameters such as topic string */
 /* MQTT发布上报的过程中, 上报发布相关参数如Topic等 */
 #define STATE_MQTT_PUB_INFO                         (STATE_MQTT_BASE - 0x0029)
+/* Too many MQTT publish submitted and not sent yet */
+/* 已提交但尚未发出的MQTT上报消息过多, 提交队列已满, 请稍后重试 */
+#define STATE_MQTT_SUBMIT_QUEUE_FULL                (STATE_MQTT_BASE - 0x002A)
+/* MQTT subscribe request refused by server in SUBACK */
+/* MQTT订阅请求被服务端在SUBACK中拒绝, 请检查Topic及其权限 */
+#define STATE_MQTT_SUB_REFUSED                      (STATE_MQTT_BASE - 0x002B)
+/* MQTT message received is dropped since too many ones wait for dispatch worker, QoS1 one is resent after reconnected if session is kept */
+/* 等待分发线程处理的MQTT下行消息过多, 新收到的消息被丢弃, 保持会话时QoS1消息断线重连后由服务端重发, 请检查消息回调是否耗时过长 */
+#define STATE_MQTT_DISPATCH_QUEUE_FULL              (STATE_MQTT_BASE - 0x002C)
+/* Too many MQTT publish held back by rate limit and not sent yet */
+/* 超出上报速率限制而排队等待发送的MQTT上报消息过多, 队列已满, 请降低上报频率 */
+#define STATE_MQTT_RATE_QUEUE_FULL                  (STATE_MQTT_BASE - 0x002D)
 
 /* MQTT: 0x0300 ~ 0x03FF */
 
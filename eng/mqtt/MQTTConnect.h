@@ -39,6 +39,8 @@
 #define MQTT_CONN_FLAG_WILL_FLAG        (0x04)
 #define MQTT_CONN_FLAG_CLEAN_SESSION    (0x02)
 
+#define MQTT_CONNACK_FLAG_SESSION_PRESENT   (0x01)
+
 typedef union {
     unsigned char all;  /**< all connect flags */
 } MQTTConnectFlags; /**< connect flags byte */
@@ -76,7 +78,7 @@ typedef struct {
     char struct_id[4];
     /** The version number of this structure.  Must be 0 */
     int struct_version;
-    /** Version of MQTT to be used.  3 = 3.1 4 = 3.1.1
+    /** Version of MQTT to be used.  3 = 3.1 4 = 3.1.1 5 = 5.0
       */
     unsigned char MQTTVersion;
     MQTTString clientID;
@@ -107,12 +109,17 @@ typedef union {
         MQTTPacket_willOptions_initializer, {NULL, {0, NULL}}, {NULL, {0, NULL}} }
 
 DLLExport int MQTTSerialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData *options);
+DLLExport int MQTTV5Serialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData *options,
+                                      MQTTProperties *props);
+DLLExport int MQTTV5Serialize_connectLength(MQTTPacket_connectData *options, MQTTProperties *props);
 DLLExport int MQTTDeserialize_connect(MQTTPacket_connectData *data, unsigned char *buf, int len);
 
 DLLExport int MQTTSerialize_connack(unsigned char *buf, int buflen, unsigned char connack_rc,
                                     unsigned char sessionPresent);
 DLLExport int MQTTDeserialize_connack(unsigned char *sessionPresent, unsigned char *connack_rc, unsigned char *buf,
                                       int buflen);
+DLLExport int MQTTV5Deserialize_connack(unsigned char *sessionPresent, unsigned char *reasonCode, MQTTProperties *props,
+                                        unsigned char *buf, int buflen);
 
 DLLExport int MQTTSerialize_disconnect(unsigned char *buf, int buflen);
 DLLExport int MQTTSerialize_pingreq(unsigned char *buf, int buflen);
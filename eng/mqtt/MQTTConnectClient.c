@@ -12,6 +12,18 @@
   * @return the length of buffer needed to contain the serialized version of the packet
   */
 int MQTTSerialize_connectLength(MQTTPacket_connectData *options)
+{
+    return MQTTV5Serialize_connectLength(options, NULL);
+}
+
+
+/**
+  * Determines the length of the MQTT connect packet that would be produced using the supplied connect options.
+  * @param options the options to be used to build the connect packet
+  * @param props the MQTT 5.0 connect properties, only used if options->MQTTVersion is 5
+  * @return the length of buffer needed to contain the serialized version of the packet
+  */
+int MQTTV5Serialize_connectLength(MQTTPacket_connectData *options, MQTTProperties *props)
 {
     int len = 0;
 
@@ -20,11 +32,16 @@ int MQTTSerialize_connectLength(MQTTPacket_connectData *options)
         len = 12;    /* variable depending on MQTT or MQIsdp */
     } else if (options->MQTTVersion == 4) {
         len = 10;
+    } else if (options->MQTTVersion == 5) {
+        len = 10 + MQTTProperties_len(props);
     }
 
     len += MQTTstrlen(options->clientID) + 2;
     if (options->willFlag) {
         len += MQTTstrlen(options->will.topicName) + 2 + MQTTstrlen(options->will.message) + 2;
+        if (options->MQTTVersion == 5) {
+            len += MQTTProperties_len(NULL);    /* will properties */
+        }
     }
     if (options->username.cstring || options->username.lenstring.data) {
         len += MQTTstrlen(options->username) + 2;
@@ -45,6 +62,20 @@ int MQTTSerialize_connectLength(MQTTPacket_connectData *options)
   * @return serialized length, or error if 0
   */
 int MQTTSerialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData *options)
+{
+    return MQTTV5Serialize_connect(buf, buflen, options, NULL);
+}
+
+
+/**
+  * Serializes the connect options into the buffer.
+  * @param buf the buffer into which the packet will be serialized
+  * @param len the length in bytes of the supplied buffer
+  * @param options the options to be used to build the connect packet
+  * @param props the MQTT 5.0 connect properties, only used if options->MQTTVersion is 5
+  * @return serialized length, or error if 0
+  */
+int MQTTV5Serialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData *options, MQTTProperties *props)
 {
     unsigned char *ptr = buf;
     MQTTHeader header = {0};
@@ -52,7 +83,7 @@ int MQTTSerialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData
     int len = 0;
     int rc = -1;
 
-    if (MQTTPacket_len(len = MQTTSerialize_connectLength(options)) > buflen) {
+    if (MQTTPacket_len(len = MQTTV5Serialize_connectLength(options, props)) > buflen) {
         rc = MQTTPACKET_BUFFER_TOO_SHORT;
         goto exit;
     }
@@ -64,9 +95,9 @@ int MQTTSerialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData
 
     ptr += MQTTPacket_encode(ptr, len); /* write remaining length */
 
-    if (options->MQTTVersion == 4) {
+    if (options->MQTTVersion == 4 || options->MQTTVersion == 5) {
         writeCString(&ptr, "MQTT");
-        writeChar(&ptr, (char) 4);
+        writeChar(&ptr, (char) options->MQTTVersion);
     } else {
         writeCString(&ptr, "MQIsdp");
         writeChar(&ptr, (char) 3);
@@ -89,8 +120,14 @@ int MQTTSerialize_connect(unsigned char *buf, int buflen, MQTTPacket_connectData
 
     writeChar(&ptr, flags.all);
     writeInt(&ptr, options->keepAliveInterval);
+    if (options->MQTTVersion == 5) {
+        MQTTProperties_write(&ptr, props);
+    }
     writeMQTTString(&ptr, options->clientID);
     if (options->willFlag) {
+        if (options->MQTTVersion == 5) {
+            MQTTProperties_write(&ptr, NULL);
+        }
         writeMQTTString(&ptr, options->will.topicName);
         writeMQTTString(&ptr, options->will.message);
     }
@@ -137,7 +174,7 @@ int MQTTDeserialize_connack(unsigned char *sessionPresent, unsigned char *connac
     }
 
     flags.all = readChar(&curdata);
-    *sessionPresent = flags.bits.sessionpresent;
+    *sessionPresent = (flags.all & MQTT_CONNACK_FLAG_SESSION_PRESENT) ? 1 : 0;
     *connack_rc = readChar(&curdata);
 
     rc = 1;
@@ -146,6 +183,54 @@ exit:
 }
 
 
+/**
+  * Deserializes the supplied (wire) buffer into MQTT 5.0 connack data
+  * @param sessionPresent the session present flag returned
+  * @param reasonCode returned integer value of the connack reason code
+  * @param props returned connack properties, all 0 if absent
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param len the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_connack(unsigned char *sessionPresent, unsigned char *reasonCode, MQTTProperties *props,
+                              unsigned char *buf, int buflen)
+{
+    MQTTHeader header = {0};
+    unsigned char *curdata = buf;
+    unsigned char *enddata = NULL;
+    int rc = 0;
+    int mylen;
+    MQTTConnackFlags flags = {0};
+
+    memset(props, 0, sizeof(MQTTProperties));
+
+    header.byte = readChar(&curdata);
+    if (MQTT_HEADER_GET_TYPE(header.byte) != CONNACK) {
+        goto exit;
+    }
+
+    curdata += (rc = MQTTPacket_decodeBuf(curdata, &mylen)); /* read remaining length */
+    rc = 0;
+    enddata = curdata + mylen;
+    if (enddata - curdata < 2) {
+        goto exit;
+    }
+
+    flags.all = readChar(&curdata);
+    *sessionPresent = (flags.all & MQTT_CONNACK_FLAG_SESSION_PRESENT) ? 1 : 0;
+    *reasonCode = readChar(&curdata);
+
+    /* properties may be left out by a server answering with a 3.1.1 connack */
+    if (curdata < enddata && !MQTTProperties_read(props, &curdata, enddata)) {
+        goto exit;
+    }
+
+    rc = 1;
+exit:
+    return rc;
+}
+
+
 /**
   * Serializes a 0-length packet into the supplied buffer, ready for writing to a socket
   * @param buf the buffer into which the packet will be serialized
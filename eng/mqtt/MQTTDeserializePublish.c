@@ -23,6 +23,28 @@
 int MQTTDeserialize_publish(unsigned char *dup, int *qos, unsigned char *retained, unsigned short *packetid,
                             MQTTString *topicName,
                             unsigned char **payload, int *payloadlen, unsigned char *buf, int buflen)
+{
+    return MQTTV5Deserialize_publish(dup, qos, retained, packetid, topicName, NULL, payload, payloadlen, buf, buflen);
+}
+
+
+/**
+  * Deserializes the supplied (wire) buffer into publish data
+  * @param dup returned integer - the MQTT dup flag
+  * @param qos returned integer - the MQTT QoS value
+  * @param retained returned integer - the MQTT retained flag
+  * @param packetid returned integer - the MQTT packet identifier
+  * @param topicName returned MQTTString - the MQTT topic in the publish, empty if props->topicAlias is used
+  * @param props returned MQTTProperties - the MQTT 5.0 publish properties, NULL for MQTT 3.1.1
+  * @param payload returned byte buffer - the MQTT publish payload
+  * @param payloadlen returned integer - the length of the MQTT payload
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param buflen the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success
+  */
+int MQTTV5Deserialize_publish(unsigned char *dup, int *qos, unsigned char *retained, unsigned short *packetid,
+                              MQTTString *topicName, MQTTProperties *props,
+                              unsigned char **payload, int *payloadlen, unsigned char *buf, int buflen)
 {
     MQTTHeader header = {0};
     unsigned char *curdata = buf;
@@ -50,6 +72,11 @@ int MQTTDeserialize_publish(unsigned char *dup, int *qos, unsigned char *retaine
         *packetid = readInt(&curdata);
     }
 
+    if (props != NULL && !MQTTProperties_read(props, &curdata, enddata)) {
+        rc = 0;
+        goto exit;
+    }
+
     *payloadlen = enddata - curdata;
     *payload = curdata;
     rc = 1;
@@ -260,4 +260,159 @@ int MQTTPacket_equals(MQTTString *a, char *bptr)
 }
 
 
+/**
+ * Determines the length of MQTT 5.0 properties, including the property length field itself
+ * @param props the properties to be written, NULL for an empty property list
+ * @return the length of buffer needed to contain the serialized properties
+ */
+int MQTTProperties_len(MQTTProperties *props)
+{
+    int len = 0;
+
+    if (props != NULL) {
+        if (props->topicAliasMaximum) {
+            len += 3;   /* identifier + two byte integer */
+        }
+        if (props->topicAlias) {
+            len += 3;
+        }
+        if (props->sessionExpiryInterval) {
+            len += 5;   /* identifier + four byte integer */
+        }
+    }
+    /* properties written here are always shorter than 128 bytes, so the length takes one byte */
+    return len + 1;
+}
+
 
+/**
+ * Writes MQTT 5.0 properties, preceded by their length, to an output buffer.
+ * @param pptr pointer to the output buffer - incremented by the number of bytes used & returned
+ * @param props the properties to be written, NULL for an empty property list
+ */
+void MQTTProperties_write(unsigned char **pptr, MQTTProperties *props)
+{
+    *pptr += MQTTPacket_encode(*pptr, MQTTProperties_len(props) - 1);
+
+    if (props == NULL) {
+        return;
+    }
+    if (props->topicAliasMaximum) {
+        writeChar(pptr, MQTT_PROP_TOPIC_ALIAS_MAXIMUM);
+        writeInt(pptr, props->topicAliasMaximum);
+    }
+    if (props->topicAlias) {
+        writeChar(pptr, MQTT_PROP_TOPIC_ALIAS);
+        writeInt(pptr, props->topicAlias);
+    }
+    if (props->sessionExpiryInterval) {
+        writeChar(pptr, MQTT_PROP_SESSION_EXPIRY_INTERVAL);
+        writeInt(pptr, (int)(props->sessionExpiryInterval >> 16));
+        writeInt(pptr, (int)(props->sessionExpiryInterval & 0xFFFF));
+    }
+}
+
+
+/* decodes a variable byte integer without reading beyond enddata, returns 1 if successful */
+static int MQTTProperties_readVarInt(int *value, unsigned char **pptr, unsigned char *enddata)
+{
+    int multiplier = 1;
+    int len = 0;
+    unsigned char c;
+
+    *value = 0;
+    do {
+        if (++len > MAX_NO_OF_REMAINING_LENGTH_BYTES || *pptr >= enddata) {
+            return 0;
+        }
+        c = (unsigned char)readChar(pptr);
+        *value += (c & 127) * multiplier;
+        multiplier *= 128;
+    } while ((c & 128) != 0);
+
+    return 1;
+}
+
+
+/**
+ * Reads MQTT 5.0 properties, preceded by their length, from the input buffer.
+ * Properties not in MQTTProperties are skipped.
+ * @param props the properties read, fields of absent properties are set to 0
+ * @param pptr pointer to the input buffer - incremented by the number of bytes used & returned
+ * @param enddata pointer to the end of the data: do not read beyond
+ * @return 1 if successful, 0 if not
+ */
+int MQTTProperties_read(MQTTProperties *props, unsigned char **pptr, unsigned char *enddata)
+{
+    unsigned char *propend = NULL;
+    unsigned char id = 0;
+    int len = 0;
+    int skip = 0;
+
+    memset(props, 0, sizeof(MQTTProperties));
+
+    if (!MQTTProperties_readVarInt(&len, pptr, enddata) || enddata - *pptr < len) {
+        return 0;
+    }
+    propend = *pptr + len;
+
+    while (*pptr < propend) {
+        id = (unsigned char)readChar(pptr);
+        switch (id) {
+            case 0x01: case 0x17: case 0x19: case 0x24:
+            case 0x25: case 0x28: case 0x29: case 0x2A:
+                skip = 1;   /* byte */
+                break;
+            case 0x13: case 0x21:
+                skip = 2;   /* two byte integer */
+                break;
+            case MQTT_PROP_TOPIC_ALIAS_MAXIMUM:
+            case MQTT_PROP_TOPIC_ALIAS:
+                if (propend - *pptr < 2) {
+                    return 0;
+                }
+                if (id == MQTT_PROP_TOPIC_ALIAS_MAXIMUM) {
+                    props->topicAliasMaximum = readInt(pptr);
+                } else {
+                    props->topicAlias = readInt(pptr);
+                }
+                skip = 0;
+                break;
+            case 0x02: case 0x11: case 0x18: case 0x27:
+                skip = 4;   /* four byte integer */
+                break;
+            case 0x0B:
+                if (!MQTTProperties_readVarInt(&skip, pptr, propend)) {
+                    return 0;
+                }
+                skip = 0;   /* variable byte integer */
+                break;
+            case 0x03: case 0x08: case 0x09: case 0x12: case 0x15:
+            case 0x16: case 0x1A: case 0x1C: case 0x1F:
+                if (propend - *pptr < 2) {
+                    return 0;
+                }
+                skip = readInt(pptr);   /* UTF-8 string or binary data */
+                break;
+            case 0x26:
+                if (propend - *pptr < 2) {
+                    return 0;
+                }
+                skip = readInt(pptr);   /* UTF-8 string pair */
+                if (propend - *pptr < skip + 2) {
+                    return 0;
+                }
+                *pptr += skip;
+                skip = readInt(pptr);
+                break;
+            default:
+                return 0;
+        }
+        if (propend - *pptr < skip) {
+            return 0;
+        }
+        *pptr += skip;
+    }
+
+    return 1;
+}
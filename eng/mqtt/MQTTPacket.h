@@ -71,6 +71,26 @@ typedef struct {
 
 int MQTTstrlen(MQTTString mqttstring);
 
+/* MQTT 5.0 property identifiers used by this client, others are skipped when read */
+#define MQTT_PROP_SESSION_EXPIRY_INTERVAL       (0x11)
+#define MQTT_PROP_TOPIC_ALIAS_MAXIMUM           (0x22)
+#define MQTT_PROP_TOPIC_ALIAS                   (0x23)
+
+/**
+ * MQTT 5.0 properties of a packet, fields which are 0 are not written
+ */
+typedef struct {
+    unsigned short topicAliasMaximum;   /**< Topic Alias Maximum of CONNECT and CONNACK */
+    unsigned short topicAlias;          /**< Topic Alias of PUBLISH */
+    unsigned int sessionExpiryInterval; /**< Session Expiry Interval of CONNECT in seconds, not read */
+} MQTTProperties;
+
+#define MQTTProperties_initializer {0, 0, 0}
+
+int MQTTProperties_len(MQTTProperties *props);
+void MQTTProperties_write(unsigned char **pptr, MQTTProperties *props);
+int MQTTProperties_read(MQTTProperties *props, unsigned char **pptr, unsigned char *enddata);
+
 #include "MQTTConnect.h"
 #include "MQTTPublish.h"
 #include "MQTTSubscribe.h"
@@ -16,10 +16,28 @@ DLLExport int MQTTSerialize_publish(unsigned char *buf, int buflen, unsigned cha
                                     unsigned short packetid,
                                     MQTTString topicName, unsigned char *payload, int payloadlen);
 
+DLLExport int MQTTSerialize_publishHeader(unsigned char *buf, int buflen, unsigned char dup, int qos,
+                                          unsigned char retained, unsigned short packetid,
+                                          MQTTString topicName, int payloadlen);
+
 DLLExport int MQTTDeserialize_publish(unsigned char *dup, int *qos, unsigned char *retained, unsigned short *packetid,
                                       MQTTString *topicName,
                                       unsigned char **payload, int *payloadlen, unsigned char *buf, int len);
 
+DLLExport int MQTTV5Serialize_publish(unsigned char *buf, int buflen, unsigned char dup, int qos,
+                                      unsigned char retained, unsigned short packetid,
+                                      MQTTString topicName, MQTTProperties *props, unsigned char *payload, int payloadlen);
+
+DLLExport int MQTTV5Serialize_publishHeader(unsigned char *buf, int buflen, unsigned char dup, int qos,
+                                            unsigned char retained, unsigned short packetid,
+                                            MQTTString topicName, MQTTProperties *props, int payloadlen);
+
+DLLExport int MQTTV5Serialize_publishLength(int qos, MQTTString topicName, MQTTProperties *props, int payloadlen);
+
+DLLExport int MQTTV5Deserialize_publish(unsigned char *dup, int *qos, unsigned char *retained, unsigned short *packetid,
+                                        MQTTString *topicName, MQTTProperties *props,
+                                        unsigned char **payload, int *payloadlen, unsigned char *buf, int len);
+
 /*  DLLExport int MQTTSerialize_puback(unsigned char* buf, int buflen, unsigned short packetid); */
 DLLExport int MQTTSerialize_pubrel(unsigned char *buf, int buflen, unsigned char dup, unsigned short packetid);
 DLLExport int MQTTSerialize_pubcomp(unsigned char *buf, int buflen, unsigned short packetid);
@@ -15,6 +15,20 @@
   * @return the length of buffer needed to contain the serialized version of the packet
   */
 int MQTTSerialize_publishLength(int qos, MQTTString topicName, int payloadlen)
+{
+    return MQTTV5Serialize_publishLength(qos, topicName, NULL, payloadlen);
+}
+
+
+/**
+  * Determines the length of the MQTT publish packet that would be produced using the supplied parameters
+  * @param qos the MQTT QoS of the publish (packetid is omitted for QoS 0)
+  * @param topicName the topic name to be used in the publish
+  * @param props the MQTT 5.0 publish properties, NULL for MQTT 3.1.1
+  * @param payloadlen the length of the payload to be sent
+  * @return the length of buffer needed to contain the serialized version of the packet
+  */
+int MQTTV5Serialize_publishLength(int qos, MQTTString topicName, MQTTProperties *props, int payloadlen)
 {
     int len = 0;
 
@@ -22,6 +36,9 @@ int MQTTSerialize_publishLength(int qos, MQTTString topicName, int payloadlen)
     if (qos > 0) {
         len += 2;    /* packetid */
     }
+    if (props != NULL) {
+        len += MQTTProperties_len(props);
+    }
     return len;
 }
 
@@ -42,13 +59,95 @@ int MQTTSerialize_publishLength(int qos, MQTTString topicName, int payloadlen)
 int MQTTSerialize_publish(unsigned char *buf, int buflen, unsigned char dup, int qos, unsigned char retained,
                           unsigned short packetid,
                           MQTTString topicName, unsigned char *payload, int payloadlen)
+{
+    return MQTTV5Serialize_publish(buf, buflen, dup, qos, retained, packetid, topicName, NULL, payload, payloadlen);
+}
+
+
+/**
+  * Serializes the supplied publish data into the supplied buffer, ready for sending
+  * @param buf the buffer into which the packet will be serialized
+  * @param buflen the length in bytes of the supplied buffer
+  * @param dup integer - the MQTT dup flag
+  * @param qos integer - the MQTT QoS value
+  * @param retained integer - the MQTT retained flag
+  * @param packetid integer - the MQTT packet identifier
+  * @param topicName MQTTString - the MQTT topic in the publish, empty if props->topicAlias is known by server
+  * @param props MQTTProperties - the MQTT 5.0 publish properties, NULL for MQTT 3.1.1
+  * @param payload byte buffer - the MQTT publish payload
+  * @param payloadlen integer - the length of the MQTT payload
+  * @return the length of the serialized data.  <= 0 indicates error
+  */
+int MQTTV5Serialize_publish(unsigned char *buf, int buflen, unsigned char dup, int qos, unsigned char retained,
+                            unsigned short packetid,
+                            MQTTString topicName, MQTTProperties *props, unsigned char *payload, int payloadlen)
+{
+    int rc = 0;
+
+    if (MQTTPacket_len(MQTTV5Serialize_publishLength(qos, topicName, props, payloadlen)) > buflen) {
+        rc = MQTTPACKET_BUFFER_TOO_SHORT;
+        goto exit;
+    }
+
+    rc = MQTTV5Serialize_publishHeader(buf, buflen, dup, qos, retained, packetid, topicName, props, payloadlen);
+    if (rc <= 0) {
+        goto exit;
+    }
+
+    memcpy(buf + rc, payload, payloadlen);
+    rc += payloadlen;
+
+exit:
+    return rc;
+}
+
+
+/**
+  * Serializes the publish packet except its payload into the supplied buffer,
+  * so that the payload can be sent from its own buffer right after it
+  * @param buf the buffer into which the packet header will be serialized
+  * @param buflen the length in bytes of the supplied buffer
+  * @param dup integer - the MQTT dup flag
+  * @param qos integer - the MQTT QoS value
+  * @param retained integer - the MQTT retained flag
+  * @param packetid integer - the MQTT packet identifier
+  * @param topicName MQTTString - the MQTT topic in the publish
+  * @param payloadlen integer - the length of the MQTT payload sent after it
+  * @return the length of the serialized header.  <= 0 indicates error
+  */
+int MQTTSerialize_publishHeader(unsigned char *buf, int buflen, unsigned char dup, int qos, unsigned char retained,
+                                unsigned short packetid,
+                                MQTTString topicName, int payloadlen)
+{
+    return MQTTV5Serialize_publishHeader(buf, buflen, dup, qos, retained, packetid, topicName, NULL, payloadlen);
+}
+
+
+/**
+  * Serializes the publish packet except its payload into the supplied buffer,
+  * so that the payload can be sent from its own buffer right after it
+  * @param buf the buffer into which the packet header will be serialized
+  * @param buflen the length in bytes of the supplied buffer
+  * @param dup integer - the MQTT dup flag
+  * @param qos integer - the MQTT QoS value
+  * @param retained integer - the MQTT retained flag
+  * @param packetid integer - the MQTT packet identifier
+  * @param topicName MQTTString - the MQTT topic in the publish, empty if props->topicAlias is known by server
+  * @param props MQTTProperties - the MQTT 5.0 publish properties, NULL for MQTT 3.1.1
+  * @param payloadlen integer - the length of the MQTT payload sent after it
+  * @return the length of the serialized header.  <= 0 indicates error
+  */
+int MQTTV5Serialize_publishHeader(unsigned char *buf, int buflen, unsigned char dup, int qos, unsigned char retained,
+                                  unsigned short packetid,
+                                  MQTTString topicName, MQTTProperties *props, int payloadlen)
 {
     unsigned char *ptr = buf;
     MQTTHeader header = {0};
     int rem_len = 0;
     int rc = 0;
 
-    if (MQTTPacket_len(rem_len = MQTTSerialize_publishLength(qos, topicName, payloadlen)) > buflen) {
+    rem_len = MQTTV5Serialize_publishLength(qos, topicName, props, payloadlen);
+    if (MQTTPacket_len(rem_len) - payloadlen > buflen) {
         rc = MQTTPACKET_BUFFER_TOO_SHORT;
         goto exit;
     }
@@ -67,8 +166,9 @@ int MQTTSerialize_publish(unsigned char *buf, int buflen, unsigned char dup, int
         writeInt(&ptr, packetid);
     }
 
-    memcpy(ptr, payload, payloadlen);
-    ptr += payloadlen;
+    if (props != NULL) {
+        MQTTProperties_write(&ptr, props);
+    }
 
     rc = ptr - buf;
 
@@ -13,10 +13,27 @@
   * @return the length of buffer needed to contain the serialized version of the packet
   */
 int MQTTSerialize_subscribeLength(int count, MQTTString topicFilters[])
+{
+    return MQTTV5Serialize_subscribeLength(NULL, count, topicFilters);
+}
+
+
+/**
+  * Determines the length of the MQTT subscribe packet that would be produced using the supplied parameters
+  * @param props the MQTT 5.0 subscribe properties, NULL for MQTT 3.1.1
+  * @param count the number of topic filter strings in topicFilters
+  * @param topicFilters the array of topic filter strings to be used in the publish
+  * @return the length of buffer needed to contain the serialized version of the packet
+  */
+int MQTTV5Serialize_subscribeLength(MQTTProperties *props, int count, MQTTString topicFilters[])
 {
     int i;
     int len = 2; /* packetid */
 
+    if (props != NULL) {
+        len += MQTTProperties_len(props);
+    }
+
     for (i = 0; i < count; ++i) {
         len += 2 + MQTTstrlen(topicFilters[i]) + 1;    /* length + topic + req_qos */
     }
@@ -37,6 +54,25 @@ int MQTTSerialize_subscribeLength(int count, MQTTString topicFilters[])
   */
 int MQTTSerialize_subscribe(unsigned char *buf, int buflen, unsigned char dup, unsigned short packetid, int count,
                             MQTTString topicFilters[], int requestedQoSs[])
+{
+    return MQTTV5Serialize_subscribe(buf, buflen, dup, packetid, NULL, count, topicFilters, requestedQoSs);
+}
+
+
+/**
+  * Serializes the supplied subscribe data into the supplied buffer, ready for sending
+  * @param buf the buffer into which the packet will be serialized
+  * @param buflen the length in bytes of the supplied bufferr
+  * @param dup integer - the MQTT dup flag
+  * @param packetid integer - the MQTT packet identifier
+  * @param props - the MQTT 5.0 subscribe properties, NULL for MQTT 3.1.1
+  * @param count - number of members in the topicFilters and reqQos arrays
+  * @param topicFilters - array of topic filter names
+  * @param requestedQoSs - array of requested QoS
+  * @return the length of the serialized data.  <= 0 indicates error
+  */
+int MQTTV5Serialize_subscribe(unsigned char *buf, int buflen, unsigned char dup, unsigned short packetid,
+                              MQTTProperties *props, int count, MQTTString topicFilters[], int requestedQoSs[])
 {
     unsigned char *ptr = buf;
     MQTTHeader header = {0};
@@ -44,7 +80,7 @@ int MQTTSerialize_subscribe(unsigned char *buf, int buflen, unsigned char dup, u
     int rc = 0;
     int i = 0;
 
-    if (MQTTPacket_len(rem_len = MQTTSerialize_subscribeLength(count, topicFilters)) > buflen) {
+    if (MQTTPacket_len(rem_len = MQTTV5Serialize_subscribeLength(props, count, topicFilters)) > buflen) {
         rc = MQTTPACKET_BUFFER_TOO_SHORT;
         goto exit;
     }
@@ -59,6 +95,10 @@ int MQTTSerialize_subscribe(unsigned char *buf, int buflen, unsigned char dup, u
 
     writeInt(&ptr, packetid);
 
+    if (props != NULL) {
+        MQTTProperties_write(&ptr, props);
+    }
+
     for (i = 0; i < count; ++i) {
         writeMQTTString(&ptr, topicFilters[i]);
         writeChar(&ptr, requestedQoSs[i]);
@@ -83,6 +123,24 @@ exit:
   */
 int MQTTDeserialize_suback(unsigned short *packetid, int maxcount, int *count, int grantedQoSs[], unsigned char *buf,
                            int buflen)
+{
+    return MQTTV5Deserialize_suback(packetid, NULL, maxcount, count, grantedQoSs, buf, buflen);
+}
+
+
+/**
+  * Deserializes the supplied (wire) buffer into suback data
+  * @param packetid returned integer - the MQTT packet identifier
+  * @param props returned MQTTProperties - the MQTT 5.0 suback properties, NULL for MQTT 3.1.1
+  * @param maxcount - the maximum number of members allowed in the grantedQoSs array
+  * @param count returned integer - number of members in the grantedQoSs array
+  * @param grantedQoSs returned array of integers - the granted qualities of service, or reason codes of MQTT 5.0
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param buflen the length in bytes of the data in the supplied buffer
+  * @return error code.  1 is success, 0 is failure
+  */
+int MQTTV5Deserialize_suback(unsigned short *packetid, MQTTProperties *props, int maxcount, int *count,
+                             int grantedQoSs[], unsigned char *buf, int buflen)
 {
     MQTTHeader header = {0};
     unsigned char *curdata = buf;
@@ -103,6 +161,11 @@ int MQTTDeserialize_suback(unsigned short *packetid, int maxcount, int *count, i
 
     *packetid = readInt(&curdata);
 
+    if (props != NULL && !MQTTProperties_read(props, &curdata, enddata)) {
+        rc = -1;
+        goto exit;
+    }
+
     *count = 0;
     while (curdata < enddata) {
         if (*count >= maxcount) {
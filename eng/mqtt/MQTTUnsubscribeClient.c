@@ -13,10 +13,27 @@
   * @return the length of buffer needed to contain the serialized version of the packet
   */
 int MQTTSerialize_unsubscribeLength(int count, MQTTString topicFilters[])
+{
+    return MQTTV5Serialize_unsubscribeLength(NULL, count, topicFilters);
+}
+
+
+/**
+  * Determines the length of the MQTT unsubscribe packet that would be produced using the supplied parameters
+  * @param props the MQTT 5.0 unsubscribe properties, NULL for MQTT 3.1.1
+  * @param count the number of topic filter strings in topicFilters
+  * @param topicFilters the array of topic filter strings to be used in the publish
+  * @return the length of buffer needed to contain the serialized version of the packet
+  */
+int MQTTV5Serialize_unsubscribeLength(MQTTProperties *props, int count, MQTTString topicFilters[])
 {
     int i;
     int len = 2; /* packetid */
 
+    if (props != NULL) {
+        len += MQTTProperties_len(props);
+    }
+
     for (i = 0; i < count; ++i) {
         len += 2 + MQTTstrlen(topicFilters[i]);    /* length + topic*/
     }
@@ -36,6 +53,24 @@ int MQTTSerialize_unsubscribeLength(int count, MQTTString topicFilters[])
   */
 int MQTTSerialize_unsubscribe(unsigned char *buf, int buflen, unsigned char dup, unsigned short packetid,
                               int count, MQTTString topicFilters[])
+{
+    return MQTTV5Serialize_unsubscribe(buf, buflen, dup, packetid, NULL, count, topicFilters);
+}
+
+
+/**
+  * Serializes the supplied unsubscribe data into the supplied buffer, ready for sending
+  * @param buf the raw buffer data, of the correct length determined by the remaining length field
+  * @param buflen the length in bytes of the data in the supplied buffer
+  * @param dup integer - the MQTT dup flag
+  * @param packetid integer - the MQTT packet identifier
+  * @param props - the MQTT 5.0 unsubscribe properties, NULL for MQTT 3.1.1
+  * @param count - number of members in the topicFilters array
+  * @param topicFilters - array of topic filter names
+  * @return the length of the serialized data.  <= 0 indicates error
+  */
+int MQTTV5Serialize_unsubscribe(unsigned char *buf, int buflen, unsigned char dup, unsigned short packetid,
+                                MQTTProperties *props, int count, MQTTString topicFilters[])
 {
     unsigned char *ptr = buf;
     MQTTHeader header = {0};
@@ -43,7 +78,7 @@ int MQTTSerialize_unsubscribe(unsigned char *buf, int buflen, unsigned char dup,
     int rc = -1;
     int i = 0;
 
-    if (MQTTPacket_len(rem_len = MQTTSerialize_unsubscribeLength(count, topicFilters)) > buflen) {
+    if (MQTTPacket_len(rem_len = MQTTV5Serialize_unsubscribeLength(props, count, topicFilters)) > buflen) {
         rc = MQTTPACKET_BUFFER_TOO_SHORT;
         goto exit;
     }
@@ -58,6 +93,10 @@ int MQTTSerialize_unsubscribe(unsigned char *buf, int buflen, unsigned char dup,
 
     writeInt(&ptr, packetid);
 
+    if (props != NULL) {
+        MQTTProperties_write(&ptr, props);
+    }
+
     for (i = 0; i < count; ++i) {
         writeMQTTString(&ptr, topicFilters[i]);
     }
@@ -22,10 +22,179 @@ static void iotx_mc_release(iotx_mc_client_t *pclient)
 }
 
 #if !WITH_MQTT_ONLY_QOS0
+#ifdef PLATFORM_HAS_DYNMEM
+/* index is never full, so that probing always ends at an empty slot */
+#if IOTX_MC_REPUB_INDEX_LEN <= IOTX_MC_REPUB_NUM_MAX
+    #error "IOTX_MC_REPUB_INDEX_LEN must be greater than IOTX_MC_REPUB_NUM_MAX"
+#endif
+
+/* open addressing index of wait publish ack, with linear probing */
+static uint32_t _pub_index_hash(uint16_t msgId)
+{
+    return msgId % IOTX_MC_REPUB_INDEX_LEN;
+}
+
+/* find slot of node, or of the first node with msgId if node is NULL, must be called with lock_list_pub held */
+static int _pub_index_find(iotx_mc_client_t *c, uint16_t msgId, iotx_mc_pub_info_t *node)
+{
+    uint32_t idx = _pub_index_hash(msgId);
+    uint32_t probe = 0;
+
+    for (probe = 0; probe < IOTX_MC_REPUB_INDEX_LEN && c->pub_wait_index[idx] != NULL; probe++) {
+        if (c->pub_wait_index[idx] == node || (node == NULL && c->pub_wait_index[idx]->msg_id == msgId)) {
+            return idx;
+        }
+        idx = (idx + 1) % IOTX_MC_REPUB_INDEX_LEN;
+    }
+
+    return -1;
+}
+
+static void _pub_index_insert(iotx_mc_client_t *c, iotx_mc_pub_info_t *node)
+{
+    uint32_t idx = _pub_index_hash(node->msg_id);
+
+    while (c->pub_wait_index[idx] != NULL) {
+        idx = (idx + 1) % IOTX_MC_REPUB_INDEX_LEN;
+    }
+    c->pub_wait_index[idx] = node;
+}
+
+/* clear slot and shift back following nodes of the probe sequence, so that no tombstone is needed */
+static void _pub_index_remove(iotx_mc_client_t *c, uint32_t idx)
+{
+    uint32_t next = (idx + 1) % IOTX_MC_REPUB_INDEX_LEN;
+    uint32_t home = 0;
+
+    c->pub_wait_index[idx] = NULL;
+    while (c->pub_wait_index[next] != NULL) {
+        home = _pub_index_hash(c->pub_wait_index[next]->msg_id);
+        /* move node back unless its home slot lies cyclically in (idx, next] */
+        if ((next > idx && (home <= idx || home > next)) || (next < idx && home <= idx && home > next)) {
+            c->pub_wait_index[idx] = c->pub_wait_index[next];
+            c->pub_wait_index[next] = NULL;
+            idx = next;
+        }
+        next = (next + 1) % IOTX_MC_REPUB_INDEX_LEN;
+    }
+}
+
+/* reference 'data', or a copy of it if 'copy' is set, the reference count starts from 1 */
+static iotx_mc_payload_t *iotx_mc_payload_new(const char *data, uint32_t len, int copy)
+{
+    iotx_mc_payload_t *payload = NULL;
+
+    payload = (iotx_mc_payload_t *)mqtt_malloc(sizeof(iotx_mc_payload_t) + (copy ? len : 0));
+    if (payload == NULL) {
+        return NULL;
+    }
+
+    if (copy) {
+        memcpy((char *)payload + sizeof(iotx_mc_payload_t), data, len);
+        data = (char *)payload + sizeof(iotx_mc_payload_t);
+    }
+    payload->data = data;
+    payload->len = len;
+    payload->ref = 1;
+    payload->free_fp = NULL;
+
+    return payload;
+}
+
+/* must be called with lock_list_pub held, so 'free_fp' is called with it held too */
+static void iotx_mc_payload_release(iotx_mc_payload_t *payload)
+{
+    if (--payload->ref > 0) {
+        return;
+    }
+
+    if (payload->free_fp != NULL) {
+        payload->free_fp((void *)payload->data);
+    }
+    mqtt_free(payload);
+}
+
+/* must be called with lock_list_pub held */
+static void iotx_mc_pub_info_release(iotx_mc_client_t *c, iotx_mc_pub_info_t *node)
+{
+    int idx = _pub_index_find(c, node->msg_id, node);
+
+    if (idx >= 0) {
+        _pub_index_remove(c, idx);
+    }
+    list_del(&node->linked_list);
+    if (node->payload != NULL) {
+        iotx_mc_payload_release(node->payload);
+    }
+    mqtt_free(node);
+    c->pub_wait_num--;
+}
+#endif
+
+/* check if QoS1 publish with msgId is still waiting for PUBACK, must be called with lock_list_pub held */
+static int iotx_mc_pub_info_in_flight(iotx_mc_client_t *c, uint16_t msgId)
+{
+#ifdef PLATFORM_HAS_DYNMEM
+    return _pub_index_find(c, msgId, NULL) >= 0;
+#else
+    int idx;
+
+    for (idx = 0; idx < IOTX_MC_REPUB_NUM_MAX; idx++) {
+        if (c->list_pub_wait_ack[idx].used &&
+            c->list_pub_wait_ack[idx].node_state == IOTX_MC_NODE_STATE_NORMANL &&
+            c->list_pub_wait_ack[idx].msg_id == msgId) {
+            return 1;
+        }
+    }
+    return 0;
+#endif
+}
+
+/* milliseconds until the next QoS1 republish is due, 0xFFFFFFFF if none */
+static uint32_t iotx_mc_pub_info_next_due(iotx_mc_client_t *c)
+{
+    uint32_t interval = c->request_timeout_ms * 2;
+    uint32_t spend = 0, due = 0xFFFFFFFF;
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_pub_info_t *node = NULL;
+
+    HAL_MutexLock(c->lock_list_pub);
+    if (!list_empty(&c->list_pub_wait_ack)) {
+        node = list_first_entry(&c->list_pub_wait_ack, iotx_mc_pub_info_t, linked_list);
+        spend = utils_time_spend(&node->pub_start_time);
+        due = (spend > interval) ? 0 : (interval - spend + 1);
+    }
+    HAL_MutexUnlock(c->lock_list_pub);
+#else
+    int idx;
+
+    HAL_MutexLock(c->lock_list_pub);
+    for (idx = 0; idx < IOTX_MC_REPUB_NUM_MAX; idx++) {
+        if (!c->list_pub_wait_ack[idx].used ||
+            c->list_pub_wait_ack[idx].node_state != IOTX_MC_NODE_STATE_NORMANL) {
+            continue;
+        }
+        spend = utils_time_spend(&c->list_pub_wait_ack[idx].pub_start_time);
+        if (spend > interval) {
+            due = 0;
+            break;
+        }
+        if (interval - spend + 1 < due) {
+            due = interval - spend + 1;
+        }
+    }
+    HAL_MutexUnlock(c->lock_list_pub);
+#endif
+
+    return due;
+}
+
 static void iotx_mc_pub_wait_list_init(iotx_mc_client_t *pClient)
 {
 #ifdef PLATFORM_HAS_DYNMEM
     INIT_LIST_HEAD(&pClient->list_pub_wait_ack);
+    memset(pClient->pub_wait_index, 0, sizeof(pClient->pub_wait_index));
+    pClient->pub_wait_num = 0;
 #else
     memset(pClient->list_pub_wait_ack, 0, sizeof(iotx_mc_pub_info_t) * IOTX_MC_REPUB_NUM_MAX);
 #endif
@@ -37,8 +206,13 @@ static void iotx_mc_pub_wait_list_deinit(iotx_mc_client_t *pClient)
     iotx_mc_pub_info_t *node = NULL, *next_node = NULL;
     list_for_each_entry_safe(node, next_node, &pClient->list_pub_wait_ack, linked_list, iotx_mc_pub_info_t) {
         list_del(&node->linked_list);
+        if (node->payload != NULL) {
+            iotx_mc_payload_release(node->payload);
+        }
         mqtt_free(node);
     }
+    memset(pClient->pub_wait_index, 0, sizeof(pClient->pub_wait_index));
+    pClient->pub_wait_num = 0;
 #else
     memset(pClient->list_pub_wait_ack, 0, sizeof(iotx_mc_pub_info_t) * IOTX_MC_REPUB_NUM_MAX);
 #endif
@@ -110,6 +284,10 @@ static iotx_mc_state_t iotx_mc_get_client_state(iotx_mc_client_t *pClient)
 }
 
 /* Initialize MQTT client */
+#if WITH_MQTT_DISPATCH
+static void iotx_mc_dispatch_deliver(void *owner, iotx_mc_dispatch_msg_t *msg);
+#endif
+
 static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParams)
 {
     int rc = -1;
@@ -150,6 +328,12 @@ static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParam
         goto RETURN;
     }
 
+    pClient->sem_wakeup = HAL_SemaphoreCreate();
+    if (!pClient->sem_wakeup) {
+        iotx_state_event(ITE_STATE_SYS_DEPEND, STATE_SYS_DEPEND_MUTEX_CREATE, "sem_wakeup create fail");
+        goto RETURN;
+    }
+
     connectdata.MQTTVersion = IOTX_MC_MQTT_VERSION;
     connectdata.keepAliveInterval = pInitParams->keepalive_interval_ms / 1000;
 
@@ -214,7 +398,7 @@ static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParam
         goto RETURN;
     }
 
-    iotx_time_init(&pClient->next_ping_time);
+    pClient->keepalive_ms = pClient->connect_data.keepAliveInterval * 1000;
     iotx_time_init(&pClient->reconnect_param.reconnect_next_time);
 
     memset(&pClient->ipstack, 0, sizeof(utils_network_t));
@@ -226,6 +410,42 @@ static int iotx_mc_init(iotx_mc_client_t *pClient, iotx_mqtt_param_t *pInitParam
         goto RETURN;
     }
 
+#if WITH_MQTT_SUBMIT_QUEUE
+    iotx_mc_submit_init(&pClient->submit_queue);
+#endif
+
+#if WITH_MQTT_RX_DEDUP
+    iotx_mc_dedup_init(&pClient->dedup);
+#endif
+
+#if WITH_MQTT_PUB_RATE_LIMIT
+    rc = iotx_mc_rate_init(&pClient->rate);
+    if (rc < STATE_SUCCESS) {
+        mc_state = IOTX_MC_STATE_INVALID;
+        goto RETURN;
+    }
+#endif
+
+#if WITH_MQTT_DISPATCH
+    rc = iotx_mc_dispatch_init(&pClient->dispatch, iotx_mc_dispatch_deliver, pClient);
+    if (rc < STATE_SUCCESS) {
+#if WITH_MQTT_PUB_RATE_LIMIT
+        iotx_mc_rate_deinit(&pClient->rate);
+#endif
+        mc_state = IOTX_MC_STATE_INVALID;
+        goto RETURN;
+    }
+#endif
+
+#if WITH_MQTT_JOURNAL
+    /* client works without journal, publishes made while offline just fail */
+    /* user name is "device_name&product_key", which tells devices apart */
+    if (iotx_mc_journal_init(&pClient->journal, pInitParams->username) < STATE_SUCCESS) {
+        mqtt_warning("journal init failed");
+    }
+    iotx_time_init(&pClient->journal_drain_time);
+#endif
+
     mc_state = IOTX_MC_STATE_INITIALIZED;
     rc = STATE_SUCCESS;
 
@@ -258,6 +478,10 @@ RETURN :
             HAL_MutexDestroy(pClient->lock_yield);
             pClient->lock_yield = NULL;
         }
+        if (pClient->sem_wakeup) {
+            HAL_SemaphoreDestroy(pClient->sem_wakeup);
+            pClient->sem_wakeup = NULL;
+        }
     }
 
     return rc;
@@ -305,21 +529,53 @@ static int _reset_send_buffer(iotx_mc_client_t *c)
 
 static int _reset_recv_buffer(iotx_mc_client_t *c)
 {
-#ifdef PLATFORM_HAS_DYNMEM
-#if  WITH_MQTT_DYN_BUF
-    if (c == NULL || c->buf_read == NULL) {
+    if (c == NULL) {
         return STATE_USER_INPUT_INVALID;
     }
 
-    mqtt_free(c->buf_read);
-    c->buf_read = NULL;
-    c->buf_size_read = 0;
+    /* drop buffered bytes but keep the buffer itself for the following packets */
+    c->rx_len = 0;
+    c->rx_frame_len = 0;
+    c->rx_more = 0;
     return STATE_SUCCESS;
-#else
+}
+
+static int _consume_recv_buffer(iotx_mc_client_t *c)
+{
+    uint32_t left = 0;
+
+    if (c == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    if (c->rx_frame_len == 0) {
+        return STATE_SUCCESS;
+    }
+
+    /* restore the first byte of next packet which was overwritten by terminator */
+    if (c->rx_frame_len < c->buf_size_read) {
+        c->buf_read[c->rx_frame_len] = c->rx_frame_next;
+    }
+
+    left = c->rx_len - c->rx_frame_len;
+    if (left > 0) {
+        memmove(c->buf_read, c->buf_read + c->rx_frame_len, left);
+    }
+    c->rx_len = left;
+    c->rx_frame_len = 0;
     return STATE_SUCCESS;
+}
+
+static uint32_t _get_recv_buffer_limit(iotx_mc_client_t *c)
+{
+#ifdef PLATFORM_HAS_DYNMEM
+#if  WITH_MQTT_DYN_BUF
+    return c->buf_size_read_max;
+#else
+    return c->buf_size_read;
 #endif
 #else
-    return STATE_SUCCESS;
+    return c->buf_size_read;
 #endif
 }
 
@@ -370,13 +626,17 @@ static int _alloc_recv_buffer(iotx_mc_client_t *c, int len)
     if (tmp_len > c->buf_size_read_max) {
         tmp_len = c->buf_size_read_max;
     }
+    if (c->buf_read != NULL && c->buf_size_read >= tmp_len) {
+        /* read buffer is persistent, only grow it */
+        return STATE_SUCCESS;
+    }
     if (c->buf_read != NULL) { /* do realloc */
         char *temp = mqtt_malloc(tmp_len);
         if (temp == NULL) {
             return STATE_SYS_DEPEND_MALLOC;
         }
         memset(temp, 0, tmp_len);
-        memcpy(temp, c->buf_read, c->buf_size_read < tmp_len ? c->buf_size_read : tmp_len);
+        memcpy(temp, c->buf_read, c->rx_len);
         mqtt_free(c->buf_read);
         c->buf_read = temp;
     } else {
@@ -396,220 +656,712 @@ static int _alloc_recv_buffer(iotx_mc_client_t *c, int len)
 #endif
 }
 
-static int iotx_mc_send_packet(iotx_mc_client_t *c, char *buf, int length, iotx_time_t *time)
+/* milliseconds until PINGREQ is due, the timer restarts whenever a packet is sent or received */
+static uint32_t iotx_mc_keepalive_left(iotx_mc_client_t *c)
 {
-    int rc = STATE_SUCCESS;
-    int sent = 0;
-    unsigned int left_t = 0;
+    uint32_t idle_tx = utils_time_spend(&c->last_tx_time);
+    uint32_t idle_rx = utils_time_spend(&c->last_rx_time);
+    uint32_t idle = idle_tx;
+    uint32_t interval = c->keepalive_ms;
+    uint32_t server_left = 0;
+    uint32_t left = 0;
+
+    /* inbound packet proves connection alive, unless PINGREQ is still unanswered */
+    if (c->keepalive_probes == 0 && idle_rx < idle) {
+        idle = idle_rx;
+    }
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+    /* probed idle time may have been too long, find it out soon */
+    if (c->keepalive_probes > 0 && interval > CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000) {
+        interval = CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000;
+    }
+#endif
+    left = (interval > idle) ? interval - idle : 0;
 
-    if (!c || !buf || !time) {
-        return STATE_USER_INPUT_INVALID;
+    /* server only counts packets sent by us */
+    server_left = (c->keepalive_server_ms > idle_tx) ? c->keepalive_server_ms - idle_tx : 0;
+    return (server_left < left) ? server_left : left;
+}
+
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+/* learn from outstanding PINGREQ whether connection survived idle time before it, then choose next interval */
+static void iotx_mc_keepalive_adapt(iotx_mc_client_t *c, int alive)
+{
+    uint32_t probe = c->keepalive_probe_ms;
+    uint32_t next = 0;
+
+    if (probe == 0) {
+        return;
+    }
+    c->keepalive_probe_ms = 0;
+
+    if (alive) {
+        if (probe <= c->keepalive_safe_ms) {
+            return;
+        }
+        c->keepalive_safe_ms = probe;
+    } else {
+        if (probe <= c->keepalive_safe_ms || (c->keepalive_fail_ms != 0 && probe >= c->keepalive_fail_ms)) {
+            /* lost after idle time known to be safe, it is network rather than NAT */
+            return;
+        }
+        c->keepalive_fail_ms = probe;
+    }
+
+    /* grow by half until connection is lost once, then bisect between safe and failed idle time */
+    if (c->keepalive_fail_ms == 0) {
+        next = c->keepalive_safe_ms + c->keepalive_safe_ms / 2;
+    } else if (c->keepalive_fail_ms - c->keepalive_safe_ms > IOTX_MC_KEEPALIVE_ADAPT_STEP_MS) {
+        next = c->keepalive_safe_ms + (c->keepalive_fail_ms - c->keepalive_safe_ms) / 2;
+    } else {
+        next = c->keepalive_safe_ms;
     }
 
-    while (sent < length && !utils_time_is_expired(time)) {
+    if (next < CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000) {
+        next = CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000;
+    }
+    if (next > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000) {
+        next = CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000;
+    }
+    c->keepalive_ms = next;
+    mqtt_info("keepalive interval %u ms, safe %u ms, failed %u ms",
+              next, c->keepalive_safe_ms, c->keepalive_fail_ms);
+}
+#endif
+
+/* a packet is received */
+static void iotx_mc_keepalive_rx(iotx_mc_client_t *c)
+{
+    iotx_time_start(&c->last_rx_time);
+    c->keepalive_probes = 0;
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+    iotx_mc_keepalive_adapt(c, 1);
+#endif
+}
+
+static int iotx_mc_send_packetv(iotx_mc_client_t *c, hal_iovec_t *iov, int iovcnt, iotx_time_t *time)
+{
+    int rc = 0;
+    int idx = 0;
+    unsigned int left_t = 0;
+
+    while (idx < iovcnt && !utils_time_is_expired(time)) {
         left_t = iotx_time_left(time);
         left_t = (left_t == 0) ? 1 : left_t;
-        rc = c->ipstack.write(&c->ipstack, &buf[sent], length - sent, left_t);
+        if (c->ipstack.writev != NULL) {
+            rc = c->ipstack.writev(&c->ipstack, &iov[idx], iovcnt - idx, left_t);
+        } else {
+            rc = c->ipstack.write(&c->ipstack, (const char *)iov[idx].base, iov[idx].len, left_t);
+        }
         if (rc < 0) { /* there was an error writing the data */
             break;
         }
-        sent += rc;
+
+        /* skip buffers written, then the written part of the next one */
+        while (idx < iovcnt && rc >= (int)iov[idx].len) {
+            rc -= iov[idx].len;
+            idx++;
+        }
+        if (idx < iovcnt) {
+            iov[idx].base = (const char *)iov[idx].base + rc;
+            iov[idx].len -= rc;
+        }
     }
 
-    if (sent == length) {
-        rc = STATE_SUCCESS;
-    } else {
-        rc = STATE_SYS_DEPEND_NWK_CLOSE;
+    if (idx < iovcnt) {
+        return STATE_SYS_DEPEND_NWK_CLOSE;
     }
-    return rc;
+
+    iotx_time_start(&c->last_tx_time);
+    return STATE_SUCCESS;
 }
 
-int MQTTConnect(iotx_mc_client_t *pClient)
+#if WITH_MQTT_TX_QUEUE
+/* free frames in outbound queue, lock_write_buf must be held */
+static void iotx_mc_tx_queue_drop(iotx_mc_client_t *c)
 {
-    MQTTPacket_connectData *pConnectParams;
-    iotx_time_t connectTimer;
-    int len = 0, res = 0;
+    int idx;
 
-    if (!pClient) {
-        return STATE_USER_INPUT_INVALID;
+    for (idx = 0; idx < c->tx_queue_num; idx++) {
+        mqtt_free(c->tx_queue[idx].base);
+        c->tx_queue[idx].len = 0;
     }
+    c->tx_queue_num = 0;
+    c->tx_queue_bytes = 0;
+}
 
-    pConnectParams = &pClient->connect_data;
-    HAL_MutexLock(pClient->lock_write_buf);
+/* check if a frame of 'length' fits in outbound queue, lock_write_buf must be held */
+static int iotx_mc_tx_queue_room(iotx_mc_client_t *c, int length)
+{
+    return c->tx_queue_num < IOTX_MC_TX_QUEUE_NUM_MAX && c->tx_queue_bytes + length <= IOTX_MC_TX_QUEUE_BYTES_MAX;
+}
 
-    len = _get_connect_length(pConnectParams);
+/* append 'frame' which is freed after sent, iotx_mc_tx_queue_room() must be checked, lock_write_buf must be held */
+static void iotx_mc_tx_queue_add(iotx_mc_client_t *c, char *frame, int length)
+{
+    if (c->tx_queue_num == 0) {
+        iotx_time_init(&c->tx_queue_time);
+        utils_time_countdown_ms(&c->tx_queue_time, IOTX_MC_TX_QUEUE_DELAY_MS);
+    }
+    c->tx_queue[c->tx_queue_num].base = frame;
+    c->tx_queue[c->tx_queue_num].len = length;
+    c->tx_queue_num++;
+    c->tx_queue_bytes += length;
+}
+#endif
 
-    res = _alloc_send_buffer(pClient, len);
-    if (res < STATE_SUCCESS) {
-        HAL_MutexUnlock(pClient->lock_write_buf);
-        return res;
+/* send 'iov' right after frames in outbound queue, in one vectored write, lock_write_buf must be held */
+static int iotx_mc_send_iov(iotx_mc_client_t *c, hal_iovec_t *iov, int iovcnt, iotx_time_t *time)
+{
+#if WITH_MQTT_TX_QUEUE
+    hal_iovec_t all[IOTX_MC_TX_QUEUE_NUM_MAX + 2];
+    int num = c->tx_queue_num;
+    int rc = STATE_SUCCESS;
+
+    if (num == 0) {
+        return iotx_mc_send_packetv(c, iov, iovcnt, time);
     }
 
-    if ((len = MQTTSerialize_connect((unsigned char *)pClient->buf_send, pClient->buf_size_send, pConnectParams)) <= 0) {
-        _reset_send_buffer(pClient);
-        HAL_MutexUnlock(pClient->lock_write_buf);
-        return STATE_MQTT_SERIALIZE_CONN_ERROR;
+    memcpy(all, c->tx_queue, sizeof(hal_iovec_t) * num);
+    if (iovcnt > 0 && iovcnt <= 2) {
+        memcpy(&all[num], iov, sizeof(hal_iovec_t) * iovcnt);
+        num += iovcnt;
+        iovcnt = 0;
     }
+    rc = iotx_mc_send_packetv(c, all, num, time);
 
-    /* send the connect packet */
-    iotx_time_init(&connectTimer);
-    utils_time_countdown_ms(&connectTimer, pClient->request_timeout_ms);
-    res = iotx_mc_send_packet(pClient, pClient->buf_send, len, &connectTimer);
-    if (res < STATE_SUCCESS) {
-        _reset_send_buffer(pClient);
-        HAL_MutexUnlock(pClient->lock_write_buf);
-        return res;
+    /* frames are dropped on failure as well, QoS1 publish is still in republish list */
+    iotx_mc_tx_queue_drop(c);
+
+    if (rc == STATE_SUCCESS && iovcnt > 0) {
+        rc = iotx_mc_send_packetv(c, iov, iovcnt, time);
     }
-    _reset_send_buffer(pClient);
-    HAL_MutexUnlock(pClient->lock_write_buf);
-    return STATE_SUCCESS;
+    return rc;
+#else
+    return iotx_mc_send_packetv(c, iov, iovcnt, time);
+#endif
 }
 
-static int iotx_mc_decode_packet(iotx_mc_client_t *c, int *value, int timeout)
+static int iotx_mc_send_packet(iotx_mc_client_t *c, char *buf, int length, iotx_time_t *time)
 {
-    char i;
-    int multiplier = 1;
-    int len = 0;
-    const int MAX_NO_OF_REMAINING_LENGTH_BYTES = 4;
+    hal_iovec_t iov;
 
-    if (!c || !value) {
+    if (!c || !buf || !time) {
         return STATE_USER_INPUT_INVALID;
     }
 
-    *value = 0;
-    do {
-        int rc = MQTTPACKET_READ_ERROR;
+    iov.base = buf;
+    iov.len = length;
+    return iotx_mc_send_iov(c, &iov, 1, time);
+}
 
-        if (++len > MAX_NO_OF_REMAINING_LENGTH_BYTES) {
-            return MQTTPACKET_READ_ERROR; /* bad data */
+/* queue the frame serialized in send buffer, or send it at once if queue is full, lock_write_buf must be held */
+static int iotx_mc_queue_packet(iotx_mc_client_t *c, int length, iotx_time_t *time)
+{
+#if WITH_MQTT_TX_QUEUE
+    char *frame = NULL;
+
+    if (iotx_mc_tx_queue_room(c, length)) {
+#if WITH_MQTT_DYN_BUF
+        /* send buffer is allocated per packet, take it over */
+        frame = c->buf_send;
+        c->buf_send = NULL;
+        c->buf_size_send = 0;
+#else
+        frame = mqtt_malloc(length);
+        if (frame != NULL) {
+            memcpy(frame, c->buf_send, length);
         }
-
-        rc = c->ipstack.read(&c->ipstack, &i, 1, timeout == 0 ? 1 : timeout);
-        if (rc <= STATE_SUCCESS) {
-            return STATE_SYS_DEPEND_NWK_CLOSE;
+#endif
+        if (frame != NULL) {
+            iotx_mc_tx_queue_add(c, frame, length);
+            return STATE_SUCCESS;
         }
+    }
+#endif
 
-        *value += (i & 127) * multiplier;
-        multiplier *= 128;
-    } while ((i & 128) != 0);
-
-    return len;
+    return iotx_mc_send_packet(c, c->buf_send, length, time);
 }
 
-static int _handle_event(iotx_mqtt_event_handle_pt handle, iotx_mc_client_t *c, iotx_mqtt_event_msg_pt msg)
+/* send frames in outbound queue, only if its deadline expired when 'due_only' is set */
+static int iotx_mc_tx_queue_flush(iotx_mc_client_t *c, int due_only)
 {
-    if (handle == NULL || handle->h_fp == NULL) {
-        return STATE_USER_INPUT_INVALID;
+    int rc = STATE_SUCCESS;
+#if WITH_MQTT_TX_QUEUE
+    iotx_time_t timer;
+
+    HAL_MutexLock(c->lock_write_buf);
+    if (c->tx_queue_num > 0 && (!due_only || utils_time_is_expired(&c->tx_queue_time))) {
+        iotx_time_init(&timer);
+        utils_time_countdown_ms(&timer, c->request_timeout_ms);
+        rc = iotx_mc_send_iov(c, NULL, 0, &timer);
     }
+    HAL_MutexUnlock(c->lock_write_buf);
 
-    _in_yield_cb = 1;
-    handle->h_fp(handle->pcontext, c, msg);
-    _in_yield_cb = 0;
-    return STATE_SUCCESS;
+    if (rc < STATE_SUCCESS) {
+        mqtt_err("flush outbound queue failed, rc = %d", rc);
+        iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+    }
+#endif
+    return rc;
 }
 
-static int iotx_mc_read_packet(iotx_mc_client_t *c, iotx_time_t *timer, unsigned int *packet_type)
+#if WITH_MQTT_V5
+static uint32_t _topic_alias_hash(const char *topic, uint16_t len)
 {
-    MQTTHeader header = {0};
-    int len = 0;
-    int rem_len = 0;
-    int rc = 0;
-    unsigned int left_t = 0;
+    uint32_t hash = 2166136261u;    /* FNV-1a */
+    uint16_t idx;
 
-    if (!c || !timer || !packet_type) {
+    for (idx = 0; idx < len; idx++) {
+        hash = (hash ^ (uint8_t)topic[idx]) * 16777619u;
+    }
+    return hash;
+}
+
+static void _topic_alias_clear(iotx_mc_topic_alias_t *alias)
+{
+#ifdef PLATFORM_HAS_DYNMEM
+    if (alias->topic != NULL) {
+        mqtt_free(alias->topic);
+    }
+#endif
+    alias->len = 0;
+}
+
+static int _topic_alias_set(iotx_mc_topic_alias_t *alias, const char *topic, uint16_t len, uint32_t hash)
+{
+    _topic_alias_clear(alias);
+#ifdef PLATFORM_HAS_DYNMEM
+    alias->topic = mqtt_malloc(len);
+    if (alias->topic == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+#else
+    if (len > CONFIG_MQTT_TOPIC_MAXLEN) {
+        return STATE_MQTT_TOPIC_BUF_TOO_SHORT;
+    }
+#endif
+    memcpy(alias->topic, topic, len);
+    alias->hash = hash;
+    alias->len = len;
+    return STATE_SUCCESS;
+}
+
+/* topic aliases only live as long as one network connection, forget them all at (re)connect */
+static void iotx_mc_topic_alias_reset(iotx_mc_client_t *c, uint16_t tx_max)
+{
+    int idx;
+
+    HAL_MutexLock(c->lock_list_pub);
+    for (idx = 0; idx < IOTX_MC_TOPIC_ALIAS_MAX; idx++) {
+        _topic_alias_clear(&c->topic_alias_tx[idx]);
+    }
+    c->topic_alias_tx_max = (tx_max < IOTX_MC_TOPIC_ALIAS_MAX) ? tx_max : IOTX_MC_TOPIC_ALIAS_MAX;
+    c->topic_alias_tx_next = 0;
+    HAL_MutexUnlock(c->lock_list_pub);
+
+    for (idx = 0; idx < IOTX_MC_TOPIC_ALIAS_MAX; idx++) {
+        _topic_alias_clear(&c->topic_alias_rx[idx]);
+    }
+}
+
+/*
+ * Topic alias of outbound PUBLISH, must be called with lock_list_pub held until the packet is sent or queued.
+ * Topic name is emptied if server already knows its alias, otherwise a new alias is announced along with it.
+ */
+static void iotx_mc_topic_alias_tx(iotx_mc_client_t *c, MQTTString *topic, MQTTProperties *props)
+{
+    iotx_mc_topic_alias_t *alias = NULL;
+    uint16_t idx, len, unused;
+    uint32_t hash;
+
+    if (c->topic_alias_tx_max == 0) {
+        return;
+    }
+
+    len = strlen(topic->cstring);
+    hash = _topic_alias_hash(topic->cstring, len);
+    unused = c->topic_alias_tx_max;
+    for (idx = 0; idx < c->topic_alias_tx_max; idx++) {
+        alias = &c->topic_alias_tx[idx];
+        if (alias->len == len && alias->hash == hash && memcmp(alias->topic, topic->cstring, len) == 0) {
+            props->topicAlias = idx + 1;
+            topic->cstring = "";
+            return;
+        }
+        if (alias->len == 0 && unused == c->topic_alias_tx_max) {
+            unused = idx;
+        }
+    }
+
+    /* all aliases are used, reassign them in turn */
+    if (unused == c->topic_alias_tx_max) {
+        unused = c->topic_alias_tx_next;
+        c->topic_alias_tx_next = (c->topic_alias_tx_next + 1) % c->topic_alias_tx_max;
+    }
+    if (_topic_alias_set(&c->topic_alias_tx[unused], topic->cstring, len, hash) == STATE_SUCCESS) {
+        props->topicAlias = unused + 1;
+    }
+}
+
+/* forget outbound alias of a PUBLISH which was not sent, so that its topic name is announced again */
+static void iotx_mc_topic_alias_tx_abort(iotx_mc_client_t *c, MQTTProperties *props)
+{
+    if (props->topicAlias > 0) {
+        _topic_alias_clear(&c->topic_alias_tx[props->topicAlias - 1]);
+    }
+}
+
+/* resolve topic name of inbound PUBLISH from its topic alias, or remember the alias if topic name is given */
+static int iotx_mc_topic_alias_rx(iotx_mc_client_t *c, MQTTString *topic, MQTTProperties *props)
+{
+    iotx_mc_topic_alias_t *alias = NULL;
+    int rc;
+
+    if (props->topicAlias == 0) {
+        return STATE_SUCCESS;
+    }
+    if (props->topicAlias > IOTX_MC_TOPIC_ALIAS_MAX) {
+        mqtt_err("topic alias %d exceeds maximum %d", props->topicAlias, IOTX_MC_TOPIC_ALIAS_MAX);
+        return STATE_MQTT_DESERIALIZE_PUB_ERROR;
+    }
+
+    alias = &c->topic_alias_rx[props->topicAlias - 1];
+    if (topic->lenstring.len > 0) {
+        rc = _topic_alias_set(alias, topic->lenstring.data, topic->lenstring.len,
+                              _topic_alias_hash(topic->lenstring.data, topic->lenstring.len));
+        if (rc < STATE_SUCCESS) {
+            mqtt_err("topic alias %d not saved, rc = %d", props->topicAlias, rc);
+        }
+        return STATE_SUCCESS;
+    }
+
+    if (alias->len == 0) {
+        mqtt_err("unknown topic alias %d", props->topicAlias);
+        return STATE_MQTT_DESERIALIZE_PUB_ERROR;
+    }
+    topic->lenstring.data = alias->topic;
+    topic->lenstring.len = alias->len;
+    return STATE_SUCCESS;
+}
+#endif
+
+int MQTTConnect(iotx_mc_client_t *pClient)
+{
+    MQTTPacket_connectData *pConnectParams;
+    iotx_time_t connectTimer;
+    int len = 0, res = 0;
+#if WITH_MQTT_V5
+    MQTTProperties props = MQTTProperties_initializer;
+
+    props.topicAliasMaximum = IOTX_MC_TOPIC_ALIAS_MAX;
+#if WITH_MQTT_SESSION_RESUME
+    /* MQTT 5.0 server ends session at disconnect without it, so there would be nothing to resume */
+    props.sessionExpiryInterval = IOTX_MC_SESSION_EXPIRY_S;
+#endif
+#endif
+
+    if (!pClient) {
         return STATE_USER_INPUT_INVALID;
     }
+
+    pConnectParams = &pClient->connect_data;
+    HAL_MutexLock(pClient->lock_write_buf);
+
+#if WITH_MQTT_TX_QUEUE
+    /* frames queued for the previous connection must not go before CONNECT */
+    iotx_mc_tx_queue_drop(pClient);
+#endif
+
+    len = _get_connect_length(pConnectParams);
+
+    res = _alloc_send_buffer(pClient, len);
+    if (res < STATE_SUCCESS) {
+        HAL_MutexUnlock(pClient->lock_write_buf);
+        return res;
+    }
+
+#if WITH_MQTT_V5
+    len = MQTTV5Serialize_connect((unsigned char *)pClient->buf_send, pClient->buf_size_send, pConnectParams, &props);
+#else
+    len = MQTTSerialize_connect((unsigned char *)pClient->buf_send, pClient->buf_size_send, pConnectParams);
+#endif
+    if (len <= 0) {
+        _reset_send_buffer(pClient);
+        HAL_MutexUnlock(pClient->lock_write_buf);
+        return STATE_MQTT_SERIALIZE_CONN_ERROR;
+    }
+
+    /* send the connect packet */
+    iotx_time_init(&connectTimer);
+    utils_time_countdown_ms(&connectTimer, pClient->request_timeout_ms);
+    res = iotx_mc_send_packet(pClient, pClient->buf_send, len, &connectTimer);
+    if (res < STATE_SUCCESS) {
+        _reset_send_buffer(pClient);
+        HAL_MutexUnlock(pClient->lock_write_buf);
+        return res;
+    }
+    _reset_send_buffer(pClient);
+    HAL_MutexUnlock(pClient->lock_write_buf);
+    return STATE_SUCCESS;
+}
+
+/* decode fixed header from buffered bytes: 1, length of packet is known; 0, need more bytes; < 0, bad data */
+static int iotx_mc_decode_packet(iotx_mc_client_t *c, uint32_t *frame_len)
+{
+    unsigned char i;
+    uint32_t pos = 1;
+    uint32_t rem_len = 0;
+    uint32_t multiplier = 1;
+
+    if (!c || !frame_len) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    do {
+        if (pos >= MQTT_FIXED_HEADER_MAX_LEN) {
+            return MQTTPACKET_READ_ERROR; /* bad data */
+        }
+
+        if (pos >= c->rx_len) {
+            return 0;
+        }
+
+        i = (unsigned char)c->buf_read[pos++];
+        rem_len += (i & 127) * multiplier;
+        multiplier *= 128;
+    } while ((i & 128) != 0);
+
+    *frame_len = pos + rem_len;
+    return 1;
+}
+
+/* check whether a complete packet is already in read buffer */
+static int iotx_mc_recv_buffered(iotx_mc_client_t *c)
+{
+    uint32_t frame_len = 0;
+    int buffered = 0;
+
     HAL_MutexLock(c->lock_read_buf);
-    rc = _alloc_recv_buffer(c, 0);
-    if (rc < 0) {
-        HAL_MutexUnlock(c->lock_read_buf);
+    if (c->rx_len > 0 && iotx_mc_decode_packet(c, &frame_len) == 1 && c->rx_len >= frame_len) {
+        buffered = 1;
+    }
+    HAL_MutexUnlock(c->lock_read_buf);
+
+    return buffered;
+}
+
+/* read at least @need bytes into read buffer, along with what network layer already holds */
+static int iotx_mc_recv_fill(iotx_mc_client_t *c, uint32_t need, iotx_time_t *timer)
+{
+    int rc = 0;
+    int avail = 0;
+    uint32_t want = need;
+    uint32_t limit = _get_recv_buffer_limit(c);
+    unsigned int left_t = 0;
+
+    if (c->ipstack.pending != NULL) {
+        avail = c->ipstack.pending(&c->ipstack);
+    }
+    if (avail > (int)want) {
+        want = avail;
+    }
+    if (c->rx_len + want > limit) {
+        want = (limit > c->rx_len + need) ? (limit - c->rx_len) : need;
+    }
+
+    rc = _alloc_recv_buffer(c, c->rx_len + want);
+    if (rc < STATE_SUCCESS) {
         return rc;
     }
-    /* 1. read the header byte.  This has the packet type in it */
+    if (c->rx_len + want > c->buf_size_read) {
+        want = c->buf_size_read - c->rx_len;
+    }
+
     left_t = iotx_time_left(timer);
     left_t = (left_t == 0) ? 1 : left_t;
-    rc = c->ipstack.read(&c->ipstack, c->buf_read, 1, left_t);
-    if (0 == rc) { /* timeout */
-        *packet_type = 0;
-        HAL_MutexUnlock(c->lock_read_buf);
-        return STATE_SUCCESS;
-    } else if (rc < STATE_SUCCESS) {
-        HAL_MutexUnlock(c->lock_read_buf);
+    rc = c->ipstack.read(&c->ipstack, c->buf_read + c->rx_len, want, left_t);
+    if (rc < 0) {
+        c->rx_more = 0;
         return STATE_SYS_DEPEND_NWK_CLOSE;
     }
 
-    len = 1;
+    /* socket events are edge triggered, a short read is the only proof that socket is empty */
+    c->rx_more = ((uint32_t)rc == want) ? 1 : 0;
+    c->rx_len += rc;
+    return rc;
+}
+
+static int _handle_event(iotx_mqtt_event_handle_pt handle, iotx_mc_client_t *c, iotx_mqtt_event_msg_pt msg)
+{
+    if (handle == NULL || handle->h_fp == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    _in_yield_cb = 1;
+    handle->h_fp(handle->pcontext, c, msg);
+    _in_yield_cb = 0;
+    return STATE_SUCCESS;
+}
+
+/* callback run by dispatch worker is not inside yield, so that it may wait for SUBACK */
+static int _handle_publish(iotx_mqtt_event_handle_pt handle, iotx_mc_client_t *c, iotx_mqtt_event_msg_pt msg,
+                           int in_yield)
+{
+    if (in_yield) {
+        return _handle_event(handle, c, msg);
+    }
+    if (handle == NULL || handle->h_fp == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    handle->h_fp(handle->pcontext, c, msg);
+    return STATE_SUCCESS;
+}
+
+/* skip a packet which could not fit in read buffer */
+static int iotx_mc_discard_packet(iotx_mc_client_t *c, uint32_t frame_len, iotx_time_t *timer)
+{
+    int needReadLen;
+    uint32_t rem_len = 0;
+    unsigned int left_t = 0;
+
+    iotx_state_event(ITE_STATE_MQTT_COMM, STATE_MQTT_RX_BUFFER_TOO_SHORT, "");
+    mqtt_err("mqtt read buffer is too short, mqttReadBufLen : %u, packetLen : %u", _get_recv_buffer_limit(c), frame_len);
+
+    /* packet never fits in read buffer, so part of it is buffered at most */
+    rem_len = frame_len - c->rx_len;
+    c->rx_len = 0;
+    c->rx_frame_len = 0;
+    if (_alloc_recv_buffer(c, _get_recv_buffer_limit(c)) < STATE_SUCCESS) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
 
-    /* 2. read the remaining length.  This is variable in itself */
     left_t = iotx_time_left(timer);
     left_t = (left_t == 0) ? 1 : left_t;
-    if ((rc = iotx_mc_decode_packet(c, &rem_len, left_t)) < 0) {
-        HAL_MutexUnlock(c->lock_read_buf);
-        return rc;
+    while (rem_len) {
+        needReadLen = (rem_len > c->buf_size_read) ? c->buf_size_read : rem_len;
+        mqtt_info("read len:%d\n", needReadLen);
+        if (c->ipstack.read(&c->ipstack, c->buf_read, needReadLen, left_t) != needReadLen) {
+            mqtt_err("mqtt read error");
+            return STATE_SYS_DEPEND_NWK_READ_ERROR;
+        }
+        rem_len -= needReadLen;
     }
 
-    len += MQTTPacket_encode((unsigned char *)c->buf_read + 1,
-                             rem_len); /* put the original remaining length back into the buffer */
+    return STATE_SUCCESS;
+}
 
-    rc = _alloc_recv_buffer(c, rem_len + len);
+#if WITH_MQTT_STREAM_RX
+static int MQTTPuback(iotx_mc_client_t *c, unsigned int msgId, enum msgTypes type);
+static int iotx_mc_stream_publish(iotx_mc_client_t *c, iotx_time_t *timer, int *ack_qos, uint16_t *ack_id);
+#endif
+
+static int iotx_mc_read_packet(iotx_mc_client_t *c, iotx_time_t *timer, unsigned int *packet_type)
+{
+    MQTTHeader header = {0};
+    uint32_t frame_len = 0;
+    uint32_t need = 0;
+    int read_cnt = 0;
+    int rc = 0;
+
+    if (!c || !timer || !packet_type) {
+        return STATE_USER_INPUT_INVALID;
+    }
+    *packet_type = 0;
+
+    HAL_MutexLock(c->lock_read_buf);
+    rc = _alloc_recv_buffer(c, MQTT_FIXED_HEADER_MIN_LEN);
     if (rc < 0) {
         HAL_MutexUnlock(c->lock_read_buf);
         return rc;
     }
+    /* previous packet should have been consumed, make sure not to hand it out again */
+    _consume_recv_buffer(c);
 
-    /* Check if the received data length exceeds mqtt read buffer length */
-    if ((rem_len > 0) && ((rem_len + len) > c->buf_size_read)) {
-        int needReadLen;
+    for (;;) {
+        /* 1. decode the fixed header from what is buffered */
+        rc = (c->rx_len > 0) ? iotx_mc_decode_packet(c, &frame_len) : 0;
+        if (rc < 0) {
+            mqtt_err("invalid remaining length, drop connection");
+            _reset_recv_buffer(c);
+            HAL_MutexUnlock(c->lock_read_buf);
+            return STATE_SYS_DEPEND_NWK_CLOSE;
+        }
 
-        iotx_state_event(ITE_STATE_MQTT_COMM, STATE_MQTT_RX_BUFFER_TOO_SHORT, "");
-        mqtt_err("mqtt read buffer is too short, mqttReadBufLen : %u, remainDataLen : %d", c->buf_size_read, rem_len);
-        *packet_type = 0;
-        left_t = iotx_time_left(timer);
-        left_t = (left_t == 0) ? 1 : left_t;
-        do {
-            needReadLen = (rem_len > c->buf_size_read) ? c->buf_size_read : rem_len;
-            mqtt_info("read len:%d\n", needReadLen);
-            if (c->ipstack.read(&c->ipstack, c->buf_read, needReadLen, left_t) != needReadLen) {
-                mqtt_err("mqtt read error");
+        if (rc == 1) {
+            /* 2. check if the packet length exceeds mqtt read buffer length */
+            if (frame_len > _get_recv_buffer_limit(c)) {
+#if WITH_MQTT_STREAM_RX
+                int ack_qos = 0;
+                uint16_t ack_id = 0;
+
+                rc = iotx_mc_stream_publish(c, timer, &ack_qos, &ack_id);
+                if (rc != STATE_MQTT_RX_BUFFER_TOO_SHORT) {
+                    HAL_MutexUnlock(c->lock_read_buf);
+                    if (rc == 1) {
+                        iotx_mc_keepalive_rx(c);
+                    }
+                    if (rc == 1 && ack_qos == IOTX_MQTT_QOS1) {
+                        rc = MQTTPuback(c, ack_id, PUBACK);
+                    } else if (rc == 1 && ack_qos == IOTX_MQTT_QOS2) {
+                        rc = MQTTPuback(c, ack_id, PUBREC);
+                    }
+                    return (rc < STATE_SUCCESS) ? rc : STATE_SUCCESS;
+                }
+#endif
+                rc = iotx_mc_discard_packet(c, frame_len, timer);
                 HAL_MutexUnlock(c->lock_read_buf);
-                return STATE_SYS_DEPEND_NWK_READ_ERROR;
-            }
-            rem_len -= needReadLen;
-        } while (rem_len);
+                if (rc < STATE_SUCCESS) {
+                    return rc;
+                }
+                iotx_mc_keepalive_rx(c);
 
-        HAL_MutexUnlock(c->lock_read_buf);
-        if (NULL != c->handle_event.h_fp) {
-            iotx_mqtt_event_msg_t msg;
+                if (NULL != c->handle_event.h_fp) {
+                    iotx_mqtt_event_msg_t msg;
 
-            msg.event_type = IOTX_MQTT_EVENT_BUFFER_OVERFLOW;
-            msg.msg = "mqtt read buffer is too short";
-            _handle_event(&c->handle_event, c, &msg);
-        }
+                    msg.event_type = IOTX_MQTT_EVENT_BUFFER_OVERFLOW;
+                    msg.msg = "mqtt read buffer is too short";
+                    _handle_event(&c->handle_event, c, &msg);
+                }
 
-        return STATE_SUCCESS;
+                return STATE_SUCCESS;
+            }
 
-    }
+            if (c->rx_len >= frame_len) {
+                break;
+            }
+            need = frame_len - c->rx_len;
+        } else {
+            need = (c->rx_len == 0) ? MQTT_FIXED_HEADER_MIN_LEN : 1;
+        }
 
-    /* 3. read the rest of the buffer using a callback to supply the rest of the data */
-    left_t = iotx_time_left(timer);
-    left_t = (left_t == 0) ? 1 : left_t;
+        /* 3. pull more bytes, leave partial packet buffered for next round on timeout */
+        if (read_cnt > 0 && utils_time_is_expired(timer)) {
+            HAL_MutexUnlock(c->lock_read_buf);
+            return STATE_SUCCESS;
+        }
 
-    rc = c->ipstack.read(&c->ipstack, c->buf_read + len, rem_len, left_t);
-    if (rem_len > 0) {
+        rc = iotx_mc_recv_fill(c, need, timer);
+        read_cnt++;
         if (rc < 0) {
+            _reset_recv_buffer(c);
             HAL_MutexUnlock(c->lock_read_buf);
-            return STATE_SYS_DEPEND_NWK_CLOSE;
-        } else if (rc != rem_len) {
+            return rc;
+        } else if (rc == 0) { /* timeout */
             HAL_MutexUnlock(c->lock_read_buf);
-            return STATE_MQTT_PACKET_READ_ERROR;
+            return STATE_SUCCESS;
         }
     }
 
+    c->rx_frame_len = frame_len;
+    if (frame_len < c->buf_size_read) {
+        c->rx_frame_next = c->buf_read[frame_len];
+        c->buf_read[frame_len] = '\0';
+    }
+
     header.byte = c->buf_read[0];
     *packet_type = MQTT_HEADER_GET_TYPE(header.byte);
-    if ((len + rem_len) < c->buf_size_read) {
-        c->buf_read[len + rem_len] = '\0';
-    }
     HAL_MutexUnlock(c->lock_read_buf);
     return STATE_SUCCESS;
 }
@@ -619,15 +1371,54 @@ static int iotx_mc_handle_recv_CONNACK(iotx_mc_client_t *c)
     int rc = STATE_SUCCESS;
     unsigned char connack_rc = 255;
     char sessionPresent = 0;
+#if WITH_MQTT_V5
+    MQTTProperties props;
+#endif
 
     if (!c) {
         return STATE_USER_INPUT_INVALID;
     }
 
+#if WITH_MQTT_V5
+    if (MQTTV5Deserialize_connack((unsigned char *)&sessionPresent, &connack_rc, &props, (unsigned char *)c->buf_read,
+                                  c->buf_size_read) != 1) {
+        return STATE_MQTT_DESERIALIZE_CONNACK_ERROR;
+    }
+
+    /* map MQTT 5.0 reason codes onto 3.1.1 return codes */
+    switch (connack_rc) {
+        case 0x00:
+            iotx_mc_topic_alias_reset(c, props.topicAliasMaximum);
+            connack_rc = IOTX_MC_CONNECTION_ACCEPTED;
+            break;
+        case 0x84:
+            connack_rc = IOTX_MC_CONNECTION_REFUSED_UNACCEPTABLE_PROTOCOL_VERSION;
+            break;
+        case 0x85:
+            connack_rc = IOTX_MC_CONNECTION_REFUSED_IDENTIFIER_REJECTED;
+            break;
+        case 0x86:
+            connack_rc = IOTX_MC_CONNECTION_REFUSED_BAD_USERDATA;
+            break;
+        case 0x87:
+            connack_rc = IOTX_MC_CONNECTION_REFUSED_NOT_AUTHORIZED;
+            break;
+        case 0x88:
+        case 0x89:
+            connack_rc = IOTX_MC_CONNECTION_REFUSED_SERVER_UNAVAILABLE;
+            break;
+        default:
+            break;
+    }
+#else
     if (MQTTDeserialize_connack((unsigned char *)&sessionPresent, &connack_rc, (unsigned char *)c->buf_read,
                                 c->buf_size_read) != 1) {
         return STATE_MQTT_DESERIALIZE_CONNACK_ERROR;
     }
+#endif
+#if WITH_MQTT_SESSION_RESUME
+    c->session_present = (connack_rc == IOTX_MC_CONNECTION_ACCEPTED && sessionPresent) ? 1 : 0;
+#endif
 
     switch (connack_rc) {
         case IOTX_MC_CONNECTION_ACCEPTED:
@@ -688,11 +1479,17 @@ static int iotx_mc_wait_CONNACK(iotx_mc_client_t *c)
             HAL_MutexUnlock(c->lock_read_buf);
             return STATE_SYS_DEPEND_NWK_CLOSE;
         }
+
+        if (packetType != CONNACK) {
+            HAL_MutexLock(c->lock_read_buf);
+            _consume_recv_buffer(c);
+            HAL_MutexUnlock(c->lock_read_buf);
+        }
     } while (packetType != CONNACK);
     HAL_MutexLock(c->lock_read_buf);
 
     rc = iotx_mc_handle_recv_CONNACK(c);
-    _reset_recv_buffer(c);
+    _consume_recv_buffer(c);
     HAL_MutexUnlock(c->lock_read_buf);
 
     return rc;
@@ -711,19 +1508,32 @@ static int _mqtt_connect(void *client)
         return STATE_USER_INPUT_INVALID;
     }
     userKeepAliveInterval = pClient->connect_data.keepAliveInterval;
-    pClient->connect_data.keepAliveInterval = (userKeepAliveInterval * 2);
-    if(pClient->connect_data.keepAliveInterval > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX) {
-       pClient->connect_data.keepAliveInterval = CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX;
-    }
-    mqtt_info("connect params: MQTTVersion=%d, clientID=%s, keepAliveInterval=%d, username=%s",
-              pClient->connect_data.MQTTVersion,
-              pClient->connect_data.clientID.cstring,
-              pClient->connect_data.keepAliveInterval,
-              pClient->connect_data.username.cstring);
+
+    /* bytes left from previous connection are meaningless */
+    HAL_MutexLock(pClient->lock_read_buf);
+    _reset_recv_buffer(pClient);
+    HAL_MutexUnlock(pClient->lock_read_buf);
 
     /* Establish TCP or TLS connection */
     do {
+        /* keepalive told to server is worked out for each CONNECT, since user value is restored after it is sent */
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+        /* server should wait for whatever idle time is probed */
+        pClient->connect_data.keepAliveInterval = CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX;
+#else
+        pClient->connect_data.keepAliveInterval = (userKeepAliveInterval * 2);
+        if (pClient->connect_data.keepAliveInterval > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX) {
+            pClient->connect_data.keepAliveInterval = CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX;
+        }
+#endif
+        mqtt_info("connect params: MQTTVersion=%d, clientID=%s, keepAliveInterval=%d, username=%s",
+                  pClient->connect_data.MQTTVersion,
+                  pClient->connect_data.clientID.cstring,
+                  pClient->connect_data.keepAliveInterval,
+                  pClient->connect_data.username.cstring);
+
         rc = MQTTConnect(pClient);
+        pClient->keepalive_server_ms = pClient->connect_data.keepAliveInterval * 1000;
         pClient->connect_data.keepAliveInterval = userKeepAliveInterval;
 
         if (rc < STATE_SUCCESS) {
@@ -760,44 +1570,25 @@ static int _mqtt_connect(void *client)
     }
 
     pClient->keepalive_probes = 0;
+    iotx_time_start(&pClient->last_rx_time);
 
     iotx_mc_set_client_state(pClient, IOTX_MC_STATE_CONNECTED);
 
-    utils_time_countdown_ms(&pClient->next_ping_time, pClient->connect_data.keepAliveInterval * 1000);
-
     mqtt_info("mqtt connect success!");
 
     return STATE_SUCCESS;
 }
 
 #if !WITH_MQTT_ONLY_QOS0
-static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short msgId, iotx_mc_pub_info_t **node)
-{
 #ifdef PLATFORM_HAS_DYNMEM
-    int list_number;
+/* add node holding 'buf', followed by 'payload' if it is referenced, must be called with lock_list_pub held */
+static int _pub_info_add(iotx_mc_client_t *c, const char *buf, int len, unsigned short msgId,
+                         iotx_mc_payload_t *payload, iotx_mc_pub_info_t **node)
+{
     iotx_mc_pub_info_t *repubInfo;
-#else
-    int idx;
-#endif
-
-    if (!c || !node) {
-        return STATE_USER_INPUT_INVALID;
-    }
-
-    if ((len < 0) || (len > c->buf_size_send)) {
-#ifndef PLATFORM_HAS_DYNMEM
-        if (len >= c->buf_size_send) {
-            mqtt_err("IOTX_MC_TX_MAX_LEN is too short, len: %d, IOTX_MC_TX_MAX_LEN: %d", len, IOTX_MC_TX_MAX_LEN);
-        }
-#endif
-        return STATE_MQTT_TX_BUFFER_TOO_SHORT;
-    }
-
-#ifdef PLATFORM_HAS_DYNMEM
-    list_number = list_entry_number(&c->list_pub_wait_ack);
 
-    if (list_number >= IOTX_MC_REPUB_NUM_MAX) {
-        mqtt_err("more than %u elements in republish list. List overflow!", list_number);
+    if (c->pub_wait_num >= IOTX_MC_REPUB_NUM_MAX) {
+        mqtt_err("more than %u elements in republish list. List overflow!", c->pub_wait_num);
         return STATE_MQTT_QOS1_REPUB_EXCEED_MAX;
     }
 
@@ -813,13 +1604,44 @@ static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short
     iotx_time_start(&repubInfo->pub_start_time);
     repubInfo->buf = (unsigned char *)repubInfo + sizeof(iotx_mc_pub_info_t);
 
-    memcpy(repubInfo->buf, c->buf_send, len);
+    memcpy(repubInfo->buf, buf, len);
+    repubInfo->payload = payload;
+    if (payload != NULL) {
+        payload->ref++;
+    }
     INIT_LIST_HEAD(&repubInfo->linked_list);
 
+    /* republish time of new node is the latest, so list stays in order of it */
     list_add_tail(&repubInfo->linked_list, &c->list_pub_wait_ack);
+    _pub_index_insert(c, repubInfo);
+    c->pub_wait_num++;
 
     *node = repubInfo;
     return STATE_SUCCESS;
+}
+#endif
+
+static int iotx_mc_push_pubInfo_to(iotx_mc_client_t *c, int len, unsigned short msgId, iotx_mc_pub_info_t **node)
+{
+#ifndef PLATFORM_HAS_DYNMEM
+    int idx;
+#endif
+
+    if (!c || !node) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    if ((len < 0) || (len > c->buf_size_send)) {
+#ifndef PLATFORM_HAS_DYNMEM
+        if (len >= c->buf_size_send) {
+            mqtt_err("IOTX_MC_TX_MAX_LEN is too short, len: %d, IOTX_MC_TX_MAX_LEN: %d", len, IOTX_MC_TX_MAX_LEN);
+        }
+#endif
+        return STATE_MQTT_TX_BUFFER_TOO_SHORT;
+    }
+
+#ifdef PLATFORM_HAS_DYNMEM
+    return _pub_info_add(c, c->buf_send, len, msgId, NULL, node);
 #else
     for (idx = 0; idx < IOTX_MC_REPUB_NUM_MAX; idx++) {
         if (c->list_pub_wait_ack[idx].used == 0) {
@@ -844,16 +1666,17 @@ static int iotx_mc_mask_pubInfo_from(iotx_mc_client_t *c, uint16_t msgId)
 {
 #ifdef PLATFORM_HAS_DYNMEM
     iotx_mc_pub_info_t *node = NULL;
+    int idx = 0;
 
     if (!c) {
         return STATE_USER_INPUT_INVALID;
     }
 
     HAL_MutexLock(c->lock_list_pub);
-    list_for_each_entry(node, &c->list_pub_wait_ack, linked_list, iotx_mc_pub_info_t) {
-        if (node->msg_id == msgId) {
-            node->node_state = IOTX_MC_NODE_STATE_INVALID; /* mark as invalid node */
-        }
+    idx = _pub_index_find(c, msgId, NULL);
+    if (idx >= 0) {
+        node = c->pub_wait_index[idx];
+        iotx_mc_pub_info_release(c, node);
     }
     HAL_MutexUnlock(c->lock_list_pub);
 #else
@@ -869,7 +1692,7 @@ static int iotx_mc_mask_pubInfo_from(iotx_mc_client_t *c, uint16_t msgId)
     return STATE_SUCCESS;
 }
 
-static int MQTTRePublish(iotx_mc_client_t *c, char *buf, int len)
+static int MQTTRePublish(iotx_mc_client_t *c, hal_iovec_t *iov, int iovcnt)
 {
     iotx_time_t timer;
     iotx_time_init(&timer);
@@ -877,7 +1700,7 @@ static int MQTTRePublish(iotx_mc_client_t *c, char *buf, int len)
 
     HAL_MutexLock(c->lock_write_buf);
 
-    if (iotx_mc_send_packet(c, buf, len, &timer) != STATE_SUCCESS) {
+    if (iotx_mc_send_iov(c, iov, iovcnt, &timer) != STATE_SUCCESS) {
         HAL_MutexUnlock(c->lock_write_buf);
         return STATE_SYS_DEPEND_NWK_CLOSE;
     }
@@ -886,12 +1709,15 @@ static int MQTTRePublish(iotx_mc_client_t *c, char *buf, int len)
     return STATE_SUCCESS;
 }
 
-static int MQTTPubInfoProc(iotx_mc_client_t *pClient)
+/* republish QoS1 publishes which have waited for PUBACK too long, or all of them if 'resend_all' */
+static int MQTTPubInfoProc(iotx_mc_client_t *pClient, int resend_all)
 {
     int rc = 0;
     iotx_mc_state_t state = IOTX_MC_STATE_INVALID;
+    hal_iovec_t iov[2];
 #ifdef PLATFORM_HAS_DYNMEM
-    iotx_mc_pub_info_t *node = NULL, *next_node = NULL;
+    iotx_mc_pub_info_t *node = NULL;
+    uint32_t num = 0;
 #else
     int idx;
 #endif
@@ -902,27 +1728,41 @@ static int MQTTPubInfoProc(iotx_mc_client_t *pClient)
 
     HAL_MutexLock(pClient->lock_list_pub);
 #ifdef PLATFORM_HAS_DYNMEM
-    list_for_each_entry_safe(node, next_node, &pClient->list_pub_wait_ack, linked_list, iotx_mc_pub_info_t) {
-        /* remove invalid node */
-        if (IOTX_MC_NODE_STATE_INVALID == node->node_state) {
-            list_del(&node->linked_list);
-            mqtt_free(node);
-            continue;
-        }
-
+    /* acked nodes are removed at PUBACK, list is in order of republish time, so only the head may be due */
+    num = pClient->pub_wait_num;
+    while (!list_empty(&pClient->list_pub_wait_ack)) {
         state = iotx_mc_get_client_state(pClient);
         if (state != IOTX_MC_STATE_CONNECTED) {
-            continue;
+            break;
         }
 
-        /* check the request if timeout or not */
-        if (utils_time_spend(&node->pub_start_time) <= (pClient->request_timeout_ms * 2)) {
-            continue;
+        node = list_first_entry(&pClient->list_pub_wait_ack, iotx_mc_pub_info_t, linked_list);
+
+        /* check the request if timeout or not, each node is moved to tail once it is resent */
+        if (resend_all ? (num-- == 0) :
+            (utils_time_spend(&node->pub_start_time) <= (pClient->request_timeout_ms * 2))) {
+            break;
         }
 
         /* If wait ACK timeout, republish */
-        rc = MQTTRePublish(pClient, (char *)node->buf, node->len);
+        MQTT_HEADER_SET_DUP(node->buf[0], 1);
+        iov[0].base = node->buf;
+        iov[0].len = node->len;
+        if (node->payload != NULL) {
+            iov[1].base = node->payload->data;
+            iov[1].len = node->payload->len;
+        }
         iotx_time_start(&node->pub_start_time);
+        list_del(&node->linked_list);
+        list_add_tail(&node->linked_list, &pClient->list_pub_wait_ack);
+#if WITH_MQTT_SUBMIT_QUEUE
+        /* nodes are only freed by yield, so publishers waiting on lock_list_pub needn't wait for socket */
+        HAL_MutexUnlock(pClient->lock_list_pub);
+        rc = MQTTRePublish(pClient, iov, (node->payload != NULL) ? 2 : 1);
+        HAL_MutexLock(pClient->lock_list_pub);
+#else
+        rc = MQTTRePublish(pClient, iov, (node->payload != NULL) ? 2 : 1);
+#endif
 
         if (STATE_SYS_DEPEND_NWK_CLOSE == rc) {
             iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED);
@@ -946,12 +1786,16 @@ static int MQTTPubInfoProc(iotx_mc_client_t *pClient)
         }
 
         /* check the request if timeout or not */
-        if (utils_time_spend(&pClient->list_pub_wait_ack[idx].pub_start_time) <= (pClient->request_timeout_ms * 2)) {
+        if (!resend_all &&
+            utils_time_spend(&pClient->list_pub_wait_ack[idx].pub_start_time) <= (pClient->request_timeout_ms * 2)) {
             continue;
         }
 
         /* If wait ACK timeout, republish */
-        rc = MQTTRePublish(pClient, (char *)pClient->list_pub_wait_ack[idx].buf, pClient->list_pub_wait_ack[idx].len);
+        MQTT_HEADER_SET_DUP(pClient->list_pub_wait_ack[idx].buf[0], 1);
+        iov[0].base = pClient->list_pub_wait_ack[idx].buf;
+        iov[0].len = pClient->list_pub_wait_ack[idx].len;
+        rc = MQTTRePublish(pClient, iov, 1);
         iotx_time_start(&pClient->list_pub_wait_ack[idx].pub_start_time);
 
         if (STATE_SYS_DEPEND_NWK_CLOSE == rc) {
@@ -1032,11 +1876,57 @@ static void _iotx_mqtt_event_handle_sub(void *pcontext, void *pclient, iotx_mqtt
     HAL_MutexUnlock(client->lock_generic);
 }
 
+/* pass return code of each topic in SUBACK to multi-topic subscribe waiting for it */
+static void _iotx_mqtt_sub_sync_result(iotx_mc_client_t *c, uintptr_t packet_id, int *grantedQoS, int count)
+{
+    mqtt_sub_sync_node_t *found = NULL;
+    int i;
+#ifdef PLATFORM_HAS_DYNMEM
+    mqtt_sub_sync_node_t *node = NULL;
+#else
+    int idx;
+#endif
+
+    HAL_MutexLock(c->lock_generic);
+#ifdef PLATFORM_HAS_DYNMEM
+    list_for_each_entry(node, &c->list_sub_sync_ack, linked_list, mqtt_sub_sync_node_t) {
+        if (node->packet_id == packet_id && node->entry != NULL) {
+            found = node;
+            break;
+        }
+    }
+#else
+    for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
+        if (c->list_sub_sync_ack[idx].used && c->list_sub_sync_ack[idx].packet_id == packet_id &&
+            c->list_sub_sync_ack[idx].entry != NULL) {
+            found = &c->list_sub_sync_ack[idx];
+            break;
+        }
+    }
+#endif
+    if (found != NULL) {
+        for (i = 0; i < found->entry_num; i++) {
+            if (i >= count) {
+                found->entry[i].result = STATE_MQTT_DESERIALIZE_SUBACK_ERROR;
+            } else if ((uint8_t)grantedQoS[i] >= 0x80) {
+                found->entry[i].result = STATE_MQTT_SUB_REFUSED;
+            } else {
+                found->entry[i].result = grantedQoS[i];
+            }
+        }
+    }
+    HAL_MutexUnlock(c->lock_generic);
+}
+
+#if WITH_MQTT_SESSION_RESUME
+static int _mqtt_resub_suback(iotx_mc_client_t *c, uint16_t packet_id, int *grantedQoS, int count);
+#endif
+
 static int iotx_mc_handle_recv_SUBACK(iotx_mc_client_t *c)
 {
     unsigned short mypacketid;
     iotx_mqtt_event_msg_t msg;
-    int i = 0, count = 0, fail_flag = -1, j = 0;
+    int i = 0, count = 0, fail_flag = 0, j = 0;
     int grantedQoS[MUTLI_SUBSCIRBE_MAX];
     int rc;
 
@@ -1044,8 +1934,16 @@ static int iotx_mc_handle_recv_SUBACK(iotx_mc_client_t *c)
         return STATE_USER_INPUT_INVALID;
     }
 
+#if WITH_MQTT_V5
+    {
+        MQTTProperties props;
+        rc = MQTTV5Deserialize_suback(&mypacketid, &props, MUTLI_SUBSCIRBE_MAX, &count, grantedQoS,
+                                      (unsigned char *)c->buf_read, c->buf_size_read);
+    }
+#else
     rc = MQTTDeserialize_suback(&mypacketid, MUTLI_SUBSCIRBE_MAX, &count, grantedQoS, (unsigned char *)c->buf_read,
                                 c->buf_size_read);
+#endif
 
     if (rc < 0) {
         mqtt_err("Sub ack packet error, rc = MQTTDeserialize_suback() = %d", rc);
@@ -1059,12 +1957,17 @@ static int iotx_mc_handle_recv_SUBACK(iotx_mc_client_t *c)
         mqtt_debug("%16s[%02d] : %d", "Granted QoS", i, grantedQoS[i]);
     }
 
+#if WITH_MQTT_SESSION_RESUME
+    if (_mqtt_resub_suback(c, mypacketid, grantedQoS, count)) {
+        return STATE_SUCCESS;
+    }
+#endif
+
     for (j = 0; j <  count; j++) {
-        fail_flag = 0;
-        /* In negative case, grantedQoS will be 0xFFFF FF80, which means -128 */
-        if ((uint8_t)grantedQoS[j] == 0x80) {
+        /* In negative case, grantedQoS will be 0xFFFF FF80, which means -128, MQTT 5.0 has more failure codes above it */
+        if ((uint8_t)grantedQoS[j] >= 0x80) {
             fail_flag = 1;
-            mqtt_err("MQTT SUBSCRIBE failed, ack code is 0x80");
+            mqtt_err("MQTT SUBSCRIBE failed, ack code is 0x%02x", (uint8_t)grantedQoS[j]);
         }
     }
 
@@ -1076,6 +1979,7 @@ static int iotx_mc_handle_recv_SUBACK(iotx_mc_client_t *c)
         msg.event_type = IOTX_MQTT_EVENT_SUBCRIBE_SUCCESS;
     }
 
+    _iotx_mqtt_sub_sync_result(c, mypacketid, grantedQoS, count);
     _iotx_mqtt_event_handle_sub(c->handle_event.pcontext, c, &msg);
 
     if (NULL != c->handle_event.h_fp) {
@@ -1097,49 +2001,386 @@ static int iotx_mc_get_zip_topic(const char *path, int len, char outbuf[], int o
 
     utils_sha256((unsigned char *)path, (size_t)len, comp_data);
 
-    memcpy(outbuf, comp_data, outlen > MQTT_ZIP_PATH_DEFAULT_LEN ? MQTT_ZIP_PATH_DEFAULT_LEN : outlen);
-    return STATE_SUCCESS;
-}
+    memcpy(outbuf, comp_data, outlen > MQTT_ZIP_PATH_DEFAULT_LEN ? MQTT_ZIP_PATH_DEFAULT_LEN : outlen);
+    return STATE_SUCCESS;
+}
+#endif
+
+static char iotx_mc_is_topic_matched(char *topicFilter, MQTTString *topicName)
+{
+    char *curf;
+    char *curn;
+    char *curn_end;
+
+    if (!topicFilter || !topicName) {
+        return STATE_SUCCESS;
+    }
+
+    curf = topicFilter;
+    curn = topicName->lenstring.data;
+    curn_end = curn + topicName->lenstring.len;
+
+    while (*curf && curn < curn_end) {
+        if (*curn == '/' && *curf != '/') {
+            break;
+        }
+
+        if (*curf != '+' && *curf != '#' && *curf != *curn) {
+            break;
+        }
+
+        if (*curf == '+') {
+            /* skip until we meet the next separator, or end of string */
+            char *nextpos = curn + 1;
+            while (nextpos < curn_end && *nextpos != '/') {
+                nextpos = ++curn + 1;
+            }
+        } else if (*curf == '#') {
+            curn = curn_end - 1;    /* skip until end of string */
+        }
+        curf++;
+        curn++;
+    }
+
+    return (curn == curn_end) && (*curf == '\0');
+}
+
+#if WITH_MQTT_SUB_TRIE
+#define IOTX_MC_TOPIC_NODE_CHILD_INIT    (4)
+#define IOTX_MC_TOPIC_MATCH_STACK_NUM    (8)
+
+/* Handle matched by topic trie, copied so that callback may unsubscribe freely */
+typedef struct {
+    uint32_t                    sub_seq;
+    iotx_mqtt_event_handle_t    handle;
+#if WITH_MQTT_STREAM_RX
+    iotx_mqtt_chunk_handle_func_fpt chunk_fp;
+#endif
+} iotx_mc_topic_match_item_t;
+
+typedef struct {
+    iotx_mc_topic_match_item_t *items;
+    uint32_t                    num;
+    uint32_t                    cap;
+    iotx_mc_topic_match_item_t  stack[IOTX_MC_TOPIC_MATCH_STACK_NUM];
+} iotx_mc_topic_match_t;
+
+static int _topic_node_compare(iotx_mc_topic_node_t *node, const char *level, uint16_t level_len)
+{
+    int res = memcmp(node->level, level, node->level_len < level_len ? node->level_len : level_len);
+
+    if (res != 0) {
+        return res;
+    }
+    return (int)node->level_len - (int)level_len;
+}
+
+/* binary search literal children, return index of found child or -1 with insert position in pos */
+static int _topic_node_search(iotx_mc_topic_node_t *node, const char *level, uint16_t level_len, int *pos)
+{
+    int low = 0, high = (int)node->child_num - 1, mid = 0, res = 0;
+
+    while (low <= high) {
+        mid = (low + high) / 2;
+        res = _topic_node_compare(node->children[mid], level, level_len);
+        if (res == 0) {
+            return mid;
+        } else if (res < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    if (pos) {
+        *pos = low;
+    }
+    return -1;
+}
+
+static iotx_mc_topic_node_t *_topic_node_new(iotx_mc_topic_node_t *parent, const char *level, uint16_t level_len)
+{
+    iotx_mc_topic_node_t *node = mqtt_malloc(sizeof(iotx_mc_topic_node_t) + level_len);
+
+    if (node == NULL) {
+        return NULL;
+    }
+    memset(node, 0, sizeof(iotx_mc_topic_node_t) + level_len);
+    node->parent = parent;
+    node->level_len = level_len;
+    if (level_len) {
+        memcpy(node->level, level, level_len);
+    }
+    INIT_LIST_HEAD(&node->handles);
+
+    return node;
+}
+
+static iotx_mc_topic_node_t *_topic_node_child(iotx_mc_topic_node_t *node, const char *level, uint16_t level_len,
+        int create)
+{
+    int idx = 0, pos = 0;
+    iotx_mc_topic_node_t *child = NULL;
+
+    if (level_len == 1 && (level[0] == '+' || level[0] == '#')) {
+        iotx_mc_topic_node_t **wild = (level[0] == '+') ? &node->plus : &node->hash;
+        if (*wild == NULL && create) {
+            *wild = _topic_node_new(node, level, level_len);
+        }
+        return *wild;
+    }
+
+    idx = _topic_node_search(node, level, level_len, &pos);
+    if (idx >= 0) {
+        return node->children[idx];
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    if (node->child_num == node->child_cap) {
+        uint16_t cap = node->child_cap ? node->child_cap * 2 : IOTX_MC_TOPIC_NODE_CHILD_INIT;
+        iotx_mc_topic_node_t **children = mqtt_malloc(cap * sizeof(iotx_mc_topic_node_t *));
+        if (children == NULL) {
+            return NULL;
+        }
+        if (node->children) {
+            memcpy(children, node->children, node->child_num * sizeof(iotx_mc_topic_node_t *));
+            mqtt_free(node->children);
+        }
+        node->children = children;
+        node->child_cap = cap;
+    }
+
+    child = _topic_node_new(node, level, level_len);
+    if (child == NULL) {
+        return NULL;
+    }
+    memmove(&node->children[pos + 1], &node->children[pos], (node->child_num - pos) * sizeof(iotx_mc_topic_node_t *));
+    node->children[pos] = child;
+    node->child_num++;
+
+    return child;
+}
+
+/* free nodes which carry neither handles nor children, from node up to (not including) root */
+static void _topic_node_prune(iotx_mc_topic_node_t *node)
+{
+    iotx_mc_topic_node_t *parent = NULL;
+    int idx = 0;
+
+    while (node && node->parent) {
+        if (!list_empty(&node->handles) || node->child_num || node->plus || node->hash) {
+            break;
+        }
+
+        parent = node->parent;
+        if (parent->plus == node) {
+            parent->plus = NULL;
+        } else if (parent->hash == node) {
+            parent->hash = NULL;
+        } else {
+            idx = _topic_node_search(parent, node->level, node->level_len, NULL);
+            if (idx >= 0) {
+                memmove(&parent->children[idx], &parent->children[idx + 1],
+                        (parent->child_num - idx - 1) * sizeof(iotx_mc_topic_node_t *));
+                parent->child_num--;
+            }
+        }
+
+        if (node->children) {
+            mqtt_free(node->children);
+        }
+        mqtt_free(node);
+        node = parent;
+    }
+}
+
+/* release root node once the trie is empty */
+static void _topic_trie_shrink(iotx_mc_client_t *c)
+{
+    if (c->sub_trie && c->sub_trie->child_num == 0 && !c->sub_trie->plus && !c->sub_trie->hash) {
+        if (c->sub_trie->children) {
+            mqtt_free(c->sub_trie->children);
+        }
+        mqtt_free(c->sub_trie);
+        c->sub_trie = NULL;
+    }
+}
+
+/* walk (and create if needed) the node where topic filter ends, NULL when not found or out of memory */
+static iotx_mc_topic_node_t *_topic_trie_lookup(iotx_mc_client_t *c, const char *topic, int create)
+{
+    const char *level = topic, *sep = NULL;
+    iotx_mc_topic_node_t *node = NULL, *parent = NULL;
+
+    if (c->sub_trie == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        c->sub_trie = _topic_node_new(NULL, NULL, 0);
+        if (c->sub_trie == NULL) {
+            return NULL;
+        }
+    }
+
+    node = c->sub_trie;
+    while (node) {
+        parent = node;
+        sep = strchr(level, '/');
+        node = _topic_node_child(node, level, sep ? (uint16_t)(sep - level) : (uint16_t)strlen(level), create);
+        if (sep == NULL) {
+            break;
+        }
+        level = sep + 1;
+    }
+
+    if (node == NULL && create) {
+        /* release the partial path created before allocate fail */
+        _topic_node_prune(parent);
+        _topic_trie_shrink(c);
+    }
+
+    return node;
+}
+
+/* must be called with lock_generic held */
+static int iotx_mc_topic_trie_insert(iotx_mc_client_t *c, iotx_mc_topic_handle_t *handler)
+{
+    iotx_mc_topic_node_t *node = NULL;
+
+    node = _topic_trie_lookup(c, handler->topic_filter, 1);
+    if (node == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+
+    handler->sub_seq = c->sub_seq++;
+    handler->trie_node = node;
+    list_add_tail(&handler->trie_list, &node->handles);
+
+    return STATE_SUCCESS;
+}
+
+/* must be called with lock_generic held */
+static void iotx_mc_topic_trie_remove(iotx_mc_client_t *c, iotx_mc_topic_handle_t *handler)
+{
+    iotx_mc_topic_node_t *node = (iotx_mc_topic_node_t *)handler->trie_node;
+
+    if (node == NULL) {
+        return;
+    }
+
+    list_del(&handler->trie_list);
+    handler->trie_node = NULL;
+    _topic_node_prune(node);
+    _topic_trie_shrink(c);
+}
+
+static void _topic_match_add(iotx_mc_topic_match_t *match, iotx_mc_topic_node_t *node)
+{
+    iotx_mc_topic_handle_t *handler = NULL;
+    iotx_mc_topic_match_item_t *items = NULL;
+    uint32_t pos = 0;
+
+    list_for_each_entry(handler, &node->handles, trie_list, iotx_mc_topic_handle_t) {
+        if (match->num == match->cap) {
+            items = mqtt_malloc(match->cap * 2 * sizeof(iotx_mc_topic_match_item_t));
+            if (items == NULL) {
+                mqtt_err("topic match drop handle, no memory");
+                return;
+            }
+            memcpy(items, match->items, match->num * sizeof(iotx_mc_topic_match_item_t));
+            if (match->items != match->stack) {
+                mqtt_free(match->items);
+            }
+            match->items = items;
+            match->cap *= 2;
+        }
+
+        /* keep items in subscription order */
+        pos = match->num;
+        while (pos > 0 && match->items[pos - 1].sub_seq > handler->sub_seq) {
+            match->items[pos] = match->items[pos - 1];
+            pos--;
+        }
+        match->items[pos].sub_seq = handler->sub_seq;
+        match->items[pos].handle = handler->handle;
+#if WITH_MQTT_STREAM_RX
+        match->items[pos].chunk_fp = handler->chunk_fp;
 #endif
+        match->num++;
+    }
+}
 
-static char iotx_mc_is_topic_matched(char *topicFilter, MQTTString *topicName)
+/* level points to the first unmatched topic level, NULL if all levels matched */
+static void _topic_trie_match(iotx_mc_topic_node_t *node, const char *level, const char *end,
+                              iotx_mc_topic_match_t *match)
 {
-    char *curf;
-    char *curn;
-    char *curn_end;
+    const char *sep = NULL;
+    iotx_mc_topic_node_t *child = NULL;
+    uint16_t level_len = 0;
 
-    if (!topicFilter || !topicName) {
-        return STATE_SUCCESS;
+    if (level == NULL) {
+        _topic_match_add(match, node);
+        return;
     }
 
-    curf = topicFilter;
-    curn = topicName->lenstring.data;
-    curn_end = curn + topicName->lenstring.len;
+    /* '#' matches the remaining levels, the first of which should not be empty */
+    if (node->hash && level < end && *level != '/') {
+        _topic_match_add(match, node->hash);
+    }
 
-    while (*curf && curn < curn_end) {
-        if (*curn == '/' && *curf != '/') {
-            break;
-        }
+    sep = memchr(level, '/', end - level);
+    level_len = (uint16_t)(sep ? sep - level : end - level);
 
-        if (*curf != '+' && *curf != '#' && *curf != *curn) {
-            break;
-        }
+    /* '+' matches exactly one non-empty level */
+    if (node->plus && level_len > 0) {
+        _topic_trie_match(node->plus, sep ? sep + 1 : NULL, end, match);
+    }
 
-        if (*curf == '+') {
-            /* skip until we meet the next separator, or end of string */
-            char *nextpos = curn + 1;
-            while (nextpos < curn_end && *nextpos != '/') {
-                nextpos = ++curn + 1;
-            }
-        } else if (*curf == '#') {
-            curn = curn_end - 1;    /* skip until end of string */
+    if (node->child_num) {
+        int idx = _topic_node_search(node, level, level_len, NULL);
+        if (idx >= 0) {
+            child = node->children[idx];
+            _topic_trie_match(child, sep ? sep + 1 : NULL, end, match);
         }
-        curf++;
-        curn++;
     }
+}
 
-    return (curn == curn_end) && (*curf == '\0');
+/* must be called with lock_generic held */
+static void iotx_mc_topic_trie_match(iotx_mc_client_t *c, MQTTString *topicName, iotx_mc_topic_match_t *match)
+{
+    const char *topic = NULL;
+    uint32_t topic_len = 0;
+
+    match->items = match->stack;
+    match->num = 0;
+    match->cap = IOTX_MC_TOPIC_MATCH_STACK_NUM;
+
+    if (c->sub_trie == NULL) {
+        return;
+    }
+
+    if (topicName->cstring) {
+        topic = topicName->cstring;
+        topic_len = strlen(topicName->cstring);
+    } else {
+        topic = topicName->lenstring.data;
+        topic_len = topicName->lenstring.len;
+    }
+
+    _topic_trie_match(c->sub_trie, topic, topic + topic_len, match);
+}
+
+static void iotx_mc_topic_match_release(iotx_mc_topic_match_t *match)
+{
+    if (match->items != match->stack) {
+        mqtt_free(match->items);
+    }
+    match->items = NULL;
+    match->num = 0;
 }
+#endif
 
 /* /ext/auth/identity/response, payload: {"productKey":"","deviceName":""} */
 static void iotx_mc_parse_identity_response(iotx_mqtt_topic_info_pt topic_msg)
@@ -1201,11 +2442,16 @@ static void iotx_mc_parse_identity_response(iotx_mqtt_topic_info_pt topic_msg)
     }
 }
 
-static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName, iotx_mqtt_topic_info_pt topic_msg)
+/* run callbacks of PUBLISH, 'in_yield' is 0 if they are run by dispatch worker instead of yield */
+static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                                    int in_yield)
 {
     int flag_matched = 0;
     MQTTString *compare_topic = NULL;
-#ifdef PLATFORM_HAS_DYNMEM
+#if WITH_MQTT_SUB_TRIE
+    iotx_mc_topic_match_t match;
+    uint32_t idx = 0;
+#elif defined(PLATFORM_HAS_DYNMEM)
     iotx_mc_topic_handle_t *node = NULL;
 #else
     int idx = 0;
@@ -1245,6 +2491,24 @@ static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName,
 #endif
 
     /* we have to find the right message handler - indexed by topic */
+#if WITH_MQTT_SUB_TRIE
+    (void)compare_topic;
+    HAL_MutexLock(c->lock_generic);
+    iotx_mc_topic_trie_match(c, topicName, &match);
+    HAL_MutexUnlock(c->lock_generic);
+
+    for (idx = 0; idx < match.num; idx++) {
+        mqtt_debug("topic be matched");
+        if (NULL != match.items[idx].handle.h_fp) {
+            iotx_mqtt_event_msg_t msg;
+            msg.event_type = IOTX_MQTT_EVENT_PUBLISH_RECEIVED;
+            msg.msg = (void *)topic_msg;
+            _handle_publish(&match.items[idx].handle, c, &msg, in_yield);
+            flag_matched = 1;
+        }
+    }
+    iotx_mc_topic_match_release(&match);
+#else
     HAL_MutexLock(c->lock_generic);
 #ifdef PLATFORM_HAS_DYNMEM
     list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
@@ -1257,7 +2521,7 @@ static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName,
                 iotx_mqtt_event_msg_t msg;
                 msg.event_type = IOTX_MQTT_EVENT_PUBLISH_RECEIVED;
                 msg.msg = (void *)topic_msg;
-                _handle_event(&node->handle, c, &msg);
+                _handle_publish(&node->handle, c, &msg, in_yield);
                 flag_matched = 1;
             }
             HAL_MutexLock(c->lock_generic);
@@ -1275,7 +2539,7 @@ static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName,
                 iotx_mqtt_event_msg_t msg;
                 msg.event_type = IOTX_MQTT_EVENT_PUBLISH_RECEIVED;
                 msg.msg = (void *)topic_msg;
-                _handle_event(&c->list_sub_handle[idx].handle, c, &msg);
+                _handle_publish(&c->list_sub_handle[idx].handle, c, &msg, in_yield);
                 flag_matched = 1;
             }
             HAL_MutexLock(c->lock_generic);
@@ -1283,6 +2547,7 @@ static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName,
     }
 #endif
     HAL_MutexUnlock(c->lock_generic);
+#endif
 
     if (0 == flag_matched) {
         mqtt_info("NO matching any topic, call default handle function");
@@ -1292,11 +2557,24 @@ static void iotx_mc_deliver_message(iotx_mc_client_t *c, MQTTString *topicName,
 
             msg.event_type = IOTX_MQTT_EVENT_PUBLISH_RECEIVED;
             msg.msg = topic_msg;
-            _handle_event(&c->handle_event, c, &msg);
+            _handle_publish(&c->handle_event, c, &msg, in_yield);
         }
     }
 }
 
+#if WITH_MQTT_DISPATCH
+static void iotx_mc_dispatch_deliver(void *owner, iotx_mc_dispatch_msg_t *msg)
+{
+    MQTTString topicName;
+
+    memset(&topicName, 0x0, sizeof(MQTTString));
+    topicName.lenstring.data = (char *)msg->topic_msg.ptopic;
+    topicName.lenstring.len = msg->topic_msg.topic_len;
+
+    iotx_mc_deliver_message((iotx_mc_client_t *)owner, &topicName, &msg->topic_msg, 0);
+}
+#endif
+
 static int MQTTPuback(iotx_mc_client_t *c, unsigned int msgId, enum msgTypes type)
 {
     int rc = 0;
@@ -1347,7 +2625,7 @@ static int MQTTPuback(iotx_mc_client_t *c, unsigned int msgId, enum msgTypes typ
         return STATE_MQTT_SERIALIZE_PUBACK_ERROR;
     }
 
-    rc = iotx_mc_send_packet(c, c->buf_send, len, &timer);
+    rc = iotx_mc_queue_packet(c, len, &timer);
     if (rc < STATE_SUCCESS) {
         _reset_send_buffer(c);
         HAL_MutexUnlock(c->lock_write_buf);
@@ -1366,6 +2644,12 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
     iotx_mqtt_topic_info_t topic_msg;
     int qos = 0;
     uint32_t payload_len = 0;
+#if WITH_MQTT_V5
+    MQTTProperties props;
+#endif
+#if WITH_MQTT_RX_DEDUP
+    uint32_t hash = 0;
+#endif
 #ifdef INFRA_LOG_NETWORK_PAYLOAD
     const char     *json_payload = NULL;
 #endif
@@ -1377,6 +2661,25 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
     memset(&topic_msg, 0x0, sizeof(iotx_mqtt_topic_info_t));
     memset(&topicName, 0x0, sizeof(MQTTString));
 
+#if WITH_MQTT_V5
+    if (1 != MQTTV5Deserialize_publish((unsigned char *)&topic_msg.dup,
+                                       (int *)&qos,
+                                       (unsigned char *)&topic_msg.retain,
+                                       (unsigned short *)&topic_msg.packet_id,
+                                       &topicName,
+                                       &props,
+                                       (unsigned char **)&topic_msg.payload,
+                                       (int *)&payload_len,
+                                       (unsigned char *)c->buf_read,
+                                       c->buf_size_read)) {
+        return MQTT_PUBLISH_PACKET_ERROR;
+    }
+
+    result = iotx_mc_topic_alias_rx(c, &topicName, &props);
+    if (result < STATE_SUCCESS) {
+        return result;
+    }
+#else
     if (1 != MQTTDeserialize_publish((unsigned char *)&topic_msg.dup,
                                      (int *)&qos,
                                      (unsigned char *)&topic_msg.retain,
@@ -1388,6 +2691,7 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
                                      c->buf_size_read)) {
         return MQTT_PUBLISH_PACKET_ERROR;
     }
+#endif
     topic_msg.qos = (unsigned char)qos;
     topic_msg.payload_len = payload_len;
 
@@ -1432,6 +2736,19 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
 
     mqtt_debug("delivering msg ...");
 
+#if WITH_MQTT_RX_DEDUP
+    if (topic_msg.qos == IOTX_MQTT_QOS1) {
+        hash = iotx_mc_dedup_hash(topicName.lenstring.data, topicName.lenstring.len, topic_msg.payload,
+                                  topic_msg.payload_len);
+        /* server resends it with DUP set if our PUBACK was lost, so just acknowledge it again */
+        if (topic_msg.dup && iotx_mc_dedup_find(&c->dedup, topic_msg.packet_id, hash)) {
+            c->dedup.duplicates++;
+            mqtt_info("duplicate of packet id %u, not delivered", topic_msg.packet_id);
+            return MQTTPuback(c, topic_msg.packet_id, PUBACK);
+        }
+    }
+#endif
+
 #if WITH_MQTT_FLOW_CTRL
     /* flowControl for specific topic */
     static uint64_t time_prev = 0;
@@ -1453,7 +2770,28 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
     }
 #endif
 
-    iotx_mc_deliver_message(c, &topicName, &topic_msg);
+#if WITH_MQTT_DISPATCH
+    /* callbacks are run by worker, message is copied since read buffer is reused at once */
+    result = iotx_mc_dispatch_push(&c->dispatch, topicName.lenstring.data, topicName.lenstring.len, &topic_msg,
+                                   (topic_msg.qos == IOTX_MQTT_QOS1) ? IOTX_MC_DISPATCH_PUSH_WAIT_MS : 0);
+    if (result < STATE_SUCCESS) {
+        iotx_state_event(ITE_STATE_MQTT_COMM, result, "QoS%d message of '%.*s' dropped", topic_msg.qos,
+                         topicName.lenstring.len, topicName.lenstring.data);
+        if (topic_msg.qos == IOTX_MQTT_QOS1 && !c->connect_data.cleansession) {
+            /* server keeps it unacknowledged in session and sends it again after reconnected */
+            iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+            return STATE_SYS_DEPEND_NWK_CLOSE;
+        }
+        return STATE_SUCCESS;
+    }
+#else
+    iotx_mc_deliver_message(c, &topicName, &topic_msg, 1);
+#endif
+#if WITH_MQTT_RX_DEDUP
+    if (topic_msg.qos == IOTX_MQTT_QOS1) {
+        iotx_mc_dedup_add(&c->dedup, topic_msg.packet_id, hash);
+    }
+#endif
 
     if (topic_msg.qos == IOTX_MQTT_QOS0) {
         return STATE_SUCCESS;
@@ -1469,6 +2807,262 @@ static int iotx_mc_handle_recv_PUBLISH(iotx_mc_client_t *c)
     return result;
 }
 
+#if WITH_MQTT_STREAM_RX
+typedef struct {
+    iotx_mqtt_chunk_handle_func_fpt chunk_fp;
+    void                           *pcontext;
+} iotx_mc_stream_handle_t;
+
+/* make sure @need bytes of the oversized packet are buffered: 1, done; 0, timeout; < 0, error */
+static int _stream_fill(iotx_mc_client_t *c, uint32_t need, iotx_time_t *timer)
+{
+    int rc = 0;
+
+    while (c->rx_len < need) {
+        rc = iotx_mc_recv_fill(c, need - c->rx_len, timer);
+        if (rc <= 0) {
+            return rc;
+        }
+    }
+
+    return 1;
+}
+
+/* get length of PUBLISH header before payload, which should fit in read buffer along with at least one payload byte */
+static int _stream_header_len(iotx_mc_client_t *c, iotx_time_t *timer, uint32_t *hdr_len)
+{
+    uint32_t limit = c->buf_size_read;
+    uint32_t pos = 1;
+    uint32_t props_len = 0;
+    uint32_t multiplier = 1;
+    unsigned char i;
+    int qos = 0;
+    int rc = 0;
+
+    /* fixed header is already decoded */
+    while (c->buf_read[pos++] & 128) {
+    }
+    qos = MQTT_HEADER_GET_QOS((unsigned char)c->buf_read[0]);
+
+    /* topic length */
+    if (pos + 2 >= limit) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+    rc = _stream_fill(c, pos + 2, timer);
+    if (rc <= 0) {
+        return rc;
+    }
+    pos += 2 + (((unsigned char)c->buf_read[pos] << 8) | (unsigned char)c->buf_read[pos + 1]);
+    if (qos > 0) {
+        pos += 2;
+    }
+
+#if WITH_MQTT_V5
+    /* properties length */
+    do {
+        if (pos >= limit) {
+            return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+        }
+        rc = _stream_fill(c, pos + 1, timer);
+        if (rc <= 0) {
+            return rc;
+        }
+        i = (unsigned char)c->buf_read[pos++];
+        props_len += (i & 127) * multiplier;
+        multiplier *= 128;
+    } while ((i & 128) != 0 && multiplier <= 128 * 128 * 128);
+    pos += props_len;
+#else
+    (void)i;
+    (void)props_len;
+    (void)multiplier;
+#endif
+
+    if (pos >= limit) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+    rc = _stream_fill(c, pos, timer);
+    if (rc <= 0) {
+        return rc;
+    }
+
+    *hdr_len = pos;
+    return 1;
+}
+
+/* collect chunk callbacks of subscriptions matching topic */
+static int _stream_handle_collect(iotx_mc_client_t *c, MQTTString *topicName, iotx_mc_stream_handle_t *handles)
+{
+    int num = 0;
+#if WITH_MQTT_SUB_TRIE
+    iotx_mc_topic_match_t match;
+    uint32_t idx = 0;
+
+    HAL_MutexLock(c->lock_generic);
+    iotx_mc_topic_trie_match(c, topicName, &match);
+    HAL_MutexUnlock(c->lock_generic);
+
+    for (idx = 0; idx < match.num && num < IOTX_MC_STREAM_HANDLE_MAX; idx++) {
+        if (match.items[idx].chunk_fp != NULL) {
+            handles[num].chunk_fp = match.items[idx].chunk_fp;
+            handles[num].pcontext = match.items[idx].handle.pcontext;
+            num++;
+        }
+    }
+    iotx_mc_topic_match_release(&match);
+#else
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_topic_handle_t *node = NULL;
+
+    HAL_MutexLock(c->lock_generic);
+    list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
+        if (num < IOTX_MC_STREAM_HANDLE_MAX && node->chunk_fp != NULL &&
+            (MQTTPacket_equals(topicName, (char *)node->topic_filter)
+             || iotx_mc_is_topic_matched((char *)node->topic_filter, topicName))) {
+            handles[num].chunk_fp = node->chunk_fp;
+            handles[num].pcontext = node->handle.pcontext;
+            num++;
+        }
+    }
+    HAL_MutexUnlock(c->lock_generic);
+#else
+    int idx = 0;
+
+    HAL_MutexLock(c->lock_generic);
+    for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN && num < IOTX_MC_STREAM_HANDLE_MAX; idx++) {
+        if ((c->list_sub_handle[idx].used == 1) && c->list_sub_handle[idx].chunk_fp != NULL &&
+            (MQTTPacket_equals(topicName, (char *)c->list_sub_handle[idx].topic_filter)
+             || iotx_mc_is_topic_matched((char *)c->list_sub_handle[idx].topic_filter, topicName))) {
+            handles[num].chunk_fp = c->list_sub_handle[idx].chunk_fp;
+            handles[num].pcontext = c->list_sub_handle[idx].handle.pcontext;
+            num++;
+        }
+    }
+    HAL_MutexUnlock(c->lock_generic);
+#endif
+#endif
+
+    return num;
+}
+
+static void _stream_deliver(iotx_mc_client_t *c, iotx_mc_stream_handle_t *handles, int num,
+                            iotx_mqtt_chunk_info_pt chunk)
+{
+    int idx;
+
+    _in_yield_cb = 1;
+    for (idx = 0; idx < num; idx++) {
+        handles[idx].chunk_fp(handles[idx].pcontext, c, chunk);
+    }
+    _in_yield_cb = 0;
+}
+
+/*
+ * Deliver PUBLISH which could not fit in read buffer to chunk callbacks, must be called with lock_read_buf held.
+ * Return 1 if it is delivered, then @ack_qos and @ack_id tell how to acknowledge it; 0 if header is not received
+ * yet; STATE_MQTT_RX_BUFFER_TOO_SHORT if nobody takes it, so that it is discarded; < 0 on other errors.
+ */
+static int iotx_mc_stream_publish(iotx_mc_client_t *c, iotx_time_t *timer, int *ack_qos, uint16_t *ack_id)
+{
+    iotx_mc_stream_handle_t handles[IOTX_MC_STREAM_HANDLE_MAX];
+    iotx_mqtt_chunk_info_t chunk;
+    MQTTString topicName;
+    unsigned char *payload = NULL;
+    unsigned char dup = 0;
+    unsigned char retain = 0;
+    unsigned short packet_id = 0;
+    uint32_t hdr_len = 0;
+    uint32_t want = 0;
+    int payload_len = 0;
+    int qos = 0;
+    int num = 0;
+    int rc = 0;
+#if WITH_MQTT_V5
+    MQTTProperties props;
+#endif
+
+    if (MQTT_HEADER_GET_TYPE((unsigned char)c->buf_read[0]) != PUBLISH) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+
+    rc = _alloc_recv_buffer(c, _get_recv_buffer_limit(c));
+    if (rc < STATE_SUCCESS) {
+        return rc;
+    }
+
+    rc = _stream_header_len(c, timer, &hdr_len);
+    if (rc <= 0) {
+        return rc;
+    }
+
+    memset(&topicName, 0, sizeof(MQTTString));
+#if WITH_MQTT_V5
+    if (1 != MQTTV5Deserialize_publish(&dup, &qos, &retain, &packet_id, &topicName, &props,
+                                       &payload, &payload_len, (unsigned char *)c->buf_read, c->buf_size_read)) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+
+    if (iotx_mc_topic_alias_rx(c, &topicName, &props) < STATE_SUCCESS) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+#else
+    if (1 != MQTTDeserialize_publish(&dup, &qos, &retain, &packet_id, &topicName,
+                                     &payload, &payload_len, (unsigned char *)c->buf_read, c->buf_size_read)) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+#endif
+    if (topicName.lenstring.len == 0 || topicName.lenstring.data == NULL || payload_len <= 0) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+
+    num = _stream_handle_collect(c, &topicName, handles);
+    if (num == 0) {
+        return STATE_MQTT_RX_BUFFER_TOO_SHORT;
+    }
+
+    mqtt_info("stream publish of %d bytes in chunks of %u bytes", payload_len, c->buf_size_read - hdr_len);
+
+    memset(&chunk, 0, sizeof(iotx_mqtt_chunk_info_t));
+    chunk.packet_id = packet_id;
+    chunk.qos = (uint8_t)qos;
+    chunk.dup = dup;
+    chunk.retain = retain;
+    chunk.topic_len = topicName.lenstring.len;
+    chunk.ptopic = topicName.lenstring.data;
+    chunk.total_len = payload_len;
+
+    /* payload bytes read along with header go first, then the rest is read into the same room */
+    want = c->rx_len - hdr_len;
+    while (chunk.offset < chunk.total_len) {
+        if (want > 0) {
+            chunk.chunk = c->buf_read + hdr_len;
+            chunk.chunk_len = want;
+            _stream_deliver(c, handles, num, &chunk);
+            chunk.offset += want;
+        }
+
+        want = chunk.total_len - chunk.offset;
+        if (want > c->buf_size_read - hdr_len) {
+            want = c->buf_size_read - hdr_len;
+        }
+        if (want > 0 &&
+            c->ipstack.read(&c->ipstack, c->buf_read + hdr_len, want, c->request_timeout_ms) != (int)want) {
+            mqtt_err("mqtt read error, stream publish broken off at %u", chunk.offset);
+            chunk.chunk = NULL;
+            chunk.chunk_len = 0;
+            _stream_deliver(c, handles, num, &chunk);
+            _reset_recv_buffer(c);
+            return STATE_SYS_DEPEND_NWK_READ_ERROR;
+        }
+    }
+
+    _reset_recv_buffer(c);
+    *ack_qos = qos;
+    *ack_id = packet_id;
+    return 1;
+}
+#endif  /* #if WITH_MQTT_STREAM_RX */
+
 static int iotx_mc_handle_recv_UNSUBACK(iotx_mc_client_t *c)
 {
     unsigned short mypacketid = 0;  /* should be the same as the packetid above */
@@ -1509,6 +3103,7 @@ static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
     if (IOTX_MC_KEEPALIVE_PROBE_MAX < c->keepalive_probes) {
         iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
         c->keepalive_probes = 0;
+        c->ping_lost++;
         mqtt_debug("keepalive_probes more than %u, disconnected\n", IOTX_MC_KEEPALIVE_PROBE_MAX);
         return STATE_MQTT_IN_OFFLINE_STATUS;
     }
@@ -1528,14 +3123,11 @@ static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
 
     if (MQTT_CPT_RESERVED == packetType) {
         /* mqtt_debug("wait data timeout"); */
-        HAL_MutexLock(c->lock_read_buf);
-        _reset_recv_buffer(c);
-        HAL_MutexUnlock(c->lock_read_buf);
         return STATE_SUCCESS;
     }
 
     /* clear ping mark when any data received from MQTT broker */
-    c->keepalive_probes = 0;
+    iotx_mc_keepalive_rx(c);
     HAL_MutexLock(c->lock_read_buf);
     switch (packetType) {
         case CONNACK: {
@@ -1581,55 +3173,250 @@ static int iotx_mc_cycle(iotx_mc_client_t *c, iotx_time_t *timer)
         }
         case PINGRESP: {
             rc = STATE_SUCCESS;
+            c->ping_resp++;
             mqtt_info("receive ping response!");
             break;
         }
-        default:
-            mqtt_err("INVALID TYPE");
-            _reset_recv_buffer(c);
-            HAL_MutexUnlock(c->lock_read_buf);
-            return STATE_MQTT_RECV_UNKNOWN_PACKET;
+        default:
+            mqtt_err("INVALID TYPE");
+            _consume_recv_buffer(c);
+            HAL_MutexUnlock(c->lock_read_buf);
+            return STATE_MQTT_RECV_UNKNOWN_PACKET;
+    }
+    _consume_recv_buffer(c);
+    HAL_MutexUnlock(c->lock_read_buf);
+    return rc;
+}
+
+static int iotx_mc_keepalive_sub(iotx_mc_client_t *pClient);
+#if WITH_MQTT_JOURNAL
+static void iotx_mc_journal_proc(iotx_mc_client_t *c);
+#endif
+#if WITH_MQTT_SUBMIT_QUEUE
+static int iotx_mc_submit_drain(iotx_mc_client_t *c);
+#endif
+#if WITH_MQTT_PUB_RATE_LIMIT
+static int iotx_mc_rate_drain(iotx_mc_client_t *c);
+#endif
+
+/* wake up yield blocked in iotx_mc_wait_event() */
+static void iotx_mc_wakeup(iotx_mc_client_t *c)
+{
+    c->wakeup_pending = 1;
+    HAL_SemaphorePost(c->sem_wakeup);
+}
+
+/* milliseconds until the next work of yield: end of cycle, keepalive or QoS1 republish */
+static uint32_t iotx_mc_next_event_ms(iotx_mc_client_t *c, iotx_time_t *cycle_timer)
+{
+    uint32_t left = iotx_time_left(cycle_timer);
+    uint32_t due = 0;
+
+    if (iotx_mc_get_client_state(c) != IOTX_MC_STATE_CONNECTED) {
+        return left;
+    }
+
+    due = iotx_mc_keepalive_left(c);
+    if (due < left) {
+        left = due;
+    }
+
+#if !WITH_MQTT_ONLY_QOS0 && !defined(ASYNC_PROTOCOL_STACK)
+    due = iotx_mc_pub_info_next_due(c);
+    if (due < left) {
+        left = due;
+    }
+#endif
+
+#if WITH_MQTT_TX_QUEUE
+    HAL_MutexLock(c->lock_write_buf);
+    if (c->tx_queue_num > 0) {
+        due = iotx_time_left(&c->tx_queue_time);
+        if (due < left) {
+            left = due;
+        }
+    }
+    HAL_MutexUnlock(c->lock_write_buf);
+#endif
+
+#if WITH_MQTT_JOURNAL
+    if (iotx_mc_journal_count(&c->journal) > 0) {
+        due = iotx_time_left(&c->journal_drain_time);
+        if (due < left) {
+            left = due;
+        }
+    }
+#endif
+
+#if WITH_MQTT_PUB_RATE_LIMIT
+    HAL_MutexLock(c->rate.lock);
+    due = iotx_mc_rate_next_ms(&c->rate);
+    HAL_MutexUnlock(c->rate.lock);
+    if (due < left) {
+        left = due;
+    }
+#endif
+
+    return left;
+}
+
+/* block until socket may be readable or wakeup is posted, return 1 if socket should be read, 2 if it should be probed */
+static int iotx_mc_wait_event(iotx_mc_client_t *c, uint32_t timeout_ms)
+{
+    int rc = 0;
+
+    if (iotx_mc_get_client_state(c) != IOTX_MC_STATE_CONNECTED) {
+        /* let iotx_mc_cycle() report the state */
+        return 1;
+    }
+
+    if (iotx_mc_recv_buffered(c) || c->ipstack.wait == NULL) {
+        return 1;
+    }
+
+    /* data left behind by last read raises no new socket event, read on until socket is empty */
+    if (c->rx_more) {
+        return 2;
+    }
+
+    rc = c->ipstack.wait(&c->ipstack, c->sem_wakeup, timeout_ms);
+    if (rc > 0 && c->wakeup_pending) {
+        /* woken up by publish, but release of a socket event may have been taken along with it */
+        c->wakeup_pending = 0;
+        return 2;
+    }
+
+    /* on error let read report it */
+    return (rc != 0) ? 1 : 0;
+}
+
+#if WITH_MQTT_RX_BACKPRESSURE
+/* sample fill level of application queues, return 1 if socket should not be read for now */
+static int iotx_mc_rx_paused(iotx_mc_client_t *c)
+{
+    iotx_mqtt_backlog_fpt backlog_fp;
+    void *backlog_ctx;
+    uint32_t backlog = 0;
+    int level = 0;
+    /* pause is held while connected, until pings go unanswered as long as a dead link is allowed to,
+     * then socket is read so that PINGRESP can clear them */
+    int hold = (iotx_mc_get_client_state(c) == IOTX_MC_STATE_CONNECTED &&
+                c->keepalive_probes < IOTX_MC_KEEPALIVE_PROBE_MAX);
+
+#if WITH_MQTT_DISPATCH
+    backlog = iotx_mc_dispatch_level(&c->dispatch);
+#endif
+
+    HAL_MutexLock(c->lock_generic);
+    backlog_fp = c->rx_backlog_fp;
+    backlog_ctx = c->rx_backlog_ctx;
+    HAL_MutexUnlock(c->lock_generic);
+    if (backlog_fp != NULL) {
+        level = backlog_fp(backlog_ctx);
+    }
+    if (level > 0 && (uint32_t)level > backlog) {
+        backlog = level;
+    }
+
+    c->rx_backlog = backlog;
+    if (backlog > c->rx_backlog_peak) {
+        c->rx_backlog_peak = backlog;
+    }
+
+    if (c->rx_paused) {
+        if (hold && backlog > IOTX_MC_RX_LOW_WATERMARK) {
+            return 1;
+        }
+        c->rx_pause_ms += utils_time_spend(&c->rx_pause_time);
+        c->rx_paused = 0;
+        mqtt_info("backlog %u%%, resume reading", backlog);
+        return 0;
     }
-    _reset_recv_buffer(c);
-    HAL_MutexUnlock(c->lock_read_buf);
-    return rc;
+
+    if (hold && backlog >= IOTX_MC_RX_HIGH_WATERMARK) {
+        c->rx_paused = 1;
+        c->rx_pause_count++;
+        iotx_time_start(&c->rx_pause_time);
+        mqtt_warning("backlog %u%%, pause reading", backlog);
+        return 1;
+    }
+
+    return 0;
 }
+#endif
 
 void _mqtt_cycle(void *client)
 {
     int                 rc = STATE_SUCCESS;
+    int                 readable = 0;
+    unsigned int        left_t = 0;
     iotx_time_t         time;
+    iotx_time_t         io_time;
     iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
 
     iotx_time_init(&time);
     utils_time_countdown_ms(&time, pClient->cycle_timeout_ms);
 
     do {
-        unsigned int left_t;
-
-        if (rc < STATE_SUCCESS) {
-            /*mqtt_err("error occur rc=%d", rc);*/
-        }
-
         HAL_MutexLock(pClient->lock_yield);
 
-        /* acquire package in cycle, such as PINGRESP or PUBLISH */
-        rc = iotx_mc_cycle(pClient, &time);
+        /* sleep until data arrives, publish wakes us up, or keepalive/republish is due */
+        rc = STATE_SUCCESS;
+#if WITH_MQTT_RX_BACKPRESSURE
+        if (iotx_mc_rx_paused(pClient)) {
+            /* leave PUBLISH in socket, so that TCP window and server hold them until application catches up */
+            uint32_t wait_ms = iotx_mc_next_event_ms(pClient, &time);
+
+            HAL_SleepMs((wait_ms < IOTX_MC_RX_PAUSE_POLL_MS) ? wait_ms : IOTX_MC_RX_PAUSE_POLL_MS);
+        } else
+#endif
+        readable = iotx_mc_wait_event(pClient, iotx_mc_next_event_ms(pClient, &time));
+        if (readable > 0) {
+            iotx_time_init(&io_time);
+            /* only probe socket when no event says it is readable */
+            utils_time_countdown_ms(&io_time, (readable == 2) ? 0 : iotx_mc_next_event_ms(pClient, &time));
+
+            /* acquire package in cycle, such as PINGRESP or PUBLISH */
+            rc = iotx_mc_cycle(pClient, &io_time);
+        }
         if (rc == STATE_SUCCESS) {
+            iotx_mc_keepalive_sub(pClient);
 #ifndef ASYNC_PROTOCOL_STACK
 #if !WITH_MQTT_ONLY_QOS0
             /* check list of wait publish ACK to remove node that is ACKED or timeout */
-            MQTTPubInfoProc(pClient);
+            MQTTPubInfoProc(pClient, 0);
+#endif
+#endif
+#if WITH_MQTT_JOURNAL
+            /* send publishes kept while offline */
+            iotx_mc_journal_proc(pClient);
+#endif
+        }
+#if WITH_MQTT_SUBMIT_QUEUE
+        /* drained even if offline, so that frames of this connection are not sent on next one */
+        if (iotx_mc_submit_drain(pClient) < STATE_SUCCESS) {
+            rc = STATE_SYS_DEPEND_NWK_CLOSE;
+        }
 #endif
+#if WITH_MQTT_PUB_RATE_LIMIT
+        if (rc == STATE_SUCCESS) {
+            /* send publishes held back by rate limit whose tokens came back */
+            rc = iotx_mc_rate_drain(pClient);
+        }
 #endif
+        if (rc == STATE_SUCCESS) {
+            /* send frames which have waited in outbound queue long enough */
+            rc = iotx_mc_tx_queue_flush(pClient, 1);
         }
         HAL_MutexUnlock(pClient->lock_yield);
 
-        left_t = iotx_time_left(&time);
-        if (left_t < 10) {
-            HAL_SleepMs(left_t);
-        } else {
-            HAL_SleepMs(10);
+        if (rc == STATE_SYS_DEPEND_NWK_CLOSE || iotx_mc_get_client_state(pClient) != IOTX_MC_STATE_CONNECTED) {
+            /* offline or connection closed, nothing to wait for until the cycle ends */
+            HAL_SleepMs(iotx_time_left(&time));
+        } else if (rc < STATE_SUCCESS) {
+            /* error of one packet, back off a little and keep reading the rest */
+            left_t = iotx_time_left(&time);
+            HAL_SleepMs((left_t < 10) ? left_t : 10);
         }
     } while (!utils_time_is_expired(&time));
 }
@@ -1665,7 +3452,7 @@ static int MQTTKeepalive(iotx_mc_client_t *pClient)
         return STATE_MQTT_SERIALIZE_PINGREQ_ERROR;
     }
 
-    rc = iotx_mc_send_packet(pClient, pClient->buf_send, len, &timer);
+    rc = iotx_mc_queue_packet(pClient, len, &timer);
     if (rc < STATE_SUCCESS) {
         /* ping outstanding, then close socket unsubscribe topic and handle callback function */
         mqtt_err("ping outstanding is error,result = %d", rc);
@@ -1692,13 +3479,31 @@ static int iotx_mc_keepalive_sub(iotx_mc_client_t *pClient)
         return STATE_SUCCESS;
     }
 
-    /* if there is no ping_timer timeout, then return success */
-    if (!utils_time_is_expired(&pClient->next_ping_time)) {
+    /* socket may never become readable again, so check it here as well as in iotx_mc_cycle() */
+    if (IOTX_MC_KEEPALIVE_PROBE_MAX < pClient->keepalive_probes) {
+        iotx_mc_set_client_state(pClient, IOTX_MC_STATE_DISCONNECTED);
+        pClient->keepalive_probes = 0;
+        pClient->ping_lost++;
+        mqtt_debug("keepalive_probes more than %u, disconnected\n", IOTX_MC_KEEPALIVE_PROBE_MAX);
+        return STATE_SUCCESS;
+    }
+
+    /* if nothing was sent or received for a while, then ping */
+    if (iotx_mc_keepalive_left(pClient) > 0) {
         return STATE_SUCCESS;
     }
 
-    /* update to next time sending MQTT keep-alive */
-    utils_time_countdown_ms(&pClient->next_ping_time, pClient->connect_data.keepAliveInterval * 1000);
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+    if (pClient->keepalive_probes == 0) {
+        uint32_t idle = utils_time_spend(&pClient->last_tx_time);
+
+        if (utils_time_spend(&pClient->last_rx_time) < idle) {
+            idle = utils_time_spend(&pClient->last_rx_time);
+        }
+        /* ping only probes idle time when it is due to the interval rather than server keepalive */
+        pClient->keepalive_probe_ms = (idle >= pClient->keepalive_ms) ? idle : 0;
+    }
+#endif
 
     rc = MQTTKeepalive(pClient);
     if (rc < STATE_SUCCESS) {
@@ -1711,6 +3516,7 @@ static int iotx_mc_keepalive_sub(iotx_mc_client_t *pClient)
 
     mqtt_info("send MQTT ping...");
     pClient->keepalive_probes++;
+    pClient->ping_sent++;
     return STATE_SUCCESS;
 }
 
@@ -1801,6 +3607,10 @@ static int iotx_mc_handle_reconnect(iotx_mc_client_t *pClient)
 
 static void iotx_mc_reconnect_callback(iotx_mc_client_t *pClient)
 {
+#if WITH_MQTT_JOURNAL
+    /* start draining journal at once */
+    utils_time_countdown_ms(&pClient->journal_drain_time, 0);
+#endif
 
     /* handle callback function */
     if (NULL != pClient->handle_event.h_fp) {
@@ -1828,6 +3638,10 @@ static void iotx_mc_disconnect_callback(iotx_mc_client_t *pClient)
     }
 }
 
+#if WITH_MQTT_SESSION_RESUME
+static void iotx_mc_session_resume(iotx_mc_client_t *c);
+#endif
+
 static void iotx_mc_keepalive(iotx_mc_client_t *pClient)
 {
     int rc = 0;
@@ -1853,6 +3667,9 @@ static void iotx_mc_keepalive(iotx_mc_client_t *pClient)
                 }
             } else {
                 mqtt_info("network is reconnected!");
+#if WITH_MQTT_SESSION_RESUME
+                iotx_mc_session_resume(pClient);
+#endif
                 iotx_mc_reconnect_callback(pClient);
                 pClient->reconnect_param.reconnect_time_interval_ms = IOTX_MC_RECONNECT_INTERVAL_MIN_MS;
             }
@@ -1863,6 +3680,9 @@ static void iotx_mc_keepalive(iotx_mc_client_t *pClient)
         /* If network suddenly interrupted, stop pinging packet, try to reconnect network immediately */
         if (currentState == IOTX_MC_STATE_DISCONNECTED) {
             mqtt_err("network is disconnected!");
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+            iotx_mc_keepalive_adapt(pClient, 0);
+#endif
             iotx_mc_disconnect_callback(pClient);
 
             pClient->reconnect_param.reconnect_time_interval_ms = IOTX_MC_RECONNECT_INTERVAL_MIN_MS;
@@ -1948,31 +3768,29 @@ static int iotx_mc_check_handle_is_identical(iotx_mc_topic_handle_t *messageHand
     return 0;
 }
 
-static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt_qos_t qos, unsigned int msgId,
-                         iotx_mqtt_event_handle_func_fpt messageHandler, void *pcontext)
+static void _mqtt_sub_handle_free(iotx_mc_topic_handle_t *handler)
+{
+#ifdef PLATFORM_HAS_DYNMEM
+    mqtt_free(handler->topic_filter);
+    mqtt_free(handler);
+#else
+    memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+#endif
+}
+
+/* allocate handler of topic filter, it is freed by _mqtt_sub_handle_free() if not added to client */
+static int _mqtt_sub_handle_new(iotx_mc_client_t *c, const char *topicFilter,
+                                iotx_mqtt_event_handle_func_fpt messageHandler, void *pcontext,
+                                iotx_mc_topic_handle_t **phandler)
 {
-    int                         len = 0, res = 0;
-    iotx_time_t                 timer;
-    MQTTString                  topic = MQTTString_initializer;
-    /*iotx_mc_topic_handle_t handler = {topicFilter, {messageHandler, pcontext}};*/
     iotx_mc_topic_handle_t     *handler = NULL;
 #ifndef PLATFORM_HAS_DYNMEM
     int idx = 0;
 #endif
-
-    if (!c || !topicFilter || !messageHandler) {
-        return STATE_USER_INPUT_INVALID;
-    }
-#if !( WITH_MQTT_DYN_BUF)
-    if (!c->buf_send) {
-        return STATE_USER_INPUT_INVALID;
-    }
+#if WITH_MQTT_ZIP_TOPIC
+    int res = 0;
 #endif
 
-    topic.cstring = (char *)topicFilter;
-    iotx_time_init(&timer);
-    utils_time_countdown_ms(&timer, c->request_timeout_ms);
-
 #ifdef PLATFORM_HAS_DYNMEM
     handler = mqtt_malloc(sizeof(iotx_mc_topic_handle_t));
     if (NULL == handler) {
@@ -1981,6 +3799,7 @@ static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt
     memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
     INIT_LIST_HEAD(&handler->linked_list);
 #else
+    HAL_MutexLock(c->lock_generic);
     for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
         if (c->list_sub_handle[idx].used == 0) {
             handler = &c->list_sub_handle[idx];
@@ -1989,6 +3808,7 @@ static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt
             break;
         }
     }
+    HAL_MutexUnlock(c->lock_generic);
 
     if (handler == NULL) {
         return STATE_MQTT_SUB_EXCEED_MAX;
@@ -2048,12 +3868,7 @@ static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt
         handler->topic_type = TOPIC_NAME_TYPE;
         res = iotx_mc_get_zip_topic(topicFilter, strlen(topicFilter), (char *)handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
         if (res < STATE_SUCCESS) {
-#ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(handler->topic_filter);
-            mqtt_free(handler);
-#else
-            memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
-#endif
+            _mqtt_sub_handle_free(handler);
             return res;
         }
     }
@@ -2061,182 +3876,482 @@ static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt
     handler->handle.h_fp = messageHandler;
     handler->handle.pcontext = pcontext;
 
-    if (qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
-        uint8_t dup = 0;
+    *phandler = handler;
+    return STATE_SUCCESS;
+}
+
+/* add handler to client, it is freed if the same topic and callback function has been subscribed */
+static int _mqtt_sub_handle_add(iotx_mc_client_t *c, iotx_mc_topic_handle_t *handler, const char *topicFilter)
+{
+    int res = STATE_SUCCESS;
+    uint8_t dup = 0;
 #ifdef PLATFORM_HAS_DYNMEM
-        iotx_mc_topic_handle_t *node;
+    iotx_mc_topic_handle_t *node;
+#else
+    int idx = 0;
 #endif
-        HAL_MutexLock(c->lock_generic);
+
+    HAL_MutexLock(c->lock_generic);
 #ifdef PLATFORM_HAS_DYNMEM
 #if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
 #if WITH_MQTT_ZIP_TOPIC
-        HEXDUMP_DEBUG(handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
+    HEXDUMP_DEBUG(handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
 #else
-        mqtt_warning("handler->topic: %s", handler->topic_filter);
+    mqtt_warning("handler->topic: %s", handler->topic_filter);
 #endif
 #endif
-        list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
-            /* If subscribe the same topic and callback function, then ignore */
+    list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
+        /* If subscribe the same topic and callback function, then ignore */
 #if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
 #if WITH_MQTT_ZIP_TOPIC
-            HEXDUMP_DEBUG(node->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
+        HEXDUMP_DEBUG(node->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
 #else
-            mqtt_warning("node->topic: %s", node->topic_filter);
+        mqtt_warning("node->topic: %s", node->topic_filter);
 #endif
 #endif
-            if (0 == iotx_mc_check_handle_is_identical(node, handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
+        if (0 == iotx_mc_check_handle_is_identical(node, handler)) {
+            mqtt_warning("dup sub,topic = %s", topicFilter);
+#if WITH_MQTT_STREAM_RX
+            if (handler->chunk_fp != NULL) {
+                node->chunk_fp = handler->chunk_fp;
             }
+#endif
+            dup = 1;
         }
+    }
 #else
-        for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
-            /* If subscribe the same topic and callback function, then ignore */
-            if (&c->list_sub_handle[idx] != handler &&
-                0 == iotx_mc_check_handle_is_identical(&c->list_sub_handle[idx], handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
+    for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
+        /* If subscribe the same topic and callback function, then ignore */
+        if (&c->list_sub_handle[idx] != handler &&
+            0 == iotx_mc_check_handle_is_identical(&c->list_sub_handle[idx], handler)) {
+            mqtt_warning("dup sub,topic = %s", topicFilter);
+#if WITH_MQTT_STREAM_RX
+            if (handler->chunk_fp != NULL) {
+                c->list_sub_handle[idx].chunk_fp = handler->chunk_fp;
             }
+#endif
+            dup = 1;
         }
+    }
 #endif
-        if (dup == 0) {
+    if (dup == 0) {
 #ifdef PLATFORM_HAS_DYNMEM
+#if WITH_MQTT_SUB_TRIE
+        res = iotx_mc_topic_trie_insert(c, handler);
+#endif
+        if (res == STATE_SUCCESS) {
             list_add_tail(&handler->linked_list, &c->list_sub_handle);
+        }
 #endif
-        } else {
-#ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(handler->topic_filter);
-            mqtt_free(handler);
-#else
-            memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+    }
+    if (dup != 0 || res < STATE_SUCCESS) {
+        _mqtt_sub_handle_free(handler);
+    }
+    HAL_MutexUnlock(c->lock_generic);
+
+    return res;
+}
+
+/* send one SUBSCRIBE packet of 'count' topic filters, and add their handlers once it is sent */
+static int MQTTSubscribeMulti(iotx_mc_client_t *c, iotx_mqtt_sub_entry_t *entry, int count, unsigned int msgId)
+{
+    int                         len = 0, res = 0, rc = 0, add_res = STATE_SUCCESS, idx = 0;
+    iotx_time_t                 timer;
+    MQTTString                  topic[MUTLI_SUBSCIRBE_MAX];
+    int                         qos[MUTLI_SUBSCIRBE_MAX];
+    iotx_mc_topic_handle_t     *handler[MUTLI_SUBSCIRBE_MAX];
+#if WITH_MQTT_V5
+    MQTTProperties              props = MQTTProperties_initializer;
 #endif
-        }
-        HAL_MutexUnlock(c->lock_generic);
-        return STATE_SUCCESS;
+
+    if (!c || !entry || count <= 0 || count > MUTLI_SUBSCIRBE_MAX) {
+        return STATE_USER_INPUT_INVALID;
     }
+#if !( WITH_MQTT_DYN_BUF)
+    if (!c->buf_send) {
+        return STATE_USER_INPUT_INVALID;
+    }
+#endif
 
-    HAL_MutexLock(c->lock_write_buf);
-    res = _alloc_send_buffer(c, strlen(topicFilter));
-    if (res < STATE_SUCCESS) {
-        HAL_MutexUnlock(c->lock_write_buf);
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(handler->topic_filter);
-        mqtt_free(handler);
-#else
-        memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    for (idx = 0; idx < count; idx++) {
+        res = _mqtt_sub_handle_new(c, entry[idx].topic_filter, entry[idx].topic_handle_func, entry[idx].pcontext,
+                                   &handler[idx]);
+        if (res < STATE_SUCCESS) {
+            while (idx-- > 0) {
+                _mqtt_sub_handle_free(handler[idx]);
+            }
+            return res;
+        }
+#if WITH_MQTT_STREAM_RX
+        handler[idx]->chunk_fp = entry[idx].chunk_handle_func;
 #endif
-        return res;
+#if WITH_MQTT_SESSION_RESUME
+        handler[idx]->qos = entry[idx].qos;
+#endif
+        memset(&topic[idx], 0, sizeof(MQTTString));
+        topic[idx].cstring = (char *)entry[idx].topic_filter;
+        qos[idx] = (int)entry[idx].qos;
+        len += strlen(entry[idx].topic_filter) + 3;
     }
 
-    len = MQTTSerialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, 1, &topic,
-                                  (int *)&qos);
-    if (len <= 0) {
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(handler->topic_filter);
-        mqtt_free(handler);
+    HAL_MutexLock(c->lock_write_buf);
+    res = _alloc_send_buffer(c, len);
+    if (res == STATE_SUCCESS) {
+#if WITH_MQTT_V5
+        len = MQTTV5Serialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, &props,
+                                        count, topic, qos);
 #else
-        memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+        len = MQTTSerialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, count,
+                                      topic, qos);
 #endif
-        _reset_send_buffer(c);
-        HAL_MutexUnlock(c->lock_write_buf);
-        return STATE_MQTT_SERIALIZE_SUB_ERROR;
+        if (len <= 0) {
+            res = STATE_MQTT_SERIALIZE_SUB_ERROR;
+        }
     }
 
-    mqtt_debug("%20s : %08d", "Packet Ident", msgId);
-    mqtt_debug("%20s : %s", "Topic", topicFilter);
-    mqtt_debug("%20s : %d", "QoS", (int)qos);
-    mqtt_debug("%20s : %d", "Packet Length", len);
+    if (res == STATE_SUCCESS) {
+        mqtt_debug("%20s : %08d", "Packet Ident", msgId);
+        for (idx = 0; idx < count; idx++) {
+            mqtt_debug("%20s : %s", "Topic", entry[idx].topic_filter);
+            mqtt_debug("%20s : %d", "QoS", qos[idx]);
+        }
+        mqtt_debug("%20s : %d", "Packet Length", len);
 #if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
-    HEXDUMP_DEBUG(c->buf_send, len);
+        HEXDUMP_DEBUG(c->buf_send, len);
 #endif
 
-    if ((iotx_mc_send_packet(c, c->buf_send, len, &timer)) != STATE_SUCCESS) { /* send the subscribe packet */
-        /* If send failed, remove it */
-        mqtt_err("run sendPacket error!");
-#ifdef PLATFORM_HAS_DYNMEM
-        mqtt_free(handler->topic_filter);
-        mqtt_free(handler);
-#else
-        memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
-#endif
-        _reset_send_buffer(c);
-        HAL_MutexUnlock(c->lock_write_buf);
-        return STATE_SYS_DEPEND_NWK_CLOSE;
+        if ((iotx_mc_send_packet(c, c->buf_send, len, &timer)) != STATE_SUCCESS) { /* send the subscribe packet */
+            mqtt_err("run sendPacket error!");
+            res = STATE_SYS_DEPEND_NWK_CLOSE;
+        }
     }
     _reset_send_buffer(c);
     HAL_MutexUnlock(c->lock_write_buf);
 
-    {
-        uint8_t dup = 0;
-#ifdef PLATFORM_HAS_DYNMEM
-        iotx_mc_topic_handle_t *node;
+    for (idx = 0; idx < count; idx++) {
+        if (res < STATE_SUCCESS) {
+            /* If send failed, remove it */
+            _mqtt_sub_handle_free(handler[idx]);
+        } else if ((rc = _mqtt_sub_handle_add(c, handler[idx], entry[idx].topic_filter)) < STATE_SUCCESS) {
+            add_res = rc;
+        }
+    }
+
+    return (res < STATE_SUCCESS) ? res : add_res;
+}
+
+/* add handler of IOTX_MQTT_QOS3_SUB_LOCAL topic filter, which is not sent to server */
+static int MQTTSubscribeLocal(iotx_mc_client_t *c, iotx_mqtt_sub_entry_t *entry)
+{
+    iotx_mc_topic_handle_t     *handler = NULL;
+    int                         res = 0;
+
+    res = _mqtt_sub_handle_new(c, entry->topic_filter, entry->topic_handle_func, entry->pcontext, &handler);
+    if (res < STATE_SUCCESS) {
+        return res;
+    }
+#if WITH_MQTT_STREAM_RX
+    handler->chunk_fp = entry->chunk_handle_func;
 #endif
-        HAL_MutexLock(c->lock_generic);
-#ifdef PLATFORM_HAS_DYNMEM
-#if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
-#if WITH_MQTT_ZIP_TOPIC
-        HEXDUMP_DEBUG(handler->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
+#if WITH_MQTT_SESSION_RESUME
+    handler->qos = IOTX_MQTT_QOS3_SUB_LOCAL;
+#endif
+
+    return _mqtt_sub_handle_add(c, handler, entry->topic_filter);
+}
+
+static int MQTTSubscribe(iotx_mc_client_t *c, const char *topicFilter, iotx_mqtt_qos_t qos, unsigned int msgId,
+                         iotx_mqtt_event_handle_func_fpt messageHandler, void *pcontext)
+{
+    iotx_mqtt_sub_entry_t       entry;
+
+    if (!c || !topicFilter || !messageHandler) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    memset(&entry, 0, sizeof(iotx_mqtt_sub_entry_t));
+    entry.topic_filter = topicFilter;
+    entry.qos = qos;
+    entry.topic_handle_func = messageHandler;
+    entry.pcontext = pcontext;
+
+    if (qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
+        return MQTTSubscribeLocal(c, &entry);
+    }
+    return MQTTSubscribeMulti(c, &entry, 1, msgId);
+}
+
+static int iotx_mc_get_next_packetid(iotx_mc_client_t *c)
+{
+    unsigned int id = 0;
+
+    if (!c) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+#if !WITH_MQTT_ONLY_QOS0
+    HAL_MutexLock(c->lock_list_pub);
+    HAL_MutexLock(c->lock_generic);
+    /* skip packet id of QoS1 publish which is still waiting for PUBACK */
+    do {
+        c->packet_id = (c->packet_id == IOTX_MC_PACKET_ID_MAX) ? 1 : c->packet_id + 1;
+        id = c->packet_id;
+    } while (iotx_mc_pub_info_in_flight(c, (uint16_t)id));
+    HAL_MutexUnlock(c->lock_generic);
+    HAL_MutexUnlock(c->lock_list_pub);
 #else
-        mqtt_warning("handler->topic: %s", handler->topic_filter);
+    HAL_MutexLock(c->lock_generic);
+    c->packet_id = (c->packet_id == IOTX_MC_PACKET_ID_MAX) ? 1 : c->packet_id + 1;
+    id = c->packet_id;
+    HAL_MutexUnlock(c->lock_generic);
 #endif
+
+    return id;
+}
+
+#if WITH_MQTT_SESSION_RESUME
+/* handler of topic filter sent to server which no handler before it has, must be called with lock_generic held */
+static int _mqtt_resub_is_first(iotx_mc_client_t *c, iotx_mc_topic_handle_t *handler)
+{
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_topic_handle_t *node = NULL;
+#else
+    int idx;
 #endif
-        list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
-            /* If subscribe the same topic and callback function, then ignore */
-#if defined(INSPECT_MQTT_FLOW) && defined (INFRA_LOG)
-#if WITH_MQTT_ZIP_TOPIC
-            HEXDUMP_DEBUG(node->topic_filter, MQTT_ZIP_PATH_DEFAULT_LEN);
+
+    if (handler->qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
+        return 0;
+    }
+
+#ifdef PLATFORM_HAS_DYNMEM
+    list_for_each_entry(node, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
+        if (node == handler) {
+            break;
+        }
 #else
-            mqtt_warning("node->topic: %s", node->topic_filter);
+    for (idx = 0; &c->list_sub_handle[idx] != handler; idx++) {
+        iotx_mc_topic_handle_t *node = &c->list_sub_handle[idx];
+
+        if (!node->used) {
+            continue;
+        }
+#endif
+        if (node->qos != IOTX_MQTT_QOS3_SUB_LOCAL && strcmp(node->topic_filter, handler->topic_filter) == 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* drop topic filters copied by last resubscribe, must be called with lock_generic held */
+static void _mqtt_resub_clear(iotx_mc_client_t *c)
+{
+#ifdef PLATFORM_HAS_DYNMEM
+    int idx;
+
+    if (c->resub != NULL) {
+        for (idx = 0; idx < c->resub_num; idx++) {
+            mqtt_free(c->resub[idx].topic);
+        }
+        mqtt_free(c->resub);
+        c->resub = NULL;
+    }
 #endif
+    c->resub_num = 0;
+}
+
+/* copy topic filter of each handler once, so they are resubscribed without walking handlers between packets,
+ * the copy is kept until SUBACK of every packet came, or the next connection */
+static int _mqtt_resub_snapshot(iotx_mc_client_t *c)
+{
+    iotx_mc_topic_handle_t     *handler = NULL;
+#ifdef PLATFORM_HAS_DYNMEM
+    int                         num = 0;
 #endif
-            if (0 == iotx_mc_check_handle_is_identical(node, handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
-            }
+
+    HAL_MutexLock(c->lock_generic);
+    _mqtt_resub_clear(c);
+#ifdef PLATFORM_HAS_DYNMEM
+    list_for_each_entry(handler, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
+        num++;
+    }
+    if (num > 0) {
+        c->resub = (iotx_mc_resub_t *)mqtt_malloc(num * sizeof(iotx_mc_resub_t));
+        if (c->resub == NULL) {
+            HAL_MutexUnlock(c->lock_generic);
+            return STATE_SYS_DEPEND_MALLOC;
         }
+        memset(c->resub, 0, num * sizeof(iotx_mc_resub_t));
+    }
+
+    list_for_each_entry(handler, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
 #else
-        for (idx = 0; idx < IOTX_MC_SUBHANDLE_LIST_MAX_LEN; idx++) {
-            /* If subscribe the same topic and callback function, then ignore */
-            if (&c->list_sub_handle[idx] != handler &&
-                0 == iotx_mc_check_handle_is_identical(&c->list_sub_handle[idx], handler)) {
-                mqtt_warning("dup sub,topic = %s", topicFilter);
-                dup = 1;
-            }
+    for (handler = &c->list_sub_handle[0]; handler < &c->list_sub_handle[IOTX_MC_SUBHANDLE_LIST_MAX_LEN]; handler++) {
+        if (!handler->used) {
+            continue;
         }
 #endif
-        if (dup == 0) {
-#ifdef PLATFORM_HAS_DYNMEM
-            list_add_tail(&handler->linked_list, &c->list_sub_handle);
-#endif
-        } else {
+        if (!_mqtt_resub_is_first(c, handler)) {
+            continue;
+        }
 #ifdef PLATFORM_HAS_DYNMEM
-            mqtt_free(handler->topic_filter);
-            mqtt_free(handler);
+        c->resub[c->resub_num].topic = mqtt_malloc(strlen(handler->topic_filter) + 1);
+        if (c->resub[c->resub_num].topic == NULL) {
+            _mqtt_resub_clear(c);
+            HAL_MutexUnlock(c->lock_generic);
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        memcpy(c->resub[c->resub_num].topic, handler->topic_filter, strlen(handler->topic_filter) + 1);
 #else
-            memset(handler, 0, sizeof(iotx_mc_topic_handle_t));
+        memcpy(c->resub[c->resub_num].topic, handler->topic_filter, CONFIG_MQTT_TOPIC_MAXLEN);
 #endif
-        }
-        HAL_MutexUnlock(c->lock_generic);
+        c->resub[c->resub_num].qos = (int)handler->qos;
+        c->resub_num++;
     }
+    HAL_MutexUnlock(c->lock_generic);
 
     return STATE_SUCCESS;
 }
 
-static int iotx_mc_get_next_packetid(iotx_mc_client_t *c)
+/* consume SUBACK of resubscribe, which user never asked for, and report topic filters refused, return 1 if it is one */
+static int _mqtt_resub_suback(iotx_mc_client_t *c, uint16_t packet_id, int *grantedQoS, int count)
 {
-    unsigned int id = 0;
+    int                         refused[MUTLI_SUBSCIRBE_MAX];
+    int                         idx = 0, num = 0, found = 0, pending = 0;
 
-    if (!c) {
-        return STATE_USER_INPUT_INVALID;
+    HAL_MutexLock(c->lock_generic);
+    for (idx = 0; idx < c->resub_num; idx++) {
+        if (c->resub[idx].packet_id != packet_id) {
+            pending += (c->resub[idx].packet_id != 0) ? 1 : 0;
+            continue;
+        }
+        c->resub[idx].packet_id = 0;
+        if ((found >= count || (uint8_t)grantedQoS[found] >= 0x80) && num < MUTLI_SUBSCIRBE_MAX) {
+            refused[num++] = idx;
+        }
+        found++;
+    }
+    HAL_MutexUnlock(c->lock_generic);
+
+    /* copy is only replaced by next connection, which is made by the thread reading this SUBACK */
+    for (idx = 0; idx < num; idx++) {
+        mqtt_err("resubscribe %s refused", c->resub[refused[idx]].topic);
+        iotx_state_event(ITE_STATE_MQTT_COMM, STATE_MQTT_SUB_REFUSED, c->resub[refused[idx]].topic);
+    }
+
+    if (found > 0 && pending == 0) {
+        HAL_MutexLock(c->lock_generic);
+        _mqtt_resub_clear(c);
+        HAL_MutexUnlock(c->lock_generic);
     }
 
+    return (found > 0) ? 1 : 0;
+}
+
+/* serialize SUBSCRIBE of copied topic filters from 'pos' on into send buffer, return count of them packed */
+static int _mqtt_resub_serialize(iotx_mc_client_t *c, int *pos, unsigned int msgId, int *len)
+{
+    MQTTString                  topic[MUTLI_SUBSCIRBE_MAX];
+    int                         qos[MUTLI_SUBSCIRBE_MAX];
+    int                         count = 0, bytes = 0, bytes_max = 0, idx = 0;
+#if WITH_MQTT_V5
+    MQTTProperties              props = MQTTProperties_initializer;
+#endif
+
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_DYN_BUF
+    bytes_max = (int)c->buf_size_send_max - MQTT_DYNBUF_SEND_MARGIN;
+#else
+    bytes_max = (int)c->buf_size_send - MQTT_DYNBUF_SEND_MARGIN;
+#endif
+
     HAL_MutexLock(c->lock_generic);
-    c->packet_id = (c->packet_id == IOTX_MC_PACKET_ID_MAX) ? 1 : c->packet_id + 1;
-    id = c->packet_id;
+    for (idx = *pos; idx < c->resub_num; idx++) {
+        if (count == MUTLI_SUBSCIRBE_MAX || (count > 0 && bytes + (int)strlen(c->resub[idx].topic) + 3 > bytes_max)) {
+            break;
+        }
+        memset(&topic[count], 0, sizeof(MQTTString));
+        topic[count].cstring = c->resub[idx].topic;
+        qos[count] = c->resub[idx].qos;
+        c->resub[idx].packet_id = (uint16_t)msgId;
+        bytes += (int)strlen(c->resub[idx].topic) + 3;
+        count++;
+    }
+    *pos = idx;
+
+    *len = 0;
+    if (count > 0 && _alloc_send_buffer(c, bytes) == STATE_SUCCESS) {
+#if WITH_MQTT_V5
+        *len = MQTTV5Serialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, &props,
+                                         count, topic, qos);
+#else
+        *len = MQTTSerialize_subscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, count,
+                                       topic, qos);
+#endif
+    }
     HAL_MutexUnlock(c->lock_generic);
 
-    return id;
+    return count;
+}
+
+/* subscribe topic filters of all handlers again, since server has lost them */
+static int iotx_mc_resubscribe(iotx_mc_client_t *c)
+{
+    int                         pos = 0, count = 0, len = 0, rc = STATE_SUCCESS;
+    unsigned int                msgId = 0;
+    iotx_time_t                 timer;
+
+    rc = _mqtt_resub_snapshot(c);
+    if (rc != STATE_SUCCESS) {
+        mqtt_err("resubscribe failed, rc = %d", rc);
+        return rc;
+    }
+
+    do {
+        msgId = iotx_mc_get_next_packetid(c);
+        iotx_time_init(&timer);
+        utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+        HAL_MutexLock(c->lock_write_buf);
+        count = _mqtt_resub_serialize(c, &pos, msgId, &len);
+        if (count > 0 && len <= 0) {
+            rc = STATE_MQTT_SERIALIZE_SUB_ERROR;
+        } else if (count > 0 && iotx_mc_send_packet(c, c->buf_send, len, &timer) != STATE_SUCCESS) {
+            rc = STATE_SYS_DEPEND_NWK_CLOSE;
+        }
+        _reset_send_buffer(c);
+        HAL_MutexUnlock(c->lock_write_buf);
+
+        if (count > 0) {
+            mqtt_info("resubscribe %d topics, packet id %u, rc = %d", count, msgId, rc);
+        }
+    } while (count > 0 && rc == STATE_SUCCESS);
+
+    return rc;
+}
+
+/* restore subscriptions unless server kept session, and resend QoS1 publishes of last connection without waiting */
+static void iotx_mc_session_resume(iotx_mc_client_t *c)
+{
+    if (c->session_present) {
+        mqtt_info("session present, skip resubscribe");
+        HAL_MutexLock(c->lock_generic);
+        _mqtt_resub_clear(c);
+        HAL_MutexUnlock(c->lock_generic);
+    } else if (iotx_mc_resubscribe(c) == STATE_SYS_DEPEND_NWK_CLOSE) {
+        iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+        return;
+    }
+
+#if !WITH_MQTT_ONLY_QOS0 && !defined(ASYNC_PROTOCOL_STACK)
+    /* PUBACK of them will never come on this connection unless they are resent */
+    MQTTPubInfoProc(c, 1);
+#endif
 }
+#endif
 
 static int iotx_mc_check_rule(char *iterm, iotx_mc_topic_type_t type)
 {
@@ -2344,6 +4459,9 @@ static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigne
 #else
     int idx = 0;
     iotx_mc_topic_handle_t s_handler;
+#endif
+#if WITH_MQTT_V5
+    MQTTProperties props = MQTTProperties_initializer;
 #endif
     if (!c || !topicFilter) {
         return STATE_USER_INPUT_INVALID;
@@ -2433,8 +4551,14 @@ static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigne
         return res;
     }
 
-    if ((len = MQTTSerialize_unsubscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, 1,
-                                         &topic)) <= 0) {
+#if WITH_MQTT_V5
+    len = MQTTV5Serialize_unsubscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, &props,
+                                      1, &topic);
+#else
+    len = MQTTSerialize_unsubscribe((unsigned char *)c->buf_send, c->buf_size_send, 0, (unsigned short)msgId, 1,
+                                    &topic);
+#endif
+    if (len <= 0) {
 #ifdef PLATFORM_HAS_DYNMEM
         mqtt_free(handler->topic_filter);
         mqtt_free(handler);
@@ -2468,7 +4592,26 @@ static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigne
 #endif
     /* we have to find the right message handler - indexed by topic */
     HAL_MutexLock(c->lock_generic);
-#ifdef PLATFORM_HAS_DYNMEM
+#if WITH_MQTT_SUB_TRIE
+    /* remove handles whose topic filter is identical to the unsubscribed one */
+    {
+        iotx_mc_topic_node_t *trie_node = _topic_trie_lookup(c, handler->topic_filter, 0);
+        if (trie_node != NULL) {
+            list_for_each_entry_safe(node, next, &trie_node->handles, trie_list, iotx_mc_topic_handle_t) {
+                mqtt_debug("topic be matched");
+                list_del(&node->linked_list);
+                list_del(&node->trie_list);
+                mqtt_free(node->topic_filter);
+                mqtt_free(node);
+            }
+            _topic_node_prune(trie_node);
+            _topic_trie_shrink(c);
+        }
+    }
+    (void)cur_topic;
+    mqtt_free(handler->topic_filter);
+    mqtt_free(handler);
+#elif defined(PLATFORM_HAS_DYNMEM)
     list_for_each_entry_safe(node, next, &c->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
         if (MQTTPacket_equals(&cur_topic, (char *)node->topic_filter)
             || iotx_mc_is_topic_matched((char *)node->topic_filter, &cur_topic)) {
@@ -2490,21 +4633,305 @@ static int MQTTUnsubscribe(iotx_mc_client_t *c, const char *topicFilter, unsigne
         }
     }
 #endif
-    HAL_MutexUnlock(c->lock_generic);
-    _reset_send_buffer(c);
+    HAL_MutexUnlock(c->lock_generic);
+    _reset_send_buffer(c);
+    HAL_MutexUnlock(c->lock_write_buf);
+    return STATE_SUCCESS;
+}
+
+int MQTTPublish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+
+{
+    int res = 0;
+    iotx_time_t         timer;
+    MQTTString          topic = MQTTString_initializer;
+    int                 len = 0;
+#if !WITH_MQTT_ONLY_QOS0
+    iotx_mc_pub_info_t  *node = NULL;
+#endif
+#if WITH_MQTT_V5
+    MQTTProperties      props = MQTTProperties_initializer;
+#endif
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    const char     *json_payload = NULL;
+#endif
+
+    if (!c || !topicName || !topic_msg) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    topic.cstring = (char *)topicName;
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    HAL_MutexLock(c->lock_list_pub);
+    HAL_MutexLock(c->lock_write_buf);
+
+    res = _alloc_send_buffer(c, strlen(topicName) + topic_msg->payload_len);
+    if (res < STATE_SUCCESS) {
+        HAL_MutexUnlock(c->lock_write_buf);
+        HAL_MutexUnlock(c->lock_list_pub);
+        return res;
+    }
+
+#if WITH_MQTT_V5
+    /* QoS1 publish may be republished after reconnect, when aliases of this connection are gone */
+    if (topic_msg->qos == IOTX_MQTT_QOS0) {
+        iotx_mc_topic_alias_tx(c, &topic, &props);
+    }
+    len = MQTTV5Serialize_publish((unsigned char *)c->buf_send,
+                                  c->buf_size_send,
+                                  0,
+                                  topic_msg->qos,
+                                  topic_msg->retain,
+                                  topic_msg->packet_id,
+                                  topic,
+                                  &props,
+                                  (unsigned char *)topic_msg->payload,
+                                  topic_msg->payload_len);
+#else
+    len = MQTTSerialize_publish((unsigned char *)c->buf_send,
+                                c->buf_size_send,
+                                0,
+                                topic_msg->qos,
+                                topic_msg->retain,
+                                topic_msg->packet_id,
+                                topic,
+                                (unsigned char *)topic_msg->payload,
+                                topic_msg->payload_len);
+#endif
+    if (len <= 0) {
+        mqtt_err("MQTTSerialize_publish is error, len=%d, buf_size_send=%u, payloadlen=%u",
+                 len,
+                 c->buf_size_send,
+                 topic_msg->payload_len);
+#if WITH_MQTT_V5
+        iotx_mc_topic_alias_tx_abort(c, &props);
+#endif
+        _reset_send_buffer(c);
+        HAL_MutexUnlock(c->lock_write_buf);
+        HAL_MutexUnlock(c->lock_list_pub);
+        return STATE_MQTT_SERIALIZE_PUB_ERROR;
+    }
+
+#if !WITH_MQTT_ONLY_QOS0
+    node = NULL;
+    /* If the QOS >1, push the information into list of wait publish ACK */
+    if (topic_msg->qos > IOTX_MQTT_QOS0) {
+        /* push into list */
+        res = iotx_mc_push_pubInfo_to(c, len, topic_msg->packet_id, &node);
+        if (res < STATE_SUCCESS) {
+            mqtt_err("push publish into to pubInfolist failed!");
+            _reset_send_buffer(c);
+            HAL_MutexUnlock(c->lock_write_buf);
+            HAL_MutexUnlock(c->lock_list_pub);
+            return res;
+        }
+    }
+#endif
+    /* queue the publish packet, it is sent with other frames by yield or flush */
+    if (iotx_mc_queue_packet(c, len, &timer) != STATE_SUCCESS) {
+#if !WITH_MQTT_ONLY_QOS0
+        if (topic_msg->qos > IOTX_MQTT_QOS0) {
+            /* If not even successfully sent to IP stack, meaningless to wait QOS1 ack, give up waiting */
+#ifdef PLATFORM_HAS_DYNMEM
+            iotx_mc_pub_info_release(c, node);
+#else
+            memset(node, 0, sizeof(iotx_mc_pub_info_t));
+#endif
+        }
+#endif
+#if WITH_MQTT_V5
+        iotx_mc_topic_alias_tx_abort(c, &props);
+#endif
+        _reset_send_buffer(c);
+        HAL_MutexUnlock(c->lock_write_buf);
+        HAL_MutexUnlock(c->lock_list_pub);
+        return STATE_SYS_DEPEND_NWK_CLOSE;
+    }
+
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    json_payload = (const char *)topic_msg->payload;
+
+    mqtt_info("Upstream Topic: '%s'", topicName);
+    mqtt_info("Upstream Payload:");
+    iotx_facility_json_print(json_payload, LOG_INFO_LEVEL, '>');
+
+#endif  /* #ifdef INFRA_LOG */
+
+    _reset_send_buffer(c);
+    HAL_MutexUnlock(c->lock_write_buf);
+    HAL_MutexUnlock(c->lock_list_pub);
+
+    return STATE_SUCCESS;
+}
+
+#ifdef PLATFORM_HAS_DYNMEM
+/*
+ * Publish with only header serialized, payload is written from caller's buffer.
+ * QoS1 payload is kept by reference if 'by_ref' is set, then its '*payload_free' is taken over
+ * and cleared, otherwise payload is copied once for republish.
+ */
+static int MQTTPublishRef(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                          int by_ref, iotx_mqtt_payload_free_fpt *payload_free)
+{
+    int                 rc = 0;
+    int                 len = 0;
+    iotx_time_t         timer;
+    MQTTString          topic = MQTTString_initializer;
+    unsigned char       header[MQTT_PUBLISH_HEADER_MAX_LEN];
+    hal_iovec_t         iov[2];
+#if !WITH_MQTT_ONLY_QOS0
+    iotx_mc_payload_t  *payload = NULL;
+    iotx_mc_pub_info_t *node = NULL;
+#endif
+#if WITH_MQTT_V5
+    MQTTProperties      props = MQTTProperties_initializer;
+#endif
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    const char     *json_payload = NULL;
+#endif
+
+    if (!c || !topicName || !topic_msg) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    topic.cstring = (char *)topicName;
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    HAL_MutexLock(c->lock_list_pub);
+
+#if WITH_MQTT_V5
+    /* QoS1 publish may be republished after reconnect, when aliases of this connection are gone */
+    if (topic_msg->qos == IOTX_MQTT_QOS0) {
+        iotx_mc_topic_alias_tx(c, &topic, &props);
+    }
+    len = MQTTV5Serialize_publishHeader(header,
+                                        sizeof(header),
+                                        0,
+                                        topic_msg->qos,
+                                        topic_msg->retain,
+                                        topic_msg->packet_id,
+                                        topic,
+                                        &props,
+                                        topic_msg->payload_len);
+#else
+    len = MQTTSerialize_publishHeader(header,
+                                      sizeof(header),
+                                      0,
+                                      topic_msg->qos,
+                                      topic_msg->retain,
+                                      topic_msg->packet_id,
+                                      topic,
+                                      topic_msg->payload_len);
+#endif
+    if (len <= 0) {
+        mqtt_err("MQTTSerialize_publishHeader is error, len=%d, payloadlen=%u", len, topic_msg->payload_len);
+#if WITH_MQTT_V5
+        iotx_mc_topic_alias_tx_abort(c, &props);
+#endif
+        HAL_MutexUnlock(c->lock_list_pub);
+        return STATE_MQTT_SERIALIZE_PUB_ERROR;
+    }
+
+    iov[0].base = header;
+    iov[0].len = len;
+    iov[1].base = topic_msg->payload;
+    iov[1].len = topic_msg->payload_len;
+
+#if !WITH_MQTT_ONLY_QOS0
+    if (topic_msg->qos > IOTX_MQTT_QOS0) {
+        /* republish node keeps header and a reference of payload */
+        payload = iotx_mc_payload_new(topic_msg->payload, topic_msg->payload_len, !by_ref);
+        if (payload == NULL) {
+            HAL_MutexUnlock(c->lock_list_pub);
+            return STATE_SYS_DEPEND_MALLOC;
+        }
+        rc = _pub_info_add(c, (const char *)header, len, topic_msg->packet_id, payload, &node);
+        if (rc < STATE_SUCCESS) {
+            mqtt_err("push publish into to pubInfolist failed!");
+            iotx_mc_payload_release(payload);
+            HAL_MutexUnlock(c->lock_list_pub);
+            return rc;
+        }
+    }
+#endif
+
+    HAL_MutexLock(c->lock_write_buf);
+    rc = iotx_mc_send_iov(c, iov, 2, &timer);
     HAL_MutexUnlock(c->lock_write_buf);
+
+#if WITH_MQTT_V5
+    if (rc < STATE_SUCCESS) {
+        iotx_mc_topic_alias_tx_abort(c, &props);
+    }
+#endif
+
+#if !WITH_MQTT_ONLY_QOS0
+    if (payload != NULL) {
+        if (rc < STATE_SUCCESS) {
+            /* If not even successfully sent to IP stack, meaningless to wait QOS1 ack, give up waiting */
+            iotx_mc_pub_info_release(c, node);
+        } else if (by_ref) {
+            payload->free_fp = *payload_free;
+            *payload_free = NULL;
+        }
+        iotx_mc_payload_release(payload);
+    }
+#endif
+    HAL_MutexUnlock(c->lock_list_pub);
+
+    if (rc < STATE_SUCCESS) {
+        return STATE_SYS_DEPEND_NWK_CLOSE;
+    }
+
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    json_payload = (const char *)topic_msg->payload;
+
+    mqtt_info("Upstream Topic: '%s'", topicName);
+    mqtt_info("Upstream Payload:");
+    iotx_facility_json_print(json_payload, LOG_INFO_LEVEL, '>');
+
+#endif  /* #ifdef INFRA_LOG */
+
     return STATE_SUCCESS;
 }
+#endif
 
-int MQTTPublish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+#if !WITH_MQTT_ONLY_QOS0 && (WITH_MQTT_SUBMIT_QUEUE || WITH_MQTT_PUB_RATE_LIMIT)
+/* QoS1 publish queued by application could not be kept for PUBACK, it is dropped and user is told so */
+static void iotx_mc_publish_drop(iotx_mc_client_t *c, uint16_t msg_id, int rc)
+{
+    iotx_mqtt_event_msg_t msg;
+
+    mqtt_err("QoS1 publish %u dropped, rc = %d", msg_id, rc);
+    if (NULL != c->handle_event.h_fp) {
+        msg.event_type = IOTX_MQTT_EVENT_PUBLISH_NACK;
+        msg.msg = (void *)(uintptr_t)msg_id;
+        _handle_event(&c->handle_event, c, &msg);
+    }
+}
+#endif
 
+#if WITH_MQTT_SUBMIT_QUEUE
+/*
+ * Serialize publish into a frame of its own and push it into submission queue, yield sends it later.
+ * Publish never waits for socket here, STATE_MQTT_SUBMIT_QUEUE_FULL is returned when yield falls behind.
+ */
+static int MQTTPublishSubmit(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
 {
-    int res = 0;
-    iotx_time_t         timer;
-    MQTTString          topic = MQTTString_initializer;
+    int                 rc = 0;
     int                 len = 0;
+    uint32_t            size = 0;
 #if !WITH_MQTT_ONLY_QOS0
-    iotx_mc_pub_info_t  *node = NULL;
+    uint32_t            wait_num = 0;
+#endif
+    char               *frame = NULL;
+    uint16_t            msg_id = 0;
+    MQTTString          topic = MQTTString_initializer;
+#if WITH_MQTT_V5
+    MQTTProperties      props = MQTTProperties_initializer;
 #endif
 #ifdef INFRA_LOG_NETWORK_PAYLOAD
     const char     *json_payload = NULL;
@@ -2514,22 +4941,46 @@ int MQTTPublish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info
         return STATE_USER_INPUT_INVALID;
     }
 
-    topic.cstring = (char *)topicName;
-    iotx_time_init(&timer);
-    utils_time_countdown_ms(&timer, c->request_timeout_ms);
-
-    HAL_MutexLock(c->lock_list_pub);
-    HAL_MutexLock(c->lock_write_buf);
-
-    res = _alloc_send_buffer(c, strlen(topicName) + topic_msg->payload_len);
-    if (res < STATE_SUCCESS) {
-        HAL_MutexUnlock(c->lock_write_buf);
+#if !WITH_MQTT_ONLY_QOS0
+    if (topic_msg->qos > IOTX_MQTT_QOS0) {
+        HAL_MutexLock(c->lock_list_pub);
+        wait_num = c->pub_wait_num;
         HAL_MutexUnlock(c->lock_list_pub);
-        return res;
+        /* others may submit meanwhile, yield drops the publish and tells user if republish list turns out to be full */
+        if (wait_num + IOTX_MC_ATOMIC_LOAD(&c->submit_queue.qos1_num) >= IOTX_MC_REPUB_NUM_MAX) {
+            mqtt_err("more than %u QoS1 publish waiting for PUBACK", IOTX_MC_REPUB_NUM_MAX);
+            return STATE_MQTT_QOS1_REPUB_EXCEED_MAX;
+        }
+        msg_id = topic_msg->packet_id;
     }
+#endif
 
-    len = MQTTSerialize_publish((unsigned char *)c->buf_send,
-                                c->buf_size_send,
+    topic.cstring = (char *)topicName;
+    size = MQTT_FIXED_HEADER_MAX_LEN + 2 + strlen(topicName) + 2 + MQTT_PUBLISH_PROPS_MAX_LEN + topic_msg->payload_len;
+    frame = mqtt_malloc(size);
+    if (frame == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+
+#if WITH_MQTT_V5
+    /* alias is assigned and pushed under lock, so that the PUBLISH setting an alias is sent before the ones using it */
+    HAL_MutexLock(c->lock_list_pub);
+    if (topic_msg->qos == IOTX_MQTT_QOS0) {
+        iotx_mc_topic_alias_tx(c, &topic, &props);
+    }
+    len = MQTTV5Serialize_publish((unsigned char *)frame,
+                                  size,
+                                  0,
+                                  topic_msg->qos,
+                                  topic_msg->retain,
+                                  topic_msg->packet_id,
+                                  topic,
+                                  &props,
+                                  (unsigned char *)topic_msg->payload,
+                                  topic_msg->payload_len);
+#else
+    len = MQTTSerialize_publish((unsigned char *)frame,
+                                size,
                                 0,
                                 topic_msg->qos,
                                 topic_msg->retain,
@@ -2537,66 +4988,247 @@ int MQTTPublish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info
                                 topic,
                                 (unsigned char *)topic_msg->payload,
                                 topic_msg->payload_len);
-    if (len <= 0) {
-        mqtt_err("MQTTSerialize_publish is error, len=%d, buf_size_send=%u, payloadlen=%u",
-                 len,
-                 c->buf_size_send,
-                 topic_msg->payload_len);
-        _reset_send_buffer(c);
+#endif
+    rc = (len > 0) ? iotx_mc_submit_push(&c->submit_queue, frame, len, msg_id) : STATE_MQTT_SERIALIZE_PUB_ERROR;
+#if WITH_MQTT_V5
+    if (rc < STATE_SUCCESS) {
+        iotx_mc_topic_alias_tx_abort(c, &props);
+    }
+    HAL_MutexUnlock(c->lock_list_pub);
+#endif
+    if (rc < STATE_SUCCESS) {
+        mqtt_err("submit publish failed, rc = %d", rc);
+        mqtt_free(frame);
+        return rc;
+    }
+
+#ifdef INFRA_LOG_NETWORK_PAYLOAD
+    json_payload = (const char *)topic_msg->payload;
+
+    mqtt_info("Upstream Topic: '%s'", topicName);
+    mqtt_info("Upstream Payload:");
+    iotx_facility_json_print(json_payload, LOG_INFO_LEVEL, '>');
+
+#endif  /* #ifdef INFRA_LOG */
+
+    return STATE_SUCCESS;
+}
+
+/* send publishes submitted by application threads in their order, they are dropped if offline, called by yield only */
+static int iotx_mc_submit_drain(iotx_mc_client_t *c)
+{
+    int                 rc = STATE_SUCCESS;
+    int                 connected = 0;
+    char               *frame = NULL;
+    uint32_t            len = 0;
+    uint16_t            msg_id = 0;
+    iotx_time_t         timer;
+#if !WITH_MQTT_ONLY_QOS0
+    iotx_mc_pub_info_t *node = NULL;
+    int                 add_rc = 0;
+#endif
+
+    connected = (iotx_mc_get_client_state(c) == IOTX_MC_STATE_CONNECTED);
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
+
+    while (iotx_mc_submit_pop(&c->submit_queue, &frame, &len, &msg_id)) {
+#if !WITH_MQTT_ONLY_QOS0
+        if (msg_id != 0) {
+            /* QoS1 publish not sent now is republished after reconnected */
+            HAL_MutexLock(c->lock_list_pub);
+            add_rc = _pub_info_add(c, frame, len, msg_id, NULL, &node);
+            HAL_MutexUnlock(c->lock_list_pub);
+            if (add_rc < STATE_SUCCESS) {
+                /* PUBACK of it could never be matched, so it is not sent at all */
+                iotx_mc_publish_drop(c, msg_id, add_rc);
+                mqtt_free(frame);
+                continue;
+            }
+        }
+#endif
+        if (!connected || rc < STATE_SUCCESS) {
+            mqtt_free(frame);
+            continue;
+        }
+
+        HAL_MutexLock(c->lock_write_buf);
+#if WITH_MQTT_TX_QUEUE
+        if (iotx_mc_tx_queue_room(c, len)) {
+            iotx_mc_tx_queue_add(c, frame, len);
+            frame = NULL;
+        }
+#endif
+        if (frame != NULL) {
+            rc = iotx_mc_send_packet(c, frame, len, &timer);
+            mqtt_free(frame);
+        }
         HAL_MutexUnlock(c->lock_write_buf);
+    }
+
+    if (rc < STATE_SUCCESS) {
+        mqtt_err("send submitted publish failed, rc = %d", rc);
+        iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+    }
+    return rc;
+}
+#endif
+
+#if WITH_MQTT_PUB_RATE_LIMIT
+/*
+ * Take tokens of publish, or serialize it into a frame of its own and queue it if there are none.
+ * Return 1 if it is queued and yield sends it later, 0 if it is to be sent now.
+ */
+static int iotx_mc_rate_publish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+{
+    int                     rc = 0;
+    int                     len = 0;
+    uint32_t                size = 0;
+    char                   *frame = NULL;
+    uint16_t                msg_id = 0;
+    iotx_mqtt_rate_class_t  cls = iotx_mc_rate_class(topicName);
+#if !WITH_MQTT_ONLY_QOS0
+    uint32_t                wait_num = 0;
+#endif
+    MQTTString              topic = MQTTString_initializer;
+#if WITH_MQTT_V5
+    MQTTProperties          props = MQTTProperties_initializer;
+#endif
+
+#if !WITH_MQTT_ONLY_QOS0
+    if (topic_msg->qos > IOTX_MQTT_QOS0) {
+        HAL_MutexLock(c->lock_list_pub);
+        wait_num = c->pub_wait_num;
         HAL_MutexUnlock(c->lock_list_pub);
-        return STATE_MQTT_SERIALIZE_PUB_ERROR;
+    }
+#endif
+
+    HAL_MutexLock(c->rate.lock);
+    if (iotx_mc_rate_take(&c->rate, cls)) {
+        HAL_MutexUnlock(c->rate.lock);
+        return 0;
     }
 
 #if !WITH_MQTT_ONLY_QOS0
-    node = NULL;
-    /* If the QOS >1, push the information into list of wait publish ACK */
     if (topic_msg->qos > IOTX_MQTT_QOS0) {
-        /* push into list */
-        res = iotx_mc_push_pubInfo_to(c, len, topic_msg->packet_id, &node);
-        if (res < STATE_SUCCESS) {
-            mqtt_err("push publish into to pubInfolist failed!");
-            _reset_send_buffer(c);
-            HAL_MutexUnlock(c->lock_write_buf);
-            HAL_MutexUnlock(c->lock_list_pub);
-            return res;
+        /* yield drops the publish and tells user if republish list turns out to be full */
+        if (wait_num + c->rate.qos1_num >= IOTX_MC_REPUB_NUM_MAX) {
+            HAL_MutexUnlock(c->rate.lock);
+            mqtt_err("more than %u QoS1 publish waiting for PUBACK", IOTX_MC_REPUB_NUM_MAX);
+            return STATE_MQTT_QOS1_REPUB_EXCEED_MAX;
         }
+        msg_id = topic_msg->packet_id;
     }
 #endif
-    /* send the publish packet */
-    if (iotx_mc_send_packet(c, c->buf_send, len, &timer) != STATE_SUCCESS) {
-#if !WITH_MQTT_ONLY_QOS0
-        if (topic_msg->qos > IOTX_MQTT_QOS0) {
-            /* If not even successfully sent to IP stack, meaningless to wait QOS1 ack, give up waiting */
-#ifdef PLATFORM_HAS_DYNMEM
-            list_del(&node->linked_list);
-            mqtt_free(node);
+
+    /* queued frame may be sent on next connection, so it carries topic name instead of alias */
+    topic.cstring = (char *)topicName;
+    size = MQTT_FIXED_HEADER_MAX_LEN + 2 + strlen(topicName) + 2 + MQTT_PUBLISH_PROPS_MAX_LEN + topic_msg->payload_len;
+    frame = mqtt_malloc(size);
+    if (frame == NULL) {
+        HAL_MutexUnlock(c->rate.lock);
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+
+#if WITH_MQTT_V5
+    len = MQTTV5Serialize_publish((unsigned char *)frame,
+                                  size,
+                                  0,
+                                  topic_msg->qos,
+                                  topic_msg->retain,
+                                  topic_msg->packet_id,
+                                  topic,
+                                  &props,
+                                  (unsigned char *)topic_msg->payload,
+                                  topic_msg->payload_len);
 #else
-            memset(node, 0, sizeof(iotx_mc_pub_info_t));
+    len = MQTTSerialize_publish((unsigned char *)frame,
+                                size,
+                                0,
+                                topic_msg->qos,
+                                topic_msg->retain,
+                                topic_msg->packet_id,
+                                topic,
+                                (unsigned char *)topic_msg->payload,
+                                topic_msg->payload_len);
 #endif
-        }
+    rc = (len > 0) ? iotx_mc_rate_defer(&c->rate, cls, frame, len, msg_id) : STATE_MQTT_SERIALIZE_PUB_ERROR;
+    HAL_MutexUnlock(c->rate.lock);
+    if (rc < STATE_SUCCESS) {
+        mqtt_err("queue rate limited publish failed, rc = %d", rc);
+        mqtt_free(frame);
+        return rc;
+    }
+
+    mqtt_debug("publish of class %d queued by rate limit", cls);
+    return 1;
+}
+
+/* send publishes held back by rate limit as tokens come back, they stay queued while offline, called by yield only */
+static int iotx_mc_rate_drain(iotx_mc_client_t *c)
+{
+    int                 rc = STATE_SUCCESS;
+    int                 popped = 0;
+    char               *frame = NULL;
+    uint32_t            len = 0;
+    uint16_t            msg_id = 0;
+    iotx_time_t         timer;
+#if !WITH_MQTT_ONLY_QOS0
+    iotx_mc_pub_info_t *node = NULL;
+    int                 add_rc = 0;
 #endif
-        _reset_send_buffer(c);
-        HAL_MutexUnlock(c->lock_write_buf);
-        HAL_MutexUnlock(c->lock_list_pub);
-        return STATE_SYS_DEPEND_NWK_CLOSE;
+
+    if (iotx_mc_get_client_state(c) != IOTX_MC_STATE_CONNECTED) {
+        return STATE_SUCCESS;
     }
 
-#ifdef INFRA_LOG_NETWORK_PAYLOAD
-    json_payload = (const char *)topic_msg->payload;
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, c->request_timeout_ms);
 
-    mqtt_info("Upstream Topic: '%s'", topicName);
-    mqtt_info("Upstream Payload:");
-    iotx_facility_json_print(json_payload, LOG_INFO_LEVEL, '>');
+    while (rc == STATE_SUCCESS) {
+        HAL_MutexLock(c->rate.lock);
+        popped = iotx_mc_rate_pop(&c->rate, &frame, &len, &msg_id);
+        HAL_MutexUnlock(c->rate.lock);
+        if (!popped) {
+            break;
+        }
 
-#endif  /* #ifdef INFRA_LOG */
+#if !WITH_MQTT_ONLY_QOS0
+        if (msg_id != 0) {
+            /* QoS1 publish lost with connection is republished after reconnected */
+            HAL_MutexLock(c->lock_list_pub);
+            add_rc = _pub_info_add(c, frame, len, msg_id, NULL, &node);
+            HAL_MutexUnlock(c->lock_list_pub);
+            if (add_rc < STATE_SUCCESS) {
+                /* PUBACK of it could never be matched, so it is not sent at all */
+                iotx_mc_publish_drop(c, msg_id, add_rc);
+                mqtt_free(frame);
+                continue;
+            }
+        }
+#endif
 
-    _reset_send_buffer(c);
-    HAL_MutexUnlock(c->lock_write_buf);
-    HAL_MutexUnlock(c->lock_list_pub);
+        HAL_MutexLock(c->lock_write_buf);
+#if WITH_MQTT_TX_QUEUE
+        if (iotx_mc_tx_queue_room(c, len)) {
+            iotx_mc_tx_queue_add(c, frame, len);
+            frame = NULL;
+        }
+#endif
+        if (frame != NULL) {
+            rc = iotx_mc_send_packet(c, frame, len, &timer);
+            mqtt_free(frame);
+        }
+        HAL_MutexUnlock(c->lock_write_buf);
+    }
 
-    return STATE_SUCCESS;
+    if (rc < STATE_SUCCESS) {
+        mqtt_err("send rate limited publish failed, rc = %d", rc);
+        iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
+    }
+    return rc;
 }
+#endif
 
 static int MQTTDisconnect(iotx_mc_client_t *c)
 {
@@ -2795,20 +5427,48 @@ int wrapper_mqtt_release(void **c)
     iotx_mc_set_client_state(pClient, IOTX_MC_STATE_INVALID);
     HAL_SleepMs(100);
 
+#if WITH_MQTT_DISPATCH
+    /* workers match messages against subscriptions, so they are stopped first */
+    iotx_mc_dispatch_deinit(&pClient->dispatch);
+#endif
+
 #ifdef PLATFORM_HAS_DYNMEM
     list_for_each_entry_safe(node, next, &pClient->list_sub_handle, linked_list, iotx_mc_topic_handle_t) {
         list_del(&node->linked_list);
+#if WITH_MQTT_SUB_TRIE
+        iotx_mc_topic_trie_remove(pClient, node);
+#endif
         mqtt_free(node->topic_filter);
         mqtt_free(node);
     }
 #else
     memset(pClient->list_sub_handle, 0, sizeof(iotx_mc_topic_handle_t) * IOTX_MC_SUBHANDLE_LIST_MAX_LEN);
+#endif
+#if WITH_MQTT_SUBMIT_QUEUE
+    /* state is invalid, frames are freed without being sent */
+    iotx_mc_submit_drain(pClient);
+#endif
+#if WITH_MQTT_PUB_RATE_LIMIT
+    iotx_mc_rate_deinit(&pClient->rate);
+#endif
+#if WITH_MQTT_TX_QUEUE
+    iotx_mc_tx_queue_drop(pClient);
+#endif
+#if WITH_MQTT_V5
+    iotx_mc_topic_alias_reset(pClient, 0);
+#endif
+#if WITH_MQTT_JOURNAL
+    iotx_mc_journal_deinit(&pClient->journal);
+#endif
+#if WITH_MQTT_SESSION_RESUME
+    _mqtt_resub_clear(pClient);
 #endif
     HAL_MutexDestroy(pClient->lock_generic);
     HAL_MutexDestroy(pClient->lock_list_pub);
     HAL_MutexDestroy(pClient->lock_write_buf);
     HAL_MutexDestroy(pClient->lock_yield);
     HAL_MutexDestroy(pClient->lock_read_buf);
+    HAL_SemaphoreDestroy(pClient->sem_wakeup);
 
 #if !WITH_MQTT_ONLY_QOS0
     iotx_mc_pub_wait_list_deinit(pClient);
@@ -2822,13 +5482,43 @@ int wrapper_mqtt_release(void **c)
         mqtt_free(pClient->buf_read);
         pClient->buf_read = NULL;
     }
-    mqtt_free(pClient);
+    mqtt_free(pClient);
+#else
+    memset(pClient, 0, sizeof(iotx_mc_client_t));
+#endif
+    *c = NULL;
+    mqtt_info("mqtt release!");
+    return STATE_SUCCESS;
+}
+
+int wrapper_mqtt_flush(void *client)
+{
+    iotx_mc_client_t *pClient = (iotx_mc_client_t *)client;
+#if WITH_MQTT_SUBMIT_QUEUE
+    int rc = STATE_SUCCESS;
+#endif
+
+    if (pClient == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    if (!wrapper_mqtt_check_state(pClient)) {
+        return STATE_MQTT_IN_OFFLINE_STATUS;
+    }
+
+#if WITH_MQTT_SUBMIT_QUEUE
+    /* submission queue has only one consumer, the thread holding lock_yield, which yield releases once woken up */
+    iotx_mc_wakeup(pClient);
+    HAL_MutexLock(pClient->lock_yield);
+    rc = iotx_mc_submit_drain(pClient);
+    if (rc == STATE_SUCCESS) {
+        rc = iotx_mc_tx_queue_flush(pClient, 0);
+    }
+    HAL_MutexUnlock(pClient->lock_yield);
+    return rc;
 #else
-    memset(pClient, 0, sizeof(iotx_mc_client_t));
+    return iotx_mc_tx_queue_flush(pClient, 0);
 #endif
-    *c = NULL;
-    mqtt_info("mqtt release!");
-    return STATE_SUCCESS;
 }
 
 int wrapper_mqtt_yield(void *client, int timeout_ms)
@@ -2851,6 +5541,13 @@ int wrapper_mqtt_yield(void *client, int timeout_ms)
     pClient->cycle_timeout_ms = timeout_ms;
     /* Keep MQTT alive or reconnect if connection abort */
     iotx_mc_keepalive(pClient);
+    /* send frames queued since last yield, PINGREQ included */
+#if WITH_MQTT_SUBMIT_QUEUE
+    iotx_mc_submit_drain(pClient);
+#endif
+    if (iotx_mc_get_client_state(pClient) == IOTX_MC_STATE_CONNECTED) {
+        iotx_mc_tx_queue_flush(pClient, 0);
+    }
     HAL_MutexUnlock(pClient->lock_yield);
 
 #ifndef ASYNC_PROTOCOL_STACK
@@ -2859,7 +5556,10 @@ int wrapper_mqtt_yield(void *client, int timeout_ms)
     if (pClient->client_state == IOTX_MC_STATE_CONNECTED) {
 #if !WITH_MQTT_ONLY_QOS0
         /* check list of wait publish ACK to remove node that is ACKED or timeout */
-        MQTTPubInfoProc(pClient);
+        MQTTPubInfoProc(pClient, 0);
+#endif
+#if WITH_MQTT_JOURNAL
+        iotx_mc_journal_proc(pClient);
 #endif
     }
     HAL_SleepMs(timeout_ms);
@@ -2884,6 +5584,102 @@ int wrapper_mqtt_check_state(void *client)
     return 0;
 }
 
+int wrapper_mqtt_keepalive_stats(void *client, iotx_mqtt_keepalive_stats_pt stats)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL || stats == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    memset(stats, 0, sizeof(iotx_mqtt_keepalive_stats_t));
+    stats->interval_ms = c->keepalive_ms;
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+    stats->safe_ms = c->keepalive_safe_ms;
+#endif
+    stats->ping_sent = c->ping_sent;
+    stats->ping_resp = c->ping_resp;
+    stats->ping_lost = c->ping_lost;
+    return STATE_SUCCESS;
+}
+
+int wrapper_mqtt_set_backlog_source(void *client, iotx_mqtt_backlog_fpt backlog_fp, void *pcontext)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+#if WITH_MQTT_RX_BACKPRESSURE
+    HAL_MutexLock(c->lock_generic);
+    c->rx_backlog_fp = backlog_fp;
+    c->rx_backlog_ctx = pcontext;
+    HAL_MutexUnlock(c->lock_generic);
+#endif
+    return STATE_SUCCESS;
+}
+
+int wrapper_mqtt_rx_stats(void *client, iotx_mqtt_rx_stats_pt stats)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL || stats == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    memset(stats, 0, sizeof(iotx_mqtt_rx_stats_t));
+#if WITH_MQTT_RX_BACKPRESSURE
+    stats->backlog = c->rx_backlog;
+    stats->backlog_peak = c->rx_backlog_peak;
+    stats->paused = c->rx_paused;
+    stats->pause_count = c->rx_pause_count;
+    stats->pause_ms = c->rx_pause_ms;
+    if (c->rx_paused) {
+        stats->pause_ms += utils_time_spend(&c->rx_pause_time);
+    }
+#endif
+#if WITH_MQTT_RX_DEDUP
+    stats->duplicates = c->dedup.duplicates;
+#endif
+    return STATE_SUCCESS;
+}
+
+int wrapper_mqtt_set_rate_limit(void *client, iotx_mqtt_rate_class_t cls, uint32_t per_sec, uint32_t burst)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL || cls > IOTX_MQTT_RATE_CLASS_MAX) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+#if WITH_MQTT_PUB_RATE_LIMIT
+    iotx_mc_rate_set(&c->rate, cls, per_sec, burst);
+    /* queued publishes may be due earlier now */
+    iotx_mc_wakeup(c);
+#endif
+    return STATE_SUCCESS;
+}
+
+int wrapper_mqtt_rate_stats(void *client, iotx_mqtt_rate_stats_pt stats)
+{
+    iotx_mc_client_t *c = (iotx_mc_client_t *)client;
+
+    if (c == NULL || stats == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    memset(stats, 0, sizeof(iotx_mqtt_rate_stats_t));
+#if WITH_MQTT_PUB_RATE_LIMIT
+    HAL_MutexLock(c->rate.lock);
+    stats->queued = c->rate.queue_num;
+    stats->deferred = c->rate.deferred;
+    stats->rejected = c->rate.rejected;
+    HAL_MutexUnlock(c->rate.lock);
+#endif
+    return STATE_SUCCESS;
+}
+
 int wrapper_mqtt_subscribe(void *client,
                            const char *topicFilter,
                            iotx_mqtt_qos_t qos,
@@ -2986,6 +5782,9 @@ int wrapper_mqtt_subscribe_sync(void *c,
 #endif
 #ifdef PLATFORM_HAS_DYNMEM
             node = (mqtt_sub_sync_node_t *)mqtt_malloc(sizeof(mqtt_sub_sync_node_t));
+            if (node != NULL) {
+                memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+            }
 #else
             for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
                 if (client->list_sub_sync_ack[idx].used == 0) {
@@ -3086,6 +5885,222 @@ int wrapper_mqtt_subscribe_sync(void *c,
     return STATE_MQTT_SYNC_SUB_TIMEOUT;
 }
 
+/* largest bytes of topic filters packed into one SUBSCRIBE packet */
+static int _sub_multi_bytes_max(iotx_mc_client_t *c)
+{
+#if defined(PLATFORM_HAS_DYNMEM) && WITH_MQTT_DYN_BUF
+    return (int)c->buf_size_send_max - MQTT_DYNBUF_SEND_MARGIN;
+#else
+    return (int)c->buf_size_send - MQTT_DYNBUF_SEND_MARGIN;
+#endif
+}
+
+static int _sub_multi_node_add(iotx_mc_client_t *c, unsigned int packet_id, iotx_mqtt_sub_entry_t *entry, int num)
+{
+    mqtt_sub_sync_node_t *node = NULL;
+#ifndef PLATFORM_HAS_DYNMEM
+    int idx = 0;
+#endif
+
+#ifdef PLATFORM_HAS_DYNMEM
+    node = (mqtt_sub_sync_node_t *)mqtt_malloc(sizeof(mqtt_sub_sync_node_t));
+    if (node == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+#endif
+
+    HAL_MutexLock(c->lock_generic);
+#ifndef PLATFORM_HAS_DYNMEM
+    for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
+        if (c->list_sub_sync_ack[idx].used == 0) {
+            node = &c->list_sub_sync_ack[idx];
+            memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+            node->used = 1;
+            break;
+        }
+    }
+    if (node == NULL) {
+        HAL_MutexUnlock(c->lock_generic);
+        return STATE_MQTT_SUB_EXCEED_MAX;
+    }
+#endif
+    node->packet_id = packet_id;
+    node->ack_type = IOTX_MQTT_EVENT_UNDEF;
+    node->entry = entry;
+    node->entry_num = num;
+#ifdef PLATFORM_HAS_DYNMEM
+    list_add_tail(&node->linked_list, &c->list_sub_sync_ack);
+#endif
+    HAL_MutexUnlock(c->lock_generic);
+
+    return STATE_SUCCESS;
+}
+
+/* remove nodes of 'entry' which got SUBACK, or all of them if 'remove_all', return count of nodes left */
+static int _sub_multi_node_collect(iotx_mc_client_t *c, iotx_mqtt_sub_entry_t *entry, int count, int remove_all)
+{
+    int left = 0;
+#ifdef PLATFORM_HAS_DYNMEM
+    mqtt_sub_sync_node_t *node = NULL;
+    mqtt_sub_sync_node_t *next = NULL;
+#else
+    mqtt_sub_sync_node_t *node = NULL;
+    int idx = 0;
+#endif
+
+    HAL_MutexLock(c->lock_generic);
+#ifdef PLATFORM_HAS_DYNMEM
+    list_for_each_entry_safe(node, next, &c->list_sub_sync_ack, linked_list, mqtt_sub_sync_node_t) {
+        if (node->entry < entry || node->entry >= entry + count) {
+            continue;
+        }
+        if (remove_all || node->ack_type != IOTX_MQTT_EVENT_UNDEF) {
+            list_del(&node->linked_list);
+            mqtt_free(node);
+        } else {
+            left++;
+        }
+    }
+#else
+    for (idx = 0; idx < IOTX_MC_SUBSYNC_LIST_MAX_LEN; idx++) {
+        node = &c->list_sub_sync_ack[idx];
+        if (!node->used || node->entry < entry || node->entry >= entry + count) {
+            continue;
+        }
+        if (remove_all || node->ack_type != IOTX_MQTT_EVENT_UNDEF) {
+            memset(node, 0, sizeof(mqtt_sub_sync_node_t));
+        } else {
+            left++;
+        }
+    }
+#endif
+    HAL_MutexUnlock(c->lock_generic);
+
+    return left;
+}
+
+int wrapper_mqtt_subscribe_multi_sync(void *c, iotx_mqtt_sub_entry_t *entry, int count, int timeout_ms)
+{
+    iotx_mc_client_t *client = (iotx_mc_client_t *)c;
+    iotx_time_t timer;
+    int idx, num, len, rc;
+    int bytes_max, wait;
+    int next = 0, left = 0, subed = 0;
+    unsigned int msgId;
+
+    if (client == NULL || entry == NULL || count <= 0) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    if (!wrapper_mqtt_check_state(client)) {
+        mqtt_err("mqtt client state is error,state = %d", iotx_mc_get_client_state(client));
+        return STATE_MQTT_IN_OFFLINE_STATUS;
+    }
+
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, timeout_ms);
+
+    /* local and invalid topics are done at once, the others are marked as waiting for SUBACK */
+    for (idx = 0; idx < count; idx++) {
+        if (entry[idx].topic_filter == NULL || strlen(entry[idx].topic_filter) == 0 ||
+            entry[idx].topic_handle_func == NULL) {
+            entry[idx].result = STATE_USER_INPUT_INVALID;
+        } else if ((rc = iotx_mc_check_topic(entry[idx].topic_filter, TOPIC_FILTER_TYPE)) < STATE_SUCCESS) {
+            mqtt_err("topic format is error,topicFilter = %s", entry[idx].topic_filter);
+            entry[idx].result = rc;
+        } else if (entry[idx].qos == IOTX_MQTT_QOS3_SUB_LOCAL) {
+            entry[idx].result = MQTTSubscribeLocal(client, &entry[idx]);
+        } else {
+            entry[idx].result = STATE_MQTT_SYNC_SUB_TIMEOUT;
+        }
+    }
+
+    /* SUBACK can't be received inside callback of yield, so packets are just sent */
+    wait = (_is_in_yield_cb() == 0);
+    bytes_max = _sub_multi_bytes_max(client);
+
+    do {
+        /* send SUBSCRIBE packets one after another, the number in flight is only limited by wait list */
+        while (next < count) {
+            if (entry[next].result != STATE_MQTT_SYNC_SUB_TIMEOUT) {
+                next++;
+                continue;
+            }
+
+            len = 0;
+            for (num = 0; next + num < count && num < MUTLI_SUBSCIRBE_MAX; num++) {
+                if (entry[next + num].result != STATE_MQTT_SYNC_SUB_TIMEOUT) {
+                    break;
+                }
+                len += strlen(entry[next + num].topic_filter) + 3;
+                if (num > 0 && len > bytes_max) {
+                    break;
+                }
+            }
+
+            msgId = iotx_mc_get_next_packetid(client);
+            if (wait) {
+                rc = _sub_multi_node_add(client, msgId, &entry[next], num);
+                if (rc < STATE_SUCCESS) {
+                    if (left > 0) {
+                        /* wait for some SUBACK to free wait list */
+                        break;
+                    }
+                    for (; next < count; next++) {
+                        entry[next].result = rc;
+                    }
+                    break;
+                }
+            }
+
+            mqtt_debug("PERFORM subscribe of %d topics (msgId=%d)", num, msgId);
+            rc = MQTTSubscribeMulti(client, &entry[next], num, msgId);
+            if (rc < STATE_SUCCESS) {
+                mqtt_err("run MQTTSubscribeMulti error, rc = %d", rc);
+                if (wait) {
+                    _sub_multi_node_collect(client, &entry[next], 1, 1);
+                }
+                if (rc == STATE_SYS_DEPEND_NWK_CLOSE) {
+                    iotx_mc_set_client_state(client, IOTX_MC_STATE_DISCONNECTED);
+                    num = count - next;
+                }
+                for (idx = 0; idx < num; idx++) {
+                    if (entry[next + idx].result == STATE_MQTT_SYNC_SUB_TIMEOUT) {
+                        entry[next + idx].result = rc;
+                    }
+                }
+            } else if (wait) {
+                left++;
+            }
+            next += num;
+        }
+
+        if (!wait || (left == 0 && next >= count) || !wrapper_mqtt_check_state(client)) {
+            break;
+        }
+
+        wrapper_mqtt_yield(client, 100);
+        left = _sub_multi_node_collect(client, entry, count, 0);
+    } while (!utils_time_is_expired(&timer));
+
+    if (wait) {
+        _sub_multi_node_collect(client, entry, count, 1);
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        if (entry[idx].result >= 0) {
+            subed++;
+        } else {
+            mqtt_warning("subscribe '%s' failed, rc = %d", entry[idx].topic_filter ? entry[idx].topic_filter : "",
+                         entry[idx].result);
+        }
+    }
+    mqtt_info("mqtt subscribe %d of %d topics", subed, count);
+
+    return subed;
+}
+
 int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter)
 {
     int rc = STATE_SUCCESS;
@@ -3122,7 +6137,9 @@ int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter)
     return (int)msgId;
 }
 
-int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+/* publish from caller's buffer when 'by_ref' is set or payload is large, see MQTTPublishRef() */
+static int _mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                         int by_ref, iotx_mqtt_payload_free_fpt *payload_free)
 {
     uint16_t msg_id = 0;
     int rc = STATE_SUCCESS;
@@ -3160,7 +6177,32 @@ int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_in
     HEXDUMP_DEBUG(topic_msg->payload, topic_msg->payload_len);
 #endif
 
-    rc = MQTTPublish(c, topicName, topic_msg);
+#if WITH_MQTT_PUB_RATE_LIMIT
+    /* payload is copied into queued frame, so that 'payload_free' is left to caller */
+    rc = iotx_mc_rate_publish(c, topicName, topic_msg);
+    if (rc < STATE_SUCCESS) {
+        return rc;
+    }
+    if (rc > 0) {
+        /* queued publish has a new deadline, let yield recompute its wait */
+        iotx_mc_wakeup(c);
+        return (int)msg_id;
+    }
+#endif
+
+#if WITH_MQTT_SUBMIT_QUEUE
+    /* payload is copied into submitted frame, so that 'payload_free' is left to caller */
+    rc = MQTTPublishSubmit(c, topicName, topic_msg);
+#else
+#ifdef PLATFORM_HAS_DYNMEM
+    if (by_ref || topic_msg->payload_len >= IOTX_MC_PUB_ZEROCOPY_MIN_LEN) {
+        rc = MQTTPublishRef(c, topicName, topic_msg, by_ref, payload_free);
+    } else
+#endif
+    {
+        rc = MQTTPublish(c, topicName, topic_msg);
+    }
+#endif
     if (rc < STATE_SUCCESS) { /* send the subscribe packet */
         if (rc == STATE_SYS_DEPEND_NWK_CLOSE) {
             iotx_mc_set_client_state(c, IOTX_MC_STATE_DISCONNECTED);
@@ -3169,9 +6211,112 @@ int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_in
         return rc;
     }
 
+    /* QoS1 publish has a new republish deadline, let yield recompute its wait */
+    iotx_mc_wakeup(c);
+
     return (int)msg_id;
 }
 
+#if WITH_MQTT_JOURNAL
+/* keep publish which failed as connection is lost in journal, return 'rc' if it is not kept */
+static int iotx_mc_journal_publish(iotx_mc_client_t *c, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                                   int rc)
+{
+    iotx_mc_state_t state;
+
+    if (rc != STATE_MQTT_IN_OFFLINE_STATUS && rc != STATE_SYS_DEPEND_NWK_CLOSE) {
+        return rc;
+    }
+
+    /* not connected yet or released, nothing will drain the journal */
+    state = iotx_mc_get_client_state(c);
+    if (state != IOTX_MC_STATE_DISCONNECTED &&
+        state != IOTX_MC_STATE_DISCONNECTED_RECONNECTING &&
+        state != IOTX_MC_STATE_CONNECT_BLOCK) {
+        return rc;
+    }
+
+    if (iotx_mc_journal_append(&c->journal, topicName, topic_msg) < STATE_SUCCESS) {
+        mqtt_err("journal append failed");
+        return rc;
+    }
+
+    mqtt_debug("publish kept in journal, topic = %s", topicName);
+    return STATE_SUCCESS;
+}
+
+/* send at most IOTX_MC_JOURNAL_DRAIN_NUM journal records each interval, so that live publishes are not starved */
+static void iotx_mc_journal_proc(iotx_mc_client_t *c)
+{
+    iotx_mqtt_topic_info_t topic_msg;
+    const char *topic = NULL;
+    int num = 0, rc = 0;
+
+    if (iotx_mc_get_client_state(c) != IOTX_MC_STATE_CONNECTED ||
+        !utils_time_is_expired(&c->journal_drain_time) ||
+        iotx_mc_journal_count(&c->journal) == 0) {
+        return;
+    }
+
+    for (num = 0; num < IOTX_MC_JOURNAL_DRAIN_NUM; num++) {
+#if !WITH_MQTT_ONLY_QOS0
+        /* leave half of republish list to live QoS1 publishes */
+        if (c->pub_wait_num >= IOTX_MC_REPUB_NUM_MAX / 2) {
+            break;
+        }
+#endif
+        if (iotx_mc_journal_peek(&c->journal, &topic, &topic_msg) < STATE_SUCCESS) {
+            break;
+        }
+
+        rc = _mqtt_publish(c, topic, &topic_msg, 0, NULL);
+        if (rc == STATE_SYS_DEPEND_NWK_CLOSE || rc == STATE_MQTT_IN_OFFLINE_STATUS ||
+            rc == STATE_MQTT_QOS1_REPUB_EXCEED_MAX) {
+            /* try it again later */
+            break;
+        }
+        if (rc < STATE_SUCCESS) {
+            mqtt_err("journal publish dropped, topic = %s, rc = %d", topic, rc);
+        }
+        iotx_mc_journal_pop(&c->journal);
+    }
+
+    iotx_mc_journal_commit(&c->journal);
+    utils_time_countdown_ms(&c->journal_drain_time, IOTX_MC_JOURNAL_DRAIN_INTERVAL_MS);
+}
+#endif
+
+int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg)
+{
+#if WITH_MQTT_JOURNAL
+    int rc = _mqtt_publish(client, topicName, topic_msg, 0, NULL);
+
+    return (rc < STATE_SUCCESS) ? iotx_mc_journal_publish(client, topicName, topic_msg, rc) : rc;
+#else
+    return _mqtt_publish(client, topicName, topic_msg, 0, NULL);
+#endif
+}
+
+int wrapper_mqtt_publish_ref(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                             iotx_mqtt_payload_free_fpt payload_free)
+{
+    int rc = _mqtt_publish(client, topicName, topic_msg, 1, &payload_free);
+
+#if WITH_MQTT_JOURNAL
+    /* journal keeps a copy, payload is freed below */
+    if (rc < STATE_SUCCESS) {
+        rc = iotx_mc_journal_publish(client, topicName, topic_msg, rc);
+    }
+#endif
+
+    /* still set unless QoS1 republish node took it over */
+    if (payload_free != NULL && topic_msg != NULL && topic_msg->payload != NULL) {
+        payload_free((void *)topic_msg->payload);
+    }
+
+    return rc;
+}
+
 #ifdef ASYNC_PROTOCOL_STACK
 int wrapper_mqtt_nwk_event_handler(void *client, iotx_mqtt_nwk_event_t event, iotx_mqtt_nwk_param_t *param)
 {
@@ -14,6 +14,59 @@
 #include "mqtt_api.h"
 
 #include "MQTTPacket.h"
+#include "iotx_mqtt_journal.h"
+#include "iotx_mqtt_submit.h"
+#include "iotx_mqtt_dispatch.h"
+#include "iotx_mqtt_dedup.h"
+#include "iotx_mqtt_ratelimit.h"
+
+/* topic trie needs dynamic memory and plain text topic filters */
+#if !defined(PLATFORM_HAS_DYNMEM) || WITH_MQTT_ZIP_TOPIC
+    #undef WITH_MQTT_SUB_TRIE
+    #define WITH_MQTT_SUB_TRIE                  (0)
+#endif
+
+/* frames in outbound queue are allocated per packet */
+#if !defined(PLATFORM_HAS_DYNMEM)
+    #undef WITH_MQTT_TX_QUEUE
+    #define WITH_MQTT_TX_QUEUE                  (0)
+#endif
+
+/* submitted frames are allocated per packet and sent by the thread running yield */
+#if !defined(PLATFORM_HAS_DYNMEM) || defined(ASYNC_PROTOCOL_STACK) || !defined(IOTX_MC_HAS_ATOMIC)
+    #undef WITH_MQTT_SUBMIT_QUEUE
+    #define WITH_MQTT_SUBMIT_QUEUE              (0)
+#endif
+
+/* journal is kept in KV storage and its records are allocated per publish */
+#if !defined(PLATFORM_HAS_DYNMEM) || !defined(HAL_KV)
+    #undef WITH_MQTT_JOURNAL
+    #define WITH_MQTT_JOURNAL                   (0)
+#endif
+
+/* streamed PUBLISH is matched against plain text topic filters */
+#if WITH_MQTT_ZIP_TOPIC
+    #undef WITH_MQTT_STREAM_RX
+    #define WITH_MQTT_STREAM_RX                 (0)
+#endif
+
+/* subscriptions are restored from plain text topic filters */
+#if WITH_MQTT_ZIP_TOPIC
+    #undef WITH_MQTT_SESSION_RESUME
+    #define WITH_MQTT_SESSION_RESUME            (0)
+#endif
+
+/* messages are copied for worker threads */
+#if !defined(PLATFORM_HAS_DYNMEM)
+    #undef WITH_MQTT_DISPATCH
+    #define WITH_MQTT_DISPATCH                  (0)
+#endif
+
+/* queued publishes are allocated per packet and sent by the thread running yield */
+#if !defined(PLATFORM_HAS_DYNMEM) || defined(ASYNC_PROTOCOL_STACK)
+    #undef WITH_MQTT_PUB_RATE_LIMIT
+    #define WITH_MQTT_PUB_RATE_LIMIT            (0)
+#endif
 
 #ifdef INFRA_MEM_STATS
     #include "infra_mem_stats.h"
@@ -28,6 +81,23 @@
 
 #define MQTT_DYNBUF_RECV_MARGIN                      (8)
 
+/* minimum size of a MQTT packet: fixed header byte and one remaining length byte */
+#define MQTT_FIXED_HEADER_MIN_LEN                    (2)
+
+/* maximum size of MQTT fixed header: header byte and four remaining length bytes */
+#define MQTT_FIXED_HEADER_MAX_LEN                    (5)
+
+/* maximum size of PUBLISH properties: property length and Topic Alias */
+#if WITH_MQTT_V5
+    #define MQTT_PUBLISH_PROPS_MAX_LEN               (1 + 3)
+#else
+    #define MQTT_PUBLISH_PROPS_MAX_LEN               (0)
+#endif
+
+/* maximum size of PUBLISH without payload: fixed header, topic name, packet id and properties */
+#define MQTT_PUBLISH_HEADER_MAX_LEN                  (MQTT_FIXED_HEADER_MAX_LEN + 2 + CONFIG_MQTT_TOPIC_MAXLEN + 2 + \
+                                                      MQTT_PUBLISH_PROPS_MAX_LEN)
+
 typedef enum {
     IOTX_MC_CONNECTION_ACCEPTED = 0,
     IOTX_MC_CONNECTION_REFUSED_UNACCEPTABLE_PROTOCOL_VERSION = 1,
@@ -52,6 +122,21 @@ typedef enum MQTT_NODE_STATE {
     IOTX_MC_NODE_STATE_INVALID,
 } iotx_mc_node_t;
 
+#if WITH_MQTT_SUB_TRIE
+/* Node of subscribed topic trie, one node per topic level */
+typedef struct iotx_mc_topic_node_s {
+    struct iotx_mc_topic_node_s    *parent;
+    struct iotx_mc_topic_node_s   **children;       /* literal levels, sorted for binary search */
+    uint16_t                        child_num;
+    uint16_t                        child_cap;
+    struct iotx_mc_topic_node_s    *plus;           /* single level wildcard '+' */
+    struct iotx_mc_topic_node_s    *hash;           /* multi level wildcard '#' */
+    struct list_head                handles;        /* handles whose topic filter ends here */
+    uint16_t                        level_len;
+    char                            level[1];
+} iotx_mc_topic_node_t;
+#endif
+
 typedef enum {
     TOPIC_NAME_TYPE = 0,
     TOPIC_FILTER_TYPE
@@ -61,9 +146,20 @@ typedef enum {
 typedef struct iotx_mc_topic_handle_s {
     iotx_mc_topic_type_t topic_type;
     iotx_mqtt_event_handle_t handle;
+#if WITH_MQTT_SESSION_RESUME
+    iotx_mqtt_qos_t qos;                            /* requested QoS, used to resubscribe after reconnected */
+#endif
+#if WITH_MQTT_STREAM_RX
+    iotx_mqtt_chunk_handle_func_fpt chunk_fp;       /* receives PUBLISH too large for read buffer */
+#endif
 #ifdef PLATFORM_HAS_DYNMEM
     const char *topic_filter;
     struct list_head linked_list;
+#if WITH_MQTT_SUB_TRIE
+    uint32_t sub_seq;                               /* subscription order, handlers are called by it */
+    void *trie_node;                                /* trie node where topic filter ends */
+    struct list_head trie_list;
+#endif
 #else
     const char topic_filter[CONFIG_MQTT_TOPIC_MAXLEN];
     int used;
@@ -71,6 +167,16 @@ typedef struct iotx_mc_topic_handle_s {
 } iotx_mc_topic_handle_t;
 
 #if !WITH_MQTT_ONLY_QOS0
+#ifdef PLATFORM_HAS_DYNMEM
+/* Payload of QoS1 publish kept by reference, freed when the last reference is released */
+typedef struct {
+    const char                 *data;
+    uint32_t                    len;
+    uint32_t                    ref;                /* reference count, guarded by lock_list_pub */
+    iotx_mqtt_payload_free_fpt  free_fp;            /* free function of data, NULL if not owned */
+} iotx_mc_payload_t;
+#endif
+
 /* Information structure of published topic */
 typedef struct REPUBLISH_INFO {
     iotx_time_t                 pub_start_time;     /* start time of publish request */
@@ -78,7 +184,8 @@ typedef struct REPUBLISH_INFO {
     uint16_t                    msg_id;             /* packet id of publish */
     uint32_t                    len;                /* length of publish message */
 #ifdef PLATFORM_HAS_DYNMEM
-    unsigned char              *buf;                /* publish message */
+    unsigned char              *buf;                /* publish message, or its header if payload is referenced */
+    iotx_mc_payload_t          *payload;            /* payload sent after buf, NULL if buf holds whole message */
     struct list_head            linked_list;
 #else
     unsigned char               buf[IOTX_MC_TX_MAX_LEN];  /* publish message */
@@ -86,6 +193,32 @@ typedef struct REPUBLISH_INFO {
 #endif
 } iotx_mc_pub_info_t, *iotx_mc_pub_info_pt;
 #endif
+#if WITH_MQTT_V5
+/* Topic of a MQTT 5.0 topic alias, alias number is index in table plus 1 */
+typedef struct {
+    uint32_t                    hash;               /* hash of topic, compared before topic itself */
+    uint16_t                    len;                /* length of topic, 0 if alias is not assigned */
+#ifdef PLATFORM_HAS_DYNMEM
+    char                       *topic;
+#else
+    char                        topic[CONFIG_MQTT_TOPIC_MAXLEN];
+#endif
+} iotx_mc_topic_alias_t;
+#endif
+
+#if WITH_MQTT_SESSION_RESUME
+/* Topic filter copied from subscribe handlers, resubscribed after reconnected, its SUBACK is not told to user */
+typedef struct {
+#ifdef PLATFORM_HAS_DYNMEM
+    char                       *topic;
+#else
+    char                        topic[CONFIG_MQTT_TOPIC_MAXLEN];
+#endif
+    int                         qos;
+    uint16_t                    packet_id;          /* SUBSCRIBE it was sent in, 0 once its SUBACK came */
+} iotx_mc_resub_t;
+#endif
+
 /* Reconnected parameter of MQTT client */
 typedef struct {
     iotx_time_t         reconnect_next_time;        /* the next time point of reconnect */
@@ -96,6 +229,8 @@ typedef struct {
     uintptr_t packet_id;
     uint8_t ack_type;
     iotx_mqtt_event_handle_func_fpt sub_state_cb;
+    iotx_mqtt_sub_entry_t *entry;       /* topics of multi-topic subscribe, result is set by SUBACK */
+    int entry_num;
 #ifdef PLATFORM_HAS_DYNMEM
     struct list_head linked_list;
 #else
@@ -118,6 +253,9 @@ typedef struct Client {
 #endif
     uint32_t                        buf_size_read;                              /* read buffer size in byte */
     uint8_t                         keepalive_probes;                           /* keepalive probes */
+#if WITH_MQTT_SESSION_RESUME
+    uint8_t                         session_present;                            /* server kept session at last CONNACK */
+#endif
 #ifdef PLATFORM_HAS_DYNMEM
     char                           *buf_send;                                   /* pointer of send buffer */
     char                           *buf_read;                                   /* pointer of read buffer */
@@ -125,19 +263,85 @@ typedef struct Client {
     char                            buf_send[IOTX_MC_TX_MAX_LEN];
     char                            buf_read[IOTX_MC_RX_MAX_LEN];
 #endif
+#if WITH_MQTT_TX_QUEUE
+    hal_iovec_t                     tx_queue[IOTX_MC_TX_QUEUE_NUM_MAX];         /* serialized frames waiting to be sent, guarded by lock_write_buf */
+    uint16_t                        tx_queue_num;
+    uint32_t                        tx_queue_bytes;
+    iotx_time_t                     tx_queue_time;                              /* deadline to flush outbound queue */
+#endif
+#if WITH_MQTT_SUBMIT_QUEUE
+    iotx_mc_submit_queue_t          submit_queue;                               /* publishes submitted by application threads */
+#endif
+#if WITH_MQTT_PUB_RATE_LIMIT
+    iotx_mc_rate_t                  rate;                                       /* publishes held back by rate limit */
+#endif
+    uint32_t                        rx_len;                                     /* bytes buffered in read buffer */
+    uint32_t                        rx_frame_len;                               /* length of complete packet at head of read buffer */
+    char                            rx_frame_next;                              /* byte overwritten by packet terminator */
 #ifdef PLATFORM_HAS_DYNMEM
     struct list_head                list_sub_handle;                            /* list of subscribe handle */
 #else
     iotx_mc_topic_handle_t          list_sub_handle[IOTX_MC_SUBHANDLE_LIST_MAX_LEN];
+#endif
+#if WITH_MQTT_SESSION_RESUME
+#ifdef PLATFORM_HAS_DYNMEM
+    iotx_mc_resub_t                *resub;                                      /* topic filters of last resubscribe, guarded by lock_generic */
+#else
+    iotx_mc_resub_t                 resub[IOTX_MC_SUBHANDLE_LIST_MAX_LEN];
+#endif
+    int                             resub_num;
+#endif
+#if WITH_MQTT_SUB_TRIE
+    iotx_mc_topic_node_t           *sub_trie;                                   /* root of subscribed topic trie */
+    uint32_t                        sub_seq;                                    /* next subscription order */
 #endif
     utils_network_t                 ipstack;                                    /* network parameter */
-    iotx_time_t                     next_ping_time;                             /* next ping time */
+    uint32_t                        keepalive_ms;                               /* idle time before PINGREQ is sent */
+    uint32_t                        keepalive_server_ms;                        /* keepalive told to server in CONNECT */
+    iotx_time_t                     last_tx_time;                               /* time of last packet sent, guarded by lock_write_buf */
+    iotx_time_t                     last_rx_time;                               /* time of last packet received */
+    uint32_t                        ping_sent;
+    uint32_t                        ping_resp;                                  /* PINGRESP received */
+    uint32_t                        ping_lost;                                  /* connections dropped for PINGREQ not answered */
+#if WITH_MQTT_ADAPTIVE_KEEPALIVE
+    uint32_t                        keepalive_safe_ms;                          /* longest idle time connection survived */
+    uint32_t                        keepalive_fail_ms;                          /* shortest idle time connection was lost after, 0 if none */
+    uint32_t                        keepalive_probe_ms;                         /* idle time before unanswered PINGREQ, 0 if none */
+#endif
     iotx_mc_state_t                 client_state;                               /* state of MQTT client */
     iotx_mc_reconnect_param_t       reconnect_param;                            /* reconnect parameter */
     MQTTPacket_connectData          connect_data;                               /* connection parameter */
+#if WITH_MQTT_V5
+    uint16_t                        topic_alias_tx_max;                         /* outbound topic aliases allowed by server */
+    uint16_t                        topic_alias_tx_next;                        /* next outbound alias to be reassigned when all are used */
+    iotx_mc_topic_alias_t           topic_alias_tx[IOTX_MC_TOPIC_ALIAS_MAX];    /* outbound topic aliases, guarded by lock_list_pub */
+    iotx_mc_topic_alias_t           topic_alias_rx[IOTX_MC_TOPIC_ALIAS_MAX];    /* inbound topic aliases, used by read path only */
+#endif
+#if WITH_MQTT_RX_DEDUP
+    iotx_mc_dedup_t                 dedup;                                      /* QoS1 PUBLISH delivered recently */
+#endif
+#if WITH_MQTT_RX_BACKPRESSURE
+    iotx_mqtt_backlog_fpt           rx_backlog_fp;                              /* fill level of application queue */
+    void                           *rx_backlog_ctx;
+    uint8_t                         rx_paused;                                  /* socket is not read until backlog drains */
+    uint32_t                        rx_backlog;                                 /* last fill level in percent */
+    uint32_t                        rx_backlog_peak;
+    uint32_t                        rx_pause_count;
+    uint32_t                        rx_pause_ms;                                /* time paused, not counting current pause */
+    iotx_time_t                     rx_pause_time;                              /* start of current pause */
+#endif
+#if WITH_MQTT_DISPATCH
+    iotx_mc_dispatch_t              dispatch;                                   /* workers running callbacks of inbound PUBLISH */
+#endif
+#if WITH_MQTT_JOURNAL
+    iotx_mc_journal_t               journal;                                    /* publishes made while offline */
+    iotx_time_t                     journal_drain_time;                         /* next time to send journal records */
+#endif
 #if !WITH_MQTT_ONLY_QOS0
 #ifdef PLATFORM_HAS_DYNMEM
-    struct list_head                list_pub_wait_ack;                          /* list of wait publish ack */
+    struct list_head                list_pub_wait_ack;                          /* list of wait publish ack, in order of republish time */
+    iotx_mc_pub_info_t             *pub_wait_index[IOTX_MC_REPUB_INDEX_LEN];    /* wait publish ack indexed by packet id */
+    uint32_t                        pub_wait_num;                               /* number of wait publish ack */
 #else
     iotx_mc_pub_info_t              list_pub_wait_ack[IOTX_MC_REPUB_NUM_MAX];
 #endif
@@ -151,6 +355,9 @@ typedef struct Client {
     void                           *lock_write_buf;                             /* lock of write */
     void                           *lock_read_buf;                             /* lock of write */
     void                           *lock_yield;
+    void                           *sem_wakeup;                                 /* posted by socket events and publish to wake up yield */
+    uint8_t                         wakeup_pending;                             /* yield is woken up by publish rather than socket */
+    uint8_t                         rx_more;                                    /* last read was cut at its length, socket may hold more */
     iotx_mqtt_event_handle_t        handle_event;                               /* event handle */
 #ifndef PLATFORM_HAS_DYNMEM
     int                            used;
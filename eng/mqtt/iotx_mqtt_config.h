@@ -29,12 +29,247 @@
     #define WITH_MQTT_ZIP_TOPIC                 (0)
 #endif
 
-/* maximum republish elements in list */
+/* index subscribed topic filters in a trie for inbound PUBLISH dispatch */
+#ifndef WITH_MQTT_SUB_TRIE
+    #define WITH_MQTT_SUB_TRIE                  (1)
+#endif
+
+/* queue outbound PUBLISH/PUBACK/PINGREQ and send them together in one vectored write */
+#ifndef WITH_MQTT_TX_QUEUE
+    #define WITH_MQTT_TX_QUEUE                  (1)
+#endif
+
+/* maximum frames in outbound queue */
+#ifndef IOTX_MC_TX_QUEUE_NUM_MAX
+    #define IOTX_MC_TX_QUEUE_NUM_MAX                (16)
+#endif
+
+/* outbound queue is flushed when its bytes would exceed this, larger frames are sent at once */
+#ifndef IOTX_MC_TX_QUEUE_BYTES_MAX
+    #define IOTX_MC_TX_QUEUE_BYTES_MAX              (1024)
+#endif
+
+/* maximum time in millisecond a frame waits in outbound queue */
+#ifndef IOTX_MC_TX_QUEUE_DELAY_MS
+    #define IOTX_MC_TX_QUEUE_DELAY_MS               (20)
+#endif
+
+/* serialize publish in caller's thread and let yield send it, so that publish never waits for socket */
+#ifndef WITH_MQTT_SUBMIT_QUEUE
+    #define WITH_MQTT_SUBMIT_QUEUE              (0)
+#endif
+
+/* maximum publishes submitted and not sent yet, must be power of 2 */
+#ifndef IOTX_MC_SUBMIT_QUEUE_LEN
+    #define IOTX_MC_SUBMIT_QUEUE_LEN                (32)
+#endif
+
+/* payload at least this long is sent from caller's buffer instead of being copied into send buffer */
+#ifndef IOTX_MC_PUB_ZEROCOPY_MIN_LEN
+    #define IOTX_MC_PUB_ZEROCOPY_MIN_LEN            (256)
+#endif
+
+/* connect with MQTT 5.0 instead of 3.1.1, so that repeated QoS0 publishes carry a topic alias instead of topic name */
+#ifndef WITH_MQTT_V5
+    #define WITH_MQTT_V5                        (0)
+#endif
+
+/* topic aliases of each direction in MQTT 5.0 mode, the outbound ones are further limited by server */
+#ifndef IOTX_MC_TOPIC_ALIAS_MAX
+    #define IOTX_MC_TOPIC_ALIAS_MAX                 (8)
+#endif
+
+/* keep publishes made while offline in KV storage and send them after reconnected */
+#ifndef WITH_MQTT_JOURNAL
+    #define WITH_MQTT_JOURNAL                   (0)
+#endif
+
+/* maximum publishes kept in journal, the oldest one is dropped when it is full */
+#ifndef IOTX_MC_JOURNAL_NUM_MAX
+    #define IOTX_MC_JOURNAL_NUM_MAX                 (32)
+#endif
+
+/* maximum length of journal record, i.e. topic plus payload plus 12 bytes header */
+#ifndef IOTX_MC_JOURNAL_RECORD_MAX_LEN
+    #define IOTX_MC_JOURNAL_RECORD_MAX_LEN          (1024)
+#endif
+
+/* maximum journal records sent every IOTX_MC_JOURNAL_DRAIN_INTERVAL_MS after reconnected */
+#ifndef IOTX_MC_JOURNAL_DRAIN_NUM
+    #define IOTX_MC_JOURNAL_DRAIN_NUM               (4)
+#endif
+
+#ifndef IOTX_MC_JOURNAL_DRAIN_INTERVAL_MS
+    #define IOTX_MC_JOURNAL_DRAIN_INTERVAL_MS       (1000)
+#endif
+
+/* prefix of KV keys of journal */
+#ifndef IOTX_MC_JOURNAL_KEY_PREFIX
+    #define IOTX_MC_JOURNAL_KEY_PREFIX              "mqtt_jnl"
+#endif
+
+/* deliver inbound PUBLISH too large for read buffer in chunks to subscriptions having chunk callback */
+#ifndef WITH_MQTT_STREAM_RX
+    #define WITH_MQTT_STREAM_RX                 (0)
+#endif
+
+/* maximum chunk callbacks an inbound PUBLISH is streamed to */
+#ifndef IOTX_MC_STREAM_HANDLE_MAX
+    #define IOTX_MC_STREAM_HANDLE_MAX               (4)
+#endif
+
+/* probe for the longest idle time NAT keeps connection within CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN/MAX, and ping at it */
+#ifndef WITH_MQTT_ADAPTIVE_KEEPALIVE
+    #define WITH_MQTT_ADAPTIVE_KEEPALIVE        (0)
+#endif
+
+/* probing stops when the longest idle time connection survived and the shortest one it did not are this close */
+#ifndef IOTX_MC_KEEPALIVE_ADAPT_STEP_MS
+    #define IOTX_MC_KEEPALIVE_ADAPT_STEP_MS         (30000)
+#endif
+
+/* run callbacks of inbound PUBLISH in worker threads instead of the thread running yield */
+#ifndef WITH_MQTT_DISPATCH
+    #define WITH_MQTT_DISPATCH                  (0)
+#endif
+
+/* worker threads of dispatch, PUBLISH of one topic is always run by the same one */
+#ifndef IOTX_MC_DISPATCH_WORKER_NUM
+    #define IOTX_MC_DISPATCH_WORKER_NUM             (2)
+#endif
+
+/* maximum PUBLISH waiting for each worker, QoS0 ones beyond it are dropped */
+#ifndef IOTX_MC_DISPATCH_QUEUE_LEN
+    #define IOTX_MC_DISPATCH_QUEUE_LEN              (16)
+#endif
+
+/* QoS1 PUBLISH stops reading at most this long while queue of its worker is full */
+#ifndef IOTX_MC_DISPATCH_PUSH_WAIT_MS
+    #define IOTX_MC_DISPATCH_PUSH_WAIT_MS           (1000)
+#endif
+
+#ifndef IOTX_MC_DISPATCH_STACK_SIZE
+    #define IOTX_MC_DISPATCH_STACK_SIZE             (6144)
+#endif
+
+/* stop reading socket while application queues are filled above high watermark, until below low watermark */
+#ifndef WITH_MQTT_RX_BACKPRESSURE
+    #define WITH_MQTT_RX_BACKPRESSURE           (0)
+#endif
+
+/* watermarks in percent of capacity of the fullest queue, see IOT_MQTT_Set_Backlog_Source() */
+#ifndef IOTX_MC_RX_HIGH_WATERMARK
+    #define IOTX_MC_RX_HIGH_WATERMARK               (80)
+#endif
+
+#ifndef IOTX_MC_RX_LOW_WATERMARK
+    #define IOTX_MC_RX_LOW_WATERMARK                (50)
+#endif
+
+/* how often queues are checked while reading is paused */
+#ifndef IOTX_MC_RX_PAUSE_POLL_MS
+    #define IOTX_MC_RX_PAUSE_POLL_MS                (20)
+#endif
+
+/* after reconnected, resubscribe topic filters unless server kept session, and resend unacknowledged QoS1 at once */
+#ifndef WITH_MQTT_SESSION_RESUME
+    #define WITH_MQTT_SESSION_RESUME            (1)
+#endif
+
+/* seconds MQTT 5.0 server keeps session after connection is lost, sent in CONNECT when session is resumed */
+#ifndef IOTX_MC_SESSION_EXPIRY_S
+    #define IOTX_MC_SESSION_EXPIRY_S            (3600)
+#endif
+
+/* acknowledge QoS1 PUBLISH retransmitted by server without delivering it again */
+#ifndef WITH_MQTT_RX_DEDUP
+    #define WITH_MQTT_RX_DEDUP                  (1)
+#endif
+
+/* recently delivered QoS1 PUBLISH remembered, one per slot chosen by packet id */
+#ifndef IOTX_MC_DEDUP_SLOTS
+    #define IOTX_MC_DEDUP_SLOTS                     (32)
+#endif
+
+/* retransmission arriving later than this after the original is delivered again */
+#ifndef IOTX_MC_DEDUP_WINDOW_MS
+    #define IOTX_MC_DEDUP_WINDOW_MS                 (60000)
+#endif
+
+/* limit publish rate per class of topic and of the whole device, publishes over it are queued and sent by yield */
+#ifndef WITH_MQTT_PUB_RATE_LIMIT
+    #define WITH_MQTT_PUB_RATE_LIMIT            (0)
+#endif
+
+/* maximum publishes queued by rate limit, more fail with STATE_MQTT_RATE_QUEUE_FULL */
+#ifndef IOTX_MC_RATE_QUEUE_NUM_MAX
+    #define IOTX_MC_RATE_QUEUE_NUM_MAX              (32)
+#endif
+
+/* publishes per second and burst after being idle, of the whole device and of each class, 0 for unlimited */
+#ifndef IOTX_MC_RATE_TOTAL_PER_SEC
+    #define IOTX_MC_RATE_TOTAL_PER_SEC              (30)
+#endif
+
+#ifndef IOTX_MC_RATE_TOTAL_BURST
+    #define IOTX_MC_RATE_TOTAL_BURST                (30)
+#endif
+
+#ifndef IOTX_MC_RATE_PROPERTY_PER_SEC
+    #define IOTX_MC_RATE_PROPERTY_PER_SEC           (0)
+#endif
+
+#ifndef IOTX_MC_RATE_PROPERTY_BURST
+    #define IOTX_MC_RATE_PROPERTY_BURST             (1)
+#endif
+
+#ifndef IOTX_MC_RATE_EVENT_PER_SEC
+    #define IOTX_MC_RATE_EVENT_PER_SEC              (0)
+#endif
+
+#ifndef IOTX_MC_RATE_EVENT_BURST
+    #define IOTX_MC_RATE_EVENT_BURST                (1)
+#endif
+
+#ifndef IOTX_MC_RATE_RAW_PER_SEC
+    #define IOTX_MC_RATE_RAW_PER_SEC                (0)
+#endif
+
+#ifndef IOTX_MC_RATE_RAW_BURST
+    #define IOTX_MC_RATE_RAW_BURST                  (1)
+#endif
+
+#ifndef IOTX_MC_RATE_DEFAULT_PER_SEC
+    #define IOTX_MC_RATE_DEFAULT_PER_SEC            (0)
+#endif
+
+#ifndef IOTX_MC_RATE_DEFAULT_BURST
+    #define IOTX_MC_RATE_DEFAULT_BURST              (1)
+#endif
+
+#ifndef IOTX_MC_RATE_LOG_PER_SEC
+    #define IOTX_MC_RATE_LOG_PER_SEC                (5)
+#endif
+
+#ifndef IOTX_MC_RATE_LOG_BURST
+    #define IOTX_MC_RATE_LOG_BURST                  (10)
+#endif
+
+/* maximum republish elements in list, i.e. QoS1 publish in flight waiting for PUBACK */
 #ifndef IOTX_MC_REPUB_NUM_MAX
     #define IOTX_MC_REPUB_NUM_MAX                   (10)
 #endif
+
+/* slots of packet id index of republish list, keep it at least twice of IOTX_MC_REPUB_NUM_MAX */
+#ifndef IOTX_MC_REPUB_INDEX_LEN
+    #define IOTX_MC_REPUB_INDEX_LEN                 (IOTX_MC_REPUB_NUM_MAX * 2)
+#endif
 /* MQTT client version number */
-#define IOTX_MC_MQTT_VERSION                    (4)
+#if WITH_MQTT_V5
+    #define IOTX_MC_MQTT_VERSION                (5)
+#else
+    #define IOTX_MC_MQTT_VERSION                (4)
+#endif
 
 /* maximum MQTT packet-id */
 #define IOTX_MC_PACKET_ID_MAX                   (65535)
@@ -62,7 +297,7 @@
         #define IOTX_MC_SUBHANDLE_LIST_MAX_LEN          (5)
     #endif
 
-    /* mqtt client max count */
+    /* mqtt client max count, raise it for connections of IOT_MQTT_Construct_Multi() */
     #ifndef IOTX_MC_CLIENT_MAX_COUNT
         #define IOTX_MC_CLIENT_MAX_COUNT                (1)
     #endif
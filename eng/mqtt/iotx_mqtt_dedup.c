@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if WITH_MQTT_RX_DEDUP
+
+#define DEDUP_SLOT(dedup, id)               (&(dedup)->slot[(id) % IOTX_MC_DEDUP_SLOTS])
+
+void iotx_mc_dedup_init(iotx_mc_dedup_t *dedup)
+{
+    memset(dedup, 0, sizeof(iotx_mc_dedup_t));
+}
+
+/* FNV-1a of topic followed by payload */
+uint32_t iotx_mc_dedup_hash(const char *topic, uint32_t topic_len, const void *payload, uint32_t payload_len)
+{
+    uint32_t hash = 2166136261u;
+    const unsigned char *p = (const unsigned char *)topic;
+    uint32_t idx;
+
+    for (idx = 0; idx < topic_len; idx++) {
+        hash = (hash ^ p[idx]) * 16777619u;
+    }
+    p = (const unsigned char *)payload;
+    for (idx = 0; idx < payload_len; idx++) {
+        hash = (hash ^ p[idx]) * 16777619u;
+    }
+
+    return hash;
+}
+
+/* return 1 if the same message was delivered with 'packet_id' within IOTX_MC_DEDUP_WINDOW_MS */
+int iotx_mc_dedup_find(iotx_mc_dedup_t *dedup, uint16_t packet_id, uint32_t hash)
+{
+    iotx_mc_dedup_slot_t *slot = DEDUP_SLOT(dedup, packet_id);
+
+    if (slot->packet_id != packet_id || slot->hash != hash) {
+        return 0;
+    }
+
+    return utils_time_spend(&slot->time) < IOTX_MC_DEDUP_WINDOW_MS;
+}
+
+/* remember delivered message, it replaces whatever used its slot */
+void iotx_mc_dedup_add(iotx_mc_dedup_t *dedup, uint16_t packet_id, uint32_t hash)
+{
+    iotx_mc_dedup_slot_t *slot = DEDUP_SLOT(dedup, packet_id);
+
+    slot->packet_id = packet_id;
+    slot->hash = hash;
+    iotx_time_start(&slot->time);
+}
+
+#endif  /* #if WITH_MQTT_RX_DEDUP */
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_DEDUP_H__
+#define __IOTX_MQTT_DEDUP_H__
+
+#include "infra_types.h"
+#include "infra_timer.h"
+#include "iotx_mqtt_config.h"
+
+/* QoS1 PUBLISH delivered recently, packet id 0 marks a free slot */
+typedef struct {
+    uint16_t                    packet_id;
+    uint32_t                    hash;               /* of topic and payload */
+    iotx_time_t                 time;               /* when it was delivered */
+} iotx_mc_dedup_slot_t;
+
+/*
+ * Recently delivered QoS1 PUBLISH, slot is chosen by packet id, so lookup and insert take one slot each.
+ * Server hands out packet ids in turn, so a slot is reused only after IOTX_MC_DEDUP_SLOTS later ones.
+ */
+typedef struct {
+    uint32_t                    duplicates;         /* retransmissions acknowledged without being delivered */
+    iotx_mc_dedup_slot_t        slot[IOTX_MC_DEDUP_SLOTS];
+} iotx_mc_dedup_t;
+
+void iotx_mc_dedup_init(iotx_mc_dedup_t *dedup);
+uint32_t iotx_mc_dedup_hash(const char *topic, uint32_t topic_len, const void *payload, uint32_t payload_len);
+int iotx_mc_dedup_find(iotx_mc_dedup_t *dedup, uint16_t packet_id, uint32_t hash);
+void iotx_mc_dedup_add(iotx_mc_dedup_t *dedup, uint16_t packet_id, uint32_t hash);
+
+#endif  /* __IOTX_MQTT_DEDUP_H__ */
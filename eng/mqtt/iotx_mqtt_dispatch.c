@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if WITH_MQTT_DISPATCH
+
+static void *_dispatch_worker_func(void *params)
+{
+    iotx_mc_dispatch_worker_t *worker = (iotx_mc_dispatch_worker_t *)params;
+    iotx_mc_dispatch_msg_t *msg = NULL;
+
+    for (;;) {
+        HAL_SemaphoreWait(worker->sem, PLATFORM_WAIT_INFINITE);
+
+        HAL_MutexLock(worker->lock);
+        if (worker->stop) {
+            HAL_MutexUnlock(worker->lock);
+            break;
+        }
+        msg = NULL;
+        if (!list_empty(&worker->msg_list)) {
+            msg = list_first_entry(&worker->msg_list, iotx_mc_dispatch_msg_t, linked_list);
+            list_del(&msg->linked_list);
+            worker->msg_num--;
+        }
+        HAL_MutexUnlock(worker->lock);
+
+        if (msg != NULL) {
+            worker->dispatch->deliver(worker->dispatch->owner, msg);
+            mqtt_free(msg);
+        }
+    }
+
+    worker->leave = 1;
+    return NULL;
+}
+
+static void _dispatch_worker_deinit(iotx_mc_dispatch_worker_t *worker)
+{
+    iotx_mc_dispatch_msg_t *msg = NULL, *next = NULL;
+
+    if (worker->thread != NULL) {
+        HAL_MutexLock(worker->lock);
+        worker->stop = 1;
+        HAL_MutexUnlock(worker->lock);
+        HAL_SemaphorePost(worker->sem);
+
+        /* callback running in worker is finished first */
+        while (!worker->leave) {
+            HAL_SleepMs(10);
+        }
+        worker->thread = NULL;
+    }
+
+    if (worker->lock != NULL) {
+        list_for_each_entry_safe(msg, next, &worker->msg_list, linked_list, iotx_mc_dispatch_msg_t) {
+            list_del(&msg->linked_list);
+            mqtt_free(msg);
+        }
+        worker->msg_num = 0;
+        HAL_MutexDestroy(worker->lock);
+        worker->lock = NULL;
+    }
+    if (worker->sem != NULL) {
+        HAL_SemaphoreDestroy(worker->sem);
+        worker->sem = NULL;
+    }
+}
+
+int iotx_mc_dispatch_init(iotx_mc_dispatch_t *dispatch, iotx_mc_dispatch_fpt deliver, void *owner)
+{
+    int idx, stack_used = 0;
+    hal_os_thread_param_t task_parms = {0};
+    iotx_mc_dispatch_worker_t *worker = NULL;
+
+    memset(dispatch, 0, sizeof(iotx_mc_dispatch_t));
+    dispatch->deliver = deliver;
+    dispatch->owner = owner;
+
+    task_parms.stack_size = IOTX_MC_DISPATCH_STACK_SIZE;
+    task_parms.detach_state = 1;
+    task_parms.name = "mqtt_dispatch";
+
+    for (idx = 0; idx < IOTX_MC_DISPATCH_WORKER_NUM; idx++) {
+        worker = &dispatch->worker[idx];
+        worker->dispatch = dispatch;
+        INIT_LIST_HEAD(&worker->msg_list);
+
+        worker->lock = HAL_MutexCreate();
+        if (worker->lock == NULL) {
+            iotx_state_event(ITE_STATE_SYS_DEPEND, STATE_SYS_DEPEND_MUTEX_CREATE, "dispatch lock create fail");
+            iotx_mc_dispatch_deinit(dispatch);
+            return STATE_SYS_DEPEND_MUTEX_CREATE;
+        }
+
+        worker->sem = HAL_SemaphoreCreate();
+        if (worker->sem == NULL) {
+            iotx_state_event(ITE_STATE_SYS_DEPEND, STATE_SYS_DEPEND_MUTEX_CREATE, "dispatch sem create fail");
+            iotx_mc_dispatch_deinit(dispatch);
+            return STATE_SYS_DEPEND_MUTEX_CREATE;
+        }
+
+        if (HAL_ThreadCreate(&worker->thread, _dispatch_worker_func, worker, &task_parms, &stack_used) != 0) {
+            worker->thread = NULL;
+            iotx_state_event(ITE_STATE_SYS_DEPEND, STATE_SYS_DEPEND_THREAD_CREATE, "dispatch thread create fail");
+            iotx_mc_dispatch_deinit(dispatch);
+            return STATE_SYS_DEPEND_THREAD_CREATE;
+        }
+    }
+
+    return STATE_SUCCESS;
+}
+
+/* stop workers, messages not run yet are dropped, must not be called by callback run in worker */
+void iotx_mc_dispatch_deinit(iotx_mc_dispatch_t *dispatch)
+{
+    int idx;
+
+    for (idx = 0; idx < IOTX_MC_DISPATCH_WORKER_NUM; idx++) {
+        _dispatch_worker_deinit(&dispatch->worker[idx]);
+    }
+}
+
+/* fill level of the fullest worker queue in percent */
+uint32_t iotx_mc_dispatch_level(iotx_mc_dispatch_t *dispatch)
+{
+    int idx;
+    uint32_t num = 0;
+
+    for (idx = 0; idx < IOTX_MC_DISPATCH_WORKER_NUM; idx++) {
+        HAL_MutexLock(dispatch->worker[idx].lock);
+        if (dispatch->worker[idx].msg_num > num) {
+            num = dispatch->worker[idx].msg_num;
+        }
+        HAL_MutexUnlock(dispatch->worker[idx].lock);
+    }
+
+    return num * 100 / IOTX_MC_DISPATCH_QUEUE_LEN;
+}
+
+/* copy message and queue it to its worker, waiting up to 'wait_ms' for room, called by thread running yield */
+int iotx_mc_dispatch_push(iotx_mc_dispatch_t *dispatch, const char *topic, uint16_t topic_len,
+                          iotx_mqtt_topic_info_pt topic_msg, uint32_t wait_ms)
+{
+    uint32_t hash = 5381;
+    uint16_t idx;
+    uint32_t msg_num;
+    iotx_time_t timer;
+    iotx_mc_dispatch_worker_t *worker = NULL;
+    iotx_mc_dispatch_msg_t *msg = NULL;
+    char *data = NULL;
+
+    for (idx = 0; idx < topic_len; idx++) {
+        hash = ((hash << 5) + hash) + (uint8_t)topic[idx];
+    }
+    worker = &dispatch->worker[hash % IOTX_MC_DISPATCH_WORKER_NUM];
+
+    iotx_time_init(&timer);
+    utils_time_countdown_ms(&timer, wait_ms);
+    for (;;) {
+        HAL_MutexLock(worker->lock);
+        msg_num = worker->msg_num;
+        HAL_MutexUnlock(worker->lock);
+        if (msg_num < IOTX_MC_DISPATCH_QUEUE_LEN) {
+            break;
+        }
+        if (utils_time_is_expired(&timer)) {
+            dispatch->dropped++;
+            return STATE_MQTT_DISPATCH_QUEUE_FULL;
+        }
+        /* worker frees a slot each time a callback returns */
+        HAL_SleepMs(10);
+    }
+
+    /* topic and payload are NUL terminated for callbacks, like those in read buffer */
+    msg = mqtt_malloc(sizeof(iotx_mc_dispatch_msg_t) + topic_len + 1 + topic_msg->payload_len + 1);
+    if (msg == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    memcpy(&msg->topic_msg, topic_msg, sizeof(iotx_mqtt_topic_info_t));
+    data = (char *)(msg + 1);
+    memcpy(data, topic, topic_len);
+    data[topic_len] = '\0';
+    msg->topic_msg.ptopic = data;
+    msg->topic_msg.topic_len = topic_len;
+    data += topic_len + 1;
+    if (topic_msg->payload_len > 0) {
+        memcpy(data, topic_msg->payload, topic_msg->payload_len);
+    }
+    data[topic_msg->payload_len] = '\0';
+    msg->topic_msg.payload = data;
+
+    /* only this thread pushes, so room checked above is still there */
+    HAL_MutexLock(worker->lock);
+    list_add_tail(&msg->linked_list, &worker->msg_list);
+    worker->msg_num++;
+    HAL_MutexUnlock(worker->lock);
+    HAL_SemaphorePost(worker->sem);
+
+    return STATE_SUCCESS;
+}
+
+#endif  /* #if WITH_MQTT_DISPATCH */
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_DISPATCH_H__
+#define __IOTX_MQTT_DISPATCH_H__
+
+#include "infra_types.h"
+#include "infra_list.h"
+#include "iotx_mqtt_config.h"
+#include "mqtt_api.h"
+
+/* Received PUBLISH waiting for worker, its topic and payload follow it in the same allocation */
+typedef struct {
+    iotx_mqtt_topic_info_t      topic_msg;
+    struct list_head            linked_list;
+} iotx_mc_dispatch_msg_t;
+
+/* run callbacks of message in worker thread, message is freed after it returns */
+typedef void (*iotx_mc_dispatch_fpt)(void *owner, iotx_mc_dispatch_msg_t *msg);
+
+typedef struct {
+    struct iotx_mc_dispatch_st *dispatch;
+    void                       *lock;               /* guards 'msg_list' and 'msg_num' */
+    void                       *sem;                /* posted once per message pushed, and on stop */
+    void                       *thread;
+    struct list_head            msg_list;
+    uint32_t                    msg_num;
+    int                         stop;
+    int                         leave;              /* set by worker thread when it exits */
+} iotx_mc_dispatch_worker_t;
+
+/*
+ * Messages are handed to worker threads by hash of topic, so that messages of one topic
+ * are always run by the same worker in the order they were received.
+ */
+typedef struct iotx_mc_dispatch_st {
+    iotx_mc_dispatch_fpt        deliver;
+    void                       *owner;
+    uint32_t                    dropped;            /* messages refused because queue of worker stayed full */
+    iotx_mc_dispatch_worker_t   worker[IOTX_MC_DISPATCH_WORKER_NUM];
+} iotx_mc_dispatch_t;
+
+int iotx_mc_dispatch_init(iotx_mc_dispatch_t *dispatch, iotx_mc_dispatch_fpt deliver, void *owner);
+void iotx_mc_dispatch_deinit(iotx_mc_dispatch_t *dispatch);
+uint32_t iotx_mc_dispatch_level(iotx_mc_dispatch_t *dispatch);
+int iotx_mc_dispatch_push(iotx_mc_dispatch_t *dispatch, const char *topic, uint16_t topic_len,
+                          iotx_mqtt_topic_info_pt topic_msg, uint32_t wait_ms);
+
+#endif  /* __IOTX_MQTT_DISPATCH_H__ */
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if WITH_MQTT_JOURNAL
+
+#define JOURNAL_META_MAGIC                  (0x4A4E4C31)    /* "JNL1" */
+#define JOURNAL_KEY_MAXLEN                  (32)
+
+typedef struct {
+    uint32_t    magic;
+    uint32_t    head;
+} iotx_mc_journal_meta_t;
+
+/* record is followed by topic and payload */
+typedef struct {
+    uint32_t    seq;
+    uint32_t    payload_len;
+    uint16_t    topic_len;
+    uint8_t     qos;
+    uint8_t     retain;
+} iotx_mc_journal_record_t;
+
+/* FNV-1a of identity of connection, so that each connection has keys of its own */
+static uint32_t _journal_owner(const char *identity)
+{
+    uint32_t hash = 2166136261U;
+
+    while (identity != NULL && *identity != '\0') {
+        hash = (hash ^ (uint8_t)*identity++) * 16777619U;
+    }
+    return hash;
+}
+
+static void _journal_slot_key(iotx_mc_journal_t *journal, char *key, uint32_t seq)
+{
+    HAL_Snprintf(key, JOURNAL_KEY_MAXLEN, "%s_%08x_%u", IOTX_MC_JOURNAL_KEY_PREFIX, (unsigned int)journal->owner,
+                 (unsigned int)(seq % IOTX_MC_JOURNAL_NUM_MAX));
+}
+
+static void _journal_meta_key(iotx_mc_journal_t *journal, char *key)
+{
+    HAL_Snprintf(key, JOURNAL_KEY_MAXLEN, "%s_%08x_meta", IOTX_MC_JOURNAL_KEY_PREFIX, (unsigned int)journal->owner);
+}
+
+/* read record of slot of 'seq', return its length or error */
+static int _journal_read(iotx_mc_journal_t *journal, uint32_t seq)
+{
+    char key[JOURNAL_KEY_MAXLEN];
+    int len = IOTX_MC_JOURNAL_RECORD_MAX_LEN;
+    iotx_mc_journal_record_t *record = (iotx_mc_journal_record_t *)journal->buf;
+
+    _journal_slot_key(journal, key, seq);
+    if (HAL_Kv_Get(key, journal->buf, &len) != 0) {
+        return STATE_SYS_DEPEND_KV_GET;
+    }
+    if (len < (int)sizeof(iotx_mc_journal_record_t) ||
+        len != (int)(sizeof(iotx_mc_journal_record_t) + record->topic_len + record->payload_len)) {
+        return STATE_SYS_DEPEND_KV_GET;
+    }
+    return len;
+}
+
+/*
+ * find range of records not drained yet, from head saved last time and sequences found in slots,
+ * 'identity' tells device of connection apart, records of other devices are never read
+ */
+int iotx_mc_journal_init(iotx_mc_journal_t *journal, const char *identity)
+{
+    char key[JOURNAL_KEY_MAXLEN];
+    iotx_mc_journal_meta_t meta;
+    iotx_mc_journal_record_t *record = NULL;
+    int len = sizeof(meta);
+    int found = 0;
+    uint32_t idx;
+
+    memset(journal, 0, sizeof(iotx_mc_journal_t));
+    journal->owner = _journal_owner(identity);
+
+    /* two more bytes to terminate topic and payload */
+    journal->buf = mqtt_malloc(IOTX_MC_JOURNAL_RECORD_MAX_LEN + 2);
+    if (journal->buf == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    journal->lock = HAL_MutexCreate();
+    if (journal->lock == NULL) {
+        mqtt_free(journal->buf);
+        return STATE_SYS_DEPEND_MUTEX_CREATE;
+    }
+
+    _journal_meta_key(journal, key);
+    if (HAL_Kv_Get(key, &meta, &len) == 0 && len == sizeof(meta) && meta.magic == JOURNAL_META_MAGIC) {
+        journal->head = meta.head;
+    }
+    journal->committed = journal->head;
+
+    record = (iotx_mc_journal_record_t *)journal->buf;
+    for (idx = 0; idx < IOTX_MC_JOURNAL_NUM_MAX; idx++) {
+        if (_journal_read(journal, idx) < 0 || record->seq % IOTX_MC_JOURNAL_NUM_MAX != idx) {
+            continue;
+        }
+        if (!found || (int32_t)(record->seq - journal->tail) >= 0) {
+            journal->tail = record->seq + 1;
+            found = 1;
+        }
+    }
+
+    if (!found || (int32_t)(journal->tail - journal->head) < 0) {
+        journal->head = journal->tail;
+    } else if (journal->tail - journal->head > IOTX_MC_JOURNAL_NUM_MAX) {
+        journal->head = journal->tail - IOTX_MC_JOURNAL_NUM_MAX;
+    }
+
+    if (journal->tail != journal->head) {
+        mqtt_info("journal has %u publish to be sent", (unsigned int)(journal->tail - journal->head));
+    }
+    return STATE_SUCCESS;
+}
+
+void iotx_mc_journal_deinit(iotx_mc_journal_t *journal)
+{
+    if (journal->lock == NULL) {
+        return;
+    }
+    iotx_mc_journal_commit(journal);
+    HAL_MutexDestroy(journal->lock);
+    mqtt_free(journal->buf);
+    memset(journal, 0, sizeof(iotx_mc_journal_t));
+}
+
+/* append publish to journal, oldest record is dropped if journal is full */
+int iotx_mc_journal_append(iotx_mc_journal_t *journal, const char *topic, iotx_mqtt_topic_info_pt topic_msg)
+{
+    char key[JOURNAL_KEY_MAXLEN];
+    iotx_mc_journal_record_t *record = NULL;
+    uint32_t topic_len, len;
+    int rc = STATE_SUCCESS;
+
+    if (journal->lock == NULL) {
+        return STATE_MQTT_IN_OFFLINE_STATUS;
+    }
+
+    topic_len = strlen(topic);
+    len = sizeof(iotx_mc_journal_record_t) + topic_len + topic_msg->payload_len;
+    if (len > IOTX_MC_JOURNAL_RECORD_MAX_LEN) {
+        return STATE_MQTT_TX_BUFFER_TOO_SHORT;
+    }
+
+    record = mqtt_malloc(len);
+    if (record == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    record->payload_len = topic_msg->payload_len;
+    record->topic_len = topic_len;
+    record->qos = topic_msg->qos;
+    record->retain = topic_msg->retain;
+    memcpy((char *)(record + 1), topic, topic_len);
+    memcpy((char *)(record + 1) + topic_len, topic_msg->payload, topic_msg->payload_len);
+
+    HAL_MutexLock(journal->lock);
+    record->seq = journal->tail;
+    _journal_slot_key(journal, key, record->seq);
+    if (HAL_Kv_Set(key, record, len, 1) != 0) {
+        rc = STATE_SYS_DEPEND_KV_SET;
+    } else {
+        journal->tail++;
+        if (journal->tail - journal->head > IOTX_MC_JOURNAL_NUM_MAX) {
+            mqtt_warning("journal is full, oldest publish dropped");
+            journal->head = journal->tail - IOTX_MC_JOURNAL_NUM_MAX;
+        }
+    }
+    HAL_MutexUnlock(journal->lock);
+
+    mqtt_free(record);
+    return rc;
+}
+
+uint32_t iotx_mc_journal_count(iotx_mc_journal_t *journal)
+{
+    uint32_t count;
+
+    if (journal->lock == NULL) {
+        return 0;
+    }
+    HAL_MutexLock(journal->lock);
+    count = journal->tail - journal->head;
+    HAL_MutexUnlock(journal->lock);
+    return count;
+}
+
+/* read oldest record, topic and payload stay valid until next peek, records which can't be read are skipped */
+int iotx_mc_journal_peek(iotx_mc_journal_t *journal, const char **topic, iotx_mqtt_topic_info_pt topic_msg)
+{
+    iotx_mc_journal_record_t *record = (iotx_mc_journal_record_t *)journal->buf;
+    int rc = STATE_MQTT_IN_OFFLINE_STATUS;
+
+    if (journal->lock == NULL) {
+        return rc;
+    }
+
+    HAL_MutexLock(journal->lock);
+    while (journal->head != journal->tail) {
+        if (_journal_read(journal, journal->head) > 0 && record->seq == journal->head) {
+            rc = STATE_SUCCESS;
+            break;
+        }
+        mqtt_err("journal record %u lost", (unsigned int)journal->head);
+        journal->head++;
+    }
+    journal->peeked = journal->head;
+    HAL_MutexUnlock(journal->lock);
+
+    if (rc < STATE_SUCCESS) {
+        return rc;
+    }
+
+    /* payload is moved forward by one byte to terminate topic, and terminated as it may be printed */
+    memmove((char *)(record + 1) + record->topic_len + 1, (char *)(record + 1) + record->topic_len,
+            record->payload_len);
+    ((char *)(record + 1))[record->topic_len] = '\0';
+    ((char *)(record + 1))[record->topic_len + 1 + record->payload_len] = '\0';
+
+    memset(topic_msg, 0, sizeof(iotx_mqtt_topic_info_t));
+    topic_msg->qos = record->qos;
+    topic_msg->retain = record->retain;
+    topic_msg->payload_len = record->payload_len;
+    topic_msg->payload = (char *)(record + 1) + record->topic_len + 1;
+    *topic = (const char *)(record + 1);
+    return STATE_SUCCESS;
+}
+
+/* remove the record returned by last peek */
+void iotx_mc_journal_pop(iotx_mc_journal_t *journal)
+{
+    HAL_MutexLock(journal->lock);
+    /* it may have been dropped by append meanwhile */
+    if (journal->head == journal->peeked && journal->head != journal->tail) {
+        journal->head++;
+    }
+    HAL_MutexUnlock(journal->lock);
+}
+
+/* save head, so that drained records are not sent again after reboot */
+int iotx_mc_journal_commit(iotx_mc_journal_t *journal)
+{
+    char key[JOURNAL_KEY_MAXLEN];
+    iotx_mc_journal_meta_t meta;
+    int rc = STATE_SUCCESS;
+
+    HAL_MutexLock(journal->lock);
+    if (journal->committed != journal->head) {
+        meta.magic = JOURNAL_META_MAGIC;
+        meta.head = journal->head;
+        _journal_meta_key(journal, key);
+        if (HAL_Kv_Set(key, &meta, sizeof(meta), 1) != 0) {
+            rc = STATE_SYS_DEPEND_KV_SET;
+        } else {
+            journal->committed = journal->head;
+        }
+    }
+    HAL_MutexUnlock(journal->lock);
+
+    return rc;
+}
+
+#endif  /* #if WITH_MQTT_JOURNAL */
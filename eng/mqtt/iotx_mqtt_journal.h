@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_JOURNAL_H__
+#define __IOTX_MQTT_JOURNAL_H__
+
+#include "infra_types.h"
+#include "iotx_mqtt_config.h"
+#include "mqtt_api.h"
+
+/*
+ * Outbound journal of publishes made while offline, kept in KV storage.
+ * Record of sequence 'seq' is stored in slot 'seq % IOTX_MC_JOURNAL_NUM_MAX', so that the
+ * slots form a ring and the oldest record is overwritten when the ring is full.
+ * Keys carry a hash of device identity, so that each connection has a journal of its own.
+ */
+typedef struct {
+    uint32_t    owner;              /* hash of device identity, part of all keys */
+    void       *lock;               /* guards all fields below */
+    uint32_t    head;               /* sequence of oldest record not drained yet */
+    uint32_t    tail;               /* sequence of next record to be appended */
+    uint32_t    committed;          /* head saved in KV storage */
+    uint32_t    peeked;             /* sequence of record in buf */
+    char       *buf;                /* record read by iotx_mc_journal_peek() */
+} iotx_mc_journal_t;
+
+int iotx_mc_journal_init(iotx_mc_journal_t *journal, const char *identity);
+void iotx_mc_journal_deinit(iotx_mc_journal_t *journal);
+int iotx_mc_journal_append(iotx_mc_journal_t *journal, const char *topic, iotx_mqtt_topic_info_pt topic_msg);
+uint32_t iotx_mc_journal_count(iotx_mc_journal_t *journal);
+int iotx_mc_journal_peek(iotx_mc_journal_t *journal, const char **topic, iotx_mqtt_topic_info_pt topic_msg);
+void iotx_mc_journal_pop(iotx_mc_journal_t *journal);
+int iotx_mc_journal_commit(iotx_mc_journal_t *journal);
+
+#endif  /* __IOTX_MQTT_JOURNAL_H__ */
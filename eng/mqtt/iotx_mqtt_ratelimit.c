@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if WITH_MQTT_PUB_RATE_LIMIT
+
+#define RATE_TOKEN_ONE                      (1000)
+
+/* keeps tokens of a full bucket within uint32_t */
+#define RATE_LIMIT_MAX                      (10000)
+
+static void _rate_bucket_set(iotx_mc_rate_bucket_t *bucket, uint32_t per_sec, uint32_t burst)
+{
+    if (burst == 0) {
+        burst = 1;
+    }
+    if (burst > RATE_LIMIT_MAX) {
+        burst = RATE_LIMIT_MAX;
+    }
+    if (per_sec > RATE_LIMIT_MAX) {
+        per_sec = RATE_LIMIT_MAX;
+    }
+
+    bucket->rate = per_sec;
+    bucket->burst = burst;
+    bucket->tokens = burst * RATE_TOKEN_ONE;
+    iotx_time_start(&bucket->refill_time);
+}
+
+static void _rate_bucket_refill(iotx_mc_rate_bucket_t *bucket)
+{
+    uint32_t spend = 0;
+    uint32_t cap = bucket->burst * RATE_TOKEN_ONE;
+
+    if (bucket->rate == 0 || bucket->tokens >= cap) {
+        iotx_time_start(&bucket->refill_time);
+        return;
+    }
+
+    /* part of millisecond is kept for next refill by not restarting timer until a whole one passed */
+    spend = utils_time_spend(&bucket->refill_time);
+    if (spend == 0) {
+        return;
+    }
+    iotx_time_start(&bucket->refill_time);
+
+    if (spend >= cap / bucket->rate + 1) {
+        bucket->tokens = cap;
+    } else {
+        bucket->tokens += spend * bucket->rate;
+        if (bucket->tokens > cap) {
+            bucket->tokens = cap;
+        }
+    }
+}
+
+static int _rate_bucket_ready(iotx_mc_rate_bucket_t *bucket)
+{
+    return (bucket->rate == 0 || bucket->tokens >= RATE_TOKEN_ONE);
+}
+
+static void _rate_bucket_consume(iotx_mc_rate_bucket_t *bucket)
+{
+    if (bucket->rate != 0 && bucket->tokens >= RATE_TOKEN_ONE) {
+        bucket->tokens -= RATE_TOKEN_ONE;
+    }
+}
+
+/* milliseconds until bucket has a token */
+static uint32_t _rate_bucket_wait(iotx_mc_rate_bucket_t *bucket)
+{
+    if (_rate_bucket_ready(bucket)) {
+        return 0;
+    }
+    return (RATE_TOKEN_ONE - bucket->tokens + bucket->rate - 1) / bucket->rate;
+}
+
+int iotx_mc_rate_init(iotx_mc_rate_t *rate)
+{
+    int idx;
+
+    memset(rate, 0, sizeof(iotx_mc_rate_t));
+    for (idx = 0; idx < IOTX_MQTT_RATE_CLASS_MAX; idx++) {
+        INIT_LIST_HEAD(&rate->queue[idx]);
+    }
+
+    _rate_bucket_set(&rate->total, IOTX_MC_RATE_TOTAL_PER_SEC, IOTX_MC_RATE_TOTAL_BURST);
+    _rate_bucket_set(&rate->bucket[IOTX_MQTT_RATE_CLASS_PROPERTY],
+                     IOTX_MC_RATE_PROPERTY_PER_SEC, IOTX_MC_RATE_PROPERTY_BURST);
+    _rate_bucket_set(&rate->bucket[IOTX_MQTT_RATE_CLASS_EVENT], IOTX_MC_RATE_EVENT_PER_SEC, IOTX_MC_RATE_EVENT_BURST);
+    _rate_bucket_set(&rate->bucket[IOTX_MQTT_RATE_CLASS_RAW], IOTX_MC_RATE_RAW_PER_SEC, IOTX_MC_RATE_RAW_BURST);
+    _rate_bucket_set(&rate->bucket[IOTX_MQTT_RATE_CLASS_DEFAULT],
+                     IOTX_MC_RATE_DEFAULT_PER_SEC, IOTX_MC_RATE_DEFAULT_BURST);
+    _rate_bucket_set(&rate->bucket[IOTX_MQTT_RATE_CLASS_LOG], IOTX_MC_RATE_LOG_PER_SEC, IOTX_MC_RATE_LOG_BURST);
+    /* replies are never held back */
+    _rate_bucket_set(&rate->bucket[IOTX_MQTT_RATE_CLASS_REPLY], 0, 1);
+
+    rate->lock = HAL_MutexCreate();
+    if (rate->lock == NULL) {
+        iotx_state_event(ITE_STATE_SYS_DEPEND, STATE_SYS_DEPEND_MUTEX_CREATE, "rate limit lock create fail");
+        return STATE_SYS_DEPEND_MUTEX_CREATE;
+    }
+
+    return STATE_SUCCESS;
+}
+
+/* queued publishes are dropped, QoS1 ones among them never get PUBACK */
+void iotx_mc_rate_deinit(iotx_mc_rate_t *rate)
+{
+    int idx;
+    iotx_mc_rate_frame_t *node = NULL, *next = NULL;
+
+    if (rate->lock == NULL) {
+        return;
+    }
+
+    for (idx = 0; idx < IOTX_MQTT_RATE_CLASS_MAX; idx++) {
+        list_for_each_entry_safe(node, next, &rate->queue[idx], linked_list, iotx_mc_rate_frame_t) {
+            list_del(&node->linked_list);
+            mqtt_free(node->frame);
+            mqtt_free(node);
+        }
+    }
+    rate->queue_num = 0;
+    rate->qos1_num = 0;
+    HAL_MutexDestroy(rate->lock);
+    rate->lock = NULL;
+}
+
+static int _rate_topic_has_suffix(const char *topic, uint32_t topic_len, const char *suffix)
+{
+    uint32_t suffix_len = strlen(suffix);
+
+    return (topic_len >= suffix_len && memcmp(topic + topic_len - suffix_len, suffix, suffix_len) == 0);
+}
+
+/* class of publish by its topic, see topics of Thing Specification Language */
+iotx_mqtt_rate_class_t iotx_mc_rate_class(const char *topic)
+{
+    uint32_t topic_len = strlen(topic);
+
+    if (_rate_topic_has_suffix(topic, topic_len, "_reply") ||
+        strstr(topic, "/rrpc/response/") != NULL ||
+        strncmp(topic, "/ext/rrpc/", strlen("/ext/rrpc/")) == 0) {
+        return IOTX_MQTT_RATE_CLASS_REPLY;
+    }
+    if (strstr(topic, "/thing/event/property/") != NULL) {
+        return IOTX_MQTT_RATE_CLASS_PROPERTY;
+    }
+    if (strstr(topic, "/thing/event/") != NULL) {
+        return IOTX_MQTT_RATE_CLASS_EVENT;
+    }
+    if (strstr(topic, "/thing/model/up_raw") != NULL) {
+        return IOTX_MQTT_RATE_CLASS_RAW;
+    }
+    if (strstr(topic, "/thing/log/") != NULL) {
+        return IOTX_MQTT_RATE_CLASS_LOG;
+    }
+
+    return IOTX_MQTT_RATE_CLASS_DEFAULT;
+}
+
+/* 'cls' of IOTX_MQTT_RATE_CLASS_MAX sets device-wide limit, 'per_sec' of 0 removes limit */
+void iotx_mc_rate_set(iotx_mc_rate_t *rate, iotx_mqtt_rate_class_t cls, uint32_t per_sec, uint32_t burst)
+{
+    HAL_MutexLock(rate->lock);
+    if (cls == IOTX_MQTT_RATE_CLASS_MAX) {
+        _rate_bucket_set(&rate->total, per_sec, burst);
+    } else if (cls != IOTX_MQTT_RATE_CLASS_REPLY) {
+        _rate_bucket_set(&rate->bucket[cls], per_sec, burst);
+    }
+    HAL_MutexUnlock(rate->lock);
+}
+
+/*
+ * Take tokens for a publish to be sent now, return 0 if it has to be queued instead.
+ * While anything is queued, publishes other than replies are queued behind it, so that they keep
+ * their order within class, and queued ones of higher class are not passed by lower ones.
+ */
+int iotx_mc_rate_take(iotx_mc_rate_t *rate, iotx_mqtt_rate_class_t cls)
+{
+    _rate_bucket_refill(&rate->total);
+    if (cls == IOTX_MQTT_RATE_CLASS_REPLY) {
+        _rate_bucket_consume(&rate->total);
+        return 1;
+    }
+
+    _rate_bucket_refill(&rate->bucket[cls]);
+    if (rate->queue_num > 0 || !_rate_bucket_ready(&rate->total) || !_rate_bucket_ready(&rate->bucket[cls])) {
+        return 0;
+    }
+
+    _rate_bucket_consume(&rate->total);
+    _rate_bucket_consume(&rate->bucket[cls]);
+    return 1;
+}
+
+/* queue publish which iotx_mc_rate_take() refused, 'frame' is taken over on success */
+int iotx_mc_rate_defer(iotx_mc_rate_t *rate, iotx_mqtt_rate_class_t cls, char *frame, uint32_t len, uint16_t msg_id)
+{
+    iotx_mc_rate_frame_t *node = NULL;
+
+    if (rate->queue_num >= IOTX_MC_RATE_QUEUE_NUM_MAX) {
+        rate->rejected++;
+        return STATE_MQTT_RATE_QUEUE_FULL;
+    }
+
+    node = (iotx_mc_rate_frame_t *)mqtt_malloc(sizeof(iotx_mc_rate_frame_t));
+    if (node == NULL) {
+        return STATE_SYS_DEPEND_MALLOC;
+    }
+    node->frame = frame;
+    node->len = len;
+    node->msg_id = msg_id;
+    INIT_LIST_HEAD(&node->linked_list);
+
+    list_add_tail(&node->linked_list, &rate->queue[cls]);
+    rate->queue_num++;
+    if (msg_id != 0) {
+        rate->qos1_num++;
+    }
+    rate->deferred++;
+
+    return STATE_SUCCESS;
+}
+
+/* take oldest queued publish of the highest class having tokens, return 0 if none can be sent now */
+int iotx_mc_rate_pop(iotx_mc_rate_t *rate, char **frame, uint32_t *len, uint16_t *msg_id)
+{
+    int idx;
+    iotx_mc_rate_frame_t *node = NULL;
+
+    if (rate->queue_num == 0) {
+        return 0;
+    }
+
+    _rate_bucket_refill(&rate->total);
+    if (!_rate_bucket_ready(&rate->total)) {
+        return 0;
+    }
+
+    for (idx = 0; idx < IOTX_MQTT_RATE_CLASS_MAX; idx++) {
+        if (list_empty(&rate->queue[idx])) {
+            continue;
+        }
+        _rate_bucket_refill(&rate->bucket[idx]);
+        if (!_rate_bucket_ready(&rate->bucket[idx])) {
+            continue;
+        }
+
+        _rate_bucket_consume(&rate->total);
+        _rate_bucket_consume(&rate->bucket[idx]);
+
+        node = list_first_entry(&rate->queue[idx], iotx_mc_rate_frame_t, linked_list);
+        list_del(&node->linked_list);
+        rate->queue_num--;
+        if (node->msg_id != 0) {
+            rate->qos1_num--;
+        }
+
+        *frame = node->frame;
+        *len = node->len;
+        *msg_id = node->msg_id;
+        mqtt_free(node);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* milliseconds until a queued publish can be sent, 0xFFFFFFFF if nothing is queued */
+uint32_t iotx_mc_rate_next_ms(iotx_mc_rate_t *rate)
+{
+    int idx;
+    uint32_t wait = 0, next = 0xFFFFFFFF;
+    uint32_t total_wait = 0;
+
+    if (rate->queue_num == 0) {
+        return next;
+    }
+
+    _rate_bucket_refill(&rate->total);
+    total_wait = _rate_bucket_wait(&rate->total);
+
+    for (idx = 0; idx < IOTX_MQTT_RATE_CLASS_MAX; idx++) {
+        if (list_empty(&rate->queue[idx])) {
+            continue;
+        }
+        _rate_bucket_refill(&rate->bucket[idx]);
+        wait = _rate_bucket_wait(&rate->bucket[idx]);
+        if (wait < total_wait) {
+            wait = total_wait;
+        }
+        if (wait < next) {
+            next = wait;
+        }
+    }
+
+    return next;
+}
+
+#endif  /* #if WITH_MQTT_PUB_RATE_LIMIT */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_RATELIMIT_H__
+#define __IOTX_MQTT_RATELIMIT_H__
+
+#include "infra_types.h"
+#include "infra_list.h"
+#include "infra_timer.h"
+#include "iotx_mqtt_config.h"
+#include "mqtt_api.h"
+
+/* Token bucket, tokens are counted in 1/1000 of a publish, so that refill of each millisecond is 'rate' */
+typedef struct {
+    uint32_t                    rate;               /* publishes per second, 0 for unlimited */
+    uint32_t                    burst;              /* publishes sent at once after being idle */
+    uint32_t                    tokens;
+    iotx_time_t                 refill_time;        /* last refill */
+} iotx_mc_rate_bucket_t;
+
+/* Publish held back by rate limit */
+typedef struct {
+    char                       *frame;              /* serialized packet, freed by the one popping it */
+    uint32_t                    len;
+    uint16_t                    msg_id;             /* packet id of QoS1 publish, 0 for QoS0 */
+    struct list_head            linked_list;
+} iotx_mc_rate_frame_t;
+
+/*
+ * Publishes take a token from the bucket of their class and from the device-wide one, those finding
+ * either empty are queued per class and sent by yield in order of class as tokens come back.
+ * Replies are never queued, so that requests of server are answered in time whatever is queued.
+ */
+typedef struct {
+    void                       *lock;               /* guards everything below */
+    iotx_mc_rate_bucket_t       total;              /* device-wide limit */
+    iotx_mc_rate_bucket_t       bucket[IOTX_MQTT_RATE_CLASS_MAX];
+    struct list_head            queue[IOTX_MQTT_RATE_CLASS_MAX];
+    uint32_t                    queue_num;
+    uint32_t                    qos1_num;           /* QoS1 publishes in queue */
+    uint32_t                    deferred;           /* publishes queued since init */
+    uint32_t                    rejected;           /* publishes failed as queue was full */
+} iotx_mc_rate_t;
+
+int iotx_mc_rate_init(iotx_mc_rate_t *rate);
+void iotx_mc_rate_deinit(iotx_mc_rate_t *rate);
+iotx_mqtt_rate_class_t iotx_mc_rate_class(const char *topic);
+void iotx_mc_rate_set(iotx_mc_rate_t *rate, iotx_mqtt_rate_class_t cls, uint32_t per_sec, uint32_t burst);
+
+/* following ones are called with 'lock' held */
+int iotx_mc_rate_take(iotx_mc_rate_t *rate, iotx_mqtt_rate_class_t cls);
+int iotx_mc_rate_defer(iotx_mc_rate_t *rate, iotx_mqtt_rate_class_t cls, char *frame, uint32_t len, uint16_t msg_id);
+int iotx_mc_rate_pop(iotx_mc_rate_t *rate, char **frame, uint32_t *len, uint16_t *msg_id);
+uint32_t iotx_mc_rate_next_ms(iotx_mc_rate_t *rate);
+
+#endif  /* __IOTX_MQTT_RATELIMIT_H__ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+#include "mqtt_internal.h"
+
+#if WITH_MQTT_SUBMIT_QUEUE
+
+/* position wraps at 2^32, slot of it stays in order only if length divides 2^32 */
+#if IOTX_MC_SUBMIT_QUEUE_LEN <= 0 || (IOTX_MC_SUBMIT_QUEUE_LEN & (IOTX_MC_SUBMIT_QUEUE_LEN - 1)) != 0
+    #error "IOTX_MC_SUBMIT_QUEUE_LEN must be a power of two"
+#endif
+
+#define SUBMIT_SLOT(queue, pos)             (&(queue)->slot[(pos) % IOTX_MC_SUBMIT_QUEUE_LEN])
+
+void iotx_mc_submit_init(iotx_mc_submit_queue_t *queue)
+{
+    uint32_t pos;
+
+    memset(queue, 0, sizeof(iotx_mc_submit_queue_t));
+    for (pos = 0; pos < IOTX_MC_SUBMIT_QUEUE_LEN; pos++) {
+        queue->slot[pos].seq = pos;
+    }
+}
+
+/* claim next position and fill its slot, any thread may call it, 'frame' is taken over on success */
+int iotx_mc_submit_push(iotx_mc_submit_queue_t *queue, char *frame, uint32_t len, uint16_t msg_id)
+{
+    iotx_mc_submit_slot_t *slot = NULL;
+    uint32_t pos = IOTX_MC_ATOMIC_LOAD(&queue->tail);
+    int32_t diff;
+
+    for (;;) {
+        slot = SUBMIT_SLOT(queue, pos);
+        diff = (int32_t)(IOTX_MC_ATOMIC_LOAD(&slot->seq) - pos);
+        if (diff == 0) {
+            /* slot is free, claim it unless another producer did, then 'pos' is reloaded */
+            if (IOTX_MC_ATOMIC_CAS(&queue->tail, &pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* consumer has not popped the slot of last round yet */
+            return STATE_MQTT_SUBMIT_QUEUE_FULL;
+        } else {
+            pos = IOTX_MC_ATOMIC_LOAD(&queue->tail);
+        }
+    }
+
+    slot->frame = frame;
+    slot->len = len;
+    slot->msg_id = msg_id;
+    if (msg_id != 0) {
+        IOTX_MC_ATOMIC_ADD(&queue->qos1_num, 1);
+    }
+    IOTX_MC_ATOMIC_STORE(&slot->seq, pos + 1);
+
+    return STATE_SUCCESS;
+}
+
+/* take oldest filled slot, return 0 if there is none, only one thread may call it at a time */
+int iotx_mc_submit_pop(iotx_mc_submit_queue_t *queue, char **frame, uint32_t *len, uint16_t *msg_id)
+{
+    iotx_mc_submit_slot_t *slot = SUBMIT_SLOT(queue, queue->head);
+
+    if (IOTX_MC_ATOMIC_LOAD(&slot->seq) != queue->head + 1) {
+        return 0;
+    }
+
+    *frame = slot->frame;
+    *len = slot->len;
+    *msg_id = slot->msg_id;
+    if (slot->msg_id != 0) {
+        IOTX_MC_ATOMIC_ADD(&queue->qos1_num, -1);
+    }
+    /* free for producer of next round */
+    IOTX_MC_ATOMIC_STORE(&slot->seq, queue->head + IOTX_MC_SUBMIT_QUEUE_LEN);
+    queue->head++;
+
+    return 1;
+}
+
+#endif  /* #if WITH_MQTT_SUBMIT_QUEUE */
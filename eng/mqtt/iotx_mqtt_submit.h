@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2015-2018 Alibaba Group Holding Limited
+ */
+
+#ifndef __IOTX_MQTT_SUBMIT_H__
+#define __IOTX_MQTT_SUBMIT_H__
+
+#include "infra_types.h"
+#include "iotx_mqtt_config.h"
+
+/* atomic operations of submission queue, which is disabled without them */
+#if defined(__GNUC__) || defined(__clang__)
+    #define IOTX_MC_HAS_ATOMIC
+    #define IOTX_MC_ATOMIC_LOAD(ptr)                __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define IOTX_MC_ATOMIC_STORE(ptr, val)          __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+    #define IOTX_MC_ATOMIC_ADD(ptr, val)            __atomic_add_fetch((ptr), (val), __ATOMIC_ACQ_REL)
+    #define IOTX_MC_ATOMIC_CAS(ptr, expected, val)  \
+        __atomic_compare_exchange_n((ptr), (expected), (val), 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#endif
+
+/* Slot of submission queue, 'seq' tells whose turn it is, see iotx_mc_submit_push() */
+typedef struct {
+    uint32_t                    seq;
+    char                       *frame;              /* serialized packet, freed by consumer */
+    uint32_t                    len;
+    uint16_t                    msg_id;             /* packet id of QoS1 publish, 0 for QoS0 */
+} iotx_mc_submit_slot_t;
+
+/*
+ * Bounded queue of serialized publishes, pushed by any thread without lock and popped by yield only.
+ * Slot 'pos % IOTX_MC_SUBMIT_QUEUE_LEN' holds seq 'pos' when it is free for the producer claiming 'pos',
+ * and 'pos + 1' once that producer filled it.
+ */
+typedef struct {
+    uint32_t                    tail;               /* next position claimed by producers */
+    uint32_t                    head;               /* next position popped, used by consumer only */
+    uint32_t                    qos1_num;           /* QoS1 publishes in queue */
+    iotx_mc_submit_slot_t       slot[IOTX_MC_SUBMIT_QUEUE_LEN];
+} iotx_mc_submit_queue_t;
+
+void iotx_mc_submit_init(iotx_mc_submit_queue_t *queue);
+int iotx_mc_submit_push(iotx_mc_submit_queue_t *queue, char *frame, uint32_t len, uint16_t msg_id);
+int iotx_mc_submit_pop(iotx_mc_submit_queue_t *queue, char **frame, uint32_t *len, uint16_t *msg_id);
+
+#endif  /* __IOTX_MQTT_SUBMIT_H__ */
@@ -125,6 +125,56 @@ static int _iotx_preauth(iotx_mqtt_region_types_t region, iotx_dev_meta_info_t *
 
 extern int _sign_get_clientid(char *clientid_string, const char *device_id, const char *custom_kv, uint8_t enable_itls);
 
+/* take optional numeric settings and event handle from user's parameter, default ones are kept if invalid */
+static void _mqtt_params_apply(iotx_mqtt_param_t *mqtt_params, iotx_mqtt_param_t *pInitParams)
+{
+    if (pInitParams->request_timeout_ms < CONFIG_MQTT_REQ_TIMEOUT_MIN ||
+        pInitParams->request_timeout_ms > CONFIG_MQTT_REQ_TIMEOUT_MAX) {
+        mqtt_warning("Using default request_timeout_ms: %d, configured value(%d) out of [%d, %d]",
+                     mqtt_params->request_timeout_ms,
+                     pInitParams->request_timeout_ms,
+                     CONFIG_MQTT_REQ_TIMEOUT_MIN,
+                     CONFIG_MQTT_REQ_TIMEOUT_MAX);
+    } else {
+        mqtt_params->request_timeout_ms = pInitParams->request_timeout_ms;
+    }
+
+    if (pInitParams->clean_session == 0 || pInitParams->clean_session == 1) {
+        mqtt_params->clean_session = pInitParams->clean_session;
+    }
+
+    if (pInitParams->keepalive_interval_ms < CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000 ||
+        pInitParams->keepalive_interval_ms > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000) {
+        mqtt_warning("Using default keepalive_interval_ms: %d, configured value(%d) out of [%d, %d]",
+                     mqtt_params->keepalive_interval_ms,
+                     pInitParams->keepalive_interval_ms,
+                     CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000,
+                     CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000);
+    } else {
+        mqtt_params->keepalive_interval_ms = pInitParams->keepalive_interval_ms;
+    }
+
+    if (!pInitParams->read_buf_size) {
+        mqtt_warning("Using default read_buf_size: %d", mqtt_params->read_buf_size);
+    } else {
+        mqtt_params->read_buf_size = pInitParams->read_buf_size;
+    }
+
+    if (!pInitParams->write_buf_size) {
+        mqtt_warning("Using default write_buf_size: %d", mqtt_params->write_buf_size);
+    } else {
+        mqtt_params->write_buf_size = pInitParams->write_buf_size;
+    }
+
+    if (pInitParams->handle_event.h_fp != NULL) {
+        mqtt_params->handle_event.h_fp = pInitParams->handle_event.h_fp;
+    }
+
+    if (pInitParams->handle_event.pcontext != NULL) {
+        mqtt_params->handle_event.pcontext = pInitParams->handle_event.pcontext;
+    }
+}
+
 /************************  Public Interface ************************/
 void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
 {
@@ -307,51 +357,7 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
             mqtt_params.password = g_default_sign.password;
         }
 
-        if (pInitParams->request_timeout_ms < CONFIG_MQTT_REQ_TIMEOUT_MIN ||
-            pInitParams->request_timeout_ms > CONFIG_MQTT_REQ_TIMEOUT_MAX) {
-            mqtt_warning("Using default request_timeout_ms: %d, configured value(%d) out of [%d, %d]",
-                         mqtt_params.request_timeout_ms,
-                         pInitParams->request_timeout_ms,
-                         CONFIG_MQTT_REQ_TIMEOUT_MIN,
-                         CONFIG_MQTT_REQ_TIMEOUT_MAX);
-        } else {
-            mqtt_params.request_timeout_ms = pInitParams->request_timeout_ms;
-        }
-
-        if (pInitParams->clean_session == 0 || pInitParams->clean_session == 1) {
-            mqtt_params.clean_session = pInitParams->clean_session;
-        }
-
-        if (pInitParams->keepalive_interval_ms < CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000 ||
-            pInitParams->keepalive_interval_ms > CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000) {
-            mqtt_warning("Using default keepalive_interval_ms: %d, configured value(%d) out of [%d, %d]",
-                         mqtt_params.keepalive_interval_ms,
-                         pInitParams->keepalive_interval_ms,
-                         CONFIG_MQTT_KEEPALIVE_INTERVAL_MIN * 1000,
-                         CONFIG_MQTT_KEEPALIVE_INTERVAL_MAX * 1000);
-        } else {
-            mqtt_params.keepalive_interval_ms = pInitParams->keepalive_interval_ms;
-        }
-
-        if (!pInitParams->read_buf_size) {
-            mqtt_warning("Using default read_buf_size: %d", mqtt_params.read_buf_size);
-        } else {
-            mqtt_params.read_buf_size = pInitParams->read_buf_size;
-        }
-
-        if (!pInitParams->write_buf_size) {
-            mqtt_warning("Using default write_buf_size: %d", mqtt_params.write_buf_size);
-        } else {
-            mqtt_params.write_buf_size = pInitParams->write_buf_size;
-        }
-
-        if (pInitParams->handle_event.h_fp != NULL) {
-            mqtt_params.handle_event.h_fp = pInitParams->handle_event.h_fp;
-        }
-
-        if (pInitParams->handle_event.pcontext != NULL) {
-            mqtt_params.handle_event.pcontext = pInitParams->handle_event.pcontext;
-        }
+        _mqtt_params_apply(&mqtt_params, pInitParams);
     } else {
         mqtt_warning("Using default port: [%d]", g_default_sign.port);
         mqtt_params.port = g_default_sign.port;
@@ -411,6 +417,54 @@ void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams)
     return pclient;
 }
 
+void *IOT_MQTT_Construct_Multi(iotx_mqtt_param_t *pInitParams)
+{
+    void *pclient;
+    iotx_mqtt_param_t mqtt_params;
+    int ret;
+
+    if (pInitParams == NULL || pInitParams->host == NULL || pInitParams->port == 0 ||
+        pInitParams->client_id == NULL || pInitParams->username == NULL || pInitParams->password == NULL) {
+        iotx_state_event(ITE_STATE_USER_INPUT, STATE_USER_INPUT_INVALID, "mqtt identity of extra connection missing");
+        return NULL;
+    }
+
+    memset(&mqtt_params, 0x0, sizeof(iotx_mqtt_param_t));
+    mqtt_params.host                  = pInitParams->host;
+    mqtt_params.port                  = pInitParams->port;
+    mqtt_params.client_id             = pInitParams->client_id;
+    mqtt_params.username              = pInitParams->username;
+    mqtt_params.password              = pInitParams->password;
+    mqtt_params.pub_key               = pInitParams->pub_key;
+#ifdef SUPPORT_TLS
+    if (mqtt_params.pub_key == NULL) {
+        extern const char *iotx_ca_crt;
+        mqtt_params.pub_key = iotx_ca_crt;
+    }
+#endif
+    mqtt_params.request_timeout_ms    = CONFIG_MQTT_REQUEST_TIMEOUT;
+    mqtt_params.clean_session         = 0;
+    mqtt_params.keepalive_interval_ms = CONFIG_MQTT_KEEPALIVE_INTERVAL * 1000;
+    mqtt_params.read_buf_size         = CONFIG_MQTT_MESSAGE_MAXLEN;
+    mqtt_params.write_buf_size        = CONFIG_MQTT_MESSAGE_MAXLEN;
+    _mqtt_params_apply(&mqtt_params, pInitParams);
+
+    pclient = wrapper_mqtt_init(&mqtt_params);
+    if (pclient == NULL) {
+        iotx_state_event(ITE_STATE_MQTT_COMM, STATE_MQTT_WRAPPER_INIT_FAIL, "mqtt wrapper init fail");
+        return NULL;
+    }
+
+    ret = wrapper_mqtt_connect(pclient);
+    if (ret < STATE_SUCCESS && MQTT_CONNECT_BLOCK != ret) {
+        iotx_state_event(ITE_STATE_MQTT_COMM, ret, "mqtt connect failed - ret = %d", ret);
+        wrapper_mqtt_release(&pclient);
+        return NULL;
+    }
+
+    return pclient;
+}
+
 int IOT_MQTT_Destroy(void **phandler)
 {
     void *client;
@@ -425,8 +479,10 @@ int IOT_MQTT_Destroy(void **phandler)
         return STATE_USER_INPUT_INVALID;
     }
 
+    if (client == g_mqtt_client) {
+        g_mqtt_client = NULL;
+    }
     wrapper_mqtt_release(&client);
-    g_mqtt_client = NULL;
 
     return STATE_SUCCESS;
 }
@@ -437,6 +493,16 @@ int IOT_MQTT_Yield(void *handle, int timeout_ms)
     return wrapper_mqtt_yield(pClient, timeout_ms);
 }
 
+int IOT_MQTT_Flush(void *handle)
+{
+    void *pClient = (handle ? handle : g_mqtt_client);
+    if (pClient == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    return wrapper_mqtt_flush(pClient);
+}
+
 /* check whether MQTT connection is established or not */
 int IOT_MQTT_CheckStateNormal(void *handle)
 {
@@ -448,6 +514,56 @@ int IOT_MQTT_CheckStateNormal(void *handle)
     return wrapper_mqtt_check_state(pClient);
 }
 
+int IOT_MQTT_Keepalive_Stats(void *handle, iotx_mqtt_keepalive_stats_pt stats)
+{
+    void *pClient = (handle ? handle : g_mqtt_client);
+    if (pClient == NULL || stats == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    return wrapper_mqtt_keepalive_stats(pClient, stats);
+}
+
+int IOT_MQTT_Set_Backlog_Source(void *handle, iotx_mqtt_backlog_fpt backlog_fp, void *pcontext)
+{
+    void *pClient = (handle ? handle : g_mqtt_client);
+    if (pClient == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    return wrapper_mqtt_set_backlog_source(pClient, backlog_fp, pcontext);
+}
+
+int IOT_MQTT_Rx_Stats(void *handle, iotx_mqtt_rx_stats_pt stats)
+{
+    void *pClient = (handle ? handle : g_mqtt_client);
+    if (pClient == NULL || stats == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    return wrapper_mqtt_rx_stats(pClient, stats);
+}
+
+int IOT_MQTT_Set_Rate_Limit(void *handle, iotx_mqtt_rate_class_t cls, uint32_t per_sec, uint32_t burst)
+{
+    void *pClient = (handle ? handle : g_mqtt_client);
+    if (pClient == NULL || cls > IOTX_MQTT_RATE_CLASS_MAX) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    return wrapper_mqtt_set_rate_limit(pClient, cls, per_sec, burst);
+}
+
+int IOT_MQTT_Rate_Stats(void *handle, iotx_mqtt_rate_stats_pt stats)
+{
+    void *pClient = (handle ? handle : g_mqtt_client);
+    if (pClient == NULL || stats == NULL) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    return wrapper_mqtt_rate_stats(pClient, stats);
+}
+
 int IOT_MQTT_Subscribe(void *handle,
                        const char *topic_filter,
                        iotx_mqtt_qos_t qos,
@@ -500,6 +616,37 @@ int IOT_MQTT_Subscribe_Sync(void *handle,
     return wrapper_mqtt_subscribe_sync(client, topic_filter, qos, topic_handle_func, pcontext, timeout_ms);
 }
 
+int IOT_MQTT_Subscribe_Multi_Sync(void *handle,
+                                  iotx_mqtt_sub_entry_t *entry,
+                                  int count,
+                                  int timeout_ms)
+{
+    void *client = handle ? handle : g_mqtt_client;
+    int idx = 0;
+
+    if (timeout_ms > SUBSCRIBE_SYNC_TIMEOUT_MAX) {
+        timeout_ms = SUBSCRIBE_SYNC_TIMEOUT_MAX;
+    }
+
+    if (entry == NULL || count <= 0) {
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    for (idx = 0; idx < count; idx++) {
+        if (entry[idx].qos > IOTX_MQTT_QOS3_SUB_LOCAL) {
+            mqtt_warning("Invalid qos(%d) out of [%d, %d], using %d",
+                         entry[idx].qos,
+                         IOTX_MQTT_QOS0, IOTX_MQTT_QOS3_SUB_LOCAL, IOTX_MQTT_QOS0);
+            entry[idx].qos = IOTX_MQTT_QOS0;
+        }
+        if (entry[idx].topic_filter != NULL) {
+            iotx_state_event(ITE_STATE_MQTT_COMM, STATE_MQTT_SUB_INFO, "subs - '%s'", entry[idx].topic_filter);
+        }
+    }
+
+    return wrapper_mqtt_subscribe_multi_sync(client, entry, count, timeout_ms);
+}
+
 int IOT_MQTT_Unsubscribe(void *handle, const char *topic_filter)
 {
     void *client = handle ? handle : g_mqtt_client;
@@ -551,6 +698,25 @@ int IOT_MQTT_Publish_Simple(void *handle, const char *topic_name, int qos, void
     return rc;
 }
 
+int IOT_MQTT_Publish_Ref(void *handle, const char *topic_name, iotx_mqtt_topic_info_pt topic_msg,
+                         iotx_mqtt_payload_free_fpt payload_free)
+{
+    void *client = handle ? handle : g_mqtt_client;
+    int                 rc = -1;
+
+    if (client == NULL || topic_name == NULL || strlen(topic_name) == 0) {
+        mqtt_err("params err");
+        if (payload_free != NULL && topic_msg != NULL && topic_msg->payload != NULL) {
+            payload_free((void *)topic_msg->payload);
+        }
+        return STATE_USER_INPUT_INVALID;
+    }
+
+    rc = wrapper_mqtt_publish_ref(client, topic_name, topic_msg, payload_free);
+    iotx_state_event(ITE_STATE_MQTT_COMM, STATE_MQTT_PUB_INFO, "pub - '%s': %d", topic_name, rc);
+    return rc;
+}
+
 int IOT_MQTT_Nwk_Event_Handler(void *handle, iotx_mqtt_nwk_event_t event, iotx_mqtt_nwk_param_t *param)
 {
 #ifdef ASYNC_PROTOCOL_STACK
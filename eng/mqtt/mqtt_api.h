@@ -12,7 +12,10 @@ extern "C" {
 #include "infra_types.h"
 #include "infra_defs.h"
 
-#define MUTLI_SUBSCIRBE_MAX                                     (5)
+/* maximum topic filters in one SUBSCRIBE packet, see IOT_MQTT_Subscribe_Multi_Sync() */
+#ifndef MUTLI_SUBSCIRBE_MAX
+    #define MUTLI_SUBSCIRBE_MAX                                 (16)
+#endif
 
 /* From mqtt_client.h */
 typedef enum {
@@ -79,6 +82,9 @@ typedef struct {
     const char     *payload;
 } iotx_mqtt_topic_info_t, *iotx_mqtt_topic_info_pt;
 
+/* free function of payload passed to IOT_MQTT_Publish_Ref() */
+typedef void (*iotx_mqtt_payload_free_fpt)(void *payload);
+
 
 typedef struct {
 
@@ -125,6 +131,35 @@ typedef struct {
 typedef void (*iotx_mqtt_event_handle_func_fpt)(void *pcontext, void *pclient, iotx_mqtt_event_msg_pt msg);
 
 
+/* The structure of a chunk of inbound PUBLISH message which is too large for read buffer */
+typedef struct {
+    uint16_t        packet_id;
+    uint8_t         qos;
+    uint8_t         dup;
+    uint8_t         retain;
+    uint16_t        topic_len;
+    const char     *ptopic;
+    uint32_t        total_len;          /* payload length of the whole message */
+    uint32_t        offset;             /* offset of this chunk in payload */
+    uint32_t        chunk_len;
+    const char     *chunk;              /* NULL if message is broken off by network error */
+} iotx_mqtt_chunk_info_t, *iotx_mqtt_chunk_info_pt;
+
+/**
+ * @brief It define a datatype of function pointer.
+ *        This type of function will be called with each chunk of a large inbound PUBLISH message in order,
+ *        offset 0 starts a message and offset plus chunk_len equal to total_len ends it.
+ *        Topic and chunk are only valid during the call.
+ *
+ * @param pcontext : The program context.
+ * @param pclient : The MQTT client.
+ * @param chunk : The chunk.
+ *
+ * @return none
+ */
+typedef void (*iotx_mqtt_chunk_handle_func_fpt)(void *pcontext, void *pclient, iotx_mqtt_chunk_info_pt chunk);
+
+
 /* The structure of MQTT event handle */
 typedef struct {
     iotx_mqtt_event_handle_func_fpt     h_fp;
@@ -132,6 +167,58 @@ typedef struct {
 } iotx_mqtt_event_handle_t, *iotx_mqtt_event_handle_pt;
 
 
+/* The structure of a topic filter subscribed by IOT_MQTT_Subscribe_Multi_Sync() */
+typedef struct {
+    const char                         *topic_filter;
+    iotx_mqtt_qos_t                     qos;
+    iotx_mqtt_event_handle_func_fpt     topic_handle_func;
+    void                               *pcontext;
+    iotx_mqtt_chunk_handle_func_fpt     chunk_handle_func;  /* optional, see WITH_MQTT_STREAM_RX */
+    int                                 result;             /* granted QoS in SUBACK, or negative state code */
+} iotx_mqtt_sub_entry_t, *iotx_mqtt_sub_entry_pt;
+
+
+/* Fill level of application queue fed by MQTT callbacks, in percent of its capacity */
+typedef int (*iotx_mqtt_backlog_fpt)(void *pcontext);
+
+/* The structure of MQTT receive statistics */
+typedef struct {
+    uint32_t                            backlog;            /* fill level of the fullest queue in percent */
+    uint32_t                            backlog_peak;       /* highest fill level seen */
+    uint32_t                            paused;             /* 1 if reading is paused now */
+    uint32_t                            pause_count;        /* times reading was paused */
+    uint32_t                            pause_ms;           /* total time reading was paused */
+    uint32_t                            duplicates;         /* QoS1 retransmissions acknowledged without delivery */
+} iotx_mqtt_rx_stats_t, *iotx_mqtt_rx_stats_pt;
+
+/* The structure of MQTT keepalive statistics */
+typedef struct {
+    uint32_t                            interval_ms;        /* idle time before PINGREQ is sent */
+    uint32_t                            safe_ms;            /* longest idle time connection survived, adaptive mode only */
+    uint32_t                            ping_sent;          /* PINGREQ sent */
+    uint32_t                            ping_resp;          /* PINGRESP received */
+    uint32_t                            ping_lost;          /* connections dropped for PINGREQ not answered */
+} iotx_mqtt_keepalive_stats_t, *iotx_mqtt_keepalive_stats_pt;
+
+/* Class of published topic, held back publishes are sent in this order, see IOT_MQTT_Set_Rate_Limit() */
+typedef enum {
+    IOTX_MQTT_RATE_CLASS_REPLY = 0,     /* replies to service and RRPC, never held back */
+    IOTX_MQTT_RATE_CLASS_PROPERTY,      /* property post */
+    IOTX_MQTT_RATE_CLASS_EVENT,         /* event post */
+    IOTX_MQTT_RATE_CLASS_RAW,           /* raw data of thing model */
+    IOTX_MQTT_RATE_CLASS_DEFAULT,       /* other topics */
+    IOTX_MQTT_RATE_CLASS_LOG,           /* device log */
+    IOTX_MQTT_RATE_CLASS_MAX            /* the whole device */
+} iotx_mqtt_rate_class_t;
+
+/* The structure of MQTT publish rate limit statistics */
+typedef struct {
+    uint32_t                            queued;             /* publishes waiting for tokens now */
+    uint32_t                            deferred;           /* publishes which had to wait for tokens */
+    uint32_t                            rejected;           /* publishes failed as queue was full */
+} iotx_mqtt_rate_stats_t, *iotx_mqtt_rate_stats_pt;
+
+
 /* The structure of MQTT initial parameter */
 typedef struct {
 
@@ -148,7 +235,7 @@ typedef struct {
 
     const char                 *pub_key;
 
-    uint8_t                     clean_session;            /* Specify MQTT clean session or not*/
+    uint8_t                     clean_session;            /* Specify MQTT clean session or not, see WITH_MQTT_SESSION_RESUME */
     uint32_t                    request_timeout_ms;       /* Specify timeout of a MQTT request in millisecond */
     uint32_t                    keepalive_interval_ms;    /* Specify MQTT keep-alive interval in millisecond */
     uint32_t                    write_buf_size;           /* Specify size of write-buffer in byte */
@@ -190,6 +277,21 @@ typedef struct {
  */
 void *IOT_MQTT_Construct(iotx_mqtt_param_t *pInitParams);
 
+/**
+ * @brief Construct one more MQTT client besides the one of IOT_MQTT_Construct(), so that traffic is spread
+ *        over several connections. Unlike IOT_MQTT_Construct(), device identity is not taken from IOT_Ioctl(),
+ *        'host', 'port', 'client_id', 'username' and 'password' must be given and kept valid until destroyed,
+ *        and they should differ from those of other connections, since server drops the older connection
+ *        of the same identity.
+ *
+ * @param [in] pInitParams: specify the MQTT client parameter.
+ *
+ * @retval     NULL : Construct failed.
+ * @retval NOT_NULL : The handle of MQTT client, destroyed by IOT_MQTT_Destroy().
+ * @see IOT_MQTT_Construct().
+ */
+void *IOT_MQTT_Construct_Multi(iotx_mqtt_param_t *pInitParams);
+
 
 /**
  * @brief Deconstruct the MQTT client
@@ -216,6 +318,18 @@ int IOT_MQTT_Destroy(void **phandle);
  */
 int IOT_MQTT_Yield(void *handle, int timeout_ms);
 
+/**
+ * @brief Send outbound packets queued by publish and acknowledge at once.
+ *        They are sent by IOT_MQTT_Yield() otherwise, call this when it is not running soon.
+ *
+ * @param [in] handle: specify the MQTT client.
+ *
+ * @retval  0 : Flush success.
+ * @retval <0 : Flush failed, MQTT is offline or network error occurred.
+ * @see IOT_MQTT_Yield().
+ */
+int IOT_MQTT_Flush(void *handle);
+
 /**
  * @brief check whether MQTT connection is established or not.
  *
@@ -227,6 +341,77 @@ int IOT_MQTT_Yield(void *handle, int timeout_ms);
  */
 int IOT_MQTT_CheckStateNormal(void *handle);
 
+/**
+ * @brief Get keepalive interval in use and PINGREQ counts.
+ *        PINGREQ is only sent after neither sending nor receiving for the interval, which is probed
+ *        for the longest idle time the connection survives when WITH_MQTT_ADAPTIVE_KEEPALIVE is enabled.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [out] stats: keepalive statistics.
+ *
+ * @retval  0 : Success.
+ * @retval <0 : Failed, the value is error code.
+ * @see None.
+ */
+int IOT_MQTT_Keepalive_Stats(void *handle, iotx_mqtt_keepalive_stats_pt stats);
+
+/**
+ * @brief Tell MQTT client how full the application queue fed by its callbacks is. With WITH_MQTT_RX_BACKPRESSURE
+ *        the client stops reading socket when it, or the queue of dispatch workers, is filled above
+ *        IOTX_MC_RX_HIGH_WATERMARK, and resumes when all are below IOTX_MC_RX_LOW_WATERMARK, so that
+ *        messages wait in TCP window and on server instead of being dropped.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] backlog_fp: returns fill level in percent, called by the thread running IOT_MQTT_Yield(), NULL to clear.
+ * @param [in] pcontext: passed back to 'backlog_fp'.
+ *
+ * @retval  0 : Success, it is ignored without WITH_MQTT_RX_BACKPRESSURE.
+ * @retval <0 : Failed, the value is error code.
+ * @see IOT_MQTT_Rx_Stats().
+ */
+int IOT_MQTT_Set_Backlog_Source(void *handle, iotx_mqtt_backlog_fpt backlog_fp, void *pcontext);
+
+/**
+ * @brief Get fill level of application queues, how long reading socket was paused for them, and how many
+ *        QoS1 retransmissions were dropped as duplicates.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [out] stats: receive statistics, backpressure ones are zero without WITH_MQTT_RX_BACKPRESSURE.
+ *
+ * @retval  0 : Success.
+ * @retval <0 : Failed, the value is error code.
+ * @see IOT_MQTT_Set_Backlog_Source().
+ */
+int IOT_MQTT_Rx_Stats(void *handle, iotx_mqtt_rx_stats_pt stats);
+
+/**
+ * @brief Limit publish rate of a class of topics, or of the whole device. With WITH_MQTT_PUB_RATE_LIMIT
+ *        a publish takes a token from both buckets, and one finding either empty is queued and sent
+ *        by IOT_MQTT_Yield() later, in order of class. Replies are never held back.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] cls: class of topics, IOTX_MQTT_RATE_CLASS_MAX for the whole device.
+ * @param [in] per_sec: publishes per second, 0 for unlimited.
+ * @param [in] burst: publishes sent at once after being idle.
+ *
+ * @retval  0 : Success, it is ignored without WITH_MQTT_PUB_RATE_LIMIT.
+ * @retval <0 : Failed, the value is error code.
+ * @see IOT_MQTT_Rate_Stats().
+ */
+int IOT_MQTT_Set_Rate_Limit(void *handle, iotx_mqtt_rate_class_t cls, uint32_t per_sec, uint32_t burst);
+
+/**
+ * @brief Get how many publishes are held back by rate limit, and how many were so far.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [out] stats: rate limit statistics, all zero without WITH_MQTT_PUB_RATE_LIMIT.
+ *
+ * @retval  0 : Success.
+ * @retval <0 : Failed, the value is error code.
+ * @see IOT_MQTT_Set_Rate_Limit().
+ */
+int IOT_MQTT_Rate_Stats(void *handle, iotx_mqtt_rate_stats_pt stats);
+
 
 /**
  * @brief Subscribe MQTT topic.
@@ -235,6 +420,8 @@ int IOT_MQTT_CheckStateNormal(void *handle);
  * @param [in] topic_filter: specify the topic filter.
  * @param [in] qos: specify the MQTT Requested QoS.
  * @param [in] topic_handle_func: specify the topic handle callback-function.
+ *             With WITH_MQTT_DISPATCH it is called by dispatch worker thread instead of the one calling
+ *             IOT_MQTT_Yield(), and must not destroy the client.
  * @param [in] pcontext: specify context. When call 'topic_handle_func', it will be passed back.
  *
  * @retval -1  : Subscribe failed.
@@ -272,6 +459,28 @@ int IOT_MQTT_Subscribe_Sync(void *handle,
                             void *pcontext,
                             int timeout_ms);
 
+/**
+ * @brief Subscribe several MQTT topics and wait suback of all of them.
+ *        Topics are packed into SUBSCRIBE packets of at most MUTLI_SUBSCIRBE_MAX topics, which are sent
+ *        one after another without waiting suback of the previous one.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in,out] entry: specify the topics, 'result' of each is set to granted QoS when suback accepts it,
+ *        STATE_MQTT_SUB_REFUSED when suback refuses it, STATE_MQTT_SYNC_SUB_TIMEOUT when no suback
+ *        came in time, or other negative state code when it is not sent. 'chunk_handle_func' of it, if any,
+ *        receives messages too large for read buffer in chunks when SDK is built with WITH_MQTT_STREAM_RX.
+ * @param [in] count: specify count of entry.
+ * @param [in] timeout_ms: time in ms to wait.
+ *
+ * @retval < 0 : Subscribe failed, e.g. client is offline.
+ * @retval >=0 : Count of topics subscribed successfully.
+ * @see None.
+ */
+int IOT_MQTT_Subscribe_Multi_Sync(void *handle,
+                                  iotx_mqtt_sub_entry_t *entry,
+                                  int count,
+                                  int timeout_ms);
+
 
 /**
  * @brief Unsubscribe MQTT topic.
@@ -300,6 +509,10 @@ int IOT_MQTT_Unsubscribe(void *handle, const char *topic_filter);
  * @retval >0 :  Publish successful, where QoS is >= 0.
         The value is a unique ID of this request.
         The ID will be passed back when callback 'iotx_mqtt_param_t:handle_event'.
+ * @note With WITH_MQTT_JOURNAL, publish made while connection is lost is kept in KV storage and 0 is returned,
+ *       it is sent after reconnected.
+ * @note With WITH_MQTT_SUBMIT_QUEUE, publish is only serialized and queued, it is sent by IOT_MQTT_Yield().
+ *       STATE_MQTT_SUBMIT_QUEUE_FULL is returned if IOT_MQTT_Yield() falls behind, retry it later.
  * @see None.
  */
 int IOT_MQTT_Publish(void *handle, const char *topic_name, iotx_mqtt_topic_info_pt topic_msg);
@@ -320,6 +533,26 @@ int IOT_MQTT_Publish(void *handle, const char *topic_name, iotx_mqtt_topic_info_
  * @see None.
  */
 int IOT_MQTT_Publish_Simple(void *handle, const char *topic_name, int qos, void *data, int len);
+/**
+ * @brief Publish message to specific topic without copying its payload.
+ *        The payload is sent from 'topic_msg->payload' and kept by reference until PUBACK where QoS is 1,
+ *        so it must not be modified after this call.
+ *
+ * @param [in] handle: specify the MQTT client.
+ * @param [in] topic_name: specify the topic name.
+ * @param [in] topic_msg: specify the topic message.
+ * @param [in] payload_free: called with 'topic_msg->payload' once it is no longer referenced,
+ *        also when publish fails. NULL if the payload stays valid until PUBACK or destroy of the client.
+ *
+ * @retval <0 :  Publish failed.
+ * @retval  0 :  Publish successful, where QoS is 0.
+ * @retval >0 :  Publish successful, where QoS is >= 0.
+        The value is a unique ID of this request.
+        The ID will be passed back when callback 'iotx_mqtt_param_t:handle_event'.
+ * @see IOT_MQTT_Publish().
+ */
+int IOT_MQTT_Publish_Ref(void *handle, const char *topic_name, iotx_mqtt_topic_info_pt topic_msg,
+                         iotx_mqtt_payload_free_fpt payload_free);
 /* From mqtt_client.h */
 /** @} */ /* end of api_mqtt */
 
@@ -8,7 +8,13 @@
 void *wrapper_mqtt_init(iotx_mqtt_param_t *mqtt_params);
 int wrapper_mqtt_connect(void *client);
 int wrapper_mqtt_yield(void *client, int timeout_ms);
+int wrapper_mqtt_flush(void *client);
 int wrapper_mqtt_check_state(void *client);
+int wrapper_mqtt_keepalive_stats(void *client, iotx_mqtt_keepalive_stats_pt stats);
+int wrapper_mqtt_set_backlog_source(void *client, iotx_mqtt_backlog_fpt backlog_fp, void *pcontext);
+int wrapper_mqtt_rx_stats(void *client, iotx_mqtt_rx_stats_pt stats);
+int wrapper_mqtt_set_rate_limit(void *client, iotx_mqtt_rate_class_t cls, uint32_t per_sec, uint32_t burst);
+int wrapper_mqtt_rate_stats(void *client, iotx_mqtt_rate_stats_pt stats);
 int wrapper_mqtt_subscribe(void *client,
                            const char *topicFilter,
                            iotx_mqtt_qos_t qos,
@@ -20,8 +26,11 @@ int wrapper_mqtt_subscribe_sync(void *client,
                                 iotx_mqtt_event_handle_func_fpt topic_handle_func,
                                 void *pcontext,
                                 int timeout_ms);
+int wrapper_mqtt_subscribe_multi_sync(void *client, iotx_mqtt_sub_entry_t *entry, int count, int timeout_ms);
 int wrapper_mqtt_unsubscribe(void *client, const char *topicFilter);
 int wrapper_mqtt_publish(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg);
+int wrapper_mqtt_publish_ref(void *client, const char *topicName, iotx_mqtt_topic_info_pt topic_msg,
+                             iotx_mqtt_payload_free_fpt payload_free);
 int wrapper_mqtt_release(void **pclient);
 int wrapper_mqtt_nwk_event_handler(void *client, iotx_mqtt_nwk_event_t event, iotx_mqtt_nwk_param_t *param);
 
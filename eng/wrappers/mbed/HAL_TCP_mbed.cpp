@@ -16,6 +16,7 @@
  * limitations under the License.
  */
 
+#include <string.h>
 #include "wrappers/wrappers.h"
 #include "platform/plat_oride.h"
 #include "misc/hal_log.h"
@@ -131,6 +132,104 @@ int32_t HAL_TCP_Write(uintptr_t fd, const char *buf, uint32_t len, uint32_t time
     return len_xfer;
 }
 
+/* Buffers up to this size are gathered and sent together, so that they share TCP segments */
+#define TCP_WRITEV_GATHER_LEN   (1024)
+
+/* Send one part of HAL_TCP_Writev(), return 1 if sent completely, 0 on timeout, -1 on error */
+static int _tcp_writev_part(uintptr_t fd, const char *buf, uint32_t len, uint32_t timeout_ms, Timer &t, uint32_t *sent)
+{
+    uint32_t elapsed_ms = t.read_ms();
+
+    if (elapsed_ms >= timeout_ms) {
+        return 0;
+    }
+
+    int32_t rc = HAL_TCP_Write(fd, buf, len, timeout_ms - elapsed_ms);
+    if (rc < 0) {
+        return -1;
+    }
+    *sent += rc;
+
+    return (static_cast<uint32_t>(rc) == len) ? 1 : 0;
+}
+
+int32_t HAL_TCP_Writev(uintptr_t fd, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms)
+{
+    /* Check 'fd' parameter */
+    if (fd == static_cast<uintptr_t>(-1) || (iov == NULL && iovcnt > 0)) {
+        hal_err("Invalid fd: %d", fd);
+        return -1;
+    }
+
+    uint32_t total = 0;
+    for (int idx = 0; idx < iovcnt; idx++) {
+        total += iov[idx].len;
+    }
+
+    uint32_t gather_size = (total < TCP_WRITEV_GATHER_LEN) ? total : TCP_WRITEV_GATHER_LEN;
+    char *gather = (iovcnt > 1 && gather_size > 0) ? static_cast<char *>(HAL_Malloc(gather_size)) : NULL;
+    if (gather == NULL) {
+        /* send buffers one by one */
+        gather_size = 0;
+    }
+
+    uint32_t gather_len = 0;
+    uint32_t len_xfer = 0;
+    int ret = 1;
+    Timer t;
+    t.start();
+
+    for (int idx = 0; idx <= iovcnt && ret > 0; idx++) {
+        /* send gathered bytes before a buffer which does not fit in, and at the end */
+        if (gather_len > 0 && (idx == iovcnt || gather_len + iov[idx].len > gather_size)) {
+            ret = _tcp_writev_part(fd, gather, gather_len, timeout_ms, t, &len_xfer);
+            gather_len = 0;
+            if (ret <= 0) {
+                break;
+            }
+        }
+        if (idx == iovcnt || iov[idx].len == 0) {
+            continue;
+        }
+
+        if (iov[idx].len <= gather_size) {
+            memcpy(gather + gather_len, iov[idx].base, iov[idx].len);
+            gather_len += iov[idx].len;
+        } else {
+            ret = _tcp_writev_part(fd, static_cast<const char *>(iov[idx].base), iov[idx].len, timeout_ms, t, &len_xfer);
+        }
+    }
+
+    if (gather != NULL) {
+        HAL_Free(gather);
+    }
+
+    return (ret < 0 && len_xfer == 0) ? -1 : static_cast<int32_t>(len_xfer);
+}
+
+/* Socket event callback, runs in network stack context so just signal the waiting thread */
+static void _tcp_socket_sigio(void *sem)
+{
+    static_cast<Semaphore *>(sem)->release();
+}
+
+int HAL_TCP_WaitReadable(uintptr_t fd, void *sem, uint32_t timeout_ms)
+{
+    /* Check 'fd' parameter */
+    if (fd == static_cast<uintptr_t>(-1) || sem == NULL) {
+        hal_err("Invalid fd: %d", fd);
+        return -1;
+    }
+
+    /* Cast 'fd' to 'TCPSocket *' */
+    TCPSocket *tcpsocket = reinterpret_cast<TCPSocket *>(fd);
+
+    /* Bind socket events to 'sem'. Events arriving between two waits stay counted in 'sem'. */
+    tcpsocket->sigio(mbed::callback(_tcp_socket_sigio, sem));
+
+    return static_cast<Semaphore *>(sem)->try_acquire_for(timeout_ms) ? 1 : 0;
+}
+
 int32_t HAL_TCP_Read(uintptr_t fd, char *buf, uint32_t len, uint32_t timeout_ms)
 {
     /* Check 'fd' parameter */
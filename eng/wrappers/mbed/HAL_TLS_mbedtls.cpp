@@ -1088,6 +1088,50 @@ uintptr_t HAL_SSL_Establish(const char *host,
     return (uintptr_t)pTlsData;
 }
 
+int HAL_SSL_Pending(uintptr_t handle)
+{
+    if ((uintptr_t)NULL == handle) {
+        return -1;
+    }
+
+    return (int)mbedtls_ssl_get_bytes_avail(&(((TLSDataParams_t *)handle)->ssl));
+}
+
+#if defined(__MBED__)
+/* Socket event callback, runs in network stack context so just signal the waiting thread */
+static void _ssl_socket_sigio(void *sem)
+{
+    static_cast<Semaphore *>(sem)->release();
+}
+#endif
+
+int HAL_SSL_WaitReadable(uintptr_t handle, void *sem, uint32_t timeout_ms)
+{
+    TLSDataParams_t *pTlsData = (TLSDataParams_t *)handle;
+
+    if (pTlsData == NULL || sem == NULL) {
+        return -1;
+    }
+
+    /* Records already decrypted are readable at once */
+    if (mbedtls_ssl_get_bytes_avail(&pTlsData->ssl) > 0) {
+        return 1;
+    }
+
+#if defined(__MBED__)
+    if (pTlsData->fd.sock == NULL) {
+        return -1;
+    }
+
+    /* Bind socket events to 'sem'. Events arriving between two waits stay counted in 'sem'. */
+    pTlsData->fd.sock->sigio(mbed::callback(_ssl_socket_sigio, sem));
+
+    return static_cast<Semaphore *>(sem)->try_acquire_for(timeout_ms) ? 1 : 0;
+#else
+    return 1;
+#endif
+}
+
 int HAL_SSL_Read(uintptr_t handle, char *buf, int len, int timeout_ms)
 {
     return _network_ssl_read((TLSDataParams_t *)handle, buf, len, timeout_ms);;
@@ -1098,6 +1142,83 @@ int HAL_SSL_Write(uintptr_t handle, const char *buf, int len, int timeout_ms)
     return _network_ssl_write((TLSDataParams_t *)handle, buf, len, timeout_ms);
 }
 
+/* Buffers up to this size are gathered and written together, so that they share TLS records */
+#define SSL_WRITEV_GATHER_LEN   (1024)
+
+/* Write one part of HAL_SSL_Writev(), return 1 if written completely, 0 on timeout, -1 on error */
+static int _network_ssl_writev_part(TLSDataParams_t *pTlsData, const char *buf, int len,
+                                    int timeout_ms, uint64_t start_ms, int *sent)
+{
+    uint64_t elapsed = HAL_UptimeMs() - start_ms;
+    int ret = 0;
+
+    if (elapsed >= (uint64_t)timeout_ms) {
+        return 0;
+    }
+
+    ret = _network_ssl_write(pTlsData, buf, len, timeout_ms - (int)elapsed);
+    if (ret < 0) {
+        return -1;
+    }
+    *sent += ret;
+
+    return (ret == len) ? 1 : 0;
+}
+
+int HAL_SSL_Writev(uintptr_t handle, const hal_iovec_t *iov, int iovcnt, int timeout_ms)
+{
+    TLSDataParams_t *pTlsData = (TLSDataParams_t *)handle;
+    uint64_t start_ms = HAL_UptimeMs();
+    uint32_t total = 0, gather_size = 0, gather_len = 0;
+    char *gather = NULL;
+    int idx = 0, ret = 1, sent = 0;
+
+    if (pTlsData == NULL || (iov == NULL && iovcnt > 0)) {
+        return -1;
+    }
+
+    for (idx = 0; idx < iovcnt; idx++) {
+        total += iov[idx].len;
+    }
+    gather_size = (total < SSL_WRITEV_GATHER_LEN) ? total : SSL_WRITEV_GATHER_LEN;
+    if (iovcnt > 1 && gather_size > 0) {
+        gather = (char *)HAL_Malloc(gather_size);
+    }
+    if (gather == NULL) {
+        /* write buffers one by one */
+        gather_size = 0;
+    }
+
+    for (idx = 0; idx <= iovcnt && ret > 0; idx++) {
+        /* write gathered bytes before a buffer which does not fit in, and at the end */
+        if (gather_len > 0 && (idx == iovcnt || gather_len + iov[idx].len > gather_size)) {
+            ret = _network_ssl_writev_part(pTlsData, gather, gather_len, timeout_ms, start_ms, &sent);
+            gather_len = 0;
+            if (ret <= 0) {
+                break;
+            }
+        }
+        if (idx == iovcnt || iov[idx].len == 0) {
+            continue;
+        }
+
+        if (iov[idx].len <= gather_size) {
+            memcpy(gather + gather_len, iov[idx].base, iov[idx].len);
+            gather_len += iov[idx].len;
+        } else {
+            /* large buffer is split into records by TLS anyway, write it without copy */
+            ret = _network_ssl_writev_part(pTlsData, (const char *)iov[idx].base, iov[idx].len,
+                                           timeout_ms, start_ms, &sent);
+        }
+    }
+
+    if (gather != NULL) {
+        HAL_Free(gather);
+    }
+
+    return (ret < 0 && sent == 0) ? -1 : sent;
+}
+
 int32_t HAL_SSL_Destroy(uintptr_t handle)
 {
     if ((uintptr_t)NULL == handle) {
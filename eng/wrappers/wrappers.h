@@ -490,6 +490,70 @@ uintptr_t HAL_SSL_Establish(const char *host,
                             uint32_t ca_crt_len);
 
 
+/**
+ * @brief Get the number of bytes which have been received and decrypted on the SSL connection
+ *        but not yet consumed by HAL_SSL_Read(). Reading up to this many bytes never blocks.
+ *
+ * @param[in] handle @n the handle of the SSL connection.
+ * @return
+   @verbatim
+     >= 0: number of bytes readable without blocking.
+     <  0: error occur.
+   @endverbatim
+ * @see None.
+ * @note Implementations which cannot tell it may return 0, the SDK then reads exactly the bytes it needs.
+ */
+int HAL_SSL_Pending(uintptr_t handle);
+
+
+/**
+ * @brief Wait until data may be readable on the SSL connection, or until @p sem is posted.
+ *        Events of the underlying socket are signalled through @p sem as well, so another thread
+ *        can wake up the waiting one by HAL_SemaphorePost(@p sem).
+ *
+ * @param[in] handle @n the handle of the SSL connection.
+ * @param[in] sem @n semaphore created by HAL_SemaphoreCreate(), used as wakeup handle.
+ * @param[in] timeout_ms @n maximum time to wait in millisecond.
+ * @return
+   @verbatim
+     = 1: data may be readable or @p sem is posted, spurious wakeup is allowed.
+     = 0: timeout.
+     < 0: error occur.
+   @endverbatim
+ * @see HAL_SSL_Pending().
+ * @note Implementations which cannot wait for socket events should return 1 at once,
+ *       the SDK then blocks in HAL_SSL_Read() instead.
+ * @note Socket events may be edge triggered. The SDK keeps reading until HAL_SSL_Read()
+ *       returns less than asked for before it waits again, so data left in the socket
+ *       after an event needs no event of its own.
+ */
+int HAL_SSL_WaitReadable(uintptr_t handle, void *sem, uint32_t timeout_ms);
+
+
+/**
+ * @brief Wait until data may be readable on the TCP connection, or until @p sem is posted.
+ *        Events of the socket are signalled through @p sem as well, so another thread
+ *        can wake up the waiting one by HAL_SemaphorePost(@p sem).
+ *
+ * @param[in] fd @n the handle of the TCP connection.
+ * @param[in] sem @n semaphore created by HAL_SemaphoreCreate(), used as wakeup handle.
+ * @param[in] timeout_ms @n maximum time to wait in millisecond.
+ * @return
+   @verbatim
+     = 1: data may be readable or @p sem is posted, spurious wakeup is allowed.
+     = 0: timeout.
+     < 0: error occur.
+   @endverbatim
+ * @see HAL_SSL_WaitReadable().
+ * @note Implementations which cannot wait for socket events should return 1 at once,
+ *       the SDK then blocks in HAL_TCP_Read() instead.
+ * @note Socket events may be edge triggered. The SDK keeps reading until HAL_TCP_Read()
+ *       returns less than asked for before it waits again, so data left in the socket
+ *       after an event needs no event of its own.
+ */
+int HAL_TCP_WaitReadable(uintptr_t fd, void *sem, uint32_t timeout_ms);
+
+
 /**
  *
  * 函数 HAL_SSL_Read() 需要SDK的使用者针对SDK将运行的硬件平台填充实现, 供SDK调用
@@ -532,6 +596,42 @@ int HAL_SSL_Read(uintptr_t handle, char *buf, int len, int timeout_ms);
 int HAL_SSL_Write(uintptr_t handle, const char *buf, int len, int timeout_ms);
 
 
+/**
+ * @brief Write several buffers to the SSL connection as if they were one contiguous buffer.
+ *        Small buffers should be gathered so that they share TLS records.
+ *
+ * @param[in] handle @n the handle of the SSL connection.
+ * @param[in] iov @n array of buffers to be written in order.
+ * @param[in] iovcnt @n number of elements in @p iov.
+ * @param[in] timeout_ms @n maximum time to write in millisecond.
+ * @return
+   @verbatim
+     >= 0: bytes written in total, less than the sum of lengths in @p iov on timeout.
+     <  0: error occur.
+   @endverbatim
+ * @see HAL_SSL_Write().
+ */
+int HAL_SSL_Writev(uintptr_t handle, const hal_iovec_t *iov, int iovcnt, int timeout_ms);
+
+
+/**
+ * @brief Write several buffers to the TCP connection as if they were one contiguous buffer.
+ *        Small buffers should be gathered so that they share TCP segments.
+ *
+ * @param[in] fd @n the handle of the TCP connection.
+ * @param[in] iov @n array of buffers to be written in order.
+ * @param[in] iovcnt @n number of elements in @p iov.
+ * @param[in] timeout_ms @n maximum time to write in millisecond.
+ * @return
+   @verbatim
+     >= 0: bytes written in total, less than the sum of lengths in @p iov on timeout.
+     <  0: error occur.
+   @endverbatim
+ * @see HAL_SSL_Writev().
+ */
+int32_t HAL_TCP_Writev(uintptr_t fd, const hal_iovec_t *iov, int iovcnt, uint32_t timeout_ms);
+
+
 /**
  *
  * 函数 HAL_SemaphoreCreate() 需要SDK的使用者针对SDK将运行的硬件平台填充实现, 供SDK调用
@@ -12,6 +12,12 @@ typedef struct {
     void (*free)(void *ptr);
 } ssl_hooks_t;
 
+/* one buffer of scatter-gather write, see HAL_SSL_Writev() */
+typedef struct {
+    const void *base;
+    uint32_t    len;
+} hal_iovec_t;
+
 typedef enum {
     os_thread_priority_idle = -3,        /* priority: idle (lowest) */
     os_thread_priority_low = -2,         /* priority: low */